@@ -516,6 +516,54 @@ struct TypeConversion<rdcpair<A, B>, false>
   static PyObject *ConvertToPy(const rdcpair<A, B> &in) { return ConvertToPy(in, NULL); }
 };
 
+// python object that owns a bytebuf and exposes its storage through the buffer protocol. bytebufs
+// returned by value from functions are returned as a read-only memoryview onto one of these, so
+// memoryview(), struct, numpy.frombuffer() and friends all read the data in place instead of making
+// another copy, and the data is freed once the last view onto it is released.
+struct PyByteBufOwner
+{
+  PyObject_HEAD
+  bytebuf *buf;
+};
+
+inline int PyByteBufOwner_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+  bytebuf *buf = ((PyByteBufOwner *)self)->buf;
+  return PyBuffer_FillInfo(view, self, buf->data(), (Py_ssize_t)buf->size(), 1, flags);
+}
+
+inline void PyByteBufOwner_dealloc(PyObject *self)
+{
+  PyByteBufOwner *owner = (PyByteBufOwner *)self;
+  delete owner->buf;
+  Py_TYPE(self)->tp_free(self);
+}
+
+inline PyTypeObject *GetByteBufOwnerType()
+{
+  static PyTypeObject type = {PyVarObject_HEAD_INIT(NULL, 0)};
+  static PyBufferProcs bufferProcs = {};
+  static bool ready = false;
+
+  if(ready)
+    return &type;
+
+  bufferProcs.bf_getbuffer = &PyByteBufOwner_getbuffer;
+
+  type.tp_name = "renderdoc.ByteBufferOwner";
+  type.tp_basicsize = sizeof(PyByteBufOwner);
+  type.tp_flags = Py_TPFLAGS_DEFAULT;
+  type.tp_doc = "Internal owner of bytes data returned from renderdoc, accessed via a memoryview";
+  type.tp_dealloc = &PyByteBufOwner_dealloc;
+  type.tp_as_buffer = &bufferProcs;
+
+  if(PyType_Ready(&type) < 0)
+    return NULL;
+
+  ready = true;
+  return &type;
+}
+
 // specialisation for bytebuf
 template <>
 struct TypeConversion<bytebuf, false>
@@ -524,13 +572,28 @@ struct TypeConversion<bytebuf, false>
   // nicer failure error messages out with the index that failed
   static int ConvertFromPy(PyObject *in, bytebuf &out, int *failIdx)
   {
-    if(!PyBytes_Check(in))
+    // fast path for plain bytes objects
+    if(PyBytes_Check(in))
+    {
+      out.assign((const byte *)PyBytes_AsString(in), (size_t)PyBytes_Size(in));
+      return SWIG_OK;
+    }
+
+    // otherwise accept anything that can give us a contiguous buffer - bytearray, memoryview,
+    // array.array, numpy arrays, etc.
+    if(!PyObject_CheckBuffer(in))
+      return SWIG_TypeError;
+
+    Py_buffer view = {};
+    if(PyObject_GetBuffer(in, &view, PyBUF_ANY_CONTIGUOUS) != 0)
+    {
+      PyErr_Clear();
       return SWIG_TypeError;
+    }
 
-    Py_ssize_t len = PyBytes_Size(in);
+    out.assign((const byte *)view.buf, (size_t)view.len);
 
-    out.resize((size_t)len);
-    memcpy(out.data(), PyBytes_AsString(in), out.size());
+    PyBuffer_Release(&view);
 
     return SWIG_OK;
   }
@@ -538,10 +601,34 @@ struct TypeConversion<bytebuf, false>
   static int ConvertFromPy(PyObject *in, bytebuf &out) { return ConvertFromPy(in, out, NULL); }
   static PyObject *ConvertToPyInPlace(PyObject *list, const bytebuf &in, int *failIdx)
   {
-    // can't modify bytes objects
+    // results are read-only, can't modify them in place
     return SWIG_Py_Void();
   }
 
+  // take ownership of the contents of in, leaving it empty. Used when the bytebuf is a temporary
+  // result so that the data is never copied.
+  static PyObject *ConvertToPyOwned(bytebuf &in, int *failIdx)
+  {
+    PyTypeObject *type = GetByteBufOwnerType();
+    if(!type)
+      return NULL;
+
+    PyByteBufOwner *owner = PyObject_New(PyByteBufOwner, type);
+    if(!owner)
+      return NULL;
+
+    owner->buf = new bytebuf;
+    owner->buf->swap(in);
+
+    // the memoryview holds the only reference to the owner
+    PyObject *ret = PyMemoryView_FromObject((PyObject *)owner);
+    Py_DECREF(owner);
+
+    return ret;
+  }
+
+  static PyObject *ConvertToPyOwned(bytebuf &in) { return ConvertToPyOwned(in, NULL); }
+  // anything else, such as struct members, is copied into a bytes object as it always has been
   static PyObject *ConvertToPy(const bytebuf &in, int *failIdx)
   {
     return PyBytes_FromStringAndSize((const char *)in.data(), (Py_ssize_t)in.size());
@@ -219,6 +219,13 @@ SIMPLE_TYPEMAPS(rdcinflexiblestr)
 SIMPLE_TYPEMAPS(rdcdatetime)
 SIMPLE_TYPEMAPS(bytebuf)
 
+// bytebufs returned by value are temporaries, so hand their storage straight to python as a
+// read-only memoryview instead of copying it. Struct members and other bytebufs are still returned
+// as bytes
+%typemap(out) bytebuf {
+  $result = TypeConversion<bytebuf>::ConvertToPyOwned(($1_ltype &)$1);
+}
+
 REFCOUNTED_TYPE(SDChunk);
 REFCOUNTED_TYPE(SDObject);
 
@@ -482,6 +489,16 @@ extern "C" PyObject *RENDERDOC_DumpObject(PyObject *obj)
     return PyObject_Repr(obj);
   }
 
+  // byte data returned from functions is a memoryview, dump it the same as bytes rather than as a
+  // list
+  if(PyMemoryView_Check(obj))
+  {
+    PyObject *bytes = PyBytes_FromObject(obj);
+    PyObject *ret = bytes ? PyObject_Repr(bytes) : NULL;
+    Py_XDECREF(bytes);
+    return ret;
+  }
+
   // also for ResourceId
   if(SWIG_ConvertPtr(obj, &resptr, SWIGTYPE_p_ResourceId, 0) != -1)
   {
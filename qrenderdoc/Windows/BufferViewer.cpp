@@ -477,6 +477,123 @@ struct BufferData
   size_t size() const { return storage.size(); }
 };
 
+// Windows of raw buffer data that have been read back for the paged buffer view, so that moving
+// back and forth between pages doesn't read them back again. After each page is displayed the
+// neighbouring pages are prefetched on the replay thread, so paging through a large buffer doesn't
+// usually wait on a readback at all. Windows are evicted least recently used first, so memory use
+// stays bounded no matter how large the buffer is, and everything is dropped whenever the data
+// could have changed.
+class BufferWindowCache
+{
+public:
+  uint32_t Generation()
+  {
+    QMutexLocker autolock(&m_Lock);
+    return m_Generation;
+  }
+
+  void Clear()
+  {
+    QMutexLocker autolock(&m_Lock);
+    m_Windows.clear();
+    m_TotalBytes = 0;
+    m_Generation++;
+  }
+
+  // called on the replay thread
+  bytebuf Fetch(IReplayController *r, uint32_t generation, ResourceId buffer, uint64_t offset,
+                uint64_t length)
+  {
+    WindowKey key = {buffer, offset, length};
+
+    {
+      QMutexLocker autolock(&m_Lock);
+      auto it = m_Windows.find(key);
+      if(it != m_Windows.end())
+      {
+        it->lastUse = ++m_UseCounter;
+        return it->data;
+      }
+    }
+
+    bytebuf data = r->GetBufferData(buffer, offset, length);
+    Insert(generation, key, data);
+    return data;
+  }
+
+  // called on the replay thread
+  void Prefetch(IReplayController *r, uint32_t generation, ResourceId buffer, uint64_t offset,
+                uint64_t length)
+  {
+    WindowKey key = {buffer, offset, length};
+
+    {
+      QMutexLocker autolock(&m_Lock);
+      if(generation != m_Generation || m_Windows.contains(key))
+        return;
+    }
+
+    Insert(generation, key, r->GetBufferData(buffer, offset, length));
+  }
+
+private:
+  struct WindowKey
+  {
+    ResourceId buffer;
+    uint64_t offset;
+    uint64_t length;
+
+    bool operator<(const WindowKey &o) const
+    {
+      if(buffer != o.buffer)
+        return buffer < o.buffer;
+      if(offset != o.offset)
+        return offset < o.offset;
+      return length < o.length;
+    }
+  };
+
+  struct Window
+  {
+    bytebuf data;
+    uint64_t lastUse = 0;
+  };
+
+  void Insert(uint32_t generation, const WindowKey &key, const bytebuf &data)
+  {
+    QMutexLocker autolock(&m_Lock);
+
+    // if we were cleared while this was being fetched, it may be stale
+    if(generation != m_Generation || data.size() > MaxBytes)
+      return;
+
+    Window &window = m_Windows[key];
+    m_TotalBytes -= window.data.size();
+    window.data = data;
+    window.lastUse = ++m_UseCounter;
+    m_TotalBytes += window.data.size();
+
+    while(m_TotalBytes > MaxBytes)
+    {
+      auto lru = m_Windows.begin();
+      for(auto it = m_Windows.begin(); it != m_Windows.end(); ++it)
+        if(it->lastUse < lru->lastUse)
+          lru = it;
+
+      m_TotalBytes -= lru->data.size();
+      m_Windows.erase(lru);
+    }
+  }
+
+  static const uint64_t MaxBytes = 64 * 1024 * 1024;
+
+  QMutex m_Lock;
+  QMap<WindowKey, Window> m_Windows;
+  uint64_t m_TotalBytes = 0;
+  uint64_t m_UseCounter = 0;
+  uint32_t m_Generation = 0;
+};
+
 struct BufferElementProperties
 {
   ResourceFormat format;
@@ -2346,6 +2463,8 @@ BufferViewer::BufferViewer(ICaptureContext &ctx, bool meshview, QWidget *parent)
 {
   ui->setupUi(this);
 
+  m_WindowCache.reset(new BufferWindowCache);
+
   ui->render->SetContext(m_Ctx);
 
   byteRangeStart = (RDSpinBox64 *)ui->byteRangeStart;
@@ -3430,14 +3549,27 @@ void BufferViewer::OnEventChanged(uint32_t eventId)
     ui->viewIndex->setValue(0);
   }
 
+  // paging within the same data can reuse fetched windows, anything else could have changed it
+  if(!m_PageChange)
+    m_WindowCache->Clear();
+  m_PageChange = false;
+
   QPointer<BufferViewer> me(this);
 
-  m_Ctx.Replay().AsyncInvoke([this, me, bufdata](IReplayController *r) {
+  QSharedPointer<BufferWindowCache> windowCache = m_WindowCache;
+  uint32_t windowGeneration = windowCache->Generation();
+
+  m_Ctx.Replay().AsyncInvoke([this, me, bufdata, windowCache,
+                              windowGeneration](IReplayController *r) {
     if(!me)
       return;
 
     BufferData *buf = NULL;
 
+    // neighbouring windows of the buffer to prefetch once this page has been displayed
+    ResourceId prefetchBuffer;
+    uint64_t prefetchOffsets[2] = {}, prefetchLengths[2] = {};
+
     if(m_MeshView)
     {
       if(bufdata->meshDispatch)
@@ -3579,12 +3711,17 @@ void BufferViewer::OnEventChanged(uint32_t eventId)
       bufdata->inConfig.unclampedNumRows =
           uint32_t((repeatedRangeEnd - repeatedRangeStart + buf->stride - 1) / buf->stride);
 
+      // each page is a window of the repeated range, starting at the paging offset and clamped
+      // to the MaxVisibleRows
+      const uint64_t pageStart = repeatedRangeStart;
+      const uint64_t pageStride = uint64_t(buf->stride) * MaxVisibleRows;
+      const uint64_t pageLength = uint64_t(buf->stride) * (MaxVisibleRows + 2);
+
       // advance the range by the paging offset
       repeatedRangeStart = qMin(repeatedRangeEnd, repeatedRangeStart + m_PagingByteOffset);
 
-      // calculate the length clamped to the MaxVisibleRows
       const uint64_t clampedRepeatedLength =
-          qMin(repeatedRangeEnd - repeatedRangeStart, uint64_t(buf->stride * (MaxVisibleRows + 2)));
+          qMin(repeatedRangeEnd - repeatedRangeStart, pageLength);
 
       if(m_IsBuffer)
       {
@@ -3592,20 +3729,34 @@ void BufferViewer::OnEventChanged(uint32_t eventId)
         {
           buf->storage.clear();
         }
-        else if(repeatedRangeStart > fixedLength)
+        else
         {
-          // if the repeated range subsection we're fetching is paged further in, we still need to
-          // fetch the fixed data from the 'start'
+          // the fixed data always comes from the 'start', even if the repeated range is paged
+          // further in
           if(fixedLength > 0)
             buf->storage = r->GetBufferData(m_BufferID, m_ByteOffset, fixedLength);
           // then append the data from where we're paged to
-          buf->storage.append(r->GetBufferData(m_BufferID, repeatedRangeStart, clampedRepeatedLength));
-        }
-        else
-        {
-          // otherwise we can fetch it all at once
-          buf->storage =
-              r->GetBufferData(m_BufferID, m_ByteOffset, fixedLength + clampedRepeatedLength);
+          buf->storage.append(windowCache->Fetch(r, windowGeneration, m_BufferID,
+                                                 repeatedRangeStart, clampedRepeatedLength));
+
+          if(repeatedRangeEnd - pageStart > pageStride)
+          {
+            prefetchBuffer = m_BufferID;
+
+            uint64_t next = repeatedRangeStart + pageStride;
+            if(next < repeatedRangeEnd)
+            {
+              prefetchOffsets[0] = next;
+              prefetchLengths[0] = qMin(repeatedRangeEnd - next, pageLength);
+            }
+
+            if(repeatedRangeStart >= pageStart + pageStride)
+            {
+              uint64_t prev = repeatedRangeStart - pageStride;
+              prefetchOffsets[1] = prev;
+              prefetchLengths[1] = qMin(repeatedRangeEnd - prev, pageLength);
+            }
+          }
         }
       }
       else
@@ -3908,6 +4059,17 @@ void BufferViewer::OnEventChanged(uint32_t eventId)
 
       INVOKE_MEMFN(RT_UpdateAndDisplay);
     });
+
+    // now that the current page is on its way to be displayed, fetch the pages either side of it
+    if(prefetchBuffer != ResourceId())
+    {
+      for(int i = 0; i < 2; i++)
+      {
+        if(prefetchLengths[i] > 0)
+          windowCache->Prefetch(r, windowGeneration, prefetchBuffer, prefetchOffsets[i],
+                                prefetchLengths[i]);
+      }
+    }
   });
 }
 
@@ -4289,8 +4451,225 @@ void BufferViewer::UI_RemoveOffsets(RDTreeWidgetItem *root)
   }
 }
 
+// formats that the bounding box calculation decodes directly. Anything else goes through the
+// generic decoding to QVariants, which is much slower on large meshes.
+enum class BoundsDecode
+{
+  Generic,
+  Float,
+  Half,
+  UNorm8,
+  SNorm8,
+  UNorm16,
+  SNorm16,
+};
+
+static BoundsDecode GetBoundsDecode(const ShaderConstant &el, const BufferElementProperties &prop)
+{
+  const ResourceFormat &fmt = prop.format;
+
+  if(fmt.type != ResourceFormatType::Regular || el.type.rows > 1 || el.type.columns > 4 ||
+     el.bitFieldSize != 0)
+    return BoundsDecode::Generic;
+
+  // BGRA needs at least three components to swizzle
+  if(fmt.BGRAOrder() && el.type.columns < 3)
+    return BoundsDecode::Generic;
+
+  if(fmt.compType == CompType::Float)
+  {
+    if(fmt.compByteWidth == 4)
+      return BoundsDecode::Float;
+    else if(fmt.compByteWidth == 2)
+      return BoundsDecode::Half;
+  }
+  else if(fmt.compType == CompType::UNorm || fmt.compType == CompType::UNormSRGB)
+  {
+    if(fmt.compByteWidth == 1)
+      return BoundsDecode::UNorm8;
+    else if(fmt.compByteWidth == 2)
+      return BoundsDecode::UNorm16;
+  }
+  else if(fmt.compType == CompType::SNorm)
+  {
+    if(fmt.compByteWidth == 1)
+      return BoundsDecode::SNorm8;
+    else if(fmt.compByteWidth == 2)
+      return BoundsDecode::SNorm16;
+  }
+
+  return BoundsDecode::Generic;
+}
+
+template <typename T, typename Convert>
+static void AccumulateBounds(const BufferConfiguration &s, const CachedElData &d, uint32_t rowBegin,
+                             uint32_t rowEnd, Convert convert, float *minOut, float *maxOut)
+{
+  const uint32_t numComps = (uint32_t)qBound(1, d.numColumns, 4);
+  const size_t byteSize = sizeof(T) * numComps;
+  const bool indexed = s.indices && s.indices->hasData();
+
+  // accumulate in locals, and swizzle once at the end for BGRA
+  const uint32_t swizzle[4] = {d.prop->format.BGRAOrder() ? 2U : 0U, 1U,
+                               d.prop->format.BGRAOrder() ? 0U : 2U, 3U};
+
+  float mins[4], maxs[4];
+  for(uint32_t c = 0; c < 4; c++)
+  {
+    mins[c] = minOut[swizzle[c]];
+    maxs[c] = maxOut[swizzle[c]];
+  }
+
+  for(uint32_t row = rowBegin; row < rowEnd; row++)
+  {
+    uint32_t idx = row;
+
+    if(indexed)
+    {
+      idx = CalcIndex(s.indices, row, s.baseVertex, s.primRestart);
+
+      if(idx == ~0U || (s.primRestart && idx == s.primRestart))
+        continue;
+    }
+
+    const byte *bytes = d.data;
+
+    if(!d.prop->perinstance)
+      bytes += d.stride * idx;
+
+    if(bytes + byteSize > d.end)
+      continue;
+
+    T comps[4];
+    memcpy(comps, bytes, byteSize);
+
+    for(uint32_t c = 0; c < numComps; c++)
+    {
+      float fval = convert(comps[c]);
+
+      if(qIsFinite(fval))
+      {
+        mins[c] = qMin(mins[c], fval);
+        maxs[c] = qMax(maxs[c], fval);
+      }
+    }
+  }
+
+  for(uint32_t c = 0; c < 4; c++)
+  {
+    minOut[swizzle[c]] = mins[c];
+    maxOut[swizzle[c]] = maxs[c];
+  }
+}
+
+static void AccumulateGenericBounds(const BufferConfiguration &s, const CachedElData &d,
+                                    uint32_t rowBegin, uint32_t rowEnd, float *minOut,
+                                    float *maxOut)
+{
+  for(uint32_t row = rowBegin; row < rowEnd; row++)
+  {
+    uint32_t idx = row;
+
+    if(s.indices && s.indices->hasData())
+    {
+      idx = CalcIndex(s.indices, row, s.baseVertex, s.primRestart);
+
+      if(idx == ~0U || (s.primRestart && idx == s.primRestart))
+        continue;
+    }
+
+    const byte *bytes = d.data;
+
+    if(!d.prop->perinstance)
+      bytes += d.stride * idx;
+
+    QVariantList list = GetVariants(d.prop->format, *d.el, bytes, d.end);
+
+    for(int comp = 0; comp < 4 && comp < list.count(); comp++)
+    {
+      const QVariant &v = list[comp];
+
+      QMetaType::Type vt = GetVariantMetatype(v);
+
+      float fval = 0.0f;
+
+      if(vt == QMetaType::Double)
+        fval = (float)v.toDouble();
+      else if(vt == QMetaType::Float)
+        fval = v.toFloat();
+      else if(vt == QMetaType::UInt || vt == QMetaType::UShort || vt == QMetaType::UChar)
+        fval = (float)v.toUInt();
+      else if(vt == QMetaType::Int || vt == QMetaType::Short || vt == QMetaType::SChar)
+        fval = (float)v.toInt();
+      else
+        continue;
+
+      if(qIsFinite(fval))
+      {
+        minOut[comp] = qMin(minOut[comp], fval);
+        maxOut[comp] = qMax(maxOut[comp], fval);
+      }
+    }
+  }
+}
+
+static void CalcBoundsForRows(const BufferConfiguration &s, const QVector<CachedElData> &cache,
+                              uint32_t rowBegin, uint32_t rowEnd, QList<FloatVector> &minOutputList,
+                              QList<FloatVector> &maxOutputList)
+{
+  // iterate per column rather than per row, so each column is a tight loop over one format.
+  // possible optimisation here if this shows up as a hot spot - sort and unique the indices and
+  // iterate in ascending order, to be more cache friendly
+  for(int col = 0; col < cache.count(); col++)
+  {
+    const CachedElData &d = cache[col];
+
+    if(!d.data)
+      continue;
+
+    float *minOut = (float *)&minOutputList[col];
+    float *maxOut = (float *)&maxOutputList[col];
+
+    switch(GetBoundsDecode(*d.el, *d.prop))
+    {
+      case BoundsDecode::Float:
+        AccumulateBounds<float>(s, d, rowBegin, rowEnd, [](float f) { return f; }, minOut, maxOut);
+        break;
+      case BoundsDecode::Half:
+        AccumulateBounds<uint16_t>(s, d, rowBegin, rowEnd,
+                                   [](uint16_t h) { return (float)rdhalf::make(h); }, minOut,
+                                   maxOut);
+        break;
+      case BoundsDecode::UNorm8:
+        AccumulateBounds<uint8_t>(s, d, rowBegin, rowEnd,
+                                  [](uint8_t u) { return float(u) / 255.0f; }, minOut, maxOut);
+        break;
+      case BoundsDecode::SNorm8:
+        AccumulateBounds<int8_t>(s, d, rowBegin, rowEnd,
+                                 [](int8_t i) { return qMax(float(i) / 127.0f, -1.0f); }, minOut,
+                                 maxOut);
+        break;
+      case BoundsDecode::UNorm16:
+        AccumulateBounds<uint16_t>(s, d, rowBegin, rowEnd,
+                                   [](uint16_t u) { return float(u) / 65535.0f; }, minOut, maxOut);
+        break;
+      case BoundsDecode::SNorm16:
+        AccumulateBounds<int16_t>(s, d, rowBegin, rowEnd,
+                                  [](int16_t i) { return qMax(float(i) / 32767.0f, -1.0f); },
+                                  minOut, maxOut);
+        break;
+      case BoundsDecode::Generic:
+        AccumulateGenericBounds(s, d, rowBegin, rowEnd, minOut, maxOut);
+        break;
+    }
+  }
+}
+
 void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
 {
+  // below this many rows it's not worth spinning up threads to split the work
+  const uint32_t MinRowsPerThread = 64 * 1024;
+
   for(size_t stage = 0; stage < ARRAY_COUNT(bbox.input); stage++)
   {
     const BufferConfiguration &s = bbox.input[stage];
@@ -4320,64 +4699,56 @@ void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
 
     CacheDataForIteration(cache, s.columns, s.props, s.buffers, bbox.input[0].curInstance);
 
-    // possible optimisation here if this shows up as a hot spot - sort and unique the indices and
-    // iterate in ascending order, to be more cache friendly
+    const uint32_t maxThreads = (uint32_t)qMax(1, QThread::idealThreadCount());
+    const int numThreads = (int)qBound(1U, s.numRows / MinRowsPerThread, maxThreads);
 
-    for(uint32_t row = 0; row < s.numRows; row++)
+    if(numThreads == 1)
     {
-      uint32_t idx = row;
-
-      if(s.indices && s.indices->hasData())
-      {
-        idx = CalcIndex(s.indices, row, s.baseVertex, s.primRestart);
-
-        if(idx == ~0U || (s.primRestart && idx == s.primRestart))
-          continue;
-      }
+      CalcBoundsForRows(s, cache, 0, s.numRows, minOutputList, maxOutputList);
+      continue;
+    }
 
-      for(int col = 0; col < s.columns.count(); col++)
-      {
-        const CachedElData &d = cache[col];
-        const ShaderConstant *el = d.el;
-        const BufferElementProperties *prop = d.prop;
+    // split the rows into contiguous ranges, each with its own bounds that are merged at the end.
+    // This thread takes the first range itself
+    const uint32_t rowsPerThread = (s.numRows + numThreads - 1) / numThreads;
 
-        float *minOut = (float *)&minOutputList[col];
-        float *maxOut = (float *)&maxOutputList[col];
+    QVector<QList<FloatVector>> mins(numThreads, minOutputList);
+    QVector<QList<FloatVector>> maxs(numThreads, maxOutputList);
 
-        if(d.data)
-        {
-          const byte *bytes = d.data;
+    QSemaphore completed;
 
-          if(!prop->perinstance)
-            bytes += d.stride * idx;
+    for(int t = 1; t < numThreads; t++)
+    {
+      const uint32_t rowBegin = qMin(s.numRows, rowsPerThread * t);
+      const uint32_t rowEnd = qMin(s.numRows, rowBegin + rowsPerThread);
 
-          QVariantList list = GetVariants(prop->format, *el, bytes, d.end);
+      LambdaThread *thread = new LambdaThread([&, t, rowBegin, rowEnd] {
+        CalcBoundsForRows(s, cache, rowBegin, rowEnd, mins[t], maxs[t]);
+        completed.release();
+      });
+      thread->setName(lit("BBox calc worker"));
+      thread->selfDelete(true);
+      thread->start();
+    }
 
-          for(int comp = 0; comp < 4 && comp < list.count(); comp++)
-          {
-            const QVariant &v = list[comp];
+    CalcBoundsForRows(s, cache, 0, qMin(s.numRows, rowsPerThread), mins[0], maxs[0]);
 
-            QMetaType::Type vt = GetVariantMetatype(v);
+    completed.acquire(numThreads - 1);
 
-            float fval = 0.0f;
+    for(int t = 0; t < numThreads; t++)
+    {
+      for(int col = 0; col < s.columns.count(); col++)
+      {
+        float *minOut = (float *)&minOutputList[col];
+        float *maxOut = (float *)&maxOutputList[col];
 
-            if(vt == QMetaType::Double)
-              fval = (float)v.toDouble();
-            else if(vt == QMetaType::Float)
-              fval = v.toFloat();
-            else if(vt == QMetaType::UInt || vt == QMetaType::UShort || vt == QMetaType::UChar)
-              fval = (float)v.toUInt();
-            else if(vt == QMetaType::Int || vt == QMetaType::Short || vt == QMetaType::SChar)
-              fval = (float)v.toInt();
-            else
-              continue;
+        const float *minIn = (const float *)&mins[t][col];
+        const float *maxIn = (const float *)&maxs[t][col];
 
-            if(qIsFinite(fval))
-            {
-              minOut[comp] = qMin(minOut[comp], fval);
-              maxOut[comp] = qMax(maxOut[comp], fval);
-            }
-          }
+        for(int comp = 0; comp < 4; comp++)
+        {
+          minOut[comp] = qMin(minOut[comp], minIn[comp]);
+          maxOut[comp] = qMax(maxOut[comp], maxIn[comp]);
         }
       }
     }
@@ -7035,6 +7406,7 @@ void BufferViewer::on_rowOffset_valueChanged(int value)
     if(pageOffset != m_PagingByteOffset)
     {
       m_PagingByteOffset = pageOffset;
+      m_PageChange = true;
 
       processFormat(m_Format);
 
@@ -48,6 +48,7 @@ class CameraWrapper;
 class ArcballWrapper;
 class FlycamWrapper;
 struct BufferData;
+class BufferWindowCache;
 struct PopulateBufferData;
 struct CalcBoundingBoxData;
 
@@ -224,6 +225,9 @@ private:
   Subresource m_TexSub = {0, 0, 0};
   uint64_t m_ByteOffset = 0;
   uint64_t m_PagingByteOffset = 0;
+  // set when only the paging offset has changed, so fetched windows are still valid
+  bool m_PageChange = false;
+  QSharedPointer<BufferWindowCache> m_WindowCache;
   uint64_t m_ObjectByteSize = UINT64_MAX;
   uint64_t m_ByteSize = UINT64_MAX;
   ResourceId m_BufferID;
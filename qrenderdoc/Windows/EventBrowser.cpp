@@ -28,6 +28,7 @@
 #include <QComboBox>
 #include <QCompleter>
 #include <QDialogButtonBox>
+#include <QElapsedTimer>
 #include <QInputDialog>
 #include <QKeyEvent>
 #include <QLineEdit>
@@ -1421,6 +1422,190 @@ struct BuiltinFilterCallbacks
   IEventBrowser::AutoCompleteCallback completer;
 };
 
+// the cached result of looking up one $param() query in the index below. This is extended as the
+// index grows, rather than recalculated
+struct EventParamQuery
+{
+  uint32_t generation = ~0U;
+  uint32_t coverage = 0;
+  // how many of the parameter's values have been checked, and which of them match
+  size_t valuesChecked = 0;
+  rdcarray<size_t> matchingValues;
+  rdcarray<bool> matches;
+};
+
+// An inverted index of every event's parameters, from parameter name to each formatted value it
+// takes and the events it takes it in. $param() otherwise has to search each chunk's structured
+// data and format the values it finds for every event, every time the filter is evaluated.
+//
+// The index is built a slice at a time on the UI thread: structured data can be lazily populated
+// when it's walked so it's not safe to walk on another thread, and formatting values needs the
+// resource names. Events below the coverage can be answered from the index straight away and any
+// past it are evaluated as before until the index catches up.
+struct EventParamIndex
+{
+  void Clear(ICaptureContext &ctx)
+  {
+    m_Params.clear();
+    m_Coverage = 0;
+    m_Generation++;
+    m_NameCacheID = ctx.ResourceNameCacheID();
+  }
+
+  // index events in order until the time budget runs out. Returns true if all events are indexed
+  bool Process(ICaptureContext &ctx, const rdcarray<const SDChunk *> &chunks, qint64 budgetMS)
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    QHash<QString, const SDObject *> found;
+
+    while(m_Coverage < chunks.size())
+    {
+      uint32_t eid = m_Coverage;
+      const SDChunk *chunk = chunks[eid];
+
+      if(chunk)
+      {
+        found.clear();
+        CollectParams(chunk, found);
+
+        for(auto it = found.begin(); it != found.end(); ++it)
+        {
+          const SDObject *o = it.value();
+
+          if(o->IsArray())
+          {
+            for(const SDObject *c : *o)
+              AddValue(it.key(), RichResourceTextFormat(ctx, SDObject2Variant(c, false)), eid);
+          }
+          else
+          {
+            AddValue(it.key(), RichResourceTextFormat(ctx, SDObject2Variant(o, false)), eid);
+          }
+        }
+      }
+
+      m_Coverage++;
+
+      if((m_Coverage % 64) == 0 && timer.elapsed() > budgetMS)
+        break;
+    }
+
+    return m_Coverage >= chunks.size();
+  }
+
+  bool IsStale(ICaptureContext &ctx) const { return m_NameCacheID != ctx.ResourceNameCacheID(); }
+  // returns false if the event hasn't been indexed yet, otherwise match is set to whether the
+  // named parameter contains value, the same as searching the chunk directly.
+  bool Lookup(const QString &name, const QString &value, uint32_t eid, EventParamQuery &query,
+              bool &match) const
+  {
+    if(query.generation != m_Generation)
+    {
+      query.generation = m_Generation;
+      query.coverage = 0;
+      query.valuesChecked = 0;
+      query.matchingValues.clear();
+      query.matches.clear();
+    }
+
+    // only look at what's been indexed since the query was last updated
+    if(query.coverage != m_Coverage)
+    {
+      query.matches.resize(m_Coverage);
+
+      auto param = m_Params.find(name);
+      if(param != m_Params.end())
+      {
+        // values are only ever appended, so only new values need to be matched
+        for(size_t v = query.valuesChecked; v < param->values.size(); v++)
+          if(param->values[v].value.contains(value, Qt::CaseInsensitive))
+            query.matchingValues.push_back(v);
+
+        query.valuesChecked = param->values.size();
+
+        for(size_t v : query.matchingValues)
+        {
+          const rdcarray<uint32_t> &eids = param->values[v].eids;
+
+          for(auto it = std::lower_bound(eids.begin(), eids.end(), query.coverage);
+              it != eids.end(); ++it)
+            query.matches[*it] = true;
+        }
+      }
+
+      query.coverage = m_Coverage;
+    }
+
+    if(eid >= query.coverage)
+      return false;
+
+    match = query.matches[eid];
+    return true;
+  }
+
+private:
+  // visits objects in the same order as FindChildRecursively, so the first object recorded for
+  // each name is the one a search for that name would find.
+  static void CollectParams(const SDObject *parent, QHash<QString, const SDObject *> &found)
+  {
+    for(size_t i = 0; i < parent->NumChildren(); i++)
+    {
+      const SDObject *o = parent->GetChild(i);
+      QString name = o->name;
+      if(!found.contains(name))
+        found.insert(name, o);
+    }
+
+    for(size_t i = 0; i < parent->NumChildren(); i++)
+      CollectParams(parent->GetChild(i), found);
+  }
+
+  void AddValue(const QString &name, const QString &value, uint32_t eid)
+  {
+    Param &param = m_Params[name];
+
+    auto it = param.lookup.find(value);
+    if(it == param.lookup.end())
+    {
+      it = param.lookup.insert(value, param.values.size());
+      param.values.push_back({value, {}});
+    }
+
+    rdcarray<uint32_t> &eids = param.values[it.value()].eids;
+
+    // events are indexed in order, so this is enough to avoid duplicates from arrays
+    if(eids.empty() || eids.back() != eid)
+      eids.push_back(eid);
+  }
+
+  struct ParamValue
+  {
+    QString value;
+    // the events with this value, in order
+    rdcarray<uint32_t> eids;
+  };
+
+  struct Param
+  {
+    // values are kept in the order they were first seen, so queries can tell which are new
+    rdcarray<ParamValue> values;
+    QHash<QString, size_t> lookup;
+  };
+
+  QHash<QString, Param> m_Params;
+
+  // every event below this has been indexed
+  uint32_t m_Coverage = 0;
+
+  // incremented whenever the index is cleared, to invalidate cached queries
+  uint32_t m_Generation = 0;
+
+  // the formatted values include resource names, so renaming invalidates the index
+  int32_t m_NameCacheID = 0;
+};
+
 struct EventFilterModel : public QSortFilterProxyModel
 {
 public:
@@ -1428,6 +1613,13 @@ public:
   {
     setSourceModel(m_Model);
 
+    m_IndexTimer = new QTimer(this);
+    m_IndexTimer->setInterval(0);
+    QObject::connect(m_IndexTimer, &QTimer::timeout, this, [this]() {
+      if(m_ParamIndex.Process(m_Ctx, m_Model->m_Chunks, 10))
+        m_IndexTimer->stop();
+    });
+
     if(m_BuiltinFilters.empty())
     {
 #ifndef STRINGIZE
@@ -1472,12 +1664,57 @@ public:
     }
   }
   void ResetCache() { m_VisibleCache.clear(); }
+  // (re)build the parameter index in the background, for the current capture
+  void StartIndexing()
+  {
+    m_ParamIndex.Clear(m_Ctx);
+    m_IndexTimer->start();
+    m_Indexing = true;
+  }
+
+  // the index is out of date, e.g. because resources were renamed. Filters are being evaluated when
+  // we find this out, so the index is rebuilt once they've finished instead of under them
+  void MarkIndexStale()
+  {
+    if(m_ReindexPending)
+      return;
+
+    m_ReindexPending = true;
+
+    GUIInvoke::defer(this, [this]() {
+      m_ReindexPending = false;
+
+      if(m_Indexing && m_ParamIndex.IsStale(m_Ctx))
+        StartIndexing();
+    });
+  }
+
+  void StopIndexing()
+  {
+    m_IndexTimer->stop();
+    m_ParamIndex.Clear(m_Ctx);
+    m_Indexing = false;
+  }
+
   ParseTrace ParseExpressionToFilters(QString expr, rdcarray<EventFilter> &filters) const;
 
   void SetFilters(const rdcarray<EventFilter> &filters)
   {
     m_VisibleCache.clear();
     m_Filters = filters;
+
+    // the index is only worth building while a $param() filter is in use. Any filters that have
+    // been replaced are gone now so their queries will have expired.
+    m_ParamQueries.removeIf(
+        [](const QWeakPointer<EventParamQuery> &query) { return query.isNull(); });
+
+    bool wantIndex = m_Ctx.IsCaptureLoaded() && !m_ParamQueries.empty();
+
+    if(wantIndex && !m_Indexing)
+      StartIndexing();
+    else if(!wantIndex && m_Indexing)
+      StopIndexing();
+
     invalidateFilter();
   }
 
@@ -1619,6 +1856,14 @@ private:
   bool m_EmptyRegionsVisible = true;
   rdcarray<EventFilter> m_Filters;
 
+  EventParamIndex m_ParamIndex;
+  QTimer *m_IndexTimer = NULL;
+  bool m_Indexing = false;
+  bool m_ReindexPending = false;
+
+  // the queries of every $param() filter that has been created, to tell when any are in use
+  rdcarray<QWeakPointer<EventParamQuery>> m_ParamQueries;
+
   IEventBrowser::EventFilterCallback MakeLiteralMatcher(QString string) const
   {
     QString matchString = string.toLower();
@@ -1803,11 +2048,33 @@ searched for as a case-insensitive substring.
       return NULL;
     }
 
-    return [paramName, paramValue](ICaptureContext *ctx, const rdcstr &, const rdcstr &, uint32_t,
-                                   const SDChunk *chunk, const ActionDescription *, const rdcstr &) {
+    QSharedPointer<EventParamQuery> query(new EventParamQuery);
+    m_ParamQueries.push_back(query);
+
+    // the filter can outlive this model, e.g. if it's kept by a python script
+    QPointer<EventFilterModel> me(this);
+
+    return [me, paramName, paramValue, query](ICaptureContext *ctx, const rdcstr &, const rdcstr &,
+                                              uint32_t eid, const SDChunk *chunk,
+                                              const ActionDescription *, const rdcstr &) {
       if(!chunk)
         return false;
 
+      // while the index is stale, search the chunk directly the same as for unindexed events
+      if(me)
+      {
+        if(me->m_ParamIndex.IsStale(*ctx))
+        {
+          me->MarkIndexStale();
+        }
+        else
+        {
+          bool match = false;
+          if(me->m_ParamIndex.Lookup(paramName, paramValue, eid, *query, match))
+            return match;
+        }
+      }
+
       const SDObject *o = chunk->FindChildRecursively(paramName);
 
       if(!o)
@@ -3718,6 +3985,7 @@ void EventBrowser::OnCaptureClosed()
   m_BreadcrumbLocationText->setVisible(false);
   ui->breadcrumbStrip->hide();
 
+  m_FilterModel->StopIndexing();
   m_FilterModel->ResetCache();
   // older Qt versions lose all the sections when a model resets even if the sections don't change.
   // Manually save/restore them
@@ -42,6 +42,7 @@ struct rdcflatmap
 {
   using iterator = rdcpair<Key, Value> *;
   using const_iterator = const rdcpair<Key, Value> *;
+  using value_type = rdcpair<Key, Value>;
   using size_type = size_t;
 
   DOCUMENT("");
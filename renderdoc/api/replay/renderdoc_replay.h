@@ -257,7 +257,7 @@ which is useful for operations like picking vertices that depends on the output
 the output data is not displayed anywhere natively.
 
 :return: The output texture data as tightly packed RGB 3-byte data.
-:rtype: bytes
+:rtype: memoryview
 )");
   virtual bytebuf ReadbackOutputTexture() = 0;
 
@@ -310,7 +310,7 @@ Should only be called for texture outputs.
   texture data will be reinterpreted - e.g. from unsigned integers to floats, or to unsigned
   normalised values.
 :return: A buffer with the thumbnail RGBA8 data if successful, or empty if something went wrong.
-:rtype: bytes
+:rtype: memoryview
 )");
   virtual bytebuf DrawThumbnail(int32_t width, int32_t height, ResourceId textureId,
                                 const Subresource &sub, CompType typeCast) = 0;
@@ -1035,6 +1035,32 @@ completed, further calls will return an empty list.
 )");
   virtual rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger) = 0;
 
+  DOCUMENT(R"(Run a shader's debugging with a given shader debugger instance until it reaches one of
+a set of instructions, has run a number of steps, or finishes.
+
+Unlike :meth:`ContinueDebug` no intermediate states are recorded, so this is much faster when
+running over a large number of steps such as to a cursor or breakpoint deep inside a loop. Instead a
+single state is returned with the net change in variables from where debugging was before the call
+to where it stopped. Variables that changed and then changed back will not be listed, and
+:data:`ShaderDebugState.flags` will not contain any events.
+
+Debugging can be continued afterwards with either this function or :meth:`ContinueDebug`.
+
+.. note::
+  This is currently only supported when debugging SPIR-V shaders. Other debuggers will return an
+  empty state, and :meth:`ContinueDebug` should be used instead.
+
+:param ShaderDebugger debugger: The shader debugger to run.
+:param List[int] breakpoints: The instructions to stop at. Running stops after the first step that
+  reaches any of these as its next instruction.
+:param int maxSteps: The maximum number of steps to run, or 0 to run until a breakpoint is hit or
+  the debugging process has completed.
+:return: The consolidated state after running.
+:rtype: ShaderDebugState
+)");
+  virtual ShaderDebugState RunDebug(ShaderDebugger *debugger, const rdcarray<uint32_t> &breakpoints,
+                                    uint32_t maxSteps) = 0;
+
   DOCUMENT(R"(Free a debugging trace from running a shader invocation debug.
 
 :param ShaderDebugTrace trace: The shader debugging trace to free.
@@ -1049,6 +1075,34 @@ completed, further calls will return an empty list.
 )");
   virtual rdcarray<EventUsage> GetUsage(ResourceId id) = 0;
 
+  DOCUMENT(R"(Retrieve the list of events where the contents of a resource actually changed, as
+opposed to :meth:`GetUsage` which lists every event where the resource was bound for writing.
+
+Every event that :meth:`GetUsage` lists as writing to a resource is checked, including shader
+writes, clears, copies and resolves. The first call replays to each such event in the frame and
+fingerprints what it wrote afterwards, with each sample of a multisampled texture hashed separately,
+so it can take some time. The results are cached until a resource replacement changes.
+
+:param ResourceId id: The id of the texture or buffer resource to be queried.
+:return: The list of event IDs where the resource's contents changed, in order.
+:rtype: List[int]
+)");
+  virtual rdcarray<uint32_t> GetModifyingEvents(ResourceId id) = 0;
+
+  DOCUMENT(R"(Retrieve a fingerprint of the contents of a resource at a given event. If two events
+have the same fingerprint for a resource then its contents are the same at both, so anything
+derived from those contents doesn't need to be fetched again.
+
+See :meth:`GetModifyingEvents` for which resources are tracked.
+
+:param ResourceId id: The id of the texture or buffer resource to be queried.
+:param int eventId: The event to query the fingerprint at.
+:return: The fingerprint of the contents after the last tracked modification at or before
+  ``eventId``, or 0 if the resource hasn't been written by that point.
+:rtype: int
+)");
+  virtual uint64_t GetResourceFingerprint(ResourceId id, uint32_t eventId) = 0;
+
   DOCUMENT(R"(Retrieve the contents of a constant block by reading from memory or their source
 otherwise.
 
@@ -1091,25 +1145,78 @@ texture to something compatible with the target file format.
 )");
   virtual MeshFormat GetPostVSData(uint32_t instance, uint32_t view, MeshDataStage stage) = 0;
 
-  DOCUMENT(R"(Retrieve the contents of a range of a buffer as a ``bytes``.
+  DOCUMENT(R"(Retrieve the contents of a range of a buffer as a read-only ``memoryview``.
 
 :param ResourceId buff: The id of the buffer to retrieve data from.
 :param int offset: The byte offset to the start of the range.
 :param int len: The length of the range, or 0 to retrieve the rest of the bytes in the buffer.
 :return: The requested buffer contents.
-:rtype: bytes
+:rtype: memoryview
 )");
   virtual bytebuf GetBufferData(ResourceId buff, uint64_t offset, uint64_t len) = 0;
 
-  DOCUMENT(R"(Retrieve the contents of one subresource of a texture as a ``bytes``.
+  DOCUMENT(R"(Retrieve the contents of one subresource of a texture as a read-only
+``memoryview``.
 
 :param ResourceId tex: The id of the texture to retrieve data from.
 :param Subresource sub: The subresource within this texture to use.
 :return: The requested texture contents.
-:rtype: bytes
+:rtype: memoryview
 )");
   virtual bytebuf GetTextureData(ResourceId tex, const Subresource &sub) = 0;
 
+  DOCUMENT(R"(Queue a readback of a range of a buffer, to be fetched later with
+:meth:`FetchReadback` or :meth:`SaveReadback`.
+
+All queued readbacks are read back together in one batch the first time any of them is fetched, so
+queueing everything needed up front avoids waiting on the GPU for each one in turn. Pending
+readbacks are read back before the current event changes, so they always contain the data at the
+event where they were queued.
+
+:param ResourceId buff: The id of the buffer to retrieve data from.
+:param int offset: The byte offset to the start of the range.
+:param int len: The length of the range, or 0 to retrieve the rest of the bytes in the buffer.
+:return: A handle identifying this readback, or 0 if the buffer is invalid.
+:rtype: int
+)");
+  virtual uint32_t QueueBufferReadback(ResourceId buff, uint64_t offset, uint64_t len) = 0;
+
+  DOCUMENT(R"(Queue a readback of one subresource of a texture, to be fetched later with
+:meth:`FetchReadback` or :meth:`SaveReadback`.
+
+See :meth:`QueueBufferReadback` for how queued readbacks are batched.
+
+:param ResourceId tex: The id of the texture to retrieve data from.
+:param Subresource sub: The subresource within this texture to use.
+:return: A handle identifying this readback, or 0 if the texture is invalid.
+:rtype: int
+)");
+  virtual uint32_t QueueTextureReadback(ResourceId tex, const Subresource &sub) = 0;
+
+  DOCUMENT(R"(Fetch the contents of a queued readback as a read-only ``memoryview``. If it hasn't
+been read back yet, all pending readbacks are read back together first.
+
+The handle is no longer valid after this call.
+
+:param int handle: The handle returned when the readback was queued.
+:return: The requested contents, the same as :meth:`GetBufferData` or :meth:`GetTextureData` would
+  have returned.
+:rtype: memoryview
+)");
+  virtual bytebuf FetchReadback(uint32_t handle) = 0;
+
+  DOCUMENT(R"(Write the contents of a queued readback directly to a file on disk, without returning
+them. If it hasn't been read back yet, all pending readbacks are read back together first.
+
+The handle is no longer valid after this call.
+
+:param int handle: The handle returned when the readback was queued.
+:param str path: The path to save to on disk.
+:return: The result of the operation.
+:rtype: ResultDetails
+)");
+  virtual ResultDetails SaveReadback(uint32_t handle, const rdcstr &path) = 0;
+
   static const uint32_t NoPreference = ~0U;
 
 protected:
@@ -1277,7 +1384,7 @@ This index should not be cached, as writing sections could re-order the indices.
 
 :param int index: The index of the section.
 :return: The raw contents of the section, if the index is valid.
-:rtype: bytes
+:rtype: memoryview
 )");
   virtual bytebuf GetSectionContents(int32_t index) = 0;
 
@@ -0,0 +1,479 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "capture_transfer.h"
+#include "common/threading.h"
+#include "zstd/xxhash.h"
+#include "zstd/zstd.h"
+
+struct CaptureTransferBlock
+{
+  uint64_t offset = 0;
+  // uncompressed size of the block. A block of size 0 terminates the transfer
+  uint32_t size = 0;
+  bool compressed = false;
+  // checksum of the uncompressed data
+  uint64_t checksum = 0;
+  bytebuf data;
+
+  // not serialised, only used while preparing the block to send
+  bool readFailed = false;
+};
+
+DECLARE_REFLECTION_STRUCT(CaptureTransferBlock);
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, CaptureTransferBlock &el)
+{
+  SERIALISE_MEMBER(offset);
+  SERIALISE_MEMBER(size);
+  SERIALISE_MEMBER(compressed);
+  SERIALISE_MEMBER(checksum);
+  SERIALISE_MEMBER(data);
+}
+
+static uint64_t ChecksumBlock(const byte *data, size_t size)
+{
+  return XXH64(data, size, 0);
+}
+
+rdcarray<uint64_t> GetCaptureTransferChecksums(const rdcstr &path)
+{
+  rdcarray<uint64_t> ret;
+
+  FILE *f = FileIO::fopen(path, FileIO::ReadBinary);
+
+  if(!f)
+    return ret;
+
+  bytebuf buf;
+  buf.resize((size_t)CaptureTransferBlockSize);
+
+  while(FileIO::fread(buf.data(), 1, buf.size(), f) == buf.size())
+    ret.push_back(ChecksumBlock(buf.data(), buf.size()));
+
+  FileIO::fclose(f);
+
+  return ret;
+}
+
+uint64_t GetCaptureTransferResumeOffset(const rdcstr &path, const rdcarray<uint64_t> &checksums)
+{
+  if(checksums.empty())
+    return 0;
+
+  FILE *f = FileIO::fopen(path, FileIO::ReadBinary);
+
+  if(!f)
+    return 0;
+
+  uint64_t offset = 0;
+
+  bytebuf buf;
+  buf.resize((size_t)CaptureTransferBlockSize);
+
+  // stop at the first block that differs, or that we can't read completely
+  for(uint64_t checksum : checksums)
+  {
+    if(FileIO::fread(buf.data(), 1, buf.size(), f) != buf.size())
+      break;
+
+    if(ChecksumBlock(buf.data(), buf.size()) != checksum)
+      break;
+
+    offset += CaptureTransferBlockSize;
+  }
+
+  FileIO::fclose(f);
+
+  if(offset > 0)
+    RDCLOG("Resuming transfer of '%s' at %llu bytes", path.c_str(), offset);
+
+  return offset;
+}
+
+static void PrepareBlock(const rdcstr &path, bool compress, CaptureTransferBlock &block)
+{
+  FILE *f = FileIO::fopen(path, FileIO::ReadBinary);
+
+  if(!f)
+  {
+    block.readFailed = true;
+    return;
+  }
+
+  bytebuf raw;
+  raw.resize(block.size);
+
+  FileIO::fseek64(f, block.offset, SEEK_SET);
+  block.readFailed = FileIO::fread(raw.data(), 1, raw.size(), f) != raw.size();
+
+  FileIO::fclose(f);
+
+  if(block.readFailed)
+    return;
+
+  block.checksum = ChecksumBlock(raw.data(), raw.size());
+
+  if(compress)
+  {
+    block.data.resize(ZSTD_compressBound(raw.size()));
+
+    // use a fast level, this is about not wasting the link on highly compressible data rather than
+    // getting the smallest possible size.
+    size_t compSize =
+        ZSTD_compress(block.data.data(), block.data.size(), raw.data(), raw.size(), 1);
+
+    // only keep the compressed data if it's a real saving. This skips already-compressed sections
+    // without costing the receiver a decompression.
+    if(!ZSTD_isError(compSize) && compSize < raw.size() - raw.size() / 16)
+    {
+      block.data.resize(compSize);
+      block.compressed = true;
+      return;
+    }
+  }
+
+  block.data.swap(raw);
+  block.compressed = false;
+}
+
+// a fixed set of threads that prepare blocks for the duration of one transfer
+class BlockWorkers
+{
+public:
+  BlockWorkers(const rdcstr &path, bool compress, uint32_t numThreads)
+      : m_Path(path), m_Compress(compress)
+  {
+    m_Work = Threading::Semaphore::Create();
+    m_Done = Threading::Semaphore::Create();
+
+    for(uint32_t i = 0; i < numThreads; i++)
+      m_Threads.push_back(Threading::CreateThread([this]() { Run(); }));
+  }
+
+  ~BlockWorkers()
+  {
+    // a NULL block tells a thread to exit
+    for(size_t i = 0; i < m_Threads.size(); i++)
+      Queue(NULL);
+
+    for(Threading::ThreadHandle t : m_Threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    m_Work->Destroy();
+    m_Done->Destroy();
+  }
+
+  void Queue(CaptureTransferBlock *block)
+  {
+    {
+      SCOPED_LOCK(m_Lock);
+      m_Queue.push_back(block);
+    }
+    m_Work->Wake(1);
+  }
+
+  // wait for this many queued blocks to be prepared
+  void Wait(uint32_t count)
+  {
+    for(uint32_t i = 0; i < count; i++)
+      m_Done->WaitForWake();
+  }
+
+private:
+  void Run()
+  {
+    for(;;)
+    {
+      m_Work->WaitForWake();
+
+      CaptureTransferBlock *block = NULL;
+      {
+        SCOPED_LOCK(m_Lock);
+        block = m_Queue.takeAt(0);
+      }
+
+      if(!block)
+        break;
+
+      PrepareBlock(m_Path, m_Compress, *block);
+
+      m_Done->Wake(1);
+    }
+  }
+
+  rdcstr m_Path;
+  bool m_Compress;
+
+  Threading::Semaphore *m_Work;
+  Threading::Semaphore *m_Done;
+
+  Threading::CriticalSection m_Lock;
+  rdcarray<CaptureTransferBlock *> m_Queue;
+
+  rdcarray<Threading::ThreadHandle> m_Threads;
+};
+
+bool SendCaptureTransfer(WriteSerialiser &ser, const rdcstr &path, uint64_t resumeOffset,
+                         bool compress, RENDERDOC_ProgressCallback progress)
+{
+  const bool opened = FileIO::exists(path);
+  bool success = opened;
+
+  if(!opened)
+    RDCERR("Can't open file '%s' to send", path.c_str());
+
+  uint64_t totalSize = opened ? FileIO::GetFileSize(path) : 0;
+
+  if(resumeOffset > totalSize)
+    resumeOffset = 0;
+
+  SERIALISE_ELEMENT(totalSize);
+  SERIALISE_ELEMENT(resumeOffset);
+
+  // prepare a batch of blocks at a time in parallel, and prepare the next batch while the current
+  // one is being sent. The same worker threads are used for the whole transfer.
+  const uint32_t batchSize = RDCCLAMP(Threading::NumberOfCores(), 1U, 4U);
+
+  BlockWorkers workers(path, compress, batchSize);
+
+  uint64_t nextOffset = resumeOffset;
+
+  struct Batch
+  {
+    rdcarray<CaptureTransferBlock> blocks;
+  };
+
+  auto launch = [&](Batch &batch) {
+    batch.blocks.clear();
+
+    // the blocks must be fully populated before any are queued, so they don't move
+    while(batch.blocks.size() < batchSize && nextOffset < totalSize)
+    {
+      CaptureTransferBlock block;
+      block.offset = nextOffset;
+      block.size = (uint32_t)RDCMIN(CaptureTransferBlockSize, totalSize - nextOffset);
+      nextOffset += block.size;
+      batch.blocks.push_back(block);
+    }
+
+    for(CaptureTransferBlock &block : batch.blocks)
+      workers.Queue(&block);
+  };
+
+  auto join = [&workers](Batch &batch) { workers.Wait((uint32_t)batch.blocks.size()); };
+
+  // the workers hold pointers into the blocks, so we alternate between two batches rather than
+  // moving them around
+  Batch batches[2];
+  int cur = 0;
+
+  if(success)
+    launch(batches[cur]);
+
+  uint64_t sent = resumeOffset;
+
+  if(progress)
+    progress(0.0001f);
+
+  while(!batches[cur].blocks.empty())
+  {
+    Batch &current = batches[cur];
+    Batch &next = batches[1 - cur];
+
+    join(current);
+    launch(next);
+
+    for(CaptureTransferBlock &block : current.blocks)
+    {
+      if(block.readFailed)
+      {
+        RDCERR("Failed to read %u bytes at %llu from '%s'", block.size, block.offset, path.c_str());
+        success = false;
+        break;
+      }
+
+      SERIALISE_ELEMENT(block);
+
+      if(ser.IsErrored())
+      {
+        success = false;
+        break;
+      }
+
+      sent += block.size;
+
+      if(progress)
+        progress(float(double(sent) / double(totalSize)));
+    }
+
+    current.blocks.clear();
+
+    if(!success)
+    {
+      join(next);
+      break;
+    }
+
+    cur = 1 - cur;
+  }
+
+  // terminate the stream. The offset lets the receiver know if this is premature, and if we
+  // couldn't open the file at all we send an offset that can never match.
+  CaptureTransferBlock block;
+  block.offset = opened ? sent : ~0ULL;
+  SERIALISE_ELEMENT(block);
+
+  if(progress)
+    progress(1.0f);
+
+  return success && !ser.IsErrored();
+}
+
+bool ReceiveCaptureTransfer(ReadSerialiser &ser, const rdcstr &path,
+                            RENDERDOC_ProgressCallback progress)
+{
+  uint64_t totalSize = 0, resumeOffset = 0;
+
+  SERIALISE_ELEMENT(totalSize);
+  SERIALISE_ELEMENT(resumeOffset);
+
+  if(ser.IsErrored())
+    return false;
+
+  FILE *f = NULL;
+
+  if(resumeOffset > 0)
+  {
+    if(FileIO::GetFileSize(path) < resumeOffset)
+    {
+      RDCERR("Can't resume transfer into '%s' at %llu, file is too small", path.c_str(),
+             resumeOffset);
+    }
+    else
+    {
+      f = FileIO::fopen(path, FileIO::UpdateBinary);
+      if(f)
+        FileIO::fseek64(f, resumeOffset, SEEK_SET);
+    }
+  }
+  else
+  {
+    f = FileIO::fopen(path, FileIO::WriteBinary);
+  }
+
+  if(!f)
+    RDCERR("Can't open '%s' to receive file", path.c_str());
+
+  uint64_t verified = resumeOffset;
+  bool success = (f != NULL);
+
+  bytebuf decompressed;
+
+  if(progress)
+    progress(0.0001f);
+
+  // we always read until the terminating block even on failure, so that the stream stays in sync
+  for(;;)
+  {
+    CaptureTransferBlock block;
+    SERIALISE_ELEMENT(block);
+
+    if(ser.IsErrored())
+    {
+      RDCERR("Network error receiving file, received %llu of %llu bytes", verified, totalSize);
+      success = false;
+      break;
+    }
+
+    if(block.size == 0)
+    {
+      if(block.offset != totalSize || verified != totalSize)
+      {
+        RDCERR("Transfer ended early, received %llu of %llu bytes", verified, totalSize);
+        success = false;
+      }
+      break;
+    }
+
+    if(!success)
+      continue;
+
+    if(block.offset != verified)
+    {
+      RDCERR("Unexpected block at %llu, expected %llu", block.offset, verified);
+      success = false;
+      continue;
+    }
+
+    const byte *data = block.data.data();
+    size_t size = block.data.size();
+
+    if(block.compressed)
+    {
+      decompressed.resize(block.size);
+      size = ZSTD_decompress(decompressed.data(), decompressed.size(), block.data.data(),
+                             block.data.size());
+      if(ZSTD_isError(size))
+        size = 0;
+      data = decompressed.data();
+    }
+
+    if(size != block.size || ChecksumBlock(data, size) != block.checksum)
+    {
+      RDCERR("Block at %llu failed verification", block.offset);
+      success = false;
+      continue;
+    }
+
+    if(FileIO::fwrite(data, 1, size, f) != size)
+    {
+      RDCERR("Failed to write to '%s'", path.c_str());
+      success = false;
+      continue;
+    }
+
+    verified += size;
+
+    if(progress)
+      progress(float(double(verified) / double(totalSize)));
+  }
+
+  if(f)
+  {
+    // drop anything past what we verified, whether that's stale data from a previous larger file
+    // or a partial block.
+    FileIO::ftruncateat(f, verified);
+    FileIO::fclose(f);
+  }
+
+  if(progress)
+    progress(1.0f);
+
+  return success;
+}
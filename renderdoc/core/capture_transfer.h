@@ -0,0 +1,58 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include "api/replay/control_types.h"
+#include "serialise/serialiser.h"
+
+// Captures are copied to and from a remote server in independently checksummed blocks. If a
+// transfer drops partway through, the receiving side keeps every block it verified and the next
+// transfer of the same file resumes from there instead of starting over.
+//
+// The side that has (possibly partial) data sends the checksums of its complete blocks, the side
+// with the source file compares them against its own to find where to resume, then streams the
+// remaining blocks. Each block is compressed if that makes it meaningfully smaller, so sections
+// that are already compressed in the capture are sent as-is.
+static const uint64_t CaptureTransferBlockSize = 4 * 1024 * 1024;
+
+// returns the checksums of each complete block at the start of path, or an empty list if it doesn't
+// exist.
+rdcarray<uint64_t> GetCaptureTransferChecksums(const rdcstr &path);
+
+// given the checksums of the blocks that the receiver has, find the offset into the source file at
+// path that the transfer can resume from.
+uint64_t GetCaptureTransferResumeOffset(const rdcstr &path, const rdcarray<uint64_t> &checksums);
+
+// stream path from resumeOffset onwards. Blocks are read and compressed on worker threads ahead of
+// being written to the serialiser. Returns false if the file couldn't be read, in which case the
+// stream is still terminated cleanly and the receiver will treat the transfer as incomplete.
+bool SendCaptureTransfer(WriteSerialiser &ser, const rdcstr &path, uint64_t resumeOffset,
+                         bool compress, RENDERDOC_ProgressCallback progress);
+
+// receive a stream written by SendCaptureTransfer into path, keeping any data before the resume
+// offset. Returns true only if the whole file was received and verified, otherwise the file is
+// truncated to the data that was verified so that a later transfer can resume.
+bool ReceiveCaptureTransfer(ReadSerialiser &ser, const rdcstr &path,
+                            RENDERDOC_ProgressCallback progress);
@@ -0,0 +1,210 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/globalconfig.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "capture_transfer.h"
+
+#include "catch/catch.hpp"
+
+static bytebuf ReadWholeFile(const rdcstr &path)
+{
+  bytebuf ret;
+  FileIO::ReadAll(path, ret);
+  return ret;
+}
+
+static void WriteWholeFile(const rdcstr &path, const bytebuf &data)
+{
+  FILE *f = FileIO::fopen(path, FileIO::WriteBinary);
+  REQUIRE(f);
+  FileIO::fwrite(data.data(), 1, data.size(), f);
+  FileIO::fclose(f);
+}
+
+// send path into an in-memory stream, the same as the remote server does over its socket
+static StreamWriter *SendToMemory(const rdcstr &path, uint64_t resumeOffset, bool compress)
+{
+  StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  WriteSerialiser ser(buf, Ownership::Nothing);
+  ser.SetStreamingMode(true);
+
+  {
+    SCOPED_SERIALISE_CHUNK(1);
+    CHECK(SendCaptureTransfer(ser, path, resumeOffset, compress, NULL));
+  }
+
+  return buf;
+}
+
+static bool ReceiveFromMemory(const rdcstr &path, const byte *data, uint64_t size)
+{
+  ReadSerialiser ser(new StreamReader(data, size), Ownership::Stream);
+  ser.SetStreamingMode(true);
+
+  ser.ReadChunk<uint32_t>();
+  bool ret = ReceiveCaptureTransfer(ser, path, NULL);
+  ser.EndChunk();
+
+  return ret;
+}
+
+TEST_CASE("Test capture transfer", "[capture_transfer]")
+{
+  const rdcstr srcPath = FileIO::GetTempFolderFilename() + "/renderdoc_transfer_test_src.rdc";
+  const rdcstr dstPath = FileIO::GetTempFolderFilename() + "/renderdoc_transfer_test_dst.rdc";
+
+  // a mix of compressible and incompressible data, with a partial block at the end
+  bytebuf source;
+  source.resize(size_t(CaptureTransferBlockSize * 3 + CaptureTransferBlockSize / 2));
+  uint32_t state = 12345;
+  for(size_t i = 0; i < source.size(); i++)
+  {
+    if(i < CaptureTransferBlockSize * 2)
+    {
+      source[i] = byte(i / 1024);
+    }
+    else
+    {
+      state = state * 1664525U + 1013904223U;
+      source[i] = byte(state >> 24);
+    }
+  }
+
+  WriteWholeFile(srcPath, source);
+  FileIO::Delete(dstPath);
+
+  SECTION("Full transfer")
+  {
+    StreamWriter *compressed = SendToMemory(srcPath, 0, true);
+    StreamWriter *uncompressed = SendToMemory(srcPath, 0, false);
+
+    CHECK(compressed->GetOffset() < uncompressed->GetOffset());
+    CHECK(compressed->GetOffset() < source.size() * 3 / 4);
+
+    CHECK(ReceiveFromMemory(dstPath, compressed->GetData(), compressed->GetOffset()));
+    CHECK((ReadWholeFile(dstPath) == source));
+
+    FileIO::Delete(dstPath);
+
+    CHECK(ReceiveFromMemory(dstPath, uncompressed->GetData(), uncompressed->GetOffset()));
+    CHECK((ReadWholeFile(dstPath) == source));
+
+    delete compressed;
+    delete uncompressed;
+  };
+
+  SECTION("Resume after existing data")
+  {
+    // two good blocks, then garbage that should be replaced
+    bytebuf partial(source.data(), size_t(CaptureTransferBlockSize * 2 + 100));
+    partial.append(source.data(), size_t(CaptureTransferBlockSize * 2));
+    WriteWholeFile(dstPath, partial);
+
+    rdcarray<uint64_t> checksums = GetCaptureTransferChecksums(dstPath);
+    CHECK(checksums.size() == 4);
+
+    uint64_t resumeOffset = GetCaptureTransferResumeOffset(srcPath, checksums);
+    CHECK(resumeOffset == CaptureTransferBlockSize * 2);
+
+    StreamWriter *buf = SendToMemory(srcPath, resumeOffset, false);
+
+    CHECK(buf->GetOffset() < source.size() - CaptureTransferBlockSize);
+
+    CHECK(ReceiveFromMemory(dstPath, buf->GetData(), buf->GetOffset()));
+    CHECK((ReadWholeFile(dstPath) == source));
+
+    // a complete file resumes at the last partial block
+    checksums = GetCaptureTransferChecksums(dstPath);
+    CHECK(GetCaptureTransferResumeOffset(srcPath, checksums) == CaptureTransferBlockSize * 3);
+
+    delete buf;
+  };
+
+  SECTION("Interrupted transfer keeps verified blocks")
+  {
+    StreamWriter *buf = SendToMemory(srcPath, 0, false);
+
+    // cut the stream off partway through the third block
+    uint64_t cutoff = CaptureTransferBlockSize * 2 + CaptureTransferBlockSize / 2;
+    CHECK_FALSE(ReceiveFromMemory(dstPath, buf->GetData(), cutoff));
+
+    bytebuf received = ReadWholeFile(dstPath);
+    CHECK(received.size() == CaptureTransferBlockSize * 2);
+    CHECK(memcmp(received.data(), source.data(), received.size()) == 0);
+
+    // the next attempt picks up where we left off
+    uint64_t resumeOffset =
+        GetCaptureTransferResumeOffset(srcPath, GetCaptureTransferChecksums(dstPath));
+    CHECK(resumeOffset == CaptureTransferBlockSize * 2);
+
+    delete buf;
+    buf = SendToMemory(srcPath, resumeOffset, true);
+
+    CHECK(ReceiveFromMemory(dstPath, buf->GetData(), buf->GetOffset()));
+    CHECK((ReadWholeFile(dstPath) == source));
+
+    delete buf;
+  };
+
+  SECTION("Corrupted data is rejected")
+  {
+    StreamWriter *buf = SendToMemory(srcPath, 0, false);
+
+    bytebuf corrupted(buf->GetData(), (size_t)buf->GetOffset());
+    corrupted[size_t(CaptureTransferBlockSize + CaptureTransferBlockSize / 2)] ^= 0x1;
+
+    CHECK_FALSE(ReceiveFromMemory(dstPath, corrupted.data(), corrupted.size()));
+
+    // only the first block could be verified
+    CHECK(FileIO::GetFileSize(dstPath) == CaptureTransferBlockSize);
+
+    delete buf;
+  };
+
+  SECTION("Missing source file")
+  {
+    StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+    {
+      WriteSerialiser ser(buf, Ownership::Nothing);
+      ser.SetStreamingMode(true);
+
+      SCOPED_SERIALISE_CHUNK(1);
+      CHECK_FALSE(SendCaptureTransfer(ser, srcPath + ".missing", 0, true, NULL));
+    }
+
+    CHECK_FALSE(ReceiveFromMemory(dstPath, buf->GetData(), buf->GetOffset()));
+
+    delete buf;
+  };
+
+  FileIO::Delete(srcPath);
+  FileIO::Delete(dstPath);
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,360 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "core/content_delta.h"
+#include "common/common.h"
+
+// chunk size limits. The average is on the small side compared to what is typical for file
+// deduplication, since textures change in small localised areas and we'd rather not re-send a
+// large chunk because a few pixels changed. The minimum must be at least 64 bytes so that the
+// rolling hash has seen a full window by the time we first check for a boundary.
+static const size_t MinChunkSize = 1024;
+static const size_t AvgChunkSize = 4096;
+static const size_t MaxChunkSize = 32 * 1024;
+
+// normalised chunking: before the average size we use a mask with more bits set so boundaries are
+// less likely, after the average size a mask with fewer bits so they're more likely. This tightens
+// the distribution of chunk sizes around the average. The gear hash shifts left each byte so the
+// top bits have seen the most history, which is where we test.
+static const uint64_t MaskSmall = ~0ULL << (64 - 14);
+static const uint64_t MaskLarge = ~0ULL << (64 - 10);
+
+// granularity for the fallback diff against the reference data at the same offset. We only care
+// about large-ish sections at a time. This prevents us generating lots of tiny deltas where we
+// could batch changes together. This is tuned to not be too large (and thus causing us to miss too
+// many sections we could skip) and not too small (causing us to devolve into lots of byte-wise
+// deltas). Consider e.g. an android image of 1440x2560 and a pixel-wide line that goes vertically
+// from top to bottom. Reading horizontally that will mean 2560 different diffs, and only actually
+// one pixel changed. The larger this value gets, the more redundant data we'll send along with.
+static const uint64_t SectionSize = 128;
+
+struct GearTable
+{
+  GearTable()
+  {
+    // splitmix64 with a fixed seed. This must be deterministic as both sides of a transfer must
+    // chunk identically.
+    uint64_t state = 0x52656e646572446fULL;
+    for(size_t i = 0; i < 256; i++)
+    {
+      state += 0x9e3779b97f4a7c15ULL;
+      uint64_t z = state;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      values[i] = z ^ (z >> 31);
+    }
+  }
+
+  uint64_t values[256];
+};
+
+uint64_t HashContents(const byte *data, size_t length)
+{
+  const uint64_t prime1 = 0x9e3779b185ebca87ULL;
+  const uint64_t prime2 = 0xc2b2ae3d27d4eb4fULL;
+
+  uint64_t h = 0x27d4eb2f165667c5ULL ^ (uint64_t(length) * prime1);
+
+  size_t i = 0;
+  for(; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t))
+  {
+    uint64_t w;
+    memcpy(&w, data + i, sizeof(w));
+    w *= prime2;
+    w = (w << 31) | (w >> 33);
+    w *= prime1;
+    h ^= w;
+    h = ((h << 27) | (h >> 37)) * prime1 + 0x85ebca77c2b2ae63ULL;
+  }
+
+  for(; i < length; i++)
+  {
+    h ^= data[i] * prime1;
+    h = ((h << 11) | (h >> 53)) * prime2;
+  }
+
+  h ^= h >> 33;
+  h *= prime2;
+  h ^= h >> 29;
+  h *= prime1;
+  h ^= h >> 32;
+
+  return h;
+}
+
+static size_t FindChunkBoundary(const uint64_t *gear, const byte *data, size_t length)
+{
+  if(length <= MinChunkSize)
+    return length;
+
+  const size_t normalSize = RDCMIN(length, AvgChunkSize);
+  const size_t maxSize = RDCMIN(length, MaxChunkSize);
+
+  uint64_t fingerprint = 0;
+  size_t i = MinChunkSize;
+
+  for(; i < normalSize; i++)
+  {
+    fingerprint = (fingerprint << 1) + gear[data[i]];
+    if((fingerprint & MaskSmall) == 0)
+      return i;
+  }
+
+  for(; i < maxSize; i++)
+  {
+    fingerprint = (fingerprint << 1) + gear[data[i]];
+    if((fingerprint & MaskLarge) == 0)
+      return i;
+  }
+
+  return maxSize;
+}
+
+void ChunkContents(const byte *data, size_t length, rdcarray<ContentChunk> &chunks)
+{
+  static const GearTable gear;
+
+  chunks.clear();
+  chunks.reserve(length / AvgChunkSize + 1);
+
+  size_t offset = 0;
+  while(offset < length)
+  {
+    size_t chunkLength = FindChunkBoundary(gear.values, data + offset, length - offset);
+
+    chunks.push_back({offset, (uint32_t)chunkLength, HashContents(data + offset, chunkLength)});
+
+    offset += chunkLength;
+  }
+}
+
+const byte *ContentChunkCache::Find(uint64_t hash, uint32_t length) const
+{
+  auto it = m_Index.find(hash);
+  if(it == m_Index.end())
+    return NULL;
+
+  const Location &loc = it->second;
+
+  if(loc.length != length || loc.offset + loc.length > loc.blob->size())
+    return NULL;
+
+  return loc.blob->data() + loc.offset;
+}
+
+void ContentChunkCache::RemoveBlob(const bytebuf *blob)
+{
+  auto it = m_BlobHashes.find(blob);
+  if(it == m_BlobHashes.end())
+    return;
+
+  for(uint64_t hash : it->second)
+  {
+    auto idx = m_Index.find(hash);
+    // the entry may have been overwritten by a later blob with the same chunk, leave it alone
+    if(idx != m_Index.end() && idx->second.blob == blob)
+      m_Index.erase(idx);
+  }
+
+  m_BlobHashes.erase(it);
+}
+
+void ContentChunkCache::RetireBlob(bytebuf &blob)
+{
+  if(blob.empty())
+  {
+    RemoveBlob(&blob);
+    return;
+  }
+
+  m_History.push_back(bytebuf());
+  bytebuf &retired = m_History.back();
+  retired.swap(blob);
+  m_HistorySize += retired.size();
+
+  // point any index entries at the retired contents, which haven't moved in memory
+  auto it = m_BlobHashes.find(&blob);
+  if(it != m_BlobHashes.end())
+  {
+    for(uint64_t hash : it->second)
+    {
+      auto idx = m_Index.find(hash);
+      if(idx != m_Index.end() && idx->second.blob == &blob)
+        idx->second.blob = &retired;
+    }
+
+    m_BlobHashes[&retired].swap(it->second);
+    m_BlobHashes.erase(it);
+  }
+
+  // evict the oldest history until we're within budget
+  while(m_HistorySize > m_HistoryBudget && !m_History.empty())
+  {
+    bytebuf &oldest = m_History.front();
+    RemoveBlob(&oldest);
+    m_HistorySize -= oldest.size();
+    m_History.pop_front();
+  }
+}
+
+void ContentChunkCache::AddBlob(const bytebuf &blob, const rdcarray<ContentChunk> &chunks)
+{
+  RemoveBlob(&blob);
+
+  rdcarray<uint64_t> &hashes = m_BlobHashes[&blob];
+  hashes.reserve(chunks.size());
+
+  for(const ContentChunk &chunk : chunks)
+  {
+    // later blobs take precedence, both sides do this in the same order so it's deterministic
+    m_Index[chunk.hash] = {&blob, chunk.offset, chunk.length};
+    hashes.push_back(chunk.hash);
+  }
+}
+
+static void DiffSections(rdcarray<DeltaSection> &sections, const bytebuf &referenceData,
+                         const bytebuf &newData, uint64_t offset, uint64_t length)
+{
+  const byte *ref = referenceData.data();
+  const byte *src = newData.data();
+  const uint64_t refSize = referenceData.size();
+  const uint64_t end = offset + length;
+
+  while(offset < end)
+  {
+    // keep sections aligned to a fixed grid regardless of where chunk boundaries fall, so a change
+    // never costs more than it would if we weren't chunking at all
+    const uint64_t len = RDCMIN(SectionSize - (offset % SectionSize), end - offset);
+
+    bool diff = offset + len > refSize || memcmp(src + offset, ref + offset, (size_t)len) != 0;
+
+    if(diff)
+    {
+      // extend the last section if we're contiguous with it, otherwise start a new one
+      if(sections.empty() || sections.back().offs + sections.back().contents.size() != offset)
+      {
+        sections.push_back(DeltaSection());
+        sections.back().offs = offset;
+      }
+
+      sections.back().contents.append(src + offset, (size_t)len);
+    }
+
+    offset += len;
+  }
+}
+
+void CalculateContentDelta(const ContentChunkCache &cache, const bytebuf &referenceData,
+                           const bytebuf &newData, const rdcarray<ContentChunk> &newChunks,
+                           ContentDelta &delta)
+{
+  delta.size = newData.size();
+  delta.copies.clear();
+  delta.sections.clear();
+
+  const byte *src = newData.data();
+  const byte *ref = referenceData.data();
+  const uint64_t refSize = referenceData.size();
+
+  for(const ContentChunk &chunk : newChunks)
+  {
+    const byte *chunkData = src + chunk.offset;
+
+    // unchanged in place, nothing to do
+    if(chunk.offset + chunk.length <= refSize &&
+       memcmp(chunkData, ref + chunk.offset, chunk.length) == 0)
+      continue;
+
+    // seen before somewhere. We verify the contents since we have them here, so a hash collision
+    // can only ever cost us a missed match and not a corrupted transfer.
+    const byte *cached = cache.Find(chunk.hash, chunk.length);
+    if(cached && memcmp(cached, chunkData, chunk.length) == 0)
+    {
+      DeltaChunkCopy copy;
+      copy.offs = chunk.offset;
+      copy.hash = chunk.hash;
+      copy.length = chunk.length;
+      delta.copies.push_back(copy);
+      continue;
+    }
+
+    DiffSections(delta.sections, referenceData, newData, chunk.offset, chunk.length);
+  }
+}
+
+bool ApplyContentDelta(const ContentChunkCache &cache, const bytebuf &referenceData,
+                       const ContentDelta &delta, bytebuf &result)
+{
+  // copies may source from referenceData itself, so we build into a separate buffer
+  result.resize((size_t)delta.size);
+  memcpy(result.data(), referenceData.data(),
+         (size_t)RDCMIN((uint64_t)referenceData.size(), delta.size));
+
+  for(const DeltaChunkCopy &copy : delta.copies)
+  {
+    const byte *cached = cache.Find(copy.hash, copy.length);
+
+    if(!cached)
+    {
+      RDCERR("Delta references chunk %llx of %u bytes that isn't available", copy.hash,
+             copy.length);
+      return false;
+    }
+
+    if(copy.offs + copy.length > delta.size)
+    {
+      RDCERR("Delta chunk {%llu, %u} is out of bounds of %llu bytes", copy.offs, copy.length,
+             delta.size);
+      return false;
+    }
+
+    memcpy(result.data() + copy.offs, cached, copy.length);
+  }
+
+  for(const DeltaSection &section : delta.sections)
+  {
+    if(section.offs + section.contents.size() > delta.size)
+    {
+      RDCERR("Delta section {%llu, %llu} is out of bounds of %llu bytes", section.offs,
+             (uint64_t)section.contents.size(), delta.size);
+      return false;
+    }
+
+    memcpy(result.data() + section.offs, section.contents.data(), section.contents.size());
+  }
+
+  return true;
+}
+
+uint64_t GetContentDeltaPayloadSize(const ContentDelta &delta)
+{
+  uint64_t ret = sizeof(delta.size);
+
+  ret += delta.copies.size() * (sizeof(uint64_t) * 2 + sizeof(uint32_t));
+
+  for(const DeltaSection &section : delta.sections)
+    ret += sizeof(uint64_t) * 2 + section.contents.size();
+
+  return ret;
+}
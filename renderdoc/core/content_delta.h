@@ -0,0 +1,143 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <unordered_map>
+#include "api/replay/rdcarray.h"
+
+// A content-defined chunk of a blob. The boundaries are chosen by a rolling hash over the contents
+// so that an insertion or deletion only affects the chunks around it, and identical runs of data
+// produce identical chunks regardless of where they are in the blob.
+struct ContentChunk
+{
+  uint64_t offset;
+  uint32_t length;
+  uint64_t hash;
+};
+
+// a literal run of bytes to write at a given offset
+struct DeltaSection
+{
+  uint64_t offs = 0;
+  bytebuf contents;
+
+  void swap(DeltaSection &o)
+  {
+    std::swap(offs, o.offs);
+    contents.swap(o.contents);
+  }
+};
+
+// a chunk to copy from content that both sides have previously seen, identified by its hash
+struct DeltaChunkCopy
+{
+  uint64_t offs = 0;
+  uint64_t hash = 0;
+  uint32_t length = 0;
+};
+
+struct ContentDelta
+{
+  // the total size of the new contents
+  uint64_t size = 0;
+  // chunks copied from previously seen content. These are applied first
+  rdcarray<DeltaChunkCopy> copies;
+  // literal bytes, applied after the copies
+  rdcarray<DeltaSection> sections;
+
+  bool empty() const { return copies.empty() && sections.empty(); }
+};
+
+// a fast non-cryptographic 64-bit hash of some contents, used for chunks and resource fingerprints
+uint64_t HashContents(const byte *data, size_t length);
+
+// split data into content-defined chunks, using a gear rolling hash with normalised chunk sizes
+// as in FastCDC.
+void ChunkContents(const byte *data, size_t length, rdcarray<ContentChunk> &chunks);
+
+// An index from chunk hash to a location in a blob, over every blob that has been transferred. This
+// is kept on both sides of a transfer, and as long as both sides make the same calls in the same
+// order the indices will be identical - that lets one side refer to previous contents just by hash.
+//
+// The live blobs are owned externally (e.g. the proxy's per-resource data caches), and when their
+// contents are replaced the previous contents are moved into a bounded history so that scrubbing
+// back and forth between events can still find them.
+class ContentChunkCache
+{
+public:
+  ContentChunkCache(uint64_t historyBudget) : m_HistoryBudget(historyBudget) {}
+  // no copying
+  ContentChunkCache(const ContentChunkCache &) = delete;
+  ContentChunkCache &operator=(const ContentChunkCache &) = delete;
+
+  // look up a previously indexed chunk, returns NULL if it's not available
+  const byte *Find(uint64_t hash, uint32_t length) const;
+
+  // retire the current contents of a live blob into the history, leaving the blob empty. Called
+  // before the blob is given new contents
+  void RetireBlob(bytebuf &blob);
+
+  // index the chunks of a live blob's current contents
+  void AddBlob(const bytebuf &blob, const rdcarray<ContentChunk> &chunks);
+
+  uint64_t GetHistorySize() const { return m_HistorySize; }
+  size_t GetIndexedChunkCount() const { return m_Index.size(); }
+
+private:
+  struct Location
+  {
+    const bytebuf *blob;
+    uint64_t offset;
+    uint32_t length;
+  };
+
+  void RemoveBlob(const bytebuf *blob);
+
+  std::unordered_map<uint64_t, Location> m_Index;
+  // the hashes indexed from each blob, so we can remove or repoint them
+  std::map<const bytebuf *, rdcarray<uint64_t>> m_BlobHashes;
+
+  // oldest at the front. std::list so that the blob addresses remain stable
+  std::list<bytebuf> m_History;
+  uint64_t m_HistorySize = 0;
+  uint64_t m_HistoryBudget;
+};
+
+// calculate the delta to go from referenceData to newData. Any chunk that is unchanged at the same
+// offset is skipped, any chunk that can be found in the cache is copied, and anything else is
+// diffed against the reference data at the same offset at a finer granularity.
+void CalculateContentDelta(const ContentChunkCache &cache, const bytebuf &referenceData,
+                           const bytebuf &newData, const rdcarray<ContentChunk> &newChunks,
+                           ContentDelta &delta);
+
+// apply a delta on top of referenceData into result. Returns false if the delta referenced data not
+// in the cache, which means the two sides have gotten out of sync.
+bool ApplyContentDelta(const ContentChunkCache &cache, const bytebuf &referenceData,
+                       const ContentDelta &delta, bytebuf &result);
+
+// the number of payload bytes that a delta will transfer, before compression
+uint64_t GetContentDeltaPayloadSize(const ContentDelta &delta);
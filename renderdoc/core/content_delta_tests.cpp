@@ -0,0 +1,336 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/globalconfig.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include <set>
+#include "common/common.h"
+#include "common/timing.h"
+#include "content_delta.h"
+
+#include "catch/catch.hpp"
+
+static bytebuf MakeNoise(size_t size, uint32_t seed)
+{
+  bytebuf ret;
+  ret.resize(size);
+  uint32_t state = seed;
+  for(size_t i = 0; i < size; i++)
+  {
+    state = state * 1664525U + 1013904223U;
+    ret[i] = byte(state >> 24);
+  }
+  return ret;
+}
+
+// one side of a transfer, holding the same state as ReplayProxy does on each end
+struct DeltaEndpoint
+{
+  DeltaEndpoint(uint64_t budget) : cache(budget) {}
+  ContentChunkCache cache;
+  std::map<uint32_t, bytebuf> blobs;
+};
+
+// transfer contents into the blob with the given key, checking that the receiver ends up with the
+// right data and returning the payload size that was sent.
+static uint64_t Transfer(DeltaEndpoint &sender, DeltaEndpoint &receiver, uint32_t key,
+                         const bytebuf &contents)
+{
+  bytebuf newData = contents;
+  bytebuf &senderRef = sender.blobs[key];
+  bytebuf &receiverRef = receiver.blobs[key];
+
+  rdcarray<ContentChunk> chunks;
+  ChunkContents(newData.data(), newData.size(), chunks);
+
+  ContentDelta delta;
+  CalculateContentDelta(sender.cache, senderRef, newData, chunks, delta);
+
+  if(delta.empty() && senderRef.size() == newData.size())
+  {
+    CHECK((receiverRef == contents));
+    return 0;
+  }
+
+  sender.cache.RetireBlob(senderRef);
+  senderRef.swap(newData);
+  sender.cache.AddBlob(senderRef, chunks);
+
+  bytebuf result;
+  CHECK(ApplyContentDelta(receiver.cache, receiverRef, delta, result));
+
+  receiver.cache.RetireBlob(receiverRef);
+  receiverRef.swap(result);
+  ChunkContents(receiverRef.data(), receiverRef.size(), chunks);
+  receiver.cache.AddBlob(receiverRef, chunks);
+
+  CHECK((receiverRef == contents));
+
+  return GetContentDeltaPayloadSize(delta);
+}
+
+// the equivalent of the old fixed-section scheme - diffing only against the previous contents of
+// the same resource at the same offset. This is what we get with a cache that never has anything
+static uint64_t FixedSectionTransfer(bytebuf &reference, const bytebuf &contents)
+{
+  ContentChunkCache empty(0);
+
+  rdcarray<ContentChunk> chunks;
+  ChunkContents(contents.data(), contents.size(), chunks);
+
+  ContentDelta delta;
+  CalculateContentDelta(empty, reference, contents, chunks, delta);
+
+  reference = contents;
+
+  if(delta.empty())
+    return 0;
+
+  return GetContentDeltaPayloadSize(delta);
+}
+
+struct ScrubStep
+{
+  uint32_t key;
+  bytebuf contents;
+};
+
+// simulate the texture viewer stepping through a few events of a pass: drawing into a target,
+// scrolling it, a copy into another target, then the user scrubbing back and forth.
+static rdcarray<ScrubStep> MakeScrubTrace()
+{
+  const uint32_t width = 256, height = 256, pitch = width * 4;
+
+  bytebuf background = MakeNoise(pitch * height, 1234);
+
+  bytebuf drawn = background;
+  bytebuf rect = MakeNoise(64 * 4, 5678);
+  for(uint32_t y = 32; y < 96; y++)
+    memcpy(drawn.data() + y * pitch + 32 * 4, rect.data(), rect.size());
+
+  // scroll down by 3 rows, filling the top with new data
+  bytebuf scrolled = drawn;
+  memmove(scrolled.data() + pitch * 3, drawn.data(), pitch * (height - 3));
+  bytebuf top = MakeNoise(pitch * 3, 9012);
+  memcpy(scrolled.data(), top.data(), top.size());
+
+  // a single pixel-wide vertical line, the worst case for a content-defined scheme
+  bytebuf line = background;
+  for(uint32_t y = 0; y < height; y++)
+    line[y * pitch + 100 * 4] ^= 0xff;
+
+  return {
+      {0, background}, {0, drawn}, {0, scrolled}, {1, drawn},    {0, line},
+      {0, background}, {0, drawn}, {0, scrolled}, {1, scrolled}, {0, drawn},
+  };
+}
+
+TEST_CASE("Test content-defined chunking", "[content_delta]")
+{
+  bytebuf data = MakeNoise(1024 * 1024, 42);
+
+  rdcarray<ContentChunk> chunks;
+  ChunkContents(data.data(), data.size(), chunks);
+
+  SECTION("Chunks cover all data with bounded sizes")
+  {
+    uint64_t offset = 0;
+    for(size_t i = 0; i < chunks.size(); i++)
+    {
+      CHECK(chunks[i].offset == offset);
+      CHECK(chunks[i].length <= 32 * 1024);
+      if(i + 1 < chunks.size())
+        CHECK(chunks[i].length >= 1024);
+      offset += chunks[i].length;
+    }
+    CHECK(offset == data.size());
+
+    // average should be somewhere near the target
+    CHECK(chunks.size() > data.size() / (16 * 1024));
+    CHECK(chunks.size() < data.size() / 2048);
+  };
+
+  SECTION("Chunking is deterministic")
+  {
+    rdcarray<ContentChunk> chunks2;
+    ChunkContents(data.data(), data.size(), chunks2);
+
+    REQUIRE(chunks.size() == chunks2.size());
+    for(size_t i = 0; i < chunks.size(); i++)
+    {
+      CHECK(chunks[i].offset == chunks2[i].offset);
+      CHECK(chunks[i].length == chunks2[i].length);
+      CHECK(chunks[i].hash == chunks2[i].hash);
+    }
+  };
+
+  SECTION("Insertion only affects nearby chunks")
+  {
+    bytebuf shifted = data;
+    byte inserted[17] = {};
+    shifted.insert(data.size() / 2, inserted, sizeof(inserted));
+
+    rdcarray<ContentChunk> shiftedChunks;
+    ChunkContents(shifted.data(), shifted.size(), shiftedChunks);
+
+    std::set<uint64_t> hashes;
+    for(const ContentChunk &c : chunks)
+      hashes.insert(c.hash);
+
+    size_t found = 0;
+    for(const ContentChunk &c : shiftedChunks)
+      if(hashes.find(c.hash) != hashes.end())
+        found++;
+
+    CHECK(found + 3 >= chunks.size());
+  };
+
+  SECTION("Empty and tiny data")
+  {
+    ChunkContents(NULL, 0, chunks);
+    CHECK(chunks.empty());
+
+    ChunkContents(data.data(), 10, chunks);
+    REQUIRE(chunks.size() == 1);
+    CHECK(chunks[0].length == 10);
+  };
+};
+
+TEST_CASE("Test content delta transfer", "[content_delta]")
+{
+  SECTION("Unchanged data sends nothing")
+  {
+    DeltaEndpoint sender(0), receiver(0);
+    bytebuf data = MakeNoise(100000, 1);
+
+    CHECK(Transfer(sender, receiver, 0, data) > data.size());
+    CHECK(Transfer(sender, receiver, 0, data) == 0);
+  };
+
+  SECTION("Resized data")
+  {
+    DeltaEndpoint sender(0), receiver(0);
+    bytebuf data = MakeNoise(100000, 1);
+
+    Transfer(sender, receiver, 0, data);
+
+    data.resize(50000);
+    CHECK(Transfer(sender, receiver, 0, data) < 1000);
+
+    bytebuf larger = MakeNoise(150000, 1);
+    Transfer(sender, receiver, 0, larger);
+
+    Transfer(sender, receiver, 0, bytebuf());
+  };
+
+  SECTION("Shifted data is found in the previous contents")
+  {
+    DeltaEndpoint sender(1024 * 1024), receiver(1024 * 1024);
+    bytebuf data = MakeNoise(256 * 1024, 1);
+
+    Transfer(sender, receiver, 0, data);
+
+    bytebuf shifted = data;
+    byte inserted[5] = {1, 2, 3, 4, 5};
+    shifted.insert(1000, inserted, sizeof(inserted));
+
+    CHECK(Transfer(sender, receiver, 0, shifted) < 32 * 1024);
+  };
+
+  SECTION("Data from another blob is referenced")
+  {
+    DeltaEndpoint sender(0), receiver(0);
+    bytebuf data = MakeNoise(256 * 1024, 1);
+
+    Transfer(sender, receiver, 0, data);
+    CHECK(Transfer(sender, receiver, 1, data) < 16 * 1024);
+  };
+
+  SECTION("History is evicted identically on both sides")
+  {
+    DeltaEndpoint sender(300 * 1024), receiver(300 * 1024);
+
+    for(uint32_t i = 0; i < 8; i++)
+    {
+      Transfer(sender, receiver, i % 3, MakeNoise(128 * 1024, i % 5));
+      CHECK(sender.cache.GetHistorySize() == receiver.cache.GetHistorySize());
+      CHECK(sender.cache.GetHistorySize() <= 300 * 1024);
+      CHECK(sender.cache.GetIndexedChunkCount() == receiver.cache.GetIndexedChunkCount());
+    }
+  };
+
+  SECTION("Scrubbing trace is never worse than fixed sections")
+  {
+    rdcarray<ScrubStep> trace = MakeScrubTrace();
+
+    DeltaEndpoint sender(64 * 1024 * 1024), receiver(64 * 1024 * 1024);
+    std::map<uint32_t, bytebuf> fixedRefs;
+
+    uint64_t cdcTotal = 0, fixedTotal = 0;
+
+    for(const ScrubStep &step : trace)
+    {
+      uint64_t cdc = Transfer(sender, receiver, step.key, step.contents);
+      uint64_t fixed = FixedSectionTransfer(fixedRefs[step.key], step.contents);
+
+      // allow for the small overhead of chunk copy records
+      CHECK(cdc <= fixed + 1024);
+
+      cdcTotal += cdc;
+      fixedTotal += fixed;
+    }
+
+    CHECK(cdcTotal * 2 < fixedTotal);
+  };
+};
+
+TEST_CASE("Benchmark content delta scrubbing", "[content_delta][.][benchmark]")
+{
+  rdcarray<ScrubStep> trace = MakeScrubTrace();
+
+  DeltaEndpoint sender(64 * 1024 * 1024), receiver(64 * 1024 * 1024);
+  std::map<uint32_t, bytebuf> fixedRefs;
+
+  uint64_t cdcTotal = 0, fixedTotal = 0, rawTotal = 0;
+
+  PerformanceTimer timer;
+
+  for(int iter = 0; iter < 10; iter++)
+  {
+    for(const ScrubStep &step : trace)
+    {
+      cdcTotal += Transfer(sender, receiver, step.key, step.contents);
+      fixedTotal += FixedSectionTransfer(fixedRefs[step.key], step.contents);
+      rawTotal += step.contents.size();
+    }
+  }
+
+  RDCLOG("Scrub trace of %llu bytes: %llu bytes with fixed sections, %llu with content chunks",
+         rawTotal, fixedTotal, cdcTotal);
+  RDCLOG("Took %.3lf ms", timer.GetMilliseconds());
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -56,6 +56,10 @@ RDOC_CONFIG(bool, Replay_Debug_PrintChunkTimings, false, "Print stats of chunk p
 RDOC_CONFIG(bool, Replay_Debug_SingleThreadedCompilation, false,
             "Compile all shaders and PSOs single-threaded.");
 
+RDOC_CONFIG(bool, Replay_IncrementalForward, true,
+            "When moving forward to a later event, replay only the intervening events where the "
+            "driver knows the current replayed state is still intact.");
+
 // this is declared centrally so it can be shared with any backend - the name is a misnomer but kept
 // for backwards compatibility reasons.
 RDOC_CONFIG(rdcarray<rdcstr>, DXBC_Debug_SearchDirPaths, {},
@@ -1396,89 +1400,106 @@ void RenderDoc::ResamplePixels(const FramePixels &in, RDCThumb &out)
   out.pixels.resize(3 * out.width * out.height);
   out.format = FileType::Raw;
 
-  byte *dst = (byte *)out.pixels.data();
-  byte *source = (byte *)in.data;
+  const byte *source = (const byte *)in.data;
+
+  // the source columns we sample are the same on every row, so calculate them once
+  rdcarray<uint32_t> srcOffsets;
+  srcOffsets.resize(out.width);
+  for(uint32_t x = 0; x < out.width; x++)
+    srcOffsets[x] = in.stride * (x * in.width / out.width);
 
   for(uint32_t y = 0; y < out.height; y++)
   {
-    for(uint32_t x = 0; x < out.width; x++)
-    {
-      uint32_t xSource = x * in.width / out.width;
-      uint32_t ySource = y * in.height / out.height;
-      byte *src = &source[in.stride * xSource + in.pitch * ySource];
+    const byte *srcRow = &source[in.pitch * (y * in.height / out.height)];
+
+    // write straight to the flipped row if we need to flip, rather than flipping afterwards
+    const uint32_t dstY = in.is_y_flipped ? y : out.height - 1 - y;
+    byte *dst = (byte *)out.pixels.data() + 3 * out.width * dstY;
 
-      if(in.buf1010102)
+    // the format is the same for every pixel, so pick the conversion once per row and keep the
+    // inner loops free of branches
+    if(in.buf1010102)
+    {
+      for(uint32_t x = 0; x < out.width; x++, dst += 3)
       {
-        uint32_t *src1010102 = (uint32_t *)src;
-        Vec4f unorm = ConvertFromR10G10B10A2(*src1010102);
+        uint32_t src1010102;
+        memcpy(&src1010102, srcRow + srcOffsets[x], sizeof(src1010102));
+        Vec4f unorm = ConvertFromR10G10B10A2(src1010102);
         dst[0] = (byte)(unorm.x * 255.0f);
         dst[1] = (byte)(unorm.y * 255.0f);
         dst[2] = (byte)(unorm.z * 255.0f);
       }
-      else if(in.buf565)
+    }
+    else if(in.buf565)
+    {
+      for(uint32_t x = 0; x < out.width; x++, dst += 3)
       {
-        uint16_t *src565 = (uint16_t *)src;
-        Vec3f unorm = ConvertFromB5G6R5(*src565);
+        uint16_t src565;
+        memcpy(&src565, srcRow + srcOffsets[x], sizeof(src565));
+        Vec3f unorm = ConvertFromB5G6R5(src565);
         dst[0] = (byte)(unorm.x * 255.0f);
         dst[1] = (byte)(unorm.y * 255.0f);
         dst[2] = (byte)(unorm.z * 255.0f);
       }
-      else if(in.buf5551)
+    }
+    else if(in.buf5551)
+    {
+      for(uint32_t x = 0; x < out.width; x++, dst += 3)
       {
-        uint16_t *src5551 = (uint16_t *)src;
-        Vec4f unorm = ConvertFromB5G5R5A1(*src5551);
+        uint16_t src5551;
+        memcpy(&src5551, srcRow + srcOffsets[x], sizeof(src5551));
+        Vec4f unorm = ConvertFromB5G5R5A1(src5551);
         dst[0] = (byte)(unorm.x * 255.0f);
         dst[1] = (byte)(unorm.y * 255.0f);
         dst[2] = (byte)(unorm.z * 255.0f);
       }
-      else if(in.bgra)
+    }
+    else if(in.bgra)
+    {
+      for(uint32_t x = 0; x < out.width; x++, dst += 3)
       {
+        const byte *src = srcRow + srcOffsets[x];
         dst[0] = src[2];
         dst[1] = src[1];
         dst[2] = src[0];
       }
-      else if(in.bpc == 2)    // R16G16B16A16 backbuffer
+    }
+    else if(in.bpc == 2)    // R16G16B16A16 backbuffer
+    {
+      // there are few enough half values that a table is much cheaper than converting each pixel
+      // to sRGB with powf
+      static const struct HalfToSRGB8
       {
-        uint16_t *src16 = (uint16_t *)src;
+        HalfToSRGB8()
+        {
+          for(uint32_t i = 0; i <= 0xffff; i++)
+          {
+            float linear = RDCCLAMP(ConvertFromHalf(uint16_t(i)), 0.0f, 1.0f);
+            table[i] = byte(255.0f * ConvertLinearToSRGB(linear));
+          }
+        }
 
-        float linearR = RDCCLAMP(ConvertFromHalf(src16[0]), 0.0f, 1.0f);
-        float linearG = RDCCLAMP(ConvertFromHalf(src16[1]), 0.0f, 1.0f);
-        float linearB = RDCCLAMP(ConvertFromHalf(src16[2]), 0.0f, 1.0f);
+        byte table[0x10000];
+      } halfToSRGB;
 
-        dst[0] = byte(255.0f * ConvertLinearToSRGB(linearR));
-        dst[1] = byte(255.0f * ConvertLinearToSRGB(linearG));
-        dst[2] = byte(255.0f * ConvertLinearToSRGB(linearB));
-      }
-      else
+      for(uint32_t x = 0; x < out.width; x++, dst += 3)
       {
-        dst[0] = src[0];
-        dst[1] = src[1];
-        dst[2] = src[2];
+        uint16_t src16[3];
+        memcpy(src16, srcRow + srcOffsets[x], sizeof(src16));
+
+        dst[0] = halfToSRGB.table[src16[0]];
+        dst[1] = halfToSRGB.table[src16[1]];
+        dst[2] = halfToSRGB.table[src16[2]];
       }
-      dst += 3;
     }
-  }
-
-  if(!in.is_y_flipped)
-  {
-    for(uint16_t y = 0; y < out.height / 2; y++)
+    else
     {
-      uint16_t flipY = (out.height - 1 - y);
-      for(uint16_t x = 0; x < out.width; x++)
+      for(uint32_t x = 0; x < out.width; x++, dst += 3)
       {
-        byte *src = (byte *)out.pixels.data();
-        byte save[3];
-        save[0] = src[(y * out.width + x) * 3 + 0];
-        save[1] = src[(y * out.width + x) * 3 + 1];
-        save[2] = src[(y * out.width + x) * 3 + 2];
-
-        src[(y * out.width + x) * 3 + 0] = src[(flipY * out.width + x) * 3 + 0];
-        src[(y * out.width + x) * 3 + 1] = src[(flipY * out.width + x) * 3 + 1];
-        src[(y * out.width + x) * 3 + 2] = src[(flipY * out.width + x) * 3 + 2];
-
-        src[(flipY * out.width + x) * 3 + 0] = save[0];
-        src[(flipY * out.width + x) * 3 + 1] = save[1];
-        src[(flipY * out.width + x) * 3 + 2] = save[2];
+        const byte *src = srcRow + srcOffsets[x];
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
       }
     }
   }
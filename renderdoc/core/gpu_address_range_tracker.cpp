@@ -27,28 +27,28 @@
 void GPUAddressRangeTracker::AddTo(const GPUAddressRange &range)
 {
   SCOPED_WRITELOCK(addressLock);
-  auto it = std::lower_bound(addresses.begin(), addresses.end(), range.start);
 
-  addresses.insert(it - addresses.begin(), range);
+  // insert before any existing ranges with the same start
+  addresses.insert(addresses.lower_bound(range.start), {range.start, range});
 }
 
 void GPUAddressRangeTracker::RemoveFrom(const GPUAddressRange &range)
 {
   {
     SCOPED_WRITELOCK(addressLock);
-    size_t i = std::lower_bound(addresses.begin(), addresses.end(), range.start) - addresses.begin();
+    auto it = addresses.lower_bound(range.start);
 
     // there might be multiple buffers with the same range start, find the exact range for this
     // buffer
-    while(i < addresses.size() && addresses[i].start == range.start)
+    while(it != addresses.end() && it->first == range.start)
     {
-      if(addresses[i].id == range.id)
+      if(it->second.id == range.id)
       {
-        addresses.erase(i);
+        addresses.erase(it);
         return;
       }
 
-      ++i;
+      ++it;
     }
   }
 
@@ -69,20 +69,17 @@ void GPUAddressRangeTracker::GetResIDFromAddr(GPUAddressRange::Address addr, Res
   {
     SCOPED_READLOCK(addressLock);
 
-    auto it = std::lower_bound(addresses.begin(), addresses.end(), addr);
+    auto it = addresses.lower_bound(addr);
     if(it == addresses.end())
       return;
 
-    range = *it;
+    range = it->second;
 
     // find the largest resource containing this address - not perfect but helps with trivially bad
     // aliases where a tiny resource and a large resource are co-situated and the larger resource
     // needs to be used for validity
-    while((it + 1)->start <= addr && (it + 1)->realEnd > range.realEnd)
-    {
-      it++;
-      range = *it;
-    }
+    for(++it; it != addresses.end() && it->second.realEnd > range.realEnd; ++it)
+      range = it->second;
   }
 
   if(addr < range.start || addr >= range.realEnd)
@@ -106,20 +103,17 @@ void GPUAddressRangeTracker::GetResIDFromAddrAllowOutOfBounds(GPUAddressRange::A
   {
     SCOPED_READLOCK(addressLock);
 
-    auto it = std::lower_bound(addresses.begin(), addresses.end(), addr);
+    auto it = addresses.lower_bound(addr);
     if(it == addresses.end())
       return;
 
-    range = *it;
+    range = it->second;
 
     // find the largest resource containing this address - not perfect but helps with trivially bad
     // aliases where a tiny resource and a large resource are co-situated and the larger resource
     // needs to be used for validity
-    while((it + 1)->start <= addr && (it + 1)->realEnd > range.realEnd)
-    {
-      it++;
-      range = *it;
-    }
+    for(++it; it != addresses.end() && it->second.realEnd > range.realEnd; ++it)
+      range = it->second;
   }
 
   if(addr < range.start)
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <functional>
+#include <map>
 
 #include "api/replay/resourceid.h"
 #include "common/threading.h"
@@ -35,14 +36,6 @@ struct GPUAddressRange
 
   Address start, realEnd, oobEnd;
   ResourceId id;
-
-  bool operator<(const Address &o) const
-  {
-    if(o < start)
-      return true;
-
-    return false;
-  }
 };
 
 struct GPUAddressRangeTracker
@@ -52,7 +45,13 @@ struct GPUAddressRangeTracker
   GPUAddressRangeTracker(const GPUAddressRangeTracker &) = delete;
   GPUAddressRangeTracker &operator=(const GPUAddressRangeTracker &) = delete;
 
-  rdcarray<GPUAddressRange> addresses;
+  // ranges keyed by their start, in descending order so that lower_bound(addr) finds the highest
+  // starting range at or below addr. Kept in a tree so that creating and destroying resources
+  // doesn't shuffle the whole list when there are many thousands of them.
+  using Address = GPUAddressRange::Address;
+  using AddressMap = std::multimap<Address, GPUAddressRange, std::greater<Address>>;
+
+  AddressMap addresses;
   Threading::RWLock addressLock;
 
   void AddTo(const GPUAddressRange &range);
@@ -358,6 +358,11 @@ public:
     return new ShaderDebugTrace();
   }
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger) { return {}; }
+  ShaderDebugState RunDebug(ShaderDebugger *debugger, const rdcarray<uint32_t> &breakpoints,
+                            uint32_t maxSteps)
+  {
+    return {};
+  }
   void FreeDebugger(ShaderDebugger *debugger) { delete debugger; }
   void BuildTargetShader(ShaderEncoding sourceEncoding, const bytebuf &source, const rdcstr &entry,
                          const ShaderCompileFlags &compileFlags, ShaderStage type, ResourceId &id,
@@ -1028,7 +1033,10 @@ void ImageViewer::CreateProxyTexture(TextureDescription &texDetails, read_dds_da
       bool convertSupported = false;
       DecodeFormattedComponents(texDetails.format, NULL, &convertSupported);
 
-      if(convertSupported)
+      // block compressed formats can be decompressed instead
+      const bool blockDecode = !convertSupported && CanDecodeBlockCompressed(texDetails.format);
+
+      if(convertSupported || blockDecode)
       {
         uint32_t srcStride = texDetails.format.ElementSize();
 
@@ -1057,20 +1065,25 @@ void ImageViewer::CreateProxyTexture(TextureDescription &texDetails, read_dds_da
           convertedData.resize(convertedData.size() + read_data.subresources[i].second);
           byte *converted = convertedData.data() + read_data.subresources[i].first;
 
-          byte *src = old;
           FloatVector *dst = (FloatVector *)converted;
 
-          for(uint32_t z = 0; z < mipdepth; z++)
+          if(blockDecode)
+          {
+            const size_t blockSize = (texDetails.format.type == ResourceFormatType::BC1 ||
+                                      texDetails.format.type == ResourceFormatType::BC4)
+                                         ? 8
+                                         : 16;
+            const size_t slicePitch =
+                RDCMAX(1U, (mipwidth + 3) / 4) * RDCMAX(1U, (mipheight + 3) / 4) * blockSize;
+
+            for(uint32_t z = 0; z < mipdepth; z++)
+              DecodeBlockCompressed(texDetails.format, old + slicePitch * z, mipwidth, mipheight,
+                                    dst + mipwidth * mipheight * z);
+          }
+          else
           {
-            for(uint32_t y = 0; y < mipheight; y++)
-            {
-              for(uint32_t x = 0; x < mipwidth; x++)
-              {
-                *dst = DecodeFormattedComponents(texDetails.format, src);
-                dst++;
-                src += srcStride;
-              }
-            }
+            DecodeFormattedComponentsRow(texDetails.format, old, srcStride,
+                                         mipwidth * mipheight * mipdepth, dst);
           }
         }
 
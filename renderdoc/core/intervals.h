@@ -29,7 +29,7 @@
 #include "api/replay/renderdoc_replay.h"
 #include "common/common.h"
 
-template <typename T>
+template <typename T, typename MapType>
 struct Intervals;
 
 template <typename T, typename Map, typename Iter, typename Interval>
@@ -83,7 +83,7 @@ public:
   inline void split(uint64_t x)
   {
     if(this->start() < x)
-      this->iter = this->owner->insert(rdcpair<uint64_t, T>(x, this->value())).first;
+      this->iter = this->owner->insert(typename Map::value_type(x, this->value())).first;
   }
 
   // Merge this interval with the interval to the left, if both intervals have
@@ -109,7 +109,8 @@ public:
 template <typename T, typename Map, typename Iter, typename Interval>
 class IntervalsIter
 {
-  friend struct Intervals<T>;
+  template <typename, typename>
+  friend struct Intervals;
 
 protected:
   Interval ref;
@@ -157,13 +158,25 @@ public:
   inline Interval *operator->() { return &ref; }
 };
 
-// Data structure to efficiently store values for disjoint intervals.
+// A single update to apply in `Intervals<T>::updateBatch`, covering [start, finish).
 template <typename T>
+struct IntervalUpdate
+{
+  uint64_t start;
+  uint64_t finish;
+  T value;
+};
+
+// Data structure to efficiently store values for disjoint intervals.
+//
+// By default the start points are stored in a sorted array, which is compact and quick to iterate
+// but makes each split of an interval an O(n) insert. `TreeIntervals<T>` below stores them in a
+// balanced tree instead, for cases where there can be many thousands of intervals updated in no
+// particular order.
+template <typename T, typename MapType = rdcsortedflatmap<uint64_t, T>>
 struct Intervals
 {
 public:
-  using MapType = rdcsortedflatmap<uint64_t, T>;
-
   typedef IntervalRef<T, MapType, typename MapType::iterator> interval;
   typedef IntervalsIter<T, MapType, typename MapType::iterator, interval> iterator;
 
@@ -243,6 +256,83 @@ public:
       i->mergeLeft();
   }
 
+  // Apply a list of updates, each as if by `update(u.start, u.finish, u.value, comp)` in order.
+  // If the updates are sorted by start and don't overlap, and there are enough of them relative
+  // to the number of existing intervals, the intervals are rebuilt in a single linear pass instead
+  // of splitting and merging for each update in turn.
+  template <typename Compose>
+  void updateBatch(const rdcarray<IntervalUpdate<T>> &updates, Compose comp)
+  {
+    bool sorted = true;
+    uint64_t prevFinish = 0;
+    for(const IntervalUpdate<T> &u : updates)
+    {
+      if(u.finish <= u.start)
+        continue;
+      if(u.start < prevFinish)
+      {
+        sorted = false;
+        break;
+      }
+      prevFinish = u.finish;
+    }
+
+    if(!sorted || updates.size() * 16 < StartPoints.size())
+    {
+      for(const IntervalUpdate<T> &u : updates)
+        update(u.start, u.finish, u.value, comp);
+      return;
+    }
+
+    MapType result;
+
+    // append an interval starting at `x`, unless it would have the same value as the previous one
+    auto append = [&result](uint64_t x, const T &val) {
+      if(result.size() > 0)
+      {
+        auto last = result.end();
+        last--;
+        if(last->second == val)
+          return;
+      }
+      result.insert(result.end(), typename MapType::value_type(x, val));
+    };
+
+    size_t u = 0;
+    uint64_t pos = 0;
+
+    for(auto it = StartPoints.begin(); it != StartPoints.end();)
+    {
+      auto next = it;
+      next++;
+      uint64_t itFinish = next == StartPoints.end() ? UINT64_MAX : next->first;
+
+      // walk [pos, itFinish), which is the remainder of the existing interval `it`
+      while(pos < itFinish)
+      {
+        while(u < updates.size() && updates[u].finish <= RDCMAX(updates[u].start, pos))
+          u++;
+
+        if(u < updates.size() && updates[u].start <= pos)
+        {
+          // inside update `u`, compose its value with this part of the existing interval
+          append(pos, comp(it->second, updates[u].value));
+          pos = RDCMIN(updates[u].finish, itFinish);
+        }
+        else
+        {
+          // untouched up to the next update or the end of the existing interval
+          append(pos, it->second);
+          pos = u < updates.size() ? RDCMIN(updates[u].start, itFinish) : itFinish;
+        }
+      }
+
+      it = next;
+    }
+
+    StartPoints.swap(result);
+  }
+
   // Update `this` by composing the value of each interval with the value of the
   // corresponding interval in `other`.
   // If the intervals in `this` and `other` do not line up, then the intervals in
@@ -286,3 +376,6 @@ public:
     }
   }
 };
+
+template <typename T>
+using TreeIntervals = Intervals<T, std::map<uint64_t, T>>;
@@ -27,6 +27,7 @@
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #include "api/replay/rdcarray.h"
+#include "common/timing.h"
 #include "intervals.h"
 
 #include "catch/catch.hpp"
@@ -40,7 +41,8 @@ struct Interval
   uint64_t end;
 };
 
-void check_intervals(Intervals<uint64_t> &value, const rdcarray<Interval> &expected)
+template <typename IntervalsType>
+void check_intervals(IntervalsType &value, const rdcarray<Interval> &expected)
 {
   auto i = value.begin();
   auto j = expected.begin();
@@ -439,4 +441,197 @@ TEST_CASE("Test Intervals type", "[intervals]")
   };
 };
 
+// check two intervals instances with possibly different backing storage hold the same intervals
+template <typename A, typename B>
+void check_same_intervals(A &a, B &b)
+{
+  auto i = a.begin();
+  auto j = b.begin();
+  for(; i != a.end() && j != b.end(); i++, j++)
+  {
+    CHECK(i->start() == j->start());
+    CHECK(i->value() == j->value());
+    CHECK(i->finish() == j->finish());
+  }
+  CHECK((i == a.end()));
+  CHECK((j == b.end()));
+}
+
+static uint64_t add(uint64_t x, uint64_t y)
+{
+  return x + y;
+}
+
+// simple deterministic generator so that failures are reproducible
+static uint32_t next_random(uint32_t &state)
+{
+  state = state * 1664525U + 1013904223U;
+  return state >> 8;
+}
+
+// a sorted list of disjoint (sometimes touching) ranges within [0, space)
+static rdcarray<IntervalUpdate<uint64_t>> make_sorted_updates(uint32_t seed, size_t count,
+                                                              uint64_t space)
+{
+  rdcarray<IntervalUpdate<uint64_t>> ret;
+  uint32_t state = seed;
+  uint64_t pos = 0;
+  uint64_t stride = space / count;
+  for(size_t i = 0; i < count; i++)
+  {
+    uint64_t start = pos + (next_random(state) % 3 == 0 ? 0 : next_random(state) % (stride / 2));
+    uint64_t finish = start + 1 + next_random(state) % (stride / 2);
+    ret.push_back({start, finish, 1 + next_random(state) % 3});
+    pos = finish;
+  }
+  return ret;
+}
+
+TEST_CASE("Test tree-backed Intervals and batch updates", "[intervals]")
+{
+  SECTION("tree intervals match flat intervals")
+  {
+    Intervals<uint64_t> flat;
+    TreeIntervals<uint64_t> tree;
+
+    uint32_t state = 1234;
+    for(int i = 0; i < 2000; i++)
+    {
+      uint64_t start = next_random(state) % 100000;
+      uint64_t finish = start + next_random(state) % 1000;
+      uint64_t val = next_random(state) % 4;
+      flat.update(start, finish, val, add);
+      tree.update(start, finish, val, add);
+    }
+
+    check_same_intervals(flat, tree);
+
+    Intervals<uint64_t> flatOther;
+    TreeIntervals<uint64_t> treeOther;
+    flatOther.update(500, 50000, 7, add);
+    treeOther.update(500, 50000, 7, add);
+
+    flat.merge(flatOther, add);
+    tree.merge(treeOther, add);
+
+    check_same_intervals(flat, tree);
+  };
+
+  SECTION("batch update into empty intervals")
+  {
+    TreeIntervals<uint64_t> test;
+    test.updateBatch({{5, 10, 1}, {10, 15, 2}, {20, 30, 1}}, add);
+    check_intervals(
+        test, {{0, 0, 5}, {5, 1, 10}, {10, 2, 15}, {15, 0, 20}, {20, 1, 30}, {30, 0, UINT64_MAX}});
+  };
+
+  SECTION("batch update merges touching ranges")
+  {
+    Intervals<uint64_t> test;
+    test.updateBatch({{5, 10, 1}, {10, 15, 1}, {15, 15, 3}, {15, 20, 1}}, add);
+    check_intervals(test, {{0, 0, 5}, {5, 1, 20}, {20, 0, UINT64_MAX}});
+  };
+
+  SECTION("batch update finishing at UINT64_MAX")
+  {
+    Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+    test.updateBatch({{0, 7, 1}, {20, UINT64_MAX, 1}}, add);
+    check_intervals(
+        test, {{0, 1, 5}, {5, 2, 7}, {7, 1, 10}, {10, 0, 20}, {20, 1, UINT64_MAX}});
+  };
+
+  SECTION("batch update matches individual updates")
+  {
+    rdcarray<IntervalUpdate<uint64_t>> existing = make_sorted_updates(99, 500, 1000000);
+    rdcarray<IntervalUpdate<uint64_t>> updates = make_sorted_updates(7, 2000, 1000000);
+
+    Intervals<uint64_t> reference;
+    TreeIntervals<uint64_t> tree;
+    Intervals<uint64_t> flat;
+    for(const IntervalUpdate<uint64_t> &u : existing)
+    {
+      reference.update(u.start, u.finish, u.value, add);
+      tree.update(u.start, u.finish, u.value, add);
+      flat.update(u.start, u.finish, u.value, add);
+    }
+
+    for(const IntervalUpdate<uint64_t> &u : updates)
+      reference.update(u.start, u.finish, u.value, add);
+    tree.updateBatch(updates, add);
+    flat.updateBatch(updates, add);
+
+    check_same_intervals(reference, tree);
+    check_same_intervals(reference, flat);
+  };
+
+  SECTION("batch update with overlapping ranges")
+  {
+    Intervals<uint64_t> test;
+    test.updateBatch({{5, 10, 1}, {7, 12, 1}, {0, 3, 1}}, add);
+    check_intervals(
+        test, {{0, 1, 3}, {3, 0, 5}, {5, 1, 7}, {7, 2, 10}, {10, 1, 12}, {12, 0, UINT64_MAX}});
+  };
+};
+
+template <typename IntervalsType>
+static double time_random_updates(uint32_t count, uint64_t &numIntervals)
+{
+  IntervalsType test;
+
+  PerformanceTimer timer;
+
+  uint32_t state = 42;
+  for(uint32_t i = 0; i < count; i++)
+  {
+    uint64_t start = uint64_t(next_random(state)) * 64;
+    test.update(start, start + 16 + next_random(state) % 256, 1 + i % 3, add);
+  }
+
+  numIntervals = test.size();
+
+  return timer.GetMilliseconds();
+}
+
+template <typename IntervalsType>
+static double time_batch_updates(const rdcarray<IntervalUpdate<uint64_t>> &updates, bool batched)
+{
+  IntervalsType test;
+
+  PerformanceTimer timer;
+
+  if(batched)
+  {
+    test.updateBatch(updates, add);
+  }
+  else
+  {
+    for(const IntervalUpdate<uint64_t> &u : updates)
+      test.update(u.start, u.finish, u.value, add);
+  }
+
+  return timer.GetMilliseconds();
+}
+
+TEST_CASE("Benchmark Intervals updates", "[intervals][.][benchmark]")
+{
+  const uint32_t count = 100000;
+
+  uint64_t flatSize = 0, treeSize = 0;
+  double flatTime = time_random_updates<Intervals<uint64_t>>(count, flatSize);
+  double treeTime = time_random_updates<TreeIntervals<uint64_t>>(count, treeSize);
+
+  CHECK(flatSize == treeSize);
+
+  RDCLOG("%u random updates (%llu intervals): %.3lf ms flat, %.3lf ms tree", count, flatSize,
+         flatTime, treeTime);
+
+  rdcarray<IntervalUpdate<uint64_t>> updates = make_sorted_updates(7, count, 1ULL << 32);
+
+  RDCLOG("%u sorted updates: %.3lf ms flat, %.3lf ms tree, %.3lf/%.3lf ms flat/tree batched", count,
+         time_batch_updates<Intervals<uint64_t>>(updates, false),
+         time_batch_updates<TreeIntervals<uint64_t>>(updates, false),
+         time_batch_updates<Intervals<uint64_t>>(updates, true),
+         time_batch_updates<TreeIntervals<uint64_t>>(updates, true));
+};
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
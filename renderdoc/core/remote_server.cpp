@@ -29,6 +29,7 @@
 #include "api/replay/renderdoc_replay.h"
 #include "api/replay/version.h"
 #include "common/threading.h"
+#include "core/capture_transfer.h"
 #include "core/core.h"
 #include "core/settings.h"
 #include "os/os_specific.h"
@@ -41,6 +42,10 @@
 RDOC_CONFIG(uint32_t, RemoteServer_TimeoutMS, 5000,
             "Timeout in milliseconds for remote server operations.");
 
+RDOC_CONFIG(bool, RemoteServer_CompressCaptureTransfers, true,
+            "Compress blocks of captures that are copied to or from a remote server, where it "
+            "makes them meaningfully smaller.");
+
 RDOC_CONFIG(bool, RemoteServer_DebugLogging, false,
             "Output a verbose logging file in the system's temporary folder containing the "
             "traffic to and from the remote server.");
@@ -394,60 +399,124 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
     else if(type == eRemoteServer_CopyCaptureFromRemote)
     {
       rdcstr path;
+      rdcarray<uint64_t> checksums;
+      bool compress = false;
 
       {
         READ_DATA_SCOPE();
         SERIALISE_ELEMENT(path);
+        SERIALISE_ELEMENT(checksums);
+        SERIALISE_ELEMENT(compress);
       }
 
       reader.EndChunk();
 
+      uint64_t resumeOffset = GetCaptureTransferResumeOffset(path, checksums);
+
       {
         WRITE_DATA_SCOPE();
         SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureFromRemote);
 
-        StreamReader fileStream(FileIO::fopen(path, FileIO::ReadBinary));
-        ser.SerialiseStream(path, fileStream);
+        SendCaptureTransfer(ser, path, resumeOffset, compress, NULL);
       }
     }
     else if(type == eRemoteServer_CopyCaptureToRemote)
     {
-      rdcstr path;
-      rdcstr dummy, dummy2;
-      FileIO::GetDefaultFiles("remotecopy", path, dummy, dummy2);
+      rdcstr filename;
+      uint64_t fileSize = 0;
 
-      // remove the .rdc
-      path.erase(path.size() - 4, 4);
+      {
+        READ_DATA_SCOPE();
+        SERIALISE_ELEMENT(filename);
+        SERIALISE_ELEMENT(fileSize);
+      }
 
-      // append a process- and capture- specific suffix to avoid clashes
-      path += StringFormat::Fmt("_remotecopy_%u_%u.rdc", Process::GetCurrentPID(), captureNum);
-      captureNum++;
+      reader.EndChunk();
 
-      RDCLOG("Copying file to local path '%s'.", path.c_str());
+      // partially received files are kept under a name derived from the source file, so that if the
+      // connection drops the client can reconnect and resume where it left off.
+      rdcstr partialPath =
+          FileIO::GetTempFolderFilename() +
+          StringFormat::Fmt("/RenderDoc/remotecopy_partial_%08x_%llu.rdc",
+                            strhash(filename.c_str()), fileSize);
 
-      FileIO::CreateParentDirectory(path);
+      FileIO::CreateParentDirectory(partialPath);
 
+      // only the most recent interrupted transfer can be resumed, so remove any partial files left
+      // behind by other captures before starting this one.
       {
-        READ_DATA_SCOPE();
+        rdcstr partialDir = get_dirname(partialPath);
+        rdcstr partialName = get_basename(partialPath);
+
+        rdcarray<PathEntry> entries;
+        FileIO::GetFilesInDirectory(partialDir, entries);
+
+        for(const PathEntry &entry : entries)
+        {
+          if(entry.flags & PathProperty::Directory)
+            continue;
+
+          if(entry.filename.beginsWith("remotecopy_partial_") && entry.filename != partialName)
+            FileIO::Delete(partialDir + "/" + entry.filename);
+        }
+      }
+
+      {
+        WRITE_DATA_SCOPE();
+        SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureToRemote);
+        SERIALISE_ELEMENT_LOCAL(checksums, GetCaptureTransferChecksums(partialPath));
+      }
+
+      type = reader.ReadChunk<RemoteServerPacket>();
+
+      if(reader.IsErrored() || type != eRemoteServer_CopyCaptureToRemote)
+      {
+        RDCERR("Unexpected packet %d waiting for file", type);
+        break;
+      }
 
-        StreamWriter streamWriter(FileIO::fopen(path, FileIO::WriteBinary), Ownership::Stream);
+      bool received = false;
 
-        ser.SerialiseStream(path, streamWriter, NULL);
+      {
+        READ_DATA_SCOPE();
+        received = ReceiveCaptureTransfer(ser, partialPath, NULL);
       }
 
       reader.EndChunk();
 
       if(reader.IsErrored())
       {
-        FileIO::Delete(path);
-
-        RDCERR("Network error receiving file");
+        RDCERR("Network error receiving file, keeping partial file for resume");
         break;
       }
 
-      RDCLOG("File received.");
+      rdcstr path;
+      rdcstr dummy, dummy2;
+      FileIO::GetDefaultFiles("remotecopy", path, dummy, dummy2);
 
-      tempFiles.push_back(path);
+      // remove the .rdc
+      path.erase(path.size() - 4, 4);
+
+      // append a process- and capture- specific suffix to avoid clashes
+      path += StringFormat::Fmt("_remotecopy_%u_%u.rdc", Process::GetCurrentPID(), captureNum);
+      captureNum++;
+
+      if(received && FileIO::Move(partialPath, path, true))
+      {
+        RDCLOG("File received to local path '%s'.", path.c_str());
+      }
+      else
+      {
+        RDCERR("Failed to receive file");
+        path.clear();
+
+        // the transfer completed but the data didn't verify, or couldn't be moved into place. The
+        // partial file can't be resumed from so don't leave it behind.
+        FileIO::Delete(partialPath);
+      }
+
+      if(!path.empty())
+        tempFiles.push_back(path);
 
       {
         WRITE_DATA_SCOPE();
@@ -1544,6 +1613,10 @@ void RemoteServer::CopyCaptureFromRemote(const rdcstr &remotepath, const rdcstr
     WRITE_DATA_SCOPE();
     SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureFromRemote);
     SERIALISE_ELEMENT(remotepath);
+    // if a previous copy to this path was interrupted, the server can resume after whatever we
+    // already have
+    SERIALISE_ELEMENT_LOCAL(checksums, GetCaptureTransferChecksums(localpath));
+    SERIALISE_ELEMENT_LOCAL(compress, RemoteServer_CompressCaptureTransfers());
   }
 
   {
@@ -1552,15 +1625,16 @@ void RemoteServer::CopyCaptureFromRemote(const rdcstr &remotepath, const rdcstr
 
     if(type == eRemoteServer_CopyCaptureFromRemote)
     {
-      StreamWriter streamWriter(FileIO::fopen(localpath, FileIO::WriteBinary), Ownership::Stream);
-
-      ser.SerialiseStream(localpath, streamWriter, progress);
+      bool received = ReceiveCaptureTransfer(ser, localpath, progress);
 
       if(ser.IsErrored())
       {
         RDCERR("Network error receiving file");
         return;
       }
+
+      if(!received)
+        RDCERR("Failed to receive file");
     }
     else
     {
@@ -1573,21 +1647,47 @@ void RemoteServer::CopyCaptureFromRemote(const rdcstr &remotepath, const rdcstr
 
 rdcstr RemoteServer::CopyCaptureToRemote(const rdcstr &filename, RENDERDOC_ProgressCallback progress)
 {
-  FILE *fileHandle = FileIO::fopen(filename, FileIO::ReadBinary);
-
-  if(!fileHandle)
+  if(!FileIO::exists(filename))
   {
     RDCERR("Can't open file '%s'", filename.c_str());
     return "";
   }
 
+  {
+    WRITE_DATA_SCOPE();
+    SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureToRemote);
+    SERIALISE_ELEMENT(filename);
+    SERIALISE_ELEMENT_LOCAL(fileSize, FileIO::GetFileSize(filename));
+  }
+
+  rdcarray<uint64_t> checksums;
+
+  // the server replies with the checksums of anything it has from an interrupted copy of this file
+  {
+    READ_DATA_SCOPE();
+    RemoteServerPacket type = ser.ReadChunk<RemoteServerPacket>();
+
+    if(type == eRemoteServer_CopyCaptureToRemote)
+    {
+      SERIALISE_ELEMENT(checksums);
+    }
+    else
+    {
+      RDCERR("Unexpected response to capture copy request");
+    }
+
+    ser.EndChunk();
+
+    if(ser.IsErrored())
+      return "";
+  }
+
   {
     WRITE_DATA_SCOPE();
     SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureToRemote);
 
-    // this will take ownership of and close the file
-    StreamReader fileStream(fileHandle);
-    ser.SerialiseStream(filename, fileStream, progress);
+    SendCaptureTransfer(ser, filename, GetCaptureTransferResumeOffset(filename, checksums),
+                        RemoteServer_CompressCaptureTransfers(), progress);
   }
 
   rdcstr path;
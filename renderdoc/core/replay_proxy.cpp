@@ -24,10 +24,11 @@
  ******************************************************************************/
 
 #include "replay_proxy.h"
-#include <list>
+#include "common/timing.h"
 #include "lz4/lz4.h"
 #include "replay/dummy_driver.h"
 #include "serialise/lz4io.h"
+#include "serialise/zstdio.h"
 
 template <>
 rdcstr DoStringise(const ReplayProxyPacket &el)
@@ -103,6 +104,10 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
     STRINGISE_ENUM_NAMED(eReplayProxy_GetDescriptorAccess, "GetDescriptorAccess");
     STRINGISE_ENUM_NAMED(eReplayProxy_GetDescriptorLocations, "GetDescriptorLocations");
     STRINGISE_ENUM_NAMED(eReplayProxy_GetDescriptorStores, "GetDescriptorStores");
+
+    STRINGISE_ENUM_NAMED(eReplayProxy_RunDebug, "RunDebug");
+    STRINGISE_ENUM_NAMED(eReplayProxy_GetBatchResourceData, "GetBatchResourceData");
+    STRINGISE_ENUM_NAMED(eReplayProxy_GetResourceFingerprints, "GetResourceFingerprints");
   }
   END_ENUM_STRINGISE();
 }
@@ -1072,6 +1077,152 @@ void ReplayProxy::GetTextureData(ResourceId tex, const Subresource &sub,
   PROXY_FUNCTION(GetTextureData, tex, sub, params, data);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+void ReplayProxy::Proxied_GetBatchResourceData(ParamSerialiser &paramser, ReturnSerialiser &retser,
+                                               rdcarray<ReadbackRequest> &requests)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_GetBatchResourceData;
+  ReplayProxyPacket packet = eReplayProxy_GetBatchResourceData;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(requests);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      m_Remote->GetBatchResourceData(requests);
+  }
+
+  // the contents of every request are concatenated and sent back as one compressed block, as in
+  // GetBufferData, with the sizes alongside to split them up again.
+  rdcarray<uint64_t> sizes;
+  bytebuf packed;
+
+  if(retser.IsWriting())
+  {
+    uint64_t total = 0;
+    for(const ReadbackRequest &req : requests)
+    {
+      sizes.push_back(req.data.size());
+      total += req.data.size();
+    }
+
+    packed.reserve((size_t)total);
+    for(ReadbackRequest &req : requests)
+    {
+      packed.append(req.data);
+      req.data.clear();
+    }
+  }
+
+  // over-estimate of total uncompressed data written. Since the decompression chain needs to know
+  // the exact uncompressed size, we over-estimate (to allow for length/padding/etc) and then pad
+  // to this amount.
+  uint64_t dataSize = packed.size() + 2 * retser.GetChunkAlignment();
+
+  {
+    ReturnSerialiser &ser = retser;
+    PACKET_HEADER(packet);
+    SERIALISE_ELEMENT(packet);
+    SERIALISE_ELEMENT(sizes);
+    SERIALISE_ELEMENT(dataSize);
+  }
+
+  char empty[128] = {};
+
+  // lz4 compress
+  if(retser.IsReading())
+  {
+    ReadSerialiser ser(new StreamReader(new LZ4Decompressor(retser.GetReader(), Ownership::Nothing),
+                                        dataSize, Ownership::Stream),
+                       Ownership::Stream);
+
+    SERIALISE_ELEMENT(packed);
+
+    uint64_t offs = ser.GetReader()->GetOffset();
+    RDCASSERT(offs <= dataSize, offs, dataSize);
+    RDCASSERT(dataSize - offs < sizeof(empty), offs, dataSize);
+
+    if(offs < dataSize)
+      ser.GetReader()->Read(empty, dataSize - offs);
+  }
+  else
+  {
+    WriteSerialiser ser(new StreamWriter(new LZ4Compressor(retser.GetWriter(), Ownership::Nothing),
+                                         Ownership::Stream),
+                        Ownership::Stream);
+
+    SERIALISE_ELEMENT(packed);
+
+    uint64_t offs = ser.GetWriter()->GetOffset();
+    RDCASSERT(offs <= dataSize, offs, dataSize);
+    RDCASSERT(dataSize - offs < sizeof(empty), offs, dataSize);
+
+    if(offs < dataSize)
+      ser.GetWriter()->Write(empty, dataSize - offs);
+  }
+
+  retser.EndChunk();
+
+  CheckError(packet, expectedPacket);
+
+  if(retser.IsReading())
+  {
+    uint64_t offs = 0;
+    for(size_t i = 0; i < requests.size() && i < sizes.size(); i++)
+    {
+      if(offs + sizes[i] > packed.size())
+      {
+        RDCERR("Batch readback data is truncated");
+        break;
+      }
+
+      requests[i].data.assign(packed.data() + offs, (size_t)sizes[i]);
+      offs += sizes[i];
+    }
+  }
+}
+
+void ReplayProxy::GetBatchResourceData(rdcarray<ReadbackRequest> &requests)
+{
+  PROXY_FUNCTION(GetBatchResourceData, requests);
+}
+
+template <typename ParamSerialiser, typename ReturnSerialiser>
+rdcarray<uint64_t> ReplayProxy::Proxied_GetResourceFingerprints(ParamSerialiser &paramser,
+                                                                ReturnSerialiser &retser,
+                                                                rdcarray<ReadbackRequest> &requests)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_GetResourceFingerprints;
+  ReplayProxyPacket packet = eReplayProxy_GetResourceFingerprints;
+  rdcarray<uint64_t> ret;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(requests);
+    END_PARAMS();
+  }
+
+  // only the hashes come back, the contents never leave the remote side
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->GetResourceFingerprints(requests);
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+rdcarray<uint64_t> ReplayProxy::GetResourceFingerprints(rdcarray<ReadbackRequest> &requests)
+{
+  PROXY_FUNCTION(GetResourceFingerprints, requests);
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 void ReplayProxy::Proxied_InitPostVSBuffers(ParamSerialiser &paramser, ReturnSerialiser &retser,
                                             uint32_t eventId)
@@ -1692,6 +1843,7 @@ rdcarray<ShaderDebugState> ReplayProxy::Proxied_ContinueDebug(ParamSerialiser &p
   const ReplayProxyPacket expectedPacket = eReplayProxy_ContinueDebug;
   ReplayProxyPacket packet = eReplayProxy_ContinueDebug;
   rdcarray<ShaderDebugState> ret;
+  bytebuf encoded;
 
   {
     BEGIN_PARAMS();
@@ -1704,10 +1856,26 @@ rdcarray<ShaderDebugState> ReplayProxy::Proxied_ContinueDebug(ParamSerialiser &p
   {
     REMOTE_EXECUTION();
     if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+    {
       ret = m_Remote->ContinueDebug(debugger);
+      m_ShaderDebugEncoders[debugger].Encode(ret, encoded);
+    }
   }
 
-  SERIALISE_RETURN(ret);
+  // long traces are very large when serialised directly, so we send them delta encoded. The whole
+  // chunk is decoded back into full states as soon as it arrives, since ContinueDebug returns them
+  // by value - this only shrinks what goes over the wire, not what's held in memory here.
+  SERIALISE_RETURN(encoded);
+
+  if(retser.IsReading() && !retser.IsErrored() && !m_IsErrored)
+  {
+    if(!m_ShaderDebugDecoders[debugger].Decode(encoded, ret))
+    {
+      RDCERR("Failed to decode shader debug states");
+      m_IsErrored = true;
+      ret.clear();
+    }
+  }
 
   return ret;
 }
@@ -1717,6 +1885,43 @@ rdcarray<ShaderDebugState> ReplayProxy::ContinueDebug(ShaderDebugger *debugger)
   PROXY_FUNCTION(ContinueDebug, debugger);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+ShaderDebugState ReplayProxy::Proxied_RunDebug(ParamSerialiser &paramser, ReturnSerialiser &retser,
+                                               ShaderDebugger *debugger,
+                                               const rdcarray<uint32_t> &breakpoints,
+                                               uint32_t maxSteps)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_RunDebug;
+  ReplayProxyPacket packet = eReplayProxy_RunDebug;
+  ShaderDebugState ret;
+
+  {
+    BEGIN_PARAMS();
+    uint64_t debugger_ptr = (uint64_t)(uintptr_t)debugger;
+    SERIALISE_ELEMENT(debugger_ptr);
+    debugger = (ShaderDebugger *)(uintptr_t)debugger_ptr;
+    SERIALISE_ELEMENT(breakpoints);
+    SERIALISE_ELEMENT(maxSteps);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->RunDebug(debugger, breakpoints, maxSteps);
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+ShaderDebugState ReplayProxy::RunDebug(ShaderDebugger *debugger,
+                                       const rdcarray<uint32_t> &breakpoints, uint32_t maxSteps)
+{
+  PROXY_FUNCTION(RunDebug, debugger, breakpoints, maxSteps);
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 void ReplayProxy::Proxied_FreeDebugger(ParamSerialiser &paramser, ReturnSerialiser &retser,
                                        ShaderDebugger *debugger)
@@ -1738,6 +1943,9 @@ void ReplayProxy::Proxied_FreeDebugger(ParamSerialiser &paramser, ReturnSerialis
       m_Remote->FreeDebugger(debugger);
   }
 
+  m_ShaderDebugEncoders.erase(debugger);
+  m_ShaderDebugDecoders.erase(debugger);
+
   CheckError(packet, expectedPacket);
 }
 
@@ -2104,19 +2312,9 @@ void ReplayProxy::FetchStructuredFile()
   PROXY_FUNCTION(FetchStructuredFile);
 }
 
-struct DeltaSection
-{
-  uint64_t offs = 0;
-  bytebuf contents;
-
-  void swap(DeltaSection &o)
-  {
-    std::swap(offs, o.offs);
-    contents.swap(o.contents);
-  }
-};
-
 DECLARE_REFLECTION_STRUCT(DeltaSection);
+DECLARE_REFLECTION_STRUCT(DeltaChunkCopy);
+DECLARE_REFLECTION_STRUCT(ContentDelta);
 
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, DeltaSection &el)
@@ -2125,10 +2323,65 @@ void DoSerialise(SerialiserType &ser, DeltaSection &el)
   SERIALISE_MEMBER(contents);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, DeltaChunkCopy &el)
+{
+  SERIALISE_MEMBER(offs);
+  SERIALISE_MEMBER(hash);
+  SERIALISE_MEMBER(length);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, ContentDelta &el)
+{
+  SERIALISE_MEMBER(size);
+  SERIALISE_MEMBER(copies);
+  SERIALISE_MEMBER(sections);
+}
+
+int ReplayProxy::GetDeltaCompressionLevel()
+{
+  // pick a zstd level so that compression roughly keeps pace with the link. On a fast link (e.g.
+  // loopback or a wired LAN) time spent compressing harder costs more than the bytes it saves, and
+  // on a slow link (wifi, adb forwarding) it's the other way around. The thresholds are approximate
+  // single-threaded compression speeds for each level.
+  const double MB = 1024.0 * 1024.0;
+
+  // until we've measured anything, use zstd's default
+  if(m_DeltaTransferBandwidth <= 0.0)
+    return 3;
+
+  if(m_DeltaTransferBandwidth > 400.0 * MB)
+    return 1;
+  if(m_DeltaTransferBandwidth > 150.0 * MB)
+    return 3;
+  if(m_DeltaTransferBandwidth > 60.0 * MB)
+    return 5;
+  if(m_DeltaTransferBandwidth > 20.0 * MB)
+    return 7;
+  if(m_DeltaTransferBandwidth > 5.0 * MB)
+    return 9;
+  return 12;
+}
+
+void ReplayProxy::UpdateDeltaTransferBandwidth(uint64_t bytes, double milliseconds)
+{
+  // small writes are absorbed by socket buffering and don't tell us anything about the link
+  if(bytes < 256 * 1024 || milliseconds <= 0.0)
+    return;
+
+  double bandwidth = double(bytes) / (milliseconds / 1000.0);
+
+  if(m_DeltaTransferBandwidth <= 0.0)
+    m_DeltaTransferBandwidth = bandwidth;
+  else
+    m_DeltaTransferBandwidth = m_DeltaTransferBandwidth * 0.75 + bandwidth * 0.25;
+}
+
 template <typename SerialiserType>
 void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &referenceData, bytebuf &newData)
 {
-  // lz4 compress
+  // zstd compress
   if(xferser.IsReading())
   {
     uint64_t uncompSize = 0;
@@ -2140,229 +2393,95 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
       RDCDEBUG("Unchanged");
       return;
     }
-    else
-    {
-      rdcarray<DeltaSection> deltas;
 
-      {
-        ReadSerialiser ser(
-            new StreamReader(new LZ4Decompressor(xferser.GetReader(), Ownership::Nothing),
-                             uncompSize, Ownership::Stream),
-            Ownership::Stream);
-
-        SERIALISE_ELEMENT(deltas);
+    ContentDelta delta;
 
-        // add any necessary padding.
-        uint64_t offs = ser.GetReader()->GetOffset();
-        RDCASSERT(offs <= uncompSize, offs, uncompSize);
+    {
+      ReadSerialiser ser(
+          new StreamReader(new ZSTDDecompressor(xferser.GetReader(), Ownership::Nothing),
+                           uncompSize, Ownership::Stream),
+          Ownership::Stream);
 
-        if(offs < uncompSize)
-        {
-          if(uncompSize - offs > 128)
-          {
-            RDCERR("Unexpected amount of padding: %llu", uncompSize - offs);
-            m_IsErrored = true;
-          }
-          ser.GetReader()->Read(NULL, uncompSize - offs);
-        }
-      }
+      SERIALISE_ELEMENT(delta);
 
-      if(deltas.empty())
-      {
-        RDCERR("Unexpected empty delta list");
-        m_IsErrored = true;
-      }
-      else if(referenceData.empty())
-      {
-        // if we don't have reference data we blat the whole contents.
-        // in this case we only expect one delta with the whole range
-        if(deltas.size() != 1)
-          RDCERR("Got more than one delta with no reference data - taking first delta.");
+      // add any necessary padding.
+      uint64_t offs = ser.GetReader()->GetOffset();
+      RDCASSERT(offs <= uncompSize, offs, uncompSize);
 
-        referenceData = deltas.front().contents;
-        RDCDEBUG("Creating new reference data, %llu bytes", (uint64_t)referenceData.size());
-      }
-      else
+      if(offs < uncompSize)
       {
-        uint64_t deltaBytes = 0;
-
-        // apply deltas to refData
-        for(const DeltaSection &delta : deltas)
+        if(uncompSize - offs > 128)
         {
-          if(delta.offs + delta.contents.size() > referenceData.size())
-          {
-            RDCERR("{%llu, %llu} larger than reference data (%llu bytes) - expanding to fit.",
-                   delta.offs, (uint64_t)delta.contents.size(), (uint64_t)referenceData.size());
-
-            referenceData.resize(size_t(delta.offs + delta.contents.size()));
-          }
-
-          byte *dst = referenceData.data() + (ptrdiff_t)delta.offs;
-          const byte *src = delta.contents.data();
-
-          memcpy(dst, src, delta.contents.size());
-
-          deltaBytes += (uint64_t)delta.contents.size();
+          RDCERR("Unexpected amount of padding: %llu", uncompSize - offs);
+          m_IsErrored = true;
         }
-
-        RDCDEBUG("Applied %u deltas data, %llu total delta bytes to %llu resource size",
-                 (uint32_t)deltas.size(), deltaBytes, (uint64_t)referenceData.size());
+        ser.GetReader()->Read(NULL, uncompSize - offs);
       }
     }
-  }
-  else
-  {
-    uint64_t uncompSize = 0;
 
-    // we use a list so that we don't have to reserve and pushing new sections will never cause
-    // previous ones to be reallocated and move around lots of data.
-    std::list<DeltaSection> deltasList;
+    if(m_IsErrored)
+      return;
 
-    if(referenceData.empty())
+    bytebuf result;
+    if(!ApplyContentDelta(m_ProxyChunkCache, referenceData, delta, result))
     {
-      // no previous reference data, need to transfer the whole object.
-      deltasList.resize(1);
-      deltasList.back().contents = newData;
+      RDCERR("Failed to apply delta, chunk caches are out of sync");
+      m_IsErrored = true;
+      return;
     }
-    else
-    {
-      if(referenceData.size() != newData.size())
-      {
-        RDCERR("Reference data existed at %llu bytes, but new data is now %llu bytes",
-               referenceData.size(), newData.size());
 
-        // re-transfer the whole block, something went seriously wrong if the resource changed size.
-        deltasList.resize(1);
-        deltasList.back().contents = newData;
-      }
-      else
-      {
-        // do actual diff.
-        const byte *srcBegin = newData.data();
-        const byte *src = srcBegin;
-        const byte *dst = referenceData.data();
-        size_t bytesRemain = newData.size();
-
-        // we only care about large-ish chunks at a time. This prevents us generating lots of tiny
-        // deltas where we could batch changes together. This is tuned to not be too large (and
-        // thus causing us to miss too many sections we could skip) and not too small (causing us
-        // to devolve into lots of byte-wise deltas). The current value as of this comment of 128
-        // is definitely on the small end of the range, but consider e.g. an android image of
-        // 1440x2560 and a pixel-wide line that goes vertically from top to bottom. Reading
-        // horizontally that will mean 2560 different diffs, and only actually one pixel changed.
-        // The larger this value gets, the more redundant data we'll send along with.
-        const size_t chunkSize = 128;
-
-        // we use a simple state machine. Start in state 1
-        //
-        // State 1: No active delta. Look at the current chunk, if there's no difference move to the
-        //          next chunk and stay in this state. If there is a difference, push a delta onto
-        //          the list at the current offset. Copy the current chunk into the contents of the
-        //          delta. Move to state 2.
-        // State 2. Active delta. Look at the current chunk, if there is a difference then append
-        //          the current chunk to the last delta's contents, move to the next chunk, and stay
-        //          in this state. If there isn't a difference, move back to state 1 (the delta is
-        //          already 'finished' so we have no need to do anything more on it).
-        //
-        // At any point we can end the loop, both states are 'complete' at all points.
-
-        enum DeltaState
-        {
-          None,
-          Active
-        };
-        DeltaState state = DeltaState::None;
+    RDCDEBUG("Applied %u chunk copies and %u sections, %llu payload bytes to %llu resource size",
+             (uint32_t)delta.copies.size(), (uint32_t)delta.sections.size(),
+             GetContentDeltaPayloadSize(delta), delta.size);
 
-        // loop over whole chunks
-        while(bytesRemain > chunkSize)
-        {
-          // check if there's a difference in this chunk.
-          bool chunkDiff = memcmp(src, dst, chunkSize) != 0;
-
-          // if we're in state 1
-          if(state == DeltaState::None)
-          {
-            // if there's a difference, append a new delta with the current offset and chunk
-            // contents and move to state 2
-            if(chunkDiff)
-            {
-              deltasList.push_back(DeltaSection());
-              deltasList.back().offs = src - srcBegin;
-              deltasList.back().contents.append(src, chunkSize);
-
-              state = DeltaState::Active;
-            }
-          }
-          // if we're in state 2
-          else if(state == DeltaState::Active)
-          {
-            // continue to append to the delta if there's another difference in this chunk.
-            if(chunkDiff)
-            {
-              deltasList.back().contents.append(src, chunkSize);
-            }
-            else
-            {
-              state = DeltaState::None;
-            }
-          }
-
-          // move to the next chunk
-          bytesRemain -= chunkSize;
-          src += chunkSize;
-          dst += chunkSize;
-        }
+    // update the chunk cache with the new contents in exactly the same way as the other side.
+    m_ProxyChunkCache.RetireBlob(referenceData);
+    referenceData.swap(result);
 
-        // if there are still some bytes remaining at the end of the image, smaller than the chunk
-        // size, just diff directly and send if needed. We could combine this with the last delta if
-        // we ended in the active state.
-        if(bytesRemain > 0 && memcmp(src, dst, bytesRemain) != 0)
-        {
-          deltasList.push_back(DeltaSection());
-          deltasList.back().offs = src - srcBegin;
-          deltasList.back().contents.append(src, bytesRemain);
-        }
-      }
-    }
+    rdcarray<ContentChunk> chunks;
+    ChunkContents(referenceData.data(), referenceData.size(), chunks);
+    m_ProxyChunkCache.AddBlob(referenceData, chunks);
+  }
+  else
+  {
+    uint64_t uncompSize = 0;
 
-    // serialise as an array, move the storage from the list into here
-    rdcarray<DeltaSection> deltas;
-    deltas.resize(deltasList.size());
+    rdcarray<ContentChunk> chunks;
+    ChunkContents(newData.data(), newData.size(), chunks);
 
-    {
-      // swap between the list and array, so all the buffers just move storage
-      size_t i = 0;
-      for(auto it = deltasList.begin(); it != deltasList.end(); it++)
-      {
-        deltas[i].swap(*it);
-        i++;
-      }
-    }
+    ContentDelta delta;
+    CalculateContentDelta(m_ProxyChunkCache, referenceData, newData, chunks, delta);
 
     // fast path - no changes.
-    if(deltas.empty())
+    if(delta.empty() && referenceData.size() == newData.size())
     {
-      uncompSize = 0;
+      xferser.Serialise("uncompSize"_lit, uncompSize);
+      return;
     }
-    else
+
     {
       // serialise to an invalid writer, to get the size of the data that will be written.
       WriteSerialiser ser(new StreamWriter(StreamWriter::InvalidStream), Ownership::Stream);
 
-      SERIALISE_ELEMENT(deltas);
+      SERIALISE_ELEMENT(delta);
 
       uncompSize = ser.GetWriter()->GetOffset() + ser.GetChunkAlignment();
     }
 
     xferser.Serialise("uncompSize"_lit, uncompSize);
 
-    if(uncompSize > 0)
+    // compress to memory first, so that we can time the transfer by itself and estimate the link
+    // bandwidth for picking the compression level next time.
+    StreamWriter compressed(StreamWriter::DefaultScratchSize);
+
     {
-      WriteSerialiser ser(new StreamWriter(new LZ4Compressor(xferser.GetWriter(), Ownership::Nothing),
-                                           Ownership::Stream),
-                          Ownership::Stream);
+      WriteSerialiser ser(
+          new StreamWriter(new ZSTDCompressor(&compressed, Ownership::Nothing,
+                                              GetDeltaCompressionLevel()),
+                           Ownership::Stream),
+          Ownership::Stream);
 
-      SERIALISE_ELEMENT(deltas);
+      SERIALISE_ELEMENT(delta);
 
       char empty[128] = {};
 
@@ -2375,9 +2494,22 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
         ser.GetWriter()->Write(empty, uncompSize - offs);
     }
 
+    PerformanceTimer timer;
+
+    xferser.GetWriter()->Write(compressed.GetData(), compressed.GetOffset());
+    xferser.GetWriter()->Flush();
+
+    UpdateDeltaTransferBandwidth(compressed.GetOffset(), timer.GetMilliseconds());
+
+    RDCDEBUG("Sent %u chunk copies and %u sections, %llu payload bytes as %llu compressed",
+             (uint32_t)delta.copies.size(), (uint32_t)delta.sections.size(),
+             GetContentDeltaPayloadSize(delta), compressed.GetOffset());
+
     // This is the proxy side, so we have the complete newest contents in data. Swap the new data
-    // into refData for next time.
+    // into refData for next time, retiring the old contents into the chunk cache's history.
+    m_ProxyChunkCache.RetireBlob(referenceData);
     referenceData.swap(newData);
+    m_ProxyChunkCache.AddBlob(referenceData, chunks);
   }
 }
 
@@ -3125,6 +3257,19 @@ bool ReplayProxy::Tick(int type)
       break;
     }
     case eReplayProxy_ContinueDebug: ContinueDebug(NULL); break;
+    case eReplayProxy_RunDebug: RunDebug(NULL, {}, 0); break;
+    case eReplayProxy_GetBatchResourceData:
+    {
+      rdcarray<ReadbackRequest> dummy;
+      GetBatchResourceData(dummy);
+      break;
+    }
+    case eReplayProxy_GetResourceFingerprints:
+    {
+      rdcarray<ReadbackRequest> dummy;
+      GetResourceFingerprints(dummy);
+      break;
+    }
     case eReplayProxy_FreeDebugger: FreeDebugger(NULL); break;
     case eReplayProxy_RenderOverlay:
       RenderOverlay(ResourceId(), FloatVector(), DebugOverlay::NoOverlay, 0, rdcarray<uint32_t>());
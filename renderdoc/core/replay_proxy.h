@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include "core/content_delta.h"
+#include "core/shader_debug_delta.h"
 #include "os/os_specific.h"
 #include "replay/replay_driver.h"
 #include "serialise/serialiser.h"
@@ -111,6 +113,12 @@ enum ReplayProxyPacket
   eReplayProxy_GetDescriptorAccess,
   eReplayProxy_GetDescriptorLocations,
   eReplayProxy_GetDescriptorStores,
+
+  eReplayProxy_RunDebug,
+
+  eReplayProxy_GetBatchResourceData,
+
+  eReplayProxy_GetResourceFingerprints,
 };
 
 DECLARE_REFLECTION_ENUM(ReplayProxyPacket);
@@ -516,6 +524,9 @@ public:
                              bytebuf &retData);
   IMPLEMENT_FUNCTION_PROXIED(void, GetTextureData, ResourceId tex, const Subresource &sub,
                              const GetTextureDataParams &params, bytebuf &data);
+  IMPLEMENT_FUNCTION_PROXIED(void, GetBatchResourceData, rdcarray<ReadbackRequest> &requests);
+  IMPLEMENT_FUNCTION_PROXIED(rdcarray<uint64_t>, GetResourceFingerprints,
+                             rdcarray<ReadbackRequest> &requests);
 
   IMPLEMENT_FUNCTION_PROXIED(void, InitPostVSBuffers, uint32_t eventId);
   IMPLEMENT_FUNCTION_PROXIED(void, InitPostVSBuffers, const rdcarray<uint32_t> &passEvents);
@@ -553,6 +564,8 @@ public:
                              const rdcfixedarray<uint32_t, 3> &groupid,
                              const rdcfixedarray<uint32_t, 3> &threadid);
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<ShaderDebugState>, ContinueDebug, ShaderDebugger *debugger);
+  IMPLEMENT_FUNCTION_PROXIED(ShaderDebugState, RunDebug, ShaderDebugger *debugger,
+                             const rdcarray<uint32_t> &breakpoints, uint32_t maxSteps);
   IMPLEMENT_FUNCTION_PROXIED(void, FreeDebugger, ShaderDebugger *debugger);
 
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<ShaderEncoding>, GetTargetShaderEncodings);
@@ -574,6 +587,8 @@ public:
   // available on both sides of the communication.
   template <typename SerialiserType>
   void DeltaTransferBytes(SerialiserType &xferser, bytebuf &referenceData, bytebuf &newData);
+  int GetDeltaCompressionLevel();
+  void UpdateDeltaTransferBandwidth(uint64_t bytes, double milliseconds);
 
   void FileChanged() {}
   // will never be used
@@ -651,6 +666,16 @@ private:
   std::map<TextureCacheEntry, bytebuf> m_ProxyTextureData;
   std::map<ResourceId, bytebuf> m_ProxyBufferData;
 
+  // this also exists on both sides and must be kept in sync. It indexes content-defined chunks of
+  // the resource data above, as well as a bounded history of its previous contents, so that deltas
+  // can refer to data that moved or that was seen at a previous event. The history budget must be
+  // the same on both sides.
+  ContentChunkCache m_ProxyChunkCache{64 * 1024 * 1024};
+
+  // measured bandwidth in bytes per second of delta transfers, only used on the sending side to
+  // pick a compression level. 0 until we've measured a large enough transfer.
+  double m_DeltaTransferBandwidth = 0.0;
+
   // this lists any textures which are only created locally (e.g. custom visualisation shaders) and
   // should not be treated as proxied.
   std::set<ResourceId> m_LocalTextures;
@@ -679,6 +704,11 @@ private:
 
   std::map<ShaderReflKey, ShaderReflection *> m_ShaderReflectionCache;
 
+  // shader debug states are sent compactly, relative to what was previously sent for the same
+  // debugger. Only one of these is used depending on which side we're on
+  std::map<ShaderDebugger *, ShaderDebugDeltaEncoder> m_ShaderDebugEncoders;
+  std::map<ShaderDebugger *, ShaderDebugDeltaDecoder> m_ShaderDebugDecoders;
+
   // reader from the other side of the host <-> remote connection
   ReadSerialiser &m_Reader;
   // writer to the other side of the host <-> remote connection
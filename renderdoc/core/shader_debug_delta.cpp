@@ -0,0 +1,503 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "core/shader_debug_delta.h"
+#include "common/common.h"
+
+// which parts of a variable differ from the base it's encoded against
+enum VariableDeltaMask
+{
+  VariableDelta_Name = 0x1,
+  VariableDelta_Header = 0x2,
+  VariableDelta_Value = 0x4,
+  VariableDelta_Members = 0x8,
+};
+
+// how the before value of a change is encoded
+enum BeforeMode
+{
+  Before_Empty = 0,
+  // the last value we saw for the variable, only the name is sent
+  Before_Current = 1,
+  Before_Explicit = 2,
+};
+
+// how the after value of a change is encoded
+enum AfterMode
+{
+  After_Empty = 0,
+  After_DeltaFromBefore = 1,
+  // a delta from the last value we saw for the variable with the same name. This happens when a
+  // variable comes back into scope e.g. on the next iteration of a loop
+  After_DeltaFromCurrent = 2,
+  After_Explicit = 3,
+};
+
+// the value is compared and sent as 32-bit words, since most variables are 32-bit and only use the
+// first half of the storage.
+static const uint32_t ValueWords = sizeof(ShaderValue) / sizeof(uint32_t);
+
+RDCCOMPILE_ASSERT(ValueWords <= 32, "Value mask must fit in 32 bits");
+
+// guard against malformed data recursing forever
+static const int MaxVariableDepth = 64;
+
+static const ShaderVariable &EmptyVariable()
+{
+  static const ShaderVariable empty;
+  return empty;
+}
+
+static void WriteVarint(bytebuf &out, uint64_t val)
+{
+  while(val >= 0x80)
+  {
+    out.push_back(byte(val & 0x7f) | 0x80);
+    val >>= 7;
+  }
+  out.push_back(byte(val));
+}
+
+static uint64_t ZigZag(int64_t val)
+{
+  return (uint64_t(val) << 1) ^ uint64_t(val >> 63);
+}
+
+static int64_t UnZigZag(uint64_t val)
+{
+  return int64_t(val >> 1) ^ -int64_t(val & 1);
+}
+
+struct ShaderDebugDeltaDecoder::Reader
+{
+  const byte *cur;
+  const byte *end;
+  bool ok = true;
+
+  uint64_t ReadVarint()
+  {
+    uint64_t ret = 0;
+    for(uint32_t shift = 0; shift < 64; shift += 7)
+    {
+      if(cur >= end)
+        break;
+
+      byte b = *(cur++);
+      ret |= uint64_t(b & 0x7f) << shift;
+
+      if((b & 0x80) == 0)
+        return ret;
+    }
+
+    ok = false;
+    return 0;
+  }
+
+  const byte *ReadBytes(size_t size)
+  {
+    if(size_t(end - cur) < size)
+    {
+      ok = false;
+      return NULL;
+    }
+
+    const byte *ret = cur;
+    cur += size;
+    return ret;
+  }
+};
+
+void ShaderDebugDeltaEncoder::WriteName(bytebuf &out, const rdcstr &name)
+{
+  auto it = m_Context.nameLookup.find(name);
+  if(it != m_Context.nameLookup.end())
+  {
+    WriteVarint(out, it->second + 1);
+    return;
+  }
+
+  // a new name, sent inline and added to the table on both sides
+  WriteVarint(out, 0);
+  WriteVarint(out, name.size());
+  out.append((const byte *)name.c_str(), name.size());
+
+  m_Context.nameLookup[name] = (uint32_t)m_Context.names.size();
+  m_Context.names.push_back(name);
+}
+
+bool ShaderDebugDeltaDecoder::ReadName(Reader &reader, rdcstr &name)
+{
+  uint64_t idx = reader.ReadVarint();
+
+  if(idx > 0)
+  {
+    if(idx > m_Context.names.size())
+      return false;
+
+    name = m_Context.names[size_t(idx - 1)];
+    return reader.ok;
+  }
+
+  uint64_t len = reader.ReadVarint();
+  const byte *chars = reader.ReadBytes((size_t)len);
+
+  if(!reader.ok)
+    return false;
+
+  name.assign((const char *)chars, (size_t)len);
+  m_Context.names.push_back(name);
+
+  return true;
+}
+
+void ShaderDebugDeltaEncoder::WriteVariable(bytebuf &out, const ShaderVariable &var,
+                                            const ShaderVariable &base)
+{
+  uint32_t words[ValueWords], baseWords[ValueWords];
+  memcpy(words, &var.value, sizeof(words));
+  memcpy(baseWords, &base.value, sizeof(baseWords));
+
+  uint32_t valueMask = 0;
+  for(uint32_t i = 0; i < ValueWords; i++)
+    if(words[i] != baseWords[i])
+      valueMask |= 1U << i;
+
+  uint32_t mask = 0;
+  if(var.name != base.name)
+    mask |= VariableDelta_Name;
+  if(var.rows != base.rows || var.columns != base.columns || var.type != base.type ||
+     var.flags != base.flags)
+    mask |= VariableDelta_Header;
+  if(valueMask)
+    mask |= VariableDelta_Value;
+  if(!(var.members == base.members))
+    mask |= VariableDelta_Members;
+
+  WriteVarint(out, mask);
+
+  if(mask & VariableDelta_Name)
+    WriteName(out, var.name);
+
+  if(mask & VariableDelta_Header)
+  {
+    WriteVarint(out, var.rows);
+    WriteVarint(out, var.columns);
+    WriteVarint(out, (uint64_t)var.type);
+    WriteVarint(out, (uint64_t)var.flags);
+  }
+
+  if(mask & VariableDelta_Value)
+  {
+    WriteVarint(out, valueMask);
+    for(uint32_t i = 0; i < ValueWords; i++)
+      if(valueMask & (1U << i))
+        out.append((const byte *)&words[i], sizeof(uint32_t));
+  }
+
+  if(mask & VariableDelta_Members)
+  {
+    WriteVarint(out, var.members.size());
+
+    size_t numChanged = 0;
+    for(size_t i = 0; i < var.members.size(); i++)
+      if(i >= base.members.size() || !(var.members[i] == base.members[i]))
+        numChanged++;
+
+    WriteVarint(out, numChanged);
+
+    // members are encoded against the member at the same index in the base, or an empty variable
+    // for any new members
+    for(size_t i = 0; i < var.members.size(); i++)
+    {
+      if(i < base.members.size())
+      {
+        if(var.members[i] == base.members[i])
+          continue;
+
+        WriteVarint(out, i);
+        WriteVariable(out, var.members[i], base.members[i]);
+      }
+      else
+      {
+        WriteVarint(out, i);
+        WriteVariable(out, var.members[i], EmptyVariable());
+      }
+    }
+  }
+}
+
+bool ShaderDebugDeltaDecoder::ReadVariable(Reader &reader, ShaderVariable &var, int depth)
+{
+  if(depth > MaxVariableDepth)
+    return false;
+
+  uint64_t mask = reader.ReadVarint();
+
+  if(mask & VariableDelta_Name)
+  {
+    if(!ReadName(reader, var.name))
+      return false;
+  }
+
+  if(mask & VariableDelta_Header)
+  {
+    var.rows = (uint8_t)reader.ReadVarint();
+    var.columns = (uint8_t)reader.ReadVarint();
+    var.type = (VarType)reader.ReadVarint();
+    var.flags = (ShaderVariableFlags)reader.ReadVarint();
+  }
+
+  if(mask & VariableDelta_Value)
+  {
+    uint32_t words[ValueWords];
+    memcpy(words, &var.value, sizeof(words));
+
+    uint64_t valueMask = reader.ReadVarint();
+    for(uint32_t i = 0; i < ValueWords; i++)
+    {
+      if(valueMask & (1ULL << i))
+      {
+        const byte *w = reader.ReadBytes(sizeof(uint32_t));
+        if(!w)
+          return false;
+        memcpy(&words[i], w, sizeof(uint32_t));
+      }
+    }
+
+    memcpy(&var.value, words, sizeof(words));
+  }
+
+  if(mask & VariableDelta_Members)
+  {
+    uint64_t count = reader.ReadVarint();
+    uint64_t numChanged = reader.ReadVarint();
+
+    if(!reader.ok || numChanged > count || count > uint64_t(reader.end - reader.cur) + 1024 * 1024)
+      return false;
+
+    var.members.resize((size_t)count);
+
+    for(uint64_t i = 0; i < numChanged; i++)
+    {
+      uint64_t idx = reader.ReadVarint();
+      if(idx >= count || !ReadVariable(reader, var.members[(size_t)idx], depth + 1))
+        return false;
+    }
+  }
+
+  return reader.ok;
+}
+
+void ShaderDebugDeltaEncoder::Encode(const rdcarray<ShaderDebugState> &states, bytebuf &out)
+{
+  out.clear();
+
+  WriteVarint(out, states.size());
+
+  for(const ShaderDebugState &state : states)
+  {
+    // steps are almost always sequential, and instructions close to the previous one
+    WriteVarint(out, ZigZag(int64_t(state.nextInstruction) - int64_t(m_Context.nextInstruction)));
+    WriteVarint(out, ZigZag(int64_t(state.stepIndex) - int64_t(m_Context.stepIndex + 1)));
+    WriteVarint(out, (uint64_t)state.flags);
+
+    m_Context.nextInstruction = state.nextInstruction;
+    m_Context.stepIndex = state.stepIndex;
+
+    // the callstack only changes on function calls and returns
+    if(state.callstack == m_Context.callstack)
+    {
+      WriteVarint(out, 0);
+    }
+    else
+    {
+      WriteVarint(out, state.callstack.size() + 1);
+      for(const rdcstr &func : state.callstack)
+        WriteName(out, func);
+      m_Context.callstack = state.callstack;
+    }
+
+    WriteVarint(out, state.changes.size());
+
+    for(const ShaderVariableChange &change : state.changes)
+    {
+      uint32_t before = Before_Explicit, after = After_Explicit;
+
+      if(change.before == EmptyVariable())
+      {
+        before = Before_Empty;
+      }
+      else if(!change.before.name.empty())
+      {
+        auto it = m_Context.current.find(change.before.name);
+        if(it != m_Context.current.end() && it->second == change.before)
+          before = Before_Current;
+      }
+
+      const ShaderVariable *afterBase = &EmptyVariable();
+
+      if(change.after == EmptyVariable())
+      {
+        after = After_Empty;
+      }
+      else if(before != Before_Empty)
+      {
+        after = After_DeltaFromBefore;
+        afterBase = &change.before;
+      }
+      else if(!change.after.name.empty())
+      {
+        auto it = m_Context.current.find(change.after.name);
+        if(it != m_Context.current.end())
+        {
+          after = After_DeltaFromCurrent;
+          afterBase = &it->second;
+        }
+      }
+
+      out.push_back(byte(before | (after << 2)));
+
+      if(before == Before_Current)
+        WriteName(out, change.before.name);
+      else if(before == Before_Explicit)
+        WriteVariable(out, change.before, EmptyVariable());
+
+      if(after == After_DeltaFromCurrent)
+        WriteName(out, change.after.name);
+
+      if(after != After_Empty)
+        WriteVariable(out, change.after, *afterBase);
+
+      if(after != After_Empty && !change.after.name.empty())
+        m_Context.current[change.after.name] = change.after;
+    }
+  }
+}
+
+bool ShaderDebugDeltaDecoder::Decode(const bytebuf &in, rdcarray<ShaderDebugState> &states)
+{
+  Reader reader;
+  reader.cur = in.data();
+  reader.end = in.data() + in.size();
+
+  states.clear();
+
+  uint64_t numStates = reader.ReadVarint();
+
+  // every state takes at least a few bytes, so this catches nonsense counts before we allocate
+  if(!reader.ok || numStates > in.size())
+    return false;
+
+  states.resize((size_t)numStates);
+
+  for(ShaderDebugState &state : states)
+  {
+    m_Context.nextInstruction = uint32_t(m_Context.nextInstruction + UnZigZag(reader.ReadVarint()));
+    m_Context.stepIndex = uint32_t(m_Context.stepIndex + 1 + UnZigZag(reader.ReadVarint()));
+
+    state.nextInstruction = m_Context.nextInstruction;
+    state.stepIndex = m_Context.stepIndex;
+    state.flags = (ShaderEvents)reader.ReadVarint();
+
+    uint64_t callstackSize = reader.ReadVarint();
+    if(callstackSize > 0)
+    {
+      if(callstackSize - 1 > uint64_t(reader.end - reader.cur))
+        return false;
+
+      m_Context.callstack.resize(size_t(callstackSize - 1));
+      for(rdcstr &func : m_Context.callstack)
+        if(!ReadName(reader, func))
+          return false;
+    }
+
+    state.callstack = m_Context.callstack;
+
+    uint64_t numChanges = reader.ReadVarint();
+    if(!reader.ok || numChanges > uint64_t(reader.end - reader.cur))
+      return false;
+
+    state.changes.resize((size_t)numChanges);
+
+    for(ShaderVariableChange &change : state.changes)
+    {
+      const byte *modes = reader.ReadBytes(1);
+      if(!modes)
+        return false;
+
+      uint32_t before = (*modes) & 0x3;
+      uint32_t after = (*modes) >> 2;
+
+      if(before == Before_Current)
+      {
+        rdcstr name;
+        if(!ReadName(reader, name))
+          return false;
+
+        auto it = m_Context.current.find(name);
+        if(it == m_Context.current.end())
+          return false;
+
+        change.before = it->second;
+      }
+      else if(before == Before_Explicit)
+      {
+        if(!ReadVariable(reader, change.before, 0))
+          return false;
+      }
+      else if(before != Before_Empty)
+      {
+        return false;
+      }
+
+      if(after == After_DeltaFromBefore)
+      {
+        change.after = change.before;
+      }
+      else if(after == After_DeltaFromCurrent)
+      {
+        rdcstr name;
+        if(!ReadName(reader, name))
+          return false;
+
+        auto it = m_Context.current.find(name);
+        if(it == m_Context.current.end())
+          return false;
+
+        change.after = it->second;
+      }
+
+      if(after != After_Empty)
+      {
+        if(!ReadVariable(reader, change.after, 0))
+          return false;
+
+        if(!change.after.name.empty())
+          m_Context.current[change.after.name] = change.after;
+      }
+    }
+  }
+
+  return reader.ok && reader.cur == reader.end;
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <map>
+#include "api/replay/rdcarray.h"
+#include "api/replay/shader_types.h"
+
+// A compact encoding of shader debug states, used to send traces over remote replay.
+//
+// Each ShaderVariableChange normally carries two complete variables, but in practice the 'before'
+// is the value we last saw for that variable and the 'after' only differs from it in a component
+// or two. Both sides of a transfer track the last value of every variable by name, so a change is
+// encoded as a reference to that value plus the components and members (by index) that differ.
+// Names and callstack entries are interned so each string is only sent once.
+//
+// The context persists across calls, so a trace can be streamed a chunk at a time with each chunk
+// encoded relative to everything sent before it. The encoder and decoder must see the same chunks
+// in the same order.
+//
+// Decoding produces complete ShaderDebugStates for the whole chunk in one pass. Every later state
+// depends on the context built up by the ones before it, so there is no random access into an
+// encoded chunk.
+struct ShaderDebugDeltaContext
+{
+  rdcarray<rdcstr> names;
+  std::map<rdcstr, uint32_t> nameLookup;
+
+  // the last value seen for each variable, by name
+  std::map<rdcstr, ShaderVariable> current;
+
+  rdcarray<rdcstr> callstack;
+  uint32_t nextInstruction = 0;
+  uint32_t stepIndex = ~0U;
+};
+
+class ShaderDebugDeltaEncoder
+{
+public:
+  void Encode(const rdcarray<ShaderDebugState> &states, bytebuf &out);
+
+private:
+  void WriteName(bytebuf &out, const rdcstr &name);
+  void WriteVariable(bytebuf &out, const ShaderVariable &var, const ShaderVariable &base);
+
+  ShaderDebugDeltaContext m_Context;
+};
+
+class ShaderDebugDeltaDecoder
+{
+public:
+  // returns false if the data is malformed, in which case the context is no longer usable
+  bool Decode(const bytebuf &in, rdcarray<ShaderDebugState> &states);
+
+private:
+  struct Reader;
+
+  bool ReadName(Reader &reader, rdcstr &name);
+  bool ReadVariable(Reader &reader, ShaderVariable &var, int depth);
+
+  ShaderDebugDeltaContext m_Context;
+};
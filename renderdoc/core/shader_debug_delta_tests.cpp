@@ -0,0 +1,226 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/globalconfig.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "serialise/serialiser.h"
+#include "shader_debug_delta.h"
+
+#include "catch/catch.hpp"
+
+// generate something that looks like a trace of a loop accumulating into a struct, calling a
+// function each iteration with locals coming in and out of scope.
+static rdcarray<ShaderDebugState> MakeLoopTrace(uint32_t iterations)
+{
+  rdcarray<ShaderDebugState> ret;
+
+  ShaderVariable accum;
+  accum.name = "_accum";
+  accum.type = VarType::Float;
+  accum.rows = 1;
+  accum.columns = 1;
+  accum.members.resize(3);
+  for(uint32_t m = 0; m < 3; m++)
+  {
+    rdcstr name = "_accum.m";
+    name.push_back(char('0' + m));
+    accum.members[m] = ShaderVariable(name, 0.0f, 0.0f, 0.0f, 0.0f);
+  }
+
+  ShaderVariable counter("_i", 0U, 0U, 0U, 0U);
+
+  uint32_t step = 0;
+
+  ShaderDebugState initial;
+  initial.stepIndex = step++;
+  initial.nextInstruction = 10;
+  initial.callstack = {"main"};
+  initial.changes.push_back({ShaderVariable(), accum});
+  initial.changes.push_back({ShaderVariable(), counter});
+  ret.push_back(initial);
+
+  for(uint32_t i = 0; i < iterations; i++)
+  {
+    // call into a helper with a local
+    ShaderDebugState call;
+    call.stepIndex = step++;
+    call.nextInstruction = 100;
+    call.callstack = {"main", "helper"};
+    ShaderVariable local("_local", float(i), 1.0f, 2.0f, 3.0f);
+    call.changes.push_back({ShaderVariable(), local});
+    ret.push_back(call);
+
+    // first write to a local without debug info, where the before has no name
+    ShaderDebugState write;
+    write.stepIndex = step++;
+    write.nextInstruction = 101;
+    write.callstack = call.callstack;
+    ShaderVariable written = local;
+    written.value.f32v[1] = float(i) * 0.5f;
+    ShaderVariable before = local;
+    before.name = "";
+    write.changes.push_back({before, written});
+    if(i % 7 == 0)
+      write.flags = ShaderEvents::GeneratedNanOrInf;
+    ret.push_back(write);
+
+    // return, local goes out of scope
+    ShaderDebugState retState;
+    retState.stepIndex = step++;
+    retState.nextInstruction = 20;
+    retState.callstack = {"main"};
+    retState.changes.push_back({written, ShaderVariable()});
+    ret.push_back(retState);
+
+    // update one member of the struct
+    ShaderDebugState update;
+    update.stepIndex = step++;
+    update.nextInstruction = 21;
+    update.callstack = {"main"};
+    ShaderVariable newAccum = accum;
+    newAccum.members[i % 3].value.f32v[i % 4] += float(i);
+    update.changes.push_back({accum, newAccum});
+    accum = newAccum;
+    ret.push_back(update);
+
+    // increment the counter
+    ShaderDebugState inc;
+    inc.stepIndex = step++;
+    inc.nextInstruction = 22;
+    inc.callstack = {"main"};
+    ShaderVariable newCounter = counter;
+    newCounter.value.u32v[0]++;
+    inc.changes.push_back({counter, newCounter});
+    counter = newCounter;
+    ret.push_back(inc);
+  }
+
+  // a struct that grows and changes type, and a step with no changes at all
+  ShaderDebugState last;
+  last.stepIndex = step++;
+  last.nextInstruction = 5;
+  ShaderVariable grown = accum;
+  grown.members.push_back(ShaderVariable("_accum.extra", 1U, 2U, 3U, 4U));
+  grown.type = VarType::Struct;
+  grown.flags = ShaderVariableFlags::RowMajorMatrix;
+  last.changes.push_back({accum, grown});
+  ret.push_back(last);
+
+  ShaderDebugState empty;
+  empty.stepIndex = step++;
+  empty.nextInstruction = 6;
+  ret.push_back(empty);
+
+  return ret;
+}
+
+static uint64_t SerialisedSize(const rdcarray<ShaderDebugState> &states)
+{
+  StreamWriter writer(StreamWriter::DefaultScratchSize);
+  WriteSerialiser ser(&writer, Ownership::Nothing);
+
+  rdcarray<ShaderDebugState> copy = states;
+  SERIALISE_ELEMENT(copy);
+
+  return writer.GetOffset();
+}
+
+TEST_CASE("Test shader debug state delta encoding", "[shader_debug_delta]")
+{
+  rdcarray<ShaderDebugState> trace = MakeLoopTrace(50);
+
+  SECTION("Round trip in chunks")
+  {
+    ShaderDebugDeltaEncoder encoder;
+    ShaderDebugDeltaDecoder decoder;
+
+    uint64_t encodedSize = 0;
+
+    for(size_t start = 0; start < trace.size(); start += 37)
+    {
+      rdcarray<ShaderDebugState> chunk;
+      chunk.assign(trace.data() + start, RDCMIN((size_t)37, trace.size() - start));
+
+      bytebuf encoded;
+      encoder.Encode(chunk, encoded);
+      encodedSize += encoded.size();
+
+      rdcarray<ShaderDebugState> decoded;
+      REQUIRE(decoder.Decode(encoded, decoded));
+
+      REQUIRE(decoded.size() == chunk.size());
+      for(size_t i = 0; i < chunk.size(); i++)
+      {
+        CHECK((decoded[i] == chunk[i]));
+        CHECK(decoded[i].callstack == chunk[i].callstack);
+      }
+    }
+
+    // the encoding should be a fraction of the size of serialising the states directly
+    CHECK(encodedSize * 10 < SerialisedSize(trace));
+  };
+
+  SECTION("Empty chunks")
+  {
+    ShaderDebugDeltaEncoder encoder;
+    ShaderDebugDeltaDecoder decoder;
+
+    bytebuf encoded;
+    encoder.Encode({}, encoded);
+
+    rdcarray<ShaderDebugState> decoded = trace;
+    CHECK(decoder.Decode(encoded, decoded));
+    CHECK(decoded.empty());
+  };
+
+  SECTION("Malformed data is rejected")
+  {
+    ShaderDebugDeltaEncoder encoder;
+
+    bytebuf encoded;
+    encoder.Encode(trace, encoded);
+
+    // truncated at any point
+    for(size_t len : {(size_t)1, encoded.size() / 3, encoded.size() - 1})
+    {
+      ShaderDebugDeltaDecoder decoder;
+      bytebuf truncated(encoded.data(), len);
+      rdcarray<ShaderDebugState> decoded;
+      CHECK_FALSE(decoder.Decode(truncated, decoded));
+    }
+
+    // decoding a later chunk without the context from earlier ones
+    rdcarray<ShaderDebugState> chunk;
+    chunk.push_back(trace[trace.size() - 2]);
+    encoder.Encode(chunk, encoded);
+
+    ShaderDebugDeltaDecoder decoder;
+    rdcarray<ShaderDebugState> decoded;
+    CHECK_FALSE(decoder.Decode(encoded, decoded));
+  };
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -113,6 +113,10 @@ precision highp int;
 // divide MS<->buffer workgroups by 64
 #define MS_DISPATCH_LOCAL_SIZE 64
 
+// content hash workgroups, and the most that are dispatched for any one range
+#define HASH_LOCAL_SIZE 256u
+#define HASH_MAX_WORKGROUPS 1024u
+
 #if !defined(__cplusplus)
 
 vec3 CalcCubeCoord(vec2 uv, int face)
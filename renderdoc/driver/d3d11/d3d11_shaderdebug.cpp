@@ -2702,6 +2702,13 @@ rdcarray<ShaderDebugState> D3D11Replay::ContinueDebug(ShaderDebugger *debugger)
   return interpreter->ContinueDebug(&apiWrapper);
 }
 
+ShaderDebugState D3D11Replay::RunDebug(ShaderDebugger *debugger,
+                                       const rdcarray<uint32_t> &breakpoints, uint32_t maxSteps)
+{
+  // running without recording intermediate states isn't supported by the DXBC/DXIL debuggers
+  return {};
+}
+
 void D3D11Replay::FreeDebugger(ShaderDebugger *debugger)
 {
   delete debugger;
@@ -2034,8 +2034,9 @@ void D3D12DebugManager::PrepareExecuteIndirectPatching(const GPUAddressRangeTrac
   };
   rdcarray<buffermapping> buffers;
 
-  for(const GPUAddressRange &addr : origAddresses.addresses)
+  for(auto it = origAddresses.addresses.begin(); it != origAddresses.addresses.end(); ++it)
   {
+    const GPUAddressRange &addr = it->second;
     buffermapping b = {};
     b.origBase = addr.start;
     b.origEnd = addr.realEnd;
@@ -3221,9 +3221,10 @@ void WrappedID3D12Device::UploadBLASBufferAddresses()
   rdcarray<BlasAddressPair> blasAddressPair;
   D3D12ResourceManager *resManager = GetResourceManager();
 
-  for(size_t i = 0; i < m_OrigGPUAddresses.addresses.size(); i++)
+  const GPUAddressRangeTracker::AddressMap &addresses = m_OrigGPUAddresses.addresses;
+  for(auto it = addresses.begin(); it != addresses.end(); ++it)
   {
-    GPUAddressRange addressRange = m_OrigGPUAddresses.addresses[i];
+    const GPUAddressRange &addressRange = it->second;
     ResourceId resId = addressRange.id;
     if(resManager->HasLiveResource(resId))
     {
@@ -1237,9 +1237,13 @@ void D3D12RTManager::PrepareRayDispatchBuffer(const GPUAddressRangeTracker *orig
 
     m_NumPatchingAddrs = 0;
 
-    for(size_t i = 0; origAddresses && i < origAddresses->addresses.size(); i++)
+    GPUAddressRangeTracker::AddressMap noAddresses;
+    const GPUAddressRangeTracker::AddressMap &addresses =
+        origAddresses ? origAddresses->addresses : noAddresses;
+
+    for(auto it = addresses.begin(); it != addresses.end(); ++it)
     {
-      GPUAddressRange addressRange = origAddresses->addresses[i];
+      const GPUAddressRange &addressRange = it->second;
       ResourceId resId = addressRange.id;
       if(m_wrappedDevice->GetResourceManager()->HasLiveResource(resId))
       {
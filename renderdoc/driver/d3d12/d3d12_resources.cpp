@@ -449,8 +449,8 @@ void WrappedID3D12Resource::RefBuffers(D3D12ResourceManager *rm)
 {
   // only buffers go into m_Addresses
   SCOPED_READLOCK(m_Addresses.addressLock);
-  for(size_t i = 0; i < m_Addresses.addresses.size(); i++)
-    rm->MarkResourceFrameReferenced(m_Addresses.addresses[i].id, eFrameRef_Read);
+  for(auto it = m_Addresses.addresses.begin(); it != m_Addresses.addresses.end(); ++it)
+    rm->MarkResourceFrameReferenced(it->second.id, eFrameRef_Read);
 }
 
 void WrappedID3D12Resource::GetMappableIDs(D3D12ResourceManager *rm,
@@ -458,12 +458,12 @@ void WrappedID3D12Resource::GetMappableIDs(D3D12ResourceManager *rm,
                                            std::unordered_set<ResourceId> &mappableIDs)
 {
   SCOPED_READLOCK(m_Addresses.addressLock);
-  for(size_t i = 0; i < m_Addresses.addresses.size(); i++)
+  for(auto it = m_Addresses.addresses.begin(); it != m_Addresses.addresses.end(); ++it)
   {
-    if(refdIDs.find(m_Addresses.addresses[i].id) != refdIDs.end())
+    if(refdIDs.find(it->second.id) != refdIDs.end())
     {
       WrappedID3D12Resource *resource =
-          (WrappedID3D12Resource *)rm->GetCurrentResource(m_Addresses.addresses[i].id);
+          (WrappedID3D12Resource *)rm->GetCurrentResource(it->second.id);
       mappableIDs.insert(resource->GetMappableID());
     }
   }
@@ -473,15 +473,17 @@ rdcarray<ID3D12Resource *> WrappedID3D12Resource::AddRefBuffersBeforeCapture(D3D
 {
   rdcarray<ID3D12Resource *> ret;
 
-  rdcarray<GPUAddressRange> addresses;
+  rdcarray<ResourceId> ids;
   {
     SCOPED_READLOCK(m_Addresses.addressLock);
-    addresses = m_Addresses.addresses;
+    ids.reserve(m_Addresses.addresses.size());
+    for(auto it = m_Addresses.addresses.begin(); it != m_Addresses.addresses.end(); ++it)
+      ids.push_back(it->second.id);
   }
 
-  for(size_t i = 0; i < addresses.size(); i++)
+  for(size_t i = 0; i < ids.size(); i++)
   {
-    ID3D12Resource *resource = (ID3D12Resource *)rm->GetCurrentResource(addresses[i].id);
+    ID3D12Resource *resource = (ID3D12Resource *)rm->GetCurrentResource(ids[i]);
     if(resource)
     {
       resource->AddRef();
@@ -3378,6 +3378,13 @@ rdcarray<ShaderDebugState> D3D12Replay::ContinueDebug(ShaderDebugger *debugger)
   }
 }
 
+ShaderDebugState D3D12Replay::RunDebug(ShaderDebugger *debugger,
+                                       const rdcarray<uint32_t> &breakpoints, uint32_t maxSteps)
+{
+  // running without recording intermediate states isn't supported by the DXBC/DXIL debuggers
+  return {};
+}
+
 void D3D12Replay::FreeDebugger(ShaderDebugger *debugger)
 {
   delete debugger;
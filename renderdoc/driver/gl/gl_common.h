@@ -788,6 +788,8 @@ extern bool IsGLES;
   EXT_TO_CHECK(99, 99, EXT_texture_sRGB_decode)                  \
   EXT_TO_CHECK(99, 99, INTEL_performance_query)                  \
   EXT_TO_CHECK(99, 99, EXT_texture_buffer)                       \
+  EXT_TO_CHECK(99, 99, ARB_parallel_shader_compile)              \
+  EXT_TO_CHECK(99, 99, KHR_parallel_shader_compile)              \
   /* OpenGL ES extensions */                                     \
   EXT_TO_CHECK(99, 32, EXT_color_buffer_float)                   \
   EXT_TO_CHECK(99, 32, EXT_primitive_bounding_box)               \
@@ -903,8 +905,13 @@ struct ShaderReflection;
 
 struct PerStageReflections
 {
+  // GLSL shaders are only reflected here when it's explicitly requested, since iterating program
+  // uniforms and bindings only needs the reflection of SPIR-V shaders.
   const ShaderReflection *refls[NumShaderStages] = {};
   const ShaderBindpointMapping *mappings[NumShaderStages] = {};
+  // whether each stage has a shader, whether or not it was reflected
+  bool present[NumShaderStages] = {};
+  bool spirv[NumShaderStages] = {};
 };
 
 void CopyProgramUniforms(const PerStageReflections &srcStages, GLuint progSrc,
@@ -916,6 +923,7 @@ void SerialiseProgramUniforms(SerialiserType &ser, CaptureState state,
                               std::map<GLint, GLint> *locTranslate);
 bool CopyProgramAttribBindings(GLuint progsrc, GLuint progdst, ShaderReflection *refl);
 bool CopyProgramFragDataBindings(GLuint progsrc, GLuint progdst, ShaderReflection *refl);
+bool CopyProgramInterfaceBindings(GLuint progsrc, GLuint progdst, bool hasVert, bool hasFrag);
 template <typename SerialiserType>
 bool SerialiseProgramBindings(SerialiserType &ser, CaptureState state,
                               const PerStageReflections &stages, GLuint prog);
@@ -34,6 +34,7 @@
 #include "gl_replay.h"
 
 RDOC_EXTERN_CONFIG(bool, Replay_Debug_PrintChunkTimings);
+RDOC_EXTERN_CONFIG(bool, Replay_IncrementalForward);
 
 std::map<uint64_t, GLWindowingData> WrappedOpenGL::m_ActiveContexts;
 
@@ -947,6 +948,8 @@ rdcstr WrappedOpenGL::GetChunkName(uint32_t idx)
 
 WrappedOpenGL::~WrappedOpenGL()
 {
+  SaveReflectionCache();
+
   if(m_IndirectBuffer)
     GL.glDeleteBuffers(1, &m_IndirectBuffer);
 
@@ -1661,6 +1664,8 @@ struct ReplacementSearch
 
 void WrappedOpenGL::ReplaceResource(ResourceId from, ResourceId to)
 {
+  InvalidateIncrementalReplay();
+
   if(GetResourceManager()->HasLiveResource(from))
   {
     GLResource fromresource = GetResourceManager()->GetLiveResource(from);
@@ -1721,10 +1726,10 @@ void WrappedOpenGL::ReplaceResource(ResourceId from, ResourceId to)
       GLuint progdst = toresource.name;
 
       if(shaderType == eGL_VERTEX_SHADER)
-        CopyProgramAttribBindings(progsrc, progdst, shadDetails.reflection);
+        CopyProgramAttribBindings(progsrc, progdst, shadDetails.GetReflection(*this));
 
       if(shaderType == eGL_FRAGMENT_SHADER)
-        CopyProgramFragDataBindings(progsrc, progdst, shadDetails.reflection);
+        CopyProgramFragDataBindings(progsrc, progdst, shadDetails.GetReflection(*this));
 
       {
         PerStageReflections dstStages;
@@ -1774,6 +1779,8 @@ void WrappedOpenGL::RemoveReplacement(ResourceId id)
 {
   if(GetResourceManager()->HasReplacement(id))
   {
+    InvalidateIncrementalReplay();
+
     GetResourceManager()->RemoveReplacement(id);
 
     RefreshDerivedReplacements();
@@ -1872,10 +1879,10 @@ void WrappedOpenGL::RefreshDerivedReplacements()
       ResourceId fs = progdata.stageShaders[4];
 
       if(vs != ResourceId())
-        CopyProgramAttribBindings(progsrc, progdst, m_Shaders[vs].reflection);
+        CopyProgramAttribBindings(progsrc, progdst, m_Shaders[vs].GetReflection(*this));
 
       if(fs != ResourceId())
-        CopyProgramFragDataBindings(progsrc, progdst, m_Shaders[fs].reflection);
+        CopyProgramFragDataBindings(progsrc, progdst, m_Shaders[fs].GetReflection(*this));
 
       // link new program
       glLinkProgram(progdst);
@@ -3415,6 +3422,17 @@ RDResult WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers, m_TimeBase, m_TimeFrequency);
 
+  // if the driver can compile shaders and link programs on background threads, let it use as many
+  // as it likes. Compiles are then issued without waiting for them to finish, and any statuses are
+  // checked once the initialisation chunks have all been processed.
+  if(IsReplayMode(m_State) &&
+     (HasExt[KHR_parallel_shader_compile] || HasExt[ARB_parallel_shader_compile]) &&
+     GL.glMaxShaderCompilerThreadsKHR)
+  {
+    GL.glMaxShaderCompilerThreadsKHR(0xFFFFFFFFU);
+    m_ParallelShaderCompile = true;
+  }
+
   m_StructuredFile = &ser.GetStructuredFile();
 
   m_StoredStructuredData->version = m_StructuredFile->version = m_SectionVersion;
@@ -3476,6 +3494,8 @@ RDResult WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
 
       m_FrameReader = new StreamReader(reader, frameDataSize);
 
+      ResolvePendingCompiles();
+
       rdcarray<DebugMessage> savedDebugMessages;
 
       // save any debug messages we built up
@@ -5328,6 +5348,8 @@ RDResult WrappedOpenGL::ContextReplayLog(CaptureState readType, uint32_t startEv
     }
   }
 
+  m_ReplayEndedActiveState = false;
+
   if(IsActiveReplaying(m_State) && !m_FetchCounters)
   {
     for(size_t i = 0; i < MAX_QUERIES; i++)
@@ -5346,6 +5368,7 @@ RDResult WrappedOpenGL::ContextReplayLog(CaptureState readType, uint32_t startEv
           else
             GL.glEndQueryIndexed(q, j);
           m_ActiveQueries[i][j] = false;
+          m_ReplayEndedActiveState = true;
         }
       }
     }
@@ -5354,12 +5377,14 @@ RDResult WrappedOpenGL::ContextReplayLog(CaptureState readType, uint32_t startEv
     {
       GL.glEndConditionalRender();
       m_ActiveConditional = false;
+      m_ReplayEndedActiveState = true;
     }
 
     if(m_ActiveFeedback)
     {
       GL.glEndTransformFeedback();
       m_ActiveFeedback = false;
+      m_ReplayEndedActiveState = true;
     }
   }
 
@@ -5415,6 +5440,222 @@ bool WrappedOpenGL::ContextProcessChunk(ReadSerialiser &ser, GLChunk chunk)
   return true;
 }
 
+static TextureType UniformTextureType(GLenum type, bool &isImage)
+{
+  isImage = false;
+
+  switch(type)
+  {
+    case eGL_IMAGE_BUFFER:
+    case eGL_INT_IMAGE_BUFFER:
+    case eGL_UNSIGNED_INT_IMAGE_BUFFER: isImage = true; return TextureType::Buffer;
+    case eGL_IMAGE_1D:
+    case eGL_INT_IMAGE_1D:
+    case eGL_UNSIGNED_INT_IMAGE_1D: isImage = true; return TextureType::Texture1D;
+    case eGL_IMAGE_1D_ARRAY:
+    case eGL_INT_IMAGE_1D_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_1D_ARRAY: isImage = true; return TextureType::Texture1DArray;
+    case eGL_IMAGE_2D:
+    case eGL_INT_IMAGE_2D:
+    case eGL_UNSIGNED_INT_IMAGE_2D: isImage = true; return TextureType::Texture2D;
+    case eGL_IMAGE_2D_RECT:
+    case eGL_INT_IMAGE_2D_RECT:
+    case eGL_UNSIGNED_INT_IMAGE_2D_RECT: isImage = true; return TextureType::TextureRect;
+    case eGL_IMAGE_2D_ARRAY:
+    case eGL_INT_IMAGE_2D_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_2D_ARRAY: isImage = true; return TextureType::Texture2DArray;
+    case eGL_IMAGE_2D_MULTISAMPLE:
+    case eGL_INT_IMAGE_2D_MULTISAMPLE:
+    case eGL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE: isImage = true; return TextureType::Texture2DMS;
+    case eGL_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case eGL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+      isImage = true;
+      return TextureType::Texture2DMSArray;
+    case eGL_IMAGE_3D:
+    case eGL_INT_IMAGE_3D:
+    case eGL_UNSIGNED_INT_IMAGE_3D: isImage = true; return TextureType::Texture3D;
+    case eGL_IMAGE_CUBE:
+    case eGL_INT_IMAGE_CUBE:
+    case eGL_UNSIGNED_INT_IMAGE_CUBE: isImage = true; return TextureType::TextureCube;
+    case eGL_IMAGE_CUBE_MAP_ARRAY:
+    case eGL_INT_IMAGE_CUBE_MAP_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:
+      isImage = true;
+      return TextureType::TextureCubeArray;
+
+    case eGL_SAMPLER_BUFFER:
+    case eGL_INT_SAMPLER_BUFFER:
+    case eGL_UNSIGNED_INT_SAMPLER_BUFFER: return TextureType::Buffer;
+    case eGL_SAMPLER_1D:
+    case eGL_SAMPLER_1D_SHADOW:
+    case eGL_INT_SAMPLER_1D:
+    case eGL_UNSIGNED_INT_SAMPLER_1D: return TextureType::Texture1D;
+    case eGL_SAMPLER_1D_ARRAY:
+    case eGL_SAMPLER_1D_ARRAY_SHADOW:
+    case eGL_INT_SAMPLER_1D_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_1D_ARRAY: return TextureType::Texture1DArray;
+    case eGL_SAMPLER_2D:
+    case eGL_SAMPLER_2D_SHADOW:
+    case eGL_INT_SAMPLER_2D:
+    case eGL_UNSIGNED_INT_SAMPLER_2D: return TextureType::Texture2D;
+    case eGL_SAMPLER_2D_RECT:
+    case eGL_SAMPLER_2D_RECT_SHADOW:
+    case eGL_INT_SAMPLER_2D_RECT:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_RECT: return TextureType::TextureRect;
+    case eGL_SAMPLER_2D_ARRAY:
+    case eGL_SAMPLER_2D_ARRAY_SHADOW:
+    case eGL_INT_SAMPLER_2D_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_ARRAY: return TextureType::Texture2DArray;
+    case eGL_SAMPLER_2D_MULTISAMPLE:
+    case eGL_INT_SAMPLER_2D_MULTISAMPLE:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE: return TextureType::Texture2DMS;
+    case eGL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case eGL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: return TextureType::Texture2DMSArray;
+    case eGL_SAMPLER_3D:
+    case eGL_INT_SAMPLER_3D:
+    case eGL_UNSIGNED_INT_SAMPLER_3D: return TextureType::Texture3D;
+    case eGL_SAMPLER_CUBE:
+    case eGL_SAMPLER_CUBE_SHADOW:
+    case eGL_INT_SAMPLER_CUBE:
+    case eGL_UNSIGNED_INT_SAMPLER_CUBE: return TextureType::TextureCube;
+    case eGL_SAMPLER_CUBE_MAP_ARRAY:
+    case eGL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+    case eGL_INT_SAMPLER_CUBE_MAP_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY: return TextureType::TextureCubeArray;
+    default: break;
+  }
+
+  return TextureType::Unknown;
+}
+
+static const GLResource *TextureBindingList(const GLRenderState &rs, TextureType type)
+{
+  switch(type)
+  {
+    case TextureType::Unknown: return NULL;
+    case TextureType::Buffer: return rs.TexBuffer;
+    case TextureType::Texture1D: return rs.Tex1D;
+    case TextureType::Texture1DArray: return rs.Tex1DArray;
+    case TextureType::Texture2D: return rs.Tex2D;
+    case TextureType::TextureRect: return rs.TexRect;
+    case TextureType::Texture2DArray: return rs.Tex2DArray;
+    case TextureType::Texture2DMS: return rs.Tex2DMS;
+    case TextureType::Texture2DMSArray: return rs.Tex2DMSArray;
+    case TextureType::Texture3D: return rs.Tex3D;
+    case TextureType::TextureCube: return rs.TexCube;
+    case TextureType::TextureCubeArray: return rs.TexCubeArray;
+    case TextureType::Count: RDCERR("Invalid shader resource type"); break;
+  }
+
+  return NULL;
+}
+
+void WrappedOpenGL::AddProgramStageUsage(GLuint prog, size_t stage, const GLRenderState &rs,
+                                         uint32_t eventId)
+{
+  GLResourceManager *rm = GetResourceManager();
+
+  EventUsage cb = EventUsage(eventId, CBUsage(stage));
+  EventUsage ro = EventUsage(eventId, ResUsage(stage));
+  EventUsage rw = EventUsage(eventId, RWResUsage(stage));
+
+  const GLenum refEnums[] = {
+      eGL_REFERENCED_BY_VERTEX_SHADER,          eGL_REFERENCED_BY_TESS_CONTROL_SHADER,
+      eGL_REFERENCED_BY_TESS_EVALUATION_SHADER, eGL_REFERENCED_BY_GEOMETRY_SHADER,
+      eGL_REFERENCED_BY_FRAGMENT_SHADER,        eGL_REFERENCED_BY_COMPUTE_SHADER,
+  };
+
+  // the binding and whether this stage references it
+  const GLenum blockProps[] = {eGL_BUFFER_BINDING, refEnums[stage]};
+  GLint blockValues[2] = {};
+
+  GLint numResources = 0;
+
+  GL.glGetProgramInterfaceiv(prog, eGL_UNIFORM_BLOCK, eGL_ACTIVE_RESOURCES, &numResources);
+  for(GLint r = 0; r < numResources; r++)
+  {
+    GL.glGetProgramResourceiv(prog, eGL_UNIFORM_BLOCK, r, 2, blockProps, 2, NULL, blockValues);
+
+    uint32_t slot = (uint32_t)blockValues[0];
+    if(blockValues[1] && slot < ARRAY_COUNT(rs.UniformBinding) && rs.UniformBinding[slot].res.name)
+      m_ResourceUses[rm->GetResID(rs.UniformBinding[slot].res)].push_back(cb);
+  }
+
+  if(HasExt[ARB_shader_storage_buffer_object])
+  {
+    GL.glGetProgramInterfaceiv(prog, eGL_SHADER_STORAGE_BLOCK, eGL_ACTIVE_RESOURCES, &numResources);
+    for(GLint r = 0; r < numResources; r++)
+    {
+      GL.glGetProgramResourceiv(prog, eGL_SHADER_STORAGE_BLOCK, r, 2, blockProps, 2, NULL,
+                                blockValues);
+
+      uint32_t slot = (uint32_t)blockValues[0];
+      if(blockValues[1] && slot < ARRAY_COUNT(rs.ShaderStorage) && rs.ShaderStorage[slot].res.name)
+        m_ResourceUses[rm->GetResID(rs.ShaderStorage[slot].res)].push_back(rw);
+    }
+  }
+
+  if(HasExt[ARB_shader_atomic_counters])
+  {
+    GL.glGetProgramInterfaceiv(prog, eGL_ATOMIC_COUNTER_BUFFER, eGL_ACTIVE_RESOURCES,
+                               &numResources);
+    for(GLint r = 0; r < numResources; r++)
+    {
+      GL.glGetProgramResourceiv(prog, eGL_ATOMIC_COUNTER_BUFFER, r, 2, blockProps, 2, NULL,
+                                blockValues);
+
+      uint32_t slot = (uint32_t)blockValues[0];
+      if(blockValues[1] && slot < ARRAY_COUNT(rs.AtomicCounter) && rs.AtomicCounter[slot].res.name)
+        m_ResourceUses[rm->GetResID(rs.AtomicCounter[slot].res)].push_back(rw);
+    }
+  }
+
+  // samplers and images are plain uniforms, with the unit as their value
+  const GLenum uniformProps[] = {eGL_TYPE, eGL_LOCATION, eGL_ARRAY_SIZE, refEnums[stage]};
+  GLint uniformValues[4] = {};
+
+  // in case of bugs, we readback into this array instead of a single int
+  GLint dummyReadback[32];
+
+  GL.glGetProgramInterfaceiv(prog, eGL_UNIFORM, eGL_ACTIVE_RESOURCES, &numResources);
+  for(GLint r = 0; r < numResources; r++)
+  {
+    GL.glGetProgramResourceiv(prog, eGL_UNIFORM, r, 4, uniformProps, 4, NULL, uniformValues);
+
+    // uniforms in blocks have no location
+    if(uniformValues[1] < 0 || uniformValues[3] == 0)
+      continue;
+
+    bool isImage = false;
+    TextureType texType = UniformTextureType((GLenum)uniformValues[0], isImage);
+
+    if(texType == TextureType::Unknown)
+      continue;
+
+    const GLResource *texList = TextureBindingList(rs, texType);
+    const uint32_t listSize = (uint32_t)ARRAY_COUNT(rs.Tex2D);
+
+    // array elements have consecutive locations
+    for(GLint arr = 0; arr < RDCMAX(1, uniformValues[2]); arr++)
+    {
+      GL.glGetUniformiv(prog, uniformValues[1] + arr, dummyReadback);
+      uint32_t slot = (uint32_t)dummyReadback[0];
+
+      if(isImage)
+      {
+        if(slot < ARRAY_COUNT(rs.Images) && rs.Images[slot].res.name)
+          m_ResourceUses[rm->GetResID(rs.Images[slot].res)].push_back(rw);
+      }
+      else if(texList != NULL && slot < listSize && texList[slot].name != 0)
+      {
+        m_ResourceUses[rm->GetResID(texList[slot])].push_back(ro);
+      }
+    }
+  }
+}
+
 void WrappedOpenGL::AddUsage(const ActionDescription &a)
 {
   ActionFlags DrawDispatchMask = ActionFlags::Drawcall | ActionFlags::Dispatch;
@@ -5461,6 +5702,7 @@ void WrappedOpenGL::AddUsage(const ActionDescription &a)
 
     ShaderReflection *refl[NumShaderStages] = {NULL};
     GLuint progForStage[NumShaderStages] = {};
+    ResourceId shadForStage[NumShaderStages];
 
     GLuint curProg = 0;
     GL.glGetIntegerv(eGL_CURRENT_PROGRAM, (GLint *)&curProg);
@@ -5483,7 +5725,7 @@ void WrappedOpenGL::AddUsage(const ActionDescription &a)
           {
             curProg = rm->GetCurrentResource(pipeDetails.stagePrograms[i]).name;
 
-            refl[i] = m_Shaders[pipeDetails.stageShaders[i]].reflection;
+            shadForStage[i] = pipeDetails.stageShaders[i];
             progForStage[i] = curProg;
           }
         }
@@ -5497,12 +5739,28 @@ void WrappedOpenGL::AddUsage(const ActionDescription &a)
       {
         if(progDetails.stageShaders[i] != ResourceId())
         {
-          refl[i] = m_Shaders[progDetails.stageShaders[i]].reflection;
+          shadForStage[i] = progDetails.stageShaders[i];
           progForStage[i] = curProg;
         }
       }
     }
 
+    // GLSL shaders may not have been reflected yet and that needs a compile, so look up their
+    // resources through the linked program's interface instead. SPIR-V shaders were reflected when
+    // they were specialised, and the program interface isn't reliable for them.
+    for(size_t i = 0; i < ARRAY_COUNT(shadForStage); i++)
+    {
+      if(shadForStage[i] == ResourceId())
+        continue;
+
+      ShaderData &shadDetails = m_Shaders[shadForStage[i]];
+
+      if(shadDetails.spirvWords.empty())
+        AddProgramStageUsage(progForStage[i], i, rs, e);
+      else
+        refl[i] = shadDetails.GetReflection(*this);
+    }
+
     for(size_t i = 0; i < ARRAY_COUNT(refl); i++)
     {
       EventUsage cb = EventUsage(e, CBUsage(i));
@@ -5566,25 +5824,8 @@ void WrappedOpenGL::AddUsage(const ActionDescription &a)
           if(!used)
             continue;
 
-          GLResource *texList = NULL;
-          const int32_t listSize = (int32_t)ARRAY_COUNT(rs.Tex2D);
-
-          switch(res.textureType)
-          {
-            case TextureType::Unknown: texList = NULL; break;
-            case TextureType::Buffer: texList = rs.TexBuffer; break;
-            case TextureType::Texture1D: texList = rs.Tex1D; break;
-            case TextureType::Texture1DArray: texList = rs.Tex1DArray; break;
-            case TextureType::Texture2D: texList = rs.Tex2D; break;
-            case TextureType::TextureRect: texList = rs.TexRect; break;
-            case TextureType::Texture2DArray: texList = rs.Tex2DArray; break;
-            case TextureType::Texture2DMS: texList = rs.Tex2DMS; break;
-            case TextureType::Texture2DMSArray: texList = rs.Tex2DMSArray; break;
-            case TextureType::Texture3D: texList = rs.Tex3D; break;
-            case TextureType::TextureCube: texList = rs.TexCube; break;
-            case TextureType::TextureCubeArray: texList = rs.TexCubeArray; break;
-            case TextureType::Count: RDCERR("Invalid shader resource type"); break;
-          }
+          const GLResource *texList = TextureBindingList(rs, res.textureType);
+          const uint32_t listSize = (uint32_t)ARRAY_COUNT(rs.Tex2D);
 
           if(texList != NULL && slot < listSize && texList[slot].name != 0)
             m_ResourceUses[rm->GetResID(texList[slot])].push_back(ro);
@@ -5800,11 +6041,33 @@ const GLDrawParams &WrappedOpenGL::GetDrawParameters(uint32_t eventId)
   return m_DrawcallParams[eventId];
 }
 
-void WrappedOpenGL::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
+void WrappedOpenGL::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType,
+                              bool incremental)
 {
   bool partial = true;
 
-  if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
+  uint32_t replayedEventID = m_ReplayedEventID;
+  m_ReplayedEventID = 0;
+
+  if(!incremental || !Replay_IncrementalForward() || m_FetchCounters)
+    replayedEventID = 0;
+
+  // if the previous replay left the frame at an earlier event and nothing has changed since then,
+  // only replay the events in between. Every chunk is an event so we can just carry on serially.
+  bool continued = false;
+  if(startEventID == 0 && replayType == eReplay_WithoutDraw && replayedEventID > 0 &&
+     replayedEventID < endEventID)
+  {
+    if(replayedEventID + 1 == endEventID)
+    {
+      m_ReplayedEventID = replayedEventID;
+      return;
+    }
+
+    startEventID = replayedEventID + 1;
+    continued = true;
+  }
+  else if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
   {
     startEventID = 1;
     partial = false;
@@ -5839,6 +6102,18 @@ void WrappedOpenGL::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
 
   RDCASSERTEQUAL(status.code, ResultCode::Succeeded);
 
+  // note where we got to if this replay was a continuation of the last one or started from scratch,
+  // unless the state had to be modified when finishing.
+  if(incremental && status == ResultCode::Succeeded && !m_ReplayEndedActiveState)
+  {
+    if(replayType == eReplay_WithoutDraw && (!partial || continued))
+      m_ReplayedEventID = RDCMAX(1U, endEventID) - 1;
+    else if(replayType == eReplay_Full && !partial)
+      m_ReplayedEventID = endEventID;
+    else if(replayType == eReplay_OnlyDraw && replayedEventID + 1 == endEventID)
+      m_ReplayedEventID = endEventID;
+  }
+
   // make sure to end any unbalanced replay events if we stopped in the middle of a frame
   for(int i = 0; m_ReplayMarkers && i < m_ReplayEventCount; i++)
     GLMarkerRegion::End();
@@ -214,6 +214,14 @@ private:
   bool m_ActiveFeedback;
   bool m_WasActiveFeedback = false;
 
+  // set if the end of the last replay had to end any active queries, conditional rendering or
+  // transform feedback, leaving the state different from the capture at that point.
+  bool m_ReplayEndedActiveState = false;
+
+  // the event that the frame has been replayed up to and including by the last incremental-capable
+  // replay, or 0 if the state since then is unknown. Any other replay resets this.
+  uint32_t m_ReplayedEventID = 0;
+
   ResourceId m_DeviceResourceID;
   GLResourceRecord *m_DeviceRecord;
 
@@ -346,6 +354,7 @@ private:
                             bool partial);
   bool ContextProcessChunk(ReadSerialiser &ser, GLChunk chunk);
   void AddUsage(const ActionDescription &a);
+  void AddProgramStageUsage(GLuint prog, size_t stage, const GLRenderState &rs, uint32_t eventId);
   void AddAction(const ActionDescription &a);
   void AddEvent();
 
@@ -669,7 +678,12 @@ public:
   bool IsUnsafeDraw(uint32_t eventId) { return m_UnsafeDraws.find(eventId) != m_UnsafeDraws.end(); }
   // replay interface
   void Initialise(GLInitParams &params, uint64_t sectionVersion, const ReplayOptions &opts);
-  void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
+  // incremental should only be set by callers that haven't modified any replay state since their
+  // last replay, which lets a replay from the start of the frame continue on from where that one
+  // stopped instead.
+  void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType,
+                 bool incremental = false);
+  void InvalidateIncrementalReplay() { m_ReplayedEventID = 0; }
   RDResult ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers);
 
   GLuint GetFakeVAO0() { return m_Global_VAO0; }
@@ -721,7 +735,6 @@ public:
     rdcspv::Reflector spirv;
     rdcstr disassembly;
     std::map<size_t, uint32_t> spirvInstructionLines;
-    ShaderReflection *reflection;
     int version;
 
     // used only when we're capturing and don't have driver-side reflection so we need to emulate
@@ -740,6 +753,31 @@ public:
     void ProcessSPIRVCompilation(WrappedOpenGL &drv, ResourceId id, GLuint realShader,
                                  const GLchar *pEntryPoint, GLuint numSpecializationConstants,
                                  const GLuint *pConstantIndex, const GLuint *pConstantValue);
+
+    // on replay, reflecting a GLSL shader needs an extra compile and link of a separable program
+    // so it's deferred from ProcessCompilation until the reflection is first needed.
+    ShaderReflection *GetReflection(WrappedOpenGL &drv)
+    {
+      ResolveCompileStatus(drv);
+      if(reflectionPending)
+        Reflect(drv);
+      return reflection;
+    }
+    // with parallel shader compilation the compile status isn't queried in ProcessCompilation, as
+    // that would wait for the compile. This fetches it if it's still outstanding.
+    void ResolveCompileStatus(WrappedOpenGL &drv);
+    // discard any reflection, e.g. when the sources change
+    void ResetReflection();
+    // take ownership of the reflection, leaving this shader without one
+    ShaderReflection *DetachReflection();
+
+  private:
+    void Reflect(WrappedOpenGL &drv);
+
+    ShaderReflection *reflection;
+    bool reflectionPending = false;
+    ResourceId reflectionId;
+    GLuint pendingStatusShader = 0;
   };
 
   struct ProgramData
@@ -759,6 +797,11 @@ public:
     bool linked;
     ResourceId stageShaders[NumShaderStages];
 
+    // the transform feedback varyings last set on the program, replayed onto the initial state
+    // program so that the same uniforms stay active.
+    rdcarray<rdcstr> feedbackVaryings;
+    GLenum feedbackBufferMode = eGL_INTERLEAVED_ATTRIBS;
+
     // used only when we're capturing and don't have driver-side reflection so we need to emulate
     glslang::TProgram *glslangProgram = NULL;
   };
@@ -786,7 +829,30 @@ public:
   std::map<ResourceId, ProgramData> m_Programs;
   std::map<ResourceId, PipelineData> m_Pipelines;
 
-  void FillReflectionArray(ResourceId program, PerStageReflections &stages)
+  // on-disk cache of GLSL shader reflection on replay, keyed by a hash of the sources and driver
+  std::map<uint32_t, bytebuf *> m_ReflectionCache;
+  rdcstr m_ReflectionCacheDriver;
+  bool m_ReflectionCacheLoaded = false;
+  bool m_ReflectionCacheDirty = false;
+
+  void GetReflectionCacheHash(const ShaderData &shad, uint32_t hash[4]);
+  bool FetchCachedReflection(const ShaderData &shad, ShaderReflection &refl,
+                             rdcarray<uint32_t> &spirvWords, rdcstr &disassembly);
+  void CacheReflection(const ShaderData &shad, const ShaderReflection &refl,
+                       const rdcarray<uint32_t> &spirvWords, const rdcstr &disassembly);
+  void SaveReflectionCache();
+
+  // on replay if the driver can compile and link in the background, compiles are issued without
+  // waiting on their status. The shaders here still have a status to check once loading finishes.
+  bool m_ParallelShaderCompile = false;
+  rdcarray<ResourceId> m_PendingCompileStatus;
+
+  void ResolvePendingCompiles();
+
+  // SPIR-V shaders are reflected when they're specialised so their reflection is always filled
+  // in. GLSL shaders are only reflected if reflectGLSL is set, since that may need a compile.
+  void FillReflectionArray(ResourceId program, PerStageReflections &stages,
+                           bool reflectGLSL = false)
   {
     ProgramData &progdata = m_Programs[program];
     for(size_t i = 0; i < ARRAY_COUNT(progdata.stageShaders); i++)
@@ -794,14 +860,21 @@ public:
       ResourceId shadId = progdata.stageShaders[i];
       if(shadId != ResourceId())
       {
-        stages.refls[i] = m_Shaders[shadId].reflection;
+        ShaderData &shadDetails = m_Shaders[shadId];
+
+        stages.present[i] = true;
+        stages.spirv[i] = !shadDetails.spirvWords.empty();
+
+        if(stages.spirv[i] || reflectGLSL)
+          stages.refls[i] = shadDetails.GetReflection(*this);
       }
     }
   }
 
-  void FillReflectionArray(GLResource program, PerStageReflections &stages)
+  void FillReflectionArray(GLResource program, PerStageReflections &stages,
+                           bool reflectGLSL = false)
   {
-    FillReflectionArray(GetResourceManager()->GetResID(program), stages);
+    FillReflectionArray(GetResourceManager()->GetResID(program), stages, reflectGLSL);
   }
 
   ResourceId ExtractFBOAttachment(GLenum target, GLenum attachment);
@@ -1185,7 +1185,6 @@ bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId i
 
       uint32_t numShaders = 0;
 
-      rdcarray<rdcstr> vertexOutputs;
       for(size_t i = 0; i < ARRAY_COUNT(details.stageShaders); i++)
       {
         if(details.stageShaders[i] == ResourceId())
@@ -1193,31 +1192,12 @@ bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId i
 
         numShaders++;
 
-        const auto &shadDetails = m_Driver->m_Shaders[details.stageShaders[i]];
+        auto &shadDetails = m_Driver->m_Shaders[details.stageShaders[i]];
 
-        IsProgramSPIRV |= shadDetails.reflection->encoding == ShaderEncoding::OpenGLSPIRV;
+        IsProgramSPIRV |= stages.spirv[i];
 
         GLuint shad = drv.glCreateShader(shadDetails.type);
 
-        if(shadDetails.type == eGL_VERTEX_SHADER)
-        {
-          for(const SigParameter &sig : shadDetails.reflection->outputSignature)
-          {
-            rdcstr name = sig.varName;
-
-            // look for :row or :col added to split up matrix variables
-            int32_t colon = name.find(":");
-
-            // remove it, if present
-            if(colon >= 0)
-              name.resize(colon);
-
-            // only push matrix variables once
-            if(!vertexOutputs.contains(name))
-              vertexOutputs.push_back(name);
-          }
-        }
-
         if(!shadDetails.sources.empty())
         {
           char **srcs = new char *[shadDetails.sources.size()];
@@ -1257,33 +1237,36 @@ bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId i
         }
       }
 
-      // Some drivers optimize out uniforms if they dont change any active vertex shader outputs.
-      // This resulted in initProg locationTranslate table being -1 for a particular shader where
-      // some uniforms were only intended to affect TF. Therefore set a TF mode for all varyings.
-      // As the initial state program is never used for TF, this wont adversely affect anything.
-
       // don't print debug messages from these links - we know some might fail but as long as we
       // eventually get one to work that's fine.
       m_Driver->SuppressDebugMessages(true);
 
       if(numShaders)
       {
-        rdcarray<const char *> vertexOutputsPtr;
-        vertexOutputsPtr.resize(vertexOutputs.size());
-        for(size_t i = 0; i < vertexOutputs.size(); i++)
-          vertexOutputsPtr[i] = vertexOutputs[i].c_str();
-
+        // Some drivers optimize out uniforms if they dont change any active vertex shader outputs.
+        // This resulted in initProg locationTranslate table being -1 for a particular shader where
+        // some uniforms were only intended to affect TF. Therefore link with the same TF varyings
+        // as the program had, so the same outputs (and uniforms) are active. As the initial state
+        // program is never used for TF, this wont adversely affect anything.
+        rdcarray<const char *> varyingsPtr;
         if(!IsProgramSPIRV)
-          drv.glTransformFeedbackVaryings(initProg, (GLsizei)vertexOutputsPtr.size(),
-                                          &vertexOutputsPtr[0], eGL_INTERLEAVED_ATTRIBS);
+        {
+          varyingsPtr.resize(details.feedbackVaryings.size());
+          for(size_t i = 0; i < details.feedbackVaryings.size(); i++)
+            varyingsPtr[i] = details.feedbackVaryings[i].c_str();
+        }
+
+        if(!varyingsPtr.empty())
+          drv.glTransformFeedbackVaryings(initProg, (GLsizei)varyingsPtr.size(), varyingsPtr.data(),
+                                          details.feedbackBufferMode);
         drv.glLinkProgram(initProg);
 
         GLint status = 0;
         drv.glGetProgramiv(initProg, eGL_LINK_STATUS, &status);
 
-        // if it failed to link, first remove the varyings hack above as maybe the driver is barfing
-        // on trying to make some output a varying
-        if(status == 0 && !IsProgramSPIRV)
+        // if it failed to link, first remove the varyings as maybe the driver is barfing on trying
+        // to make some output a varying. We lose the uniforms, but still have a program
+        if(status == 0 && !varyingsPtr.empty())
         {
           drv.glTransformFeedbackVaryings(initProg, 0, NULL, eGL_INTERLEAVED_ATTRIBS);
           drv.glLinkProgram(initProg);
@@ -2228,22 +2211,25 @@ void GLResourceManager::Apply_InitialState(GLResource live, GLInitialContents &i
 
     bool changedBindings = false;
 
-    if(prog.stageShaders[0] != ResourceId())
-      changedBindings |= CopyProgramAttribBindings(
-          initial.resource.name, live.name, m_Driver->m_Shaders[prog.stageShaders[0]].reflection);
+    PerStageReflections stages;
+    m_Driver->FillReflectionArray(Id, stages);
+
+    bool IsProgramSPIRV = false;
+    for(size_t i = 0; i < NumShaderStages; i++)
+      IsProgramSPIRV |= stages.spirv[i];
 
-    if(prog.stageShaders[4] != ResourceId())
-      changedBindings |= CopyProgramFragDataBindings(
-          initial.resource.name, live.name, m_Driver->m_Shaders[prog.stageShaders[4]].reflection);
+    // copy the bindings through the initial program's interface rather than the shaders'
+    // reflection, so that applying doesn't force GLSL shaders to be reflected. SPIR-V bindings
+    // are immutable so there's nothing to copy.
+    if(!IsProgramSPIRV)
+      changedBindings = CopyProgramInterfaceBindings(initial.resource.name, live.name,
+                                                     stages.present[0], stages.present[4]);
 
     // we need to re-link the program to apply the bindings, as long as it's linkable.
     // See the comment on shaderProgramUnlinkable for more information.
     if(!prog.shaderProgramUnlinkable && changedBindings)
       GL.glLinkProgram(live.name);
 
-    PerStageReflections stages;
-    m_Driver->FillReflectionArray(Id, stages);
-
     // we can pass in the same stages array, it's the same program essentially (reflection is
     // identical)
     CopyProgramUniforms(stages, initial.resource.name, stages, live.name);
@@ -74,10 +74,10 @@ bool GLReplay::CreateFragmentShaderReplacementProgram(GLuint program, GLuint rep
       {
         if(pipeDetails.stageShaders[i] != ResourceId())
         {
-          const WrappedOpenGL::ShaderData &shadDetails =
+          WrappedOpenGL::ShaderData &shadDetails =
               m_pDriver->m_Shaders[pipeDetails.stageShaders[i]];
 
-          if(shadDetails.reflection->encoding == ShaderEncoding::OpenGLSPIRV)
+          if(shadDetails.GetReflection(*m_pDriver)->encoding == ShaderEncoding::OpenGLSPIRV)
             HasSPIRVShaders = true;
           else
             HasGLSLShaders = true;
@@ -137,10 +137,9 @@ bool GLReplay::CreateFragmentShaderReplacementProgram(GLuint program, GLuint rep
         shaders[i] =
             m_pDriver->GetResourceManager()->GetCurrentResource(progDetails.stageShaders[i]).name;
 
-        const WrappedOpenGL::ShaderData &shadDetails =
-            m_pDriver->m_Shaders[progDetails.stageShaders[i]];
+        WrappedOpenGL::ShaderData &shadDetails = m_pDriver->m_Shaders[progDetails.stageShaders[i]];
 
-        if(shadDetails.reflection->encoding == ShaderEncoding::OpenGLSPIRV)
+        if(shadDetails.GetReflection(*m_pDriver)->encoding == ShaderEncoding::OpenGLSPIRV)
           HasSPIRVShaders = true;
         else
           HasGLSLShaders = true;
@@ -724,7 +723,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
     float colVal[] = {0.8f, 0.1f, 0.8f, 1.0f};
     drv.glProgramUniform4fv(DebugData.overlayProg, overlayFixedColLocation, 1, colVal);
 
-    ReplayLog(eventId, eReplay_OnlyDraw);
+    m_pDriver->ReplayLog(0, eventId, eReplay_OnlyDraw);
   }
   else if(overlay == DebugOverlay::Wireframe)
   {
@@ -739,7 +738,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
       // desktop GL is simple
       drv.glPolygonMode(eGL_FRONT_AND_BACK, eGL_LINE);
 
-      ReplayLog(eventId, eReplay_OnlyDraw);
+      m_pDriver->ReplayLog(0, eventId, eReplay_OnlyDraw);
     }
     else
     {
@@ -841,7 +840,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
 
     drv.glProgramUniform4fv(DebugData.overlayProg, overlayFixedColLocation, 1, col);
 
-    ReplayLog(eventId, eReplay_OnlyDraw);
+    m_pDriver->ReplayLog(0, eventId, eReplay_OnlyDraw);
 
     if(HasExt[ARB_viewport_array])
     {
@@ -863,7 +862,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
 
     drv.glProgramUniform4fv(DebugData.overlayProg, overlayFixedColLocation, 1, col);
 
-    ReplayLog(eventId, eReplay_OnlyDraw);
+    m_pDriver->ReplayLog(0, eventId, eReplay_OnlyDraw);
 
     // don't need to use the existing program at all!
     drv.glUseProgram(DebugData.checkerProg);
@@ -996,7 +995,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
     float red[] = {1.0f, 0.0f, 0.0f, 1.0f};
     drv.glProgramUniform4fv(DebugData.overlayProg, overlayFixedColLocation, 1, red);
 
-    ReplayLog(eventId, eReplay_OnlyDraw);
+    m_pDriver->ReplayLog(0, eventId, eReplay_OnlyDraw);
 
     GLuint curDepth = 0, curStencil = 0;
 
@@ -1017,7 +1016,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
     {
       useDepthStencilMask = false;
       PerStageReflections stages;
-      m_pDriver->FillReflectionArray(rs.Program, stages);
+      m_pDriver->FillReflectionArray(rs.Program, stages, true);
       const ShaderReflection *reflection = stages.refls[(uint32_t)ShaderStage::Fragment];
       if(reflection)
       {
@@ -1376,7 +1375,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
       drv.glProgramUniform4fv(DebugData.overlayProg, overlayFixedColLocation, 1, green);
     }
 
-    ReplayLog(eventId, eReplay_OnlyDraw);
+    m_pDriver->ReplayLog(0, eventId, eReplay_OnlyDraw);
 
     if(useDepthStencilMask)
     {
@@ -1454,7 +1453,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
 
     drv.glProgramUniform4fv(DebugData.overlayProg, overlayFixedColLocation, 1, col);
 
-    ReplayLog(eventId, eReplay_OnlyDraw);
+    m_pDriver->ReplayLog(0, eventId, eReplay_OnlyDraw);
 
     // only enable cull face if it was enabled originally (otherwise
     // we just render green over the exact same area, so it shows up "passing")
@@ -1466,7 +1465,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
 
     drv.glProgramUniform4fv(DebugData.overlayProg, overlayFixedColLocation, 1, col);
 
-    ReplayLog(eventId, eReplay_OnlyDraw);
+    m_pDriver->ReplayLog(0, eventId, eReplay_OnlyDraw);
   }
   else if(overlay == DebugOverlay::ClearBeforeDraw || overlay == DebugOverlay::ClearBeforePass)
   {
@@ -1641,7 +1640,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
     if(!events.empty() && DebugData.trisizeProg)
     {
       if(overlay == DebugOverlay::TriangleSizePass)
-        ReplayLog(events[0], eReplay_WithoutDraw);
+        m_pDriver->ReplayLog(0, events[0], eReplay_WithoutDraw);
       else
         rs.ApplyState(m_pDriver);
 
@@ -1997,7 +1996,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
       drv.glDeleteVertexArrays(1, &tempVAO);
 
       if(overlay == DebugOverlay::TriangleSizePass)
-        ReplayLog(eventId, eReplay_WithoutDraw);
+        m_pDriver->ReplayLog(0, eventId, eReplay_WithoutDraw);
     }
   }
   else if(overlay == DebugOverlay::QuadOverdrawDraw || overlay == DebugOverlay::QuadOverdrawPass)
@@ -2067,7 +2066,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
         GLuint curDepth = 0, depthType = 0;
 
         if(overlay == DebugOverlay::QuadOverdrawPass)
-          ReplayLog(events[0], eReplay_WithoutDraw);
+          m_pDriver->ReplayLog(0, events[0], eReplay_WithoutDraw);
         else
           rs.ApplyState(m_pDriver);
 
@@ -2305,7 +2304,7 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, Debug
         drv.glDeleteTextures(1, &overridedepth);
 
         if(overlay == DebugOverlay::QuadOverdrawPass)
-          ReplayLog(eventId, eReplay_WithoutDraw);
+          m_pDriver->ReplayLog(0, eventId, eReplay_WithoutDraw);
       }
     }
   }
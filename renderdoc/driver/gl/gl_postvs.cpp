@@ -228,6 +228,10 @@ void GLReplay::InitPostVSBuffers(uint32_t eventId)
 
   MakeCurrentReplayContext(&m_ReplayCtx);
 
+  // the vertex and geometry shaders are run again below, and any active transform feedback is
+  // ended, so the replayed state can't be continued from afterwards
+  m_pDriver->InvalidateIncrementalReplay();
+
   GLMarkerRegion postvs(StringFormat::Fmt("PostVS for %u", eventId));
 
   WrappedOpenGL &drv = *m_pDriver;
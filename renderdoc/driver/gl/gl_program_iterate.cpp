@@ -570,13 +570,11 @@ static void ForAllProgramUniforms(SerialiserType *ser, CaptureState state,
   // skip fetching or applying UBO bindings etc.
   bool IsSrcProgramSPIRV = false;
   for(size_t i = 0; i < NumShaderStages; i++)
-    IsSrcProgramSPIRV |=
-        srcStages.refls[i] && srcStages.refls[i]->encoding == ShaderEncoding::OpenGLSPIRV;
+    IsSrcProgramSPIRV |= srcStages.spirv[i];
 
   bool IsDstProgramSPIRV = false;
   for(size_t i = 0; i < NumShaderStages; i++)
-    IsDstProgramSPIRV |=
-        dstStages.refls[i] && dstStages.refls[i]->encoding == ShaderEncoding::OpenGLSPIRV;
+    IsDstProgramSPIRV |= dstStages.spirv[i];
 
   RDCASSERTMSG("Expect both programs to be SPIR-V in ForAllProgramUniforms",
                IsSrcProgramSPIRV == IsDstProgramSPIRV, IsSrcProgramSPIRV, IsDstProgramSPIRV);
@@ -1257,110 +1255,130 @@ bool CopyProgramFragDataBindings(GLuint progsrc, GLuint progdst, ShaderReflectio
   return !refl->outputSignature.empty();
 }
 
-template <typename SerialiserType>
-bool SerialiseProgramBindings(SerialiserType &ser, CaptureState state,
-                              const PerStageReflections &stages, GLuint prog)
+static void FetchProgramBindings(GLuint prog, rdcarray<ProgramBinding> &InputBindings,
+                                 rdcarray<ProgramBinding> &OutputBindings)
 {
-  rdcarray<ProgramBinding> InputBindings;
-  rdcarray<ProgramBinding> OutputBindings;
-
-  // technically we can completely skip this if the shaders are SPIR-V, but for compatibility we
-  // instead just skip the fetch & apply steps, so that we can still serialise in a backwards
-  // compatible way.
-  bool IsProgramSPIRV = false;
-  for(size_t i = 0; i < NumShaderStages; i++)
-    IsProgramSPIRV |= stages.refls[i] && stages.refls[i]->encoding == ShaderEncoding::OpenGLSPIRV;
-
-  const bool hasVert = stages.refls[0] != NULL;
-  const bool hasFrag = stages.refls[5] != NULL;
+  char buf[128] = {};
 
-  if(ser.IsWriting() && !IsProgramSPIRV)
+  for(int sigType = 0; sigType < 2; sigType++)
   {
-    char buf[128] = {};
+    GLenum sigEnum = (sigType == 0 ? eGL_PROGRAM_INPUT : eGL_PROGRAM_OUTPUT);
+    rdcarray<ProgramBinding> &bindings = (sigType == 0 ? InputBindings : OutputBindings);
 
-    for(int sigType = 0; sigType < 2; sigType++)
+    int32_t NumAttributes = 0;
+    GL.glGetProgramInterfaceiv(prog, sigEnum, eGL_ACTIVE_RESOURCES, (GLint *)&NumAttributes);
+    bindings.reserve(NumAttributes);
+
+    for(GLint i = 0; i < NumAttributes; i++)
     {
-      GLenum sigEnum = (sigType == 0 ? eGL_PROGRAM_INPUT : eGL_PROGRAM_OUTPUT);
-      rdcarray<ProgramBinding> &bindings = (sigType == 0 ? InputBindings : OutputBindings);
+      GL.glGetProgramResourceName(prog, sigEnum, i, 128, NULL, buf);
 
-      int32_t NumAttributes = 0;
-      GL.glGetProgramInterfaceiv(prog, sigEnum, eGL_ACTIVE_RESOURCES, (GLint *)&NumAttributes);
-      bindings.reserve(NumAttributes);
+      ProgramBinding bind;
+      bind.Name = buf;
 
-      for(GLint i = 0; i < NumAttributes; i++)
+      // don't query for gl_ bindings. Serialise it anyway to preserve legacy compatibility, but
+      // on replay below we won't try to set this binding either
+      if(bind.Name.beginsWith("gl_"))
       {
-        GL.glGetProgramResourceName(prog, sigEnum, i, 128, NULL, buf);
-
-        ProgramBinding bind;
-        bind.Name = buf;
-
-        // don't query for gl_ bindings. Serialise it anyway to preserve legacy compatibility, but
-        // on replay below we won't try to set this binding either
-        if(bind.Name.beginsWith("gl_"))
-        {
-          bind.Binding = -1;
-        }
+        bind.Binding = -1;
+      }
+      else
+      {
+        if(sigType == 0)
+          bind.Binding = GL.glGetAttribLocation(prog, buf);
         else
-        {
-          if(sigType == 0)
-            bind.Binding = GL.glGetAttribLocation(prog, buf);
-          else
-            bind.Binding = GL.glGetFragDataLocation(prog, buf);
-        }
-
-        bindings.push_back(bind);
+          bind.Binding = GL.glGetFragDataLocation(prog, buf);
       }
+
+      bindings.push_back(bind);
     }
   }
+}
 
-  SERIALISE_ELEMENT(InputBindings);
-  SERIALISE_ELEMENT(OutputBindings);
-
-  if(ser.IsReading() && IsReplayMode(state) && !IsProgramSPIRV)
+static void ApplyProgramBindings(GLuint prog, bool hasVert, bool hasFrag,
+                                 const rdcarray<ProgramBinding> &InputBindings,
+                                 const rdcarray<ProgramBinding> &OutputBindings)
+{
+  for(int sigType = 0; sigType < 2; sigType++)
   {
-    for(int sigType = 0; sigType < 2; sigType++)
-    {
-      const rdcarray<ProgramBinding> &bindings = (sigType == 0 ? InputBindings : OutputBindings);
+    const rdcarray<ProgramBinding> &bindings = (sigType == 0 ? InputBindings : OutputBindings);
 
-      uint64_t used = 0;
+    uint64_t used = 0;
 
-      for(const ProgramBinding &bind : bindings)
+    for(const ProgramBinding &bind : bindings)
+    {
+      if(bind.Binding >= 0)
       {
-        if(bind.Binding >= 0)
-        {
-          uint64_t mask = 1ULL << bind.Binding;
+        uint64_t mask = 1ULL << bind.Binding;
 
-          if(used & mask)
-          {
-            RDCWARN("Multiple %s items bound to location %d, ignoring %s",
-                    sigType == 0 ? "attrib" : "fragdata", bind.Binding, bind.Name.c_str());
-            continue;
-          }
+        if(used & mask)
+        {
+          RDCWARN("Multiple %s items bound to location %d, ignoring %s",
+                  sigType == 0 ? "attrib" : "fragdata", bind.Binding, bind.Name.c_str());
+          continue;
+        }
 
-          used |= mask;
+        used |= mask;
 
-          // GL_INVALID_OPERATION if name starts with reserved gl_ prefix (for both
-          // glBindAttribLocation and glBindFragDataLocation)
-          if(bind.Name.beginsWith("gl_"))
-            continue;
+        // GL_INVALID_OPERATION if name starts with reserved gl_ prefix (for both
+        // glBindAttribLocation and glBindFragDataLocation)
+        if(bind.Name.beginsWith("gl_"))
+          continue;
 
-          if(sigType == 0 && hasVert)
-          {
-            GL.glBindAttribLocation(prog, (GLuint)bind.Binding, bind.Name.c_str());
-          }
-          else if(sigType == 1 && hasFrag)
+        if(sigType == 0 && hasVert)
+        {
+          GL.glBindAttribLocation(prog, (GLuint)bind.Binding, bind.Name.c_str());
+        }
+        else if(sigType == 1 && hasFrag)
+        {
+          // glBindFragDataLocation is not core GLES. However when it's not available that means
+          // the user must have explicitly specified locations so we don't need to set them.
+          if(!IsGLES && GL.glBindFragDataLocation)
           {
-            // glBindFragDataLocation is not core GLES. However when it's not available that means
-            // the user must have explicitly specified locations so we don't need to set them.
-            if(!IsGLES && GL.glBindFragDataLocation)
-            {
-              GL.glBindFragDataLocation(prog, (GLuint)bind.Binding, bind.Name.c_str());
-            }
+            GL.glBindFragDataLocation(prog, (GLuint)bind.Binding, bind.Name.c_str());
           }
         }
       }
     }
   }
+}
+
+bool CopyProgramInterfaceBindings(GLuint progsrc, GLuint progdst, bool hasVert, bool hasFrag)
+{
+  rdcarray<ProgramBinding> InputBindings;
+  rdcarray<ProgramBinding> OutputBindings;
+
+  FetchProgramBindings(progsrc, InputBindings, OutputBindings);
+  ApplyProgramBindings(progdst, hasVert, hasFrag, InputBindings, OutputBindings);
+
+  return !InputBindings.empty() || !OutputBindings.empty();
+}
+
+template <typename SerialiserType>
+bool SerialiseProgramBindings(SerialiserType &ser, CaptureState state,
+                              const PerStageReflections &stages, GLuint prog)
+{
+  rdcarray<ProgramBinding> InputBindings;
+  rdcarray<ProgramBinding> OutputBindings;
+
+  // technically we can completely skip this if the shaders are SPIR-V, but for compatibility we
+  // instead just skip the fetch & apply steps, so that we can still serialise in a backwards
+  // compatible way.
+  bool IsProgramSPIRV = false;
+  for(size_t i = 0; i < NumShaderStages; i++)
+    IsProgramSPIRV |= stages.spirv[i];
+
+  const bool hasVert = stages.present[0];
+  const bool hasFrag = stages.present[5];
+
+  if(ser.IsWriting() && !IsProgramSPIRV)
+    FetchProgramBindings(prog, InputBindings, OutputBindings);
+
+  SERIALISE_ELEMENT(InputBindings);
+  SERIALISE_ELEMENT(OutputBindings);
+
+  if(ser.IsReading() && IsReplayMode(state) && !IsProgramSPIRV)
+    ApplyProgramBindings(prog, hasVert, hasFrag, InputBindings, OutputBindings);
 
   return !IsProgramSPIRV && (!InputBindings.empty() || !OutputBindings.empty());
 }
@@ -102,10 +102,7 @@ IReplayDriver *GLReplay::MakeDummyDriver()
   // gather up the shaders we've allocated to pass to the dummy driver
   rdcarray<ShaderReflection *> shaders;
   for(auto it = m_pDriver->m_Shaders.begin(); it != m_pDriver->m_Shaders.end(); it++)
-  {
-    shaders.push_back(it->second.reflection);
-    it->second.reflection = NULL;
-  }
+    shaders.push_back(it->second.DetachReflection());
 
   IReplayDriver *dummy = new DummyDriver(this, shaders, m_pDriver->DetachStructuredFile());
 
@@ -121,7 +118,7 @@ RDResult GLReplay::ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffe
 void GLReplay::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
 {
   MakeCurrentReplayContext(&m_ReplayCtx);
-  m_pDriver->ReplayLog(0, endEventID, replayType);
+  m_pDriver->ReplayLog(0, endEventID, replayType, true);
 
   // clear array cache
   for(size_t i = 0; i < ARRAY_COUNT(m_GetTexturePrevData); i++)
@@ -426,6 +423,125 @@ void GLReplay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, byt
   drv.glBindBuffer(eGL_COPY_READ_BUFFER, oldbuf);
 }
 
+void GLReplay::GetBatchResourceData(rdcarray<ReadbackRequest> &requests)
+{
+  WrappedOpenGL &drv = *m_pDriver;
+
+  // buffer ranges are copied into one staging buffer and read back with a single call, so the
+  // driver only has to sync once rather than once per buffer. Anything larger than this goes
+  // straight through GetBufferData.
+  const uint64_t maxBatchSize = 64 * 1024 * 1024;
+
+  struct StagedRange
+  {
+    ReadbackRequest *req;
+    uint64_t offset;
+    uint64_t len;
+  };
+
+  rdcarray<StagedRange> staged;
+  uint64_t totalSize = 0;
+
+  for(ReadbackRequest &req : requests)
+  {
+    if(req.texture)
+    {
+      GetTextureData(req.resource, req.sub, req.params, req.data);
+      continue;
+    }
+
+    auto it = m_pDriver->m_Buffers.find(req.resource);
+    if(it == m_pDriver->m_Buffers.end())
+    {
+      RDCWARN("Requesting data for non-existant buffer %s", ToStr(req.resource).c_str());
+      continue;
+    }
+
+    uint64_t bufsize = it->second.size;
+    uint64_t offset = req.offset;
+    uint64_t len = req.length;
+
+    if(offset >= bufsize)
+    {
+      // can't read past the end of the buffer, return empty
+      continue;
+    }
+
+    if(len == 0 || len > bufsize)
+    {
+      len = bufsize;
+    }
+
+    if(offset + len > bufsize)
+    {
+      RDCWARN("Attempting to read off the end of the buffer (%llu %llu). Will be clamped (%llu)",
+              offset, len, bufsize);
+      len = RDCMIN(len, bufsize - offset);
+    }
+
+    if(len > maxBatchSize)
+    {
+      GetBufferData(req.resource, offset, len, req.data);
+      continue;
+    }
+
+    staged.push_back({&req, offset, len});
+    totalSize += len;
+  }
+
+  if(staged.empty())
+    return;
+
+  GLuint oldread = 0, oldwrite = 0;
+  drv.glGetIntegerv(eGL_COPY_READ_BUFFER_BINDING, (GLint *)&oldread);
+  drv.glGetIntegerv(eGL_COPY_WRITE_BUFFER_BINDING, (GLint *)&oldwrite);
+
+  GLuint stagingBuf = 0;
+  drv.glGenBuffers(1, &stagingBuf);
+  drv.glBindBuffer(eGL_COPY_WRITE_BUFFER, stagingBuf);
+  drv.glNamedBufferDataEXT(stagingBuf, (GLsizeiptr)RDCMIN(totalSize, maxBatchSize), NULL,
+                           eGL_STREAM_READ);
+
+  bytebuf stagingData;
+
+  size_t first = 0;
+  while(first < staged.size())
+  {
+    // pack ranges into the staging buffer until the next one won't fit
+    size_t last = first;
+    uint64_t stagedSize = 0;
+    while(last < staged.size() && stagedSize + staged[last].len <= maxBatchSize)
+    {
+      const StagedRange &range = staged[last];
+
+      drv.glBindBuffer(eGL_COPY_READ_BUFFER,
+                       m_pDriver->m_Buffers[range.req->resource].resource.name);
+      drv.glCopyBufferSubData(eGL_COPY_READ_BUFFER, eGL_COPY_WRITE_BUFFER, (GLintptr)range.offset,
+                              (GLintptr)stagedSize, (GLsizeiptr)range.len);
+
+      stagedSize += range.len;
+      last++;
+    }
+
+    stagingData.resize((size_t)stagedSize);
+    drv.glGetBufferSubData(eGL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)stagedSize, stagingData.data());
+
+    uint64_t stagingOffset = 0;
+    for(size_t i = first; i < last; i++)
+    {
+      staged[i].req->data.assign(stagingData.data() + stagingOffset, (size_t)staged[i].len);
+      stagingOffset += staged[i].len;
+    }
+
+    first = last;
+  }
+
+  drv.glBindBuffer(eGL_COPY_READ_BUFFER, oldread);
+  drv.glBindBuffer(eGL_COPY_WRITE_BUFFER, oldwrite);
+
+  drv.glDeleteBuffers(1, &stagingBuf);
+}
+
 void GLReplay::CacheTexture(ResourceId id)
 {
   if(m_CachedTextures.find(id) != m_CachedTextures.end())
@@ -780,26 +896,34 @@ rdcarray<ShaderEntryPoint> GLReplay::GetShaderEntryPoints(ResourceId shader)
 
   WrappedOpenGL::ShaderData &shaderDetails = m_pDriver->m_Shaders[shader];
 
-  if(shaderDetails.reflection->resourceId == ResourceId())
+  MakeCurrentReplayContext(&m_ReplayCtx);
+
+  const ShaderReflection *refl = shaderDetails.GetReflection(*m_pDriver);
+
+  if(refl->resourceId == ResourceId())
   {
     RDCERR("Can't get shader details without successful reflect");
     return {};
   }
 
-  return {{shaderDetails.reflection->entryPoint, shaderDetails.reflection->stage}};
+  return {{refl->entryPoint, refl->stage}};
 }
 
 ShaderReflection *GLReplay::GetShader(ResourceId pipeline, ResourceId shader, ShaderEntryPoint entry)
 {
   auto &shaderDetails = m_pDriver->m_Shaders[shader];
 
-  if(shaderDetails.reflection->resourceId == ResourceId())
+  MakeCurrentReplayContext(&m_ReplayCtx);
+
+  ShaderReflection *refl = shaderDetails.GetReflection(*m_pDriver);
+
+  if(refl->resourceId == ResourceId())
   {
     RDCERR("Can't get shader details without successful reflect");
     return NULL;
   }
 
-  return shaderDetails.reflection;
+  return refl;
 }
 
 rdcarray<rdcstr> GLReplay::GetDisassemblyTargets(bool withPipeline)
@@ -1137,12 +1261,13 @@ void GLReplay::SavePipelineState(uint32_t eventId)
       stages[i]->programResourceId = rm->GetUnreplacedOriginalID(progIds[i]);
       stages[i]->shaderResourceId = rm->GetUnreplacedOriginalID(shadIds[i]);
 
-      const WrappedOpenGL::ShaderData &shaderDetails = m_pDriver->m_Shaders[shadIds[i]];
+      WrappedOpenGL::ShaderData &shaderDetails = m_pDriver->m_Shaders[shadIds[i]];
+      ShaderReflection *shadRefl = shaderDetails.GetReflection(*m_pDriver);
 
-      if(shaderDetails.reflection->resourceId == ResourceId())
+      if(shadRefl->resourceId == ResourceId())
         stages[i]->reflection = refls[i] = NULL;
       else
-        stages[i]->reflection = refls[i] = shaderDetails.reflection;
+        stages[i]->reflection = refls[i] = shadRefl;
 
       if(!shaderDetails.spirvWords.empty())
         spirv[i] = true;
@@ -2854,8 +2979,9 @@ void GLReplay::FillCBufferVariables(ResourceId pipeline, ResourceId shader, Shad
   MakeCurrentReplayContext(&m_ReplayCtx);
 
   auto &shaderDetails = m_pDriver->m_Shaders[shader];
+  const ShaderReflection *refl = shaderDetails.GetReflection(*m_pDriver);
 
-  if((int32_t)cbufSlot >= shaderDetails.reflection->constantBlocks.count())
+  if((int32_t)cbufSlot >= refl->constantBlocks.count())
   {
     RDCERR("Requesting invalid constant block");
     return;
@@ -2886,11 +3012,11 @@ void GLReplay::FillCBufferVariables(ResourceId pipeline, ResourceId shader, Shad
     }
   }
 
-  const ConstantBlock &cblock = shaderDetails.reflection->constantBlocks[cbufSlot];
+  const ConstantBlock &cblock = refl->constantBlocks[cbufSlot];
 
   if(shaderDetails.spirvWords.empty())
   {
-    OpenGLFillCBufferVariables(shaderDetails.reflection->resourceId, curProg,
+    OpenGLFillCBufferVariables(refl->resourceId, curProg,
                                cblock.bufferBacked ? true : false, "", cblock.variables, outvars,
                                data);
   }
@@ -2909,17 +3035,17 @@ void GLReplay::FillCBufferVariables(ResourceId pipeline, ResourceId shader, Shad
         specconsts.push_back(spec);
       }
 
-      FillSpecConstantVariables(shaderDetails.reflection->resourceId, shaderDetails.patchData,
+      FillSpecConstantVariables(refl->resourceId, shaderDetails.patchData,
                                 cblock.variables, outvars, specconsts);
     }
     else if(!cblock.bufferBacked)
     {
-      OpenGLFillCBufferVariables(shaderDetails.reflection->resourceId, curProg, false, "",
+      OpenGLFillCBufferVariables(refl->resourceId, curProg, false, "",
                                  cblock.variables, outvars, data);
     }
     else
     {
-      StandardFillCBufferVariables(shaderDetails.reflection->resourceId, cblock.variables, outvars,
+      StandardFillCBufferVariables(refl->resourceId, cblock.variables, outvars,
                                    data);
     }
   }
@@ -4303,6 +4429,13 @@ rdcarray<ShaderDebugState> GLReplay::ContinueDebug(ShaderDebugger *debugger)
   return {};
 }
 
+ShaderDebugState GLReplay::RunDebug(ShaderDebugger *debugger,
+                                    const rdcarray<uint32_t> &breakpoints, uint32_t maxSteps)
+{
+  GLNOTIMP("RunDebug");
+  return {};
+}
+
 void GLReplay::FreeDebugger(ShaderDebugger *debugger)
 {
   delete debugger;
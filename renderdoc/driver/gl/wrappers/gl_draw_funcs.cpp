@@ -218,17 +218,17 @@ bool WrappedOpenGL::Check_SafeDraw(bool indexed)
   }
   else
   {
-    const ShaderData &shaderDetails = m_Shaders[vs];
+    ShaderData &shaderDetails = m_Shaders[vs];
+    const ShaderReflection *refl = shaderDetails.GetReflection(*this);
 
     rdcarray<int32_t> vertexAttrBindings;
-    EvaluateVertexAttributeBinds(prog, shaderDetails.reflection, !shaderDetails.spirvWords.empty(),
-                                 vertexAttrBindings);
+    EvaluateVertexAttributeBinds(prog, refl, !shaderDetails.spirvWords.empty(), vertexAttrBindings);
 
     for(int attrib = 0; attrib < vertexAttrBindings.count(); attrib++)
     {
       // skip attributes that don't map to the shader, they're unused
       int reflIndex = vertexAttrBindings[attrib];
-      if(reflIndex >= 0 && reflIndex < shaderDetails.reflection->inputSignature.count())
+      if(reflIndex >= 0 && reflIndex < refl->inputSignature.count())
       {
         // check that this attribute is in-bounds, and enabled. If so then the driver will read from
         // it so we make sure there's a buffer bound
@@ -253,7 +253,7 @@ bool WrappedOpenGL::Check_SafeDraw(bool indexed)
                   "No vertex buffer bound to attribute %d: %s (buffer slot %d) at draw!\n"
                   "This can be caused by deleting a buffer early, before all draws using it "
                   "have been made",
-                  attrib, shaderDetails.reflection->inputSignature[reflIndex].varName.c_str(),
+                  attrib, refl->inputSignature[reflIndex].varName.c_str(),
                   bufIdx));
 
           ret = false;
@@ -273,7 +273,7 @@ bool WrappedOpenGL::Check_SafeDraw(bool indexed)
                     "draw is 0-sized!\n"
                     "Has this buffer been initialised?",
                     ToStr(GetResourceManager()->GetOriginalID(id)).c_str(), attrib,
-                    shaderDetails.reflection->inputSignature[reflIndex].varName.c_str(), bufIdx));
+                    refl->inputSignature[reflIndex].varName.c_str(), bufIdx));
 
             ret = false;
           }
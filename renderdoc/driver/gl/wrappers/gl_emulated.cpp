@@ -3453,13 +3453,15 @@ void APIENTRY _glGetTexImage(GLenum target, GLint level, const GLenum format, co
           RDCDEBUG("Handling D24 only");
         }
 
-        // go pixel-by-pixel, reading in the readback format and writing in the dest format
+        // convert from the readback format to the dest format in bulk
+        rdcarray<FloatVector> texels;
+        texels.resize(width * height);
+        DecodeFormattedComponentsRow(readFmt, srcPixel, readCompSize * readCompCount,
+                                     texels.size(), texels.data());
+        EncodeFormattedComponentsRow(origFmt, texels.data(), texels.size(), dstPixel, dstStride);
+
         for(GLint i = 0; i < width * height; i++)
         {
-          FloatVector vec = DecodeFormattedComponents(readFmt, srcPixel);
-
-          EncodeFormattedComponents(origFmt, vec, dstPixel);
-
           // GL expects ABGR order for these formats where our standard encoder writes BGRA, swizzle
           // here
           if(origFmt.type == ResourceFormatType::R4G4B4A4)
@@ -3488,7 +3490,6 @@ void APIENTRY _glGetTexImage(GLenum target, GLint level, const GLenum format, co
           }
 
           dstPixel += dstStride;
-          srcPixel += readCompSize * readCompCount;
         }
       }
 
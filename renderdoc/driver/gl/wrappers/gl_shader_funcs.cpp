@@ -27,8 +27,11 @@
 #include "../gl_driver.h"
 #include "../gl_shader_refl.h"
 #include "common/common.h"
+#include "common/shader_cache.h"
+#include "core/settings.h"
 #include "driver/shaders/spirv/glslang_compile.h"
 #include "driver/shaders/spirv/spirv_compile.h"
+#include "md5/md5.h"
 #include "strings/string_utils.h"
 
 enum GLshaderbitfield
@@ -62,12 +65,41 @@ rdcstr DoStringise(const GLshaderbitfield &el)
   END_BITFIELD_STRINGISE();
 }
 
+RDOC_CONFIG(bool, OpenGL_Replay_CacheShaderReflection, true,
+            "Cache the reflection of GLSL shaders on disk, to speed up loading captures that use "
+            "the same shaders again.");
+
+static rdcstr ConcatenateSources(const rdcarray<rdcstr> &sources)
+{
+  rdcstr concatenated;
+
+  for(size_t i = 0; i < sources.size(); i++)
+  {
+    if(sources.size() > 1)
+    {
+      if(i > 0)
+        concatenated += "\n";
+      concatenated += "/////////////////////////////";
+      concatenated += StringFormat::Fmt("// Source file %u", (uint32_t)i);
+      concatenated += "/////////////////////////////";
+      concatenated += "\n";
+    }
+
+    concatenated += sources[i];
+  }
+
+  return concatenated;
+}
+
 void WrappedOpenGL::ShaderData::ProcessSPIRVCompilation(WrappedOpenGL &drv, ResourceId id,
                                                         GLuint realShader, const GLchar *pEntryPoint,
                                                         GLuint numSpecializationConstants,
                                                         const GLuint *pConstantIndex,
                                                         const GLuint *pConstantValue)
 {
+  reflectionPending = false;
+  pendingStatusShader = 0;
+
   reflection->resourceId = id;
 
   rdcarray<SpecConstant> specInfo;
@@ -92,28 +124,9 @@ void WrappedOpenGL::ShaderData::ProcessSPIRVCompilation(WrappedOpenGL &drv, Reso
 void WrappedOpenGL::ShaderData::ProcessCompilation(WrappedOpenGL &drv, ResourceId id,
                                                    GLuint realShader)
 {
-  FixedFunctionVertexOutputs outputUsage = {};
-  if(type == eGL_VERTEX_SHADER)
-    CheckVertexOutputUses(sources, outputUsage);
-
   entryPoint = "main";
 
-  rdcstr concatenated;
-
-  for(size_t i = 0; i < sources.size(); i++)
-  {
-    if(sources.size() > 1)
-    {
-      if(i > 0)
-        concatenated += "\n";
-      concatenated += "/////////////////////////////";
-      concatenated += StringFormat::Fmt("// Source file %u", (uint32_t)i);
-      concatenated += "/////////////////////////////";
-      concatenated += "\n";
-    }
-
-    concatenated += sources[i];
-  }
+  rdcstr concatenated = ConcatenateSources(sources);
 
   int32_t offs = concatenated.find("#version");
 
@@ -196,12 +209,26 @@ void WrappedOpenGL::ShaderData::ProcessCompilation(WrappedOpenGL &drv, ResourceI
   if(version == 0)
     version = 100;
 
+  pendingStatusShader = 0;
+
+  // when compiling in parallel while loading, don't wait for the status here. Assume the compile
+  // will succeed and check later, before reflecting or once loading has finished. Without
+  // program_interface_query we need the status now to compile with glslang.
+  bool deferStatus = IsLoading(drv.GetState()) && !drv.IsInternalShader() &&
+                     drv.m_ParallelShaderCompile && HasExt[ARB_program_interface_query];
+
   GLint status = 0;
-  if(realShader == 0)
+  if(realShader == 0 || deferStatus)
     status = 1;
   else
     drv.glGetShaderiv(realShader, eGL_COMPILE_STATUS, &status);
 
+  if(realShader != 0 && deferStatus)
+  {
+    pendingStatusShader = realShader;
+    drv.m_PendingCompileStatus.push_back(drv.GetResourceManager()->GetLiveID(id));
+  }
+
   // if we don't have program_interface_query, need to compile the shader with glslang to be able
   // to reflect with. This is needed on capture or replay
   if(!HasExt[ARB_program_interface_query] && status == 1)
@@ -214,101 +241,345 @@ void WrappedOpenGL::ShaderData::ProcessCompilation(WrappedOpenGL &drv, ResourceI
 
   if(IsReplayMode(drv.GetState()) && !drv.IsInternalShader())
   {
-    // no shaders made under this point should be reflected themselves, they're only used for
-    // reflection
-    drv.PushInternalShader();
-
     if(status == 0)
     {
       RDCDEBUG("Real shader failed to compile, so skipping separable program and reflection.");
     }
     else
     {
-      bool reflected = false;
+      reflectionPending = true;
+      reflectionId = id;
+    }
+  }
+}
 
-      // if we have separate shader object support, we can create a separable program and reflect it
-      // - this may or may not be emulated depending on if ARB_program_interface_query is supported.
-      if(HasExt[ARB_separate_shader_objects])
-      {
-        GLuint sepProg = MakeSeparableShaderProgram(drv, type, sources, includepaths);
+void WrappedOpenGL::ShaderData::ResolveCompileStatus(WrappedOpenGL &drv)
+{
+  if(pendingStatusShader == 0)
+    return;
 
-        if(sepProg == 0)
-        {
-          RDCERR(
-              "Couldn't make separable program for shader via patching - functionality will be "
-              "broken.");
-        }
-        else
-        {
-          MakeShaderReflection(type, sepProg, *reflection, outputUsage);
-          reflected = true;
+  GLint status = 0;
+  drv.glGetShaderiv(pendingStatusShader, eGL_COMPILE_STATUS, &status);
 
-          drv.glDeleteProgram(sepProg);
-        }
-      }
-      else
-      {
-        // if we don't have separate shader objects, we manually reflect directly with glslang to
-        // avoid having to litter MakeSeparableShaderProgram() and child functions with checks about
-        // whether separable programs are actually supported or if we're just faking it to reflect.
-        // In this case we forcibly emulate ARB_program_interface_query.
-        RDCASSERT(!HasExt[ARB_program_interface_query]);
+  pendingStatusShader = 0;
 
-        if(glslangShader == NULL)
-        {
-          RDCERR("Couldn't compile shader via glslang - functionality will be broken.");
-        }
-        else
-        {
-          // to do this, we need to create an empty program object and manually configure its
-          // glslang program.
-          GLuint fakeProgram = drv.glCreateProgram();
+  if(status == 0)
+  {
+    RDCDEBUG("Real shader failed to compile, so skipping separable program and reflection.");
+    reflectionPending = false;
+  }
+}
 
-          ResourceId progid =
-              drv.GetResourceManager()->GetResID(ProgramRes(drv.GetCtx(), fakeProgram));
+void WrappedOpenGL::ResolvePendingCompiles()
+{
+  // the compiles have all been issued by now so they've had the chance to run in parallel, and
+  // we only wait on them once.
+  for(ResourceId id : m_PendingCompileStatus)
+  {
+    auto it = m_Shaders.find(id);
+    if(it != m_Shaders.end())
+      it->second.ResolveCompileStatus(*this);
+  }
+
+  m_PendingCompileStatus.clear();
+}
+
+void WrappedOpenGL::ShaderData::Reflect(WrappedOpenGL &drv)
+{
+  reflectionPending = false;
 
-          ProgramData &progDetails = drv.m_Programs[progid];
+  FixedFunctionVertexOutputs outputUsage = {};
+  if(type == eGL_VERTEX_SHADER)
+    CheckVertexOutputUses(sources, outputUsage);
 
-          progDetails.linked = true;
+  rdcstr concatenated = ConcatenateSources(sources);
 
-          progDetails.glslangProgram = LinkProgramForReflection({glslangShader});
+  rdcarray<uint32_t> spirvwords;
 
-          MakeShaderReflection(type, fakeProgram, *reflection, outputUsage);
-          reflected = true;
+  bool reflected = drv.FetchCachedReflection(*this, *reflection, spirvwords, disassembly);
 
-          drv.glDeleteProgram(fakeProgram);
-        }
+  if(!reflected)
+  {
+    // no shaders made under this point should be reflected themselves, they're only used for
+    // reflection
+    drv.PushInternalShader();
+
+    // if we have separate shader object support, we can create a separable program and reflect it
+    // - this may or may not be emulated depending on if ARB_program_interface_query is supported.
+    if(HasExt[ARB_separate_shader_objects])
+    {
+      GLuint sepProg = MakeSeparableShaderProgram(drv, type, sources, includepaths);
+
+      if(sepProg == 0)
+      {
+        RDCERR(
+            "Couldn't make separable program for shader via patching - functionality will be "
+            "broken.");
       }
+      else
+      {
+        MakeShaderReflection(type, sepProg, *reflection, outputUsage);
+        reflected = true;
 
-      if(reflected)
+        drv.glDeleteProgram(sepProg);
+      }
+    }
+    else
+    {
+      // if we don't have separate shader objects, we manually reflect directly with glslang to
+      // avoid having to litter MakeSeparableShaderProgram() and child functions with checks about
+      // whether separable programs are actually supported or if we're just faking it to reflect.
+      // In this case we forcibly emulate ARB_program_interface_query.
+      RDCASSERT(!HasExt[ARB_program_interface_query]);
+
+      if(glslangShader == NULL)
+      {
+        RDCERR("Couldn't compile shader via glslang - functionality will be broken.");
+      }
+      else
       {
-        rdcarray<uint32_t> spirvwords;
+        // to do this, we need to create an empty program object and manually configure its
+        // glslang program.
+        GLuint fakeProgram = drv.glCreateProgram();
 
-        rdcspv::CompilationSettings settings(rdcspv::InputLanguage::OpenGLGLSL,
-                                             rdcspv::ShaderStage(ShaderIdx(type)));
+        ResourceId progid =
+            drv.GetResourceManager()->GetResID(ProgramRes(drv.GetCtx(), fakeProgram));
 
-        settings.gles = IsGLES;
+        ProgramData &progDetails = drv.m_Programs[progid];
 
-        rdcstr s = rdcspv::Compile(settings, sources, spirvwords);
-        if(!spirvwords.empty())
-          spirv.Parse(spirvwords);
-        else
-          disassembly = "Disassembly to SPIR-V failed:\n\n" + s;
+        progDetails.linked = true;
 
-        reflection->resourceId = id;
+        progDetails.glslangProgram = LinkProgramForReflection({glslangShader});
 
-        reflection->rawBytes.assign((byte *)concatenated.c_str(), concatenated.size());
+        MakeShaderReflection(type, fakeProgram, *reflection, outputUsage);
+        reflected = true;
 
-        reflection->debugInfo.files.resize(1);
-        reflection->debugInfo.files[0].filename = "main.glsl";
-        reflection->debugInfo.files[0].contents = concatenated;
+        drv.glDeleteProgram(fakeProgram);
       }
     }
 
     drv.PopInternalShader();
+
+    if(reflected)
+    {
+      rdcspv::CompilationSettings settings(rdcspv::InputLanguage::OpenGLGLSL,
+                                           rdcspv::ShaderStage(ShaderIdx(type)));
+
+      settings.gles = IsGLES;
+
+      rdcstr s = rdcspv::Compile(settings, sources, spirvwords);
+      if(spirvwords.empty())
+        disassembly = "Disassembly to SPIR-V failed:\n\n" + s;
+
+      drv.CacheReflection(*this, *reflection, spirvwords, disassembly);
+    }
+  }
+
+  if(reflected)
+  {
+    if(!spirvwords.empty())
+      spirv.Parse(spirvwords);
+
+    reflection->resourceId = reflectionId;
+
+    reflection->rawBytes.assign((byte *)concatenated.c_str(), concatenated.size());
+
+    reflection->debugInfo.files.resize(1);
+    reflection->debugInfo.files[0].filename = "main.glsl";
+    reflection->debugInfo.files[0].contents = concatenated;
+  }
+}
+
+void WrappedOpenGL::ShaderData::ResetReflection()
+{
+  reflectionPending = false;
+  pendingStatusShader = 0;
+
+  if(reflection->resourceId != ResourceId())
+  {
+    spirv = rdcspv::Reflector();
+    *reflection = ShaderReflection();
   }
 }
 
+ShaderReflection *WrappedOpenGL::ShaderData::DetachReflection()
+{
+  ShaderReflection *ret = reflection;
+  reflection = NULL;
+  reflectionPending = false;
+  pendingStatusShader = 0;
+  return ret;
+}
+
+struct GLReflectionCacheCallbacks
+{
+  bool Create(uint32_t size, byte *data, bytebuf **ret) const
+  {
+    RDCASSERT(ret);
+
+    *ret = new bytebuf(data, size);
+
+    return true;
+  }
+
+  void Destroy(bytebuf *blob) const { delete blob; }
+  uint32_t GetSize(bytebuf *blob) const { return (uint32_t)blob->size(); }
+  const byte *GetData(bytebuf *blob) const { return blob->data(); }
+} GLReflectionCacheCallbacks;
+
+static const uint32_t GLReflectionCacheMagic = MAKE_FOURCC('G', 'L', 'R', 'F');
+static const uint32_t GLReflectionCacheVersion = 2;
+
+// the cache is keyed on every capture's shaders, so drop it once it gets too large rather than
+// letting it grow forever.
+static const size_t GLReflectionCacheMaxEntries = 16384;
+
+static void HashReflectionKeyString(MD5_CTX &ctx, const rdcstr &str)
+{
+  // length prefixed so that moving text between strings changes the hash
+  uint64_t len = str.size();
+  MD5_Update(&ctx, &len, sizeof(len));
+  MD5_Update(&ctx, str.c_str(), (unsigned long)str.size());
+}
+
+void WrappedOpenGL::GetReflectionCacheHash(const ShaderData &shad, uint32_t hash[4])
+{
+  // anything that can change the result of reflection goes into the hash: the shader itself and
+  // how it's compiled, the driver and the paths used to reflect it
+  MD5_CTX ctx = {};
+  MD5_Init(&ctx);
+
+  HashReflectionKeyString(ctx, m_ReflectionCacheDriver);
+
+  HashReflectionKeyString(
+      ctx, StringFormat::Fmt("%x %d %d %d", (uint32_t)shad.type, IsGLES ? 1 : 0,
+                             HasExt[ARB_separate_shader_objects] ? 1 : 0,
+                             HasExt[ARB_program_interface_query] ? 1 : 0));
+
+  uint64_t count = shad.sources.size();
+  MD5_Update(&ctx, &count, sizeof(count));
+  for(const rdcstr &src : shad.sources)
+    HashReflectionKeyString(ctx, src);
+
+  count = shad.includepaths.size();
+  MD5_Update(&ctx, &count, sizeof(count));
+  for(const rdcstr &path : shad.includepaths)
+    HashReflectionKeyString(ctx, path);
+
+  MD5_Final((unsigned char *)hash, &ctx);
+}
+
+bool WrappedOpenGL::FetchCachedReflection(const ShaderData &shad, ShaderReflection &refl,
+                                          rdcarray<uint32_t> &spirvWords, rdcstr &disassembly)
+{
+  if(!OpenGL_Replay_CacheShaderReflection())
+    return false;
+
+  if(!m_ReflectionCacheLoaded)
+  {
+    m_ReflectionCacheLoaded = true;
+
+    m_ReflectionCacheDriver =
+        StringFormat::Fmt("%s / %s / %s", (const char *)GL.glGetString(eGL_VENDOR),
+                          (const char *)GL.glGetString(eGL_RENDERER),
+                          (const char *)GL.glGetString(eGL_VERSION));
+
+    if(!LoadShaderCache("glreflection.cache", GLReflectionCacheMagic, GLReflectionCacheVersion,
+                        m_ReflectionCache, GLReflectionCacheCallbacks))
+    {
+      for(auto it = m_ReflectionCache.begin(); it != m_ReflectionCache.end(); ++it)
+        GLReflectionCacheCallbacks.Destroy(it->second);
+      m_ReflectionCache.clear();
+    }
+  }
+
+  uint32_t hash[4];
+  GetReflectionCacheHash(shad, hash);
+
+  auto it = m_ReflectionCache.find(hash[0]);
+  if(it == m_ReflectionCache.end())
+    return false;
+
+  StreamReader reader(*it->second);
+  ReadSerialiser ser(&reader, Ownership::Nothing);
+
+  // the cache is keyed by only the first 32 bits of the hash, so the entry contains all of it to
+  // make sure it's really for this shader
+  uint32_t check[4] = {};
+  SERIALISE_ELEMENT(check);
+
+  if(ser.IsErrored() || memcmp(check, hash, sizeof(hash)) != 0)
+    return false;
+
+  ShaderReflection cached;
+  SERIALISE_ELEMENT(cached);
+  SERIALISE_ELEMENT(spirvWords);
+  SERIALISE_ELEMENT(disassembly);
+
+  if(ser.IsErrored())
+  {
+    spirvWords.clear();
+    disassembly.clear();
+    return false;
+  }
+
+  refl = cached;
+
+  return true;
+}
+
+void WrappedOpenGL::CacheReflection(const ShaderData &shad, const ShaderReflection &refl,
+                                    const rdcarray<uint32_t> &spirvWords, const rdcstr &disassembly)
+{
+  if(!OpenGL_Replay_CacheShaderReflection() || !m_ReflectionCacheLoaded)
+    return;
+
+  if(m_ReflectionCache.size() >= GLReflectionCacheMaxEntries)
+  {
+    for(auto it = m_ReflectionCache.begin(); it != m_ReflectionCache.end(); ++it)
+      GLReflectionCacheCallbacks.Destroy(it->second);
+    m_ReflectionCache.clear();
+  }
+
+  StreamWriter writer(StreamWriter::DefaultScratchSize);
+  WriteSerialiser ser(&writer, Ownership::Nothing);
+
+  uint32_t check[4];
+  GetReflectionCacheHash(shad, check);
+  SERIALISE_ELEMENT(check);
+
+  ShaderReflection cached = refl;
+  rdcarray<uint32_t> words = spirvWords;
+  rdcstr disasm = disassembly;
+  SERIALISE_ELEMENT(cached);
+  SERIALISE_ELEMENT(words);
+  SERIALISE_ELEMENT(disasm);
+
+  bytebuf *&entry = m_ReflectionCache[check[0]];
+  if(entry)
+    GLReflectionCacheCallbacks.Destroy(entry);
+  entry = new bytebuf(writer.GetData(), (size_t)writer.GetOffset());
+
+  m_ReflectionCacheDirty = true;
+}
+
+void WrappedOpenGL::SaveReflectionCache()
+{
+  if(m_ReflectionCacheDirty)
+  {
+    SaveShaderCache("glreflection.cache", GLReflectionCacheMagic, GLReflectionCacheVersion,
+                    m_ReflectionCache, GLReflectionCacheCallbacks);
+  }
+  else
+  {
+    for(auto it = m_ReflectionCache.begin(); it != m_ReflectionCache.end(); ++it)
+      GLReflectionCacheCallbacks.Destroy(it->second);
+  }
+
+  m_ReflectionCache.clear();
+  m_ReflectionCacheDirty = false;
+}
+
 #pragma region Shaders
 
 template <typename SerialiserType>
@@ -418,11 +689,7 @@ bool WrappedOpenGL::Serialise_glShaderSource(SerialiserType &ser, GLuint shaderH
     // Doing this means we support the case of recompiling a shader different ways
     // and relinking a program before use, which is still moderately crazy and
     // so people who do that should be moderately ashamed.
-    if(m_Shaders[liveId].reflection->resourceId != ResourceId())
-    {
-      m_Shaders[liveId].spirv = rdcspv::Reflector();
-      *m_Shaders[liveId].reflection = ShaderReflection();
-    }
+    m_Shaders[liveId].ResetReflection();
 
     AddResourceInitChunk(shader);
   }
@@ -1259,6 +1526,13 @@ bool WrappedOpenGL::Serialise_glTransformFeedbackVaryings(SerialiserType &ser, G
   {
     GL.glTransformFeedbackVaryings(program.name, count, varyings, bufferMode);
 
+    ProgramData &progDetails = m_Programs[GetResourceManager()->GetResID(program)];
+
+    progDetails.feedbackVaryings.resize(count);
+    for(GLsizei i = 0; i < count; i++)
+      progDetails.feedbackVaryings[i] = varyings[i];
+    progDetails.feedbackBufferMode = bufferMode;
+
     AddResourceInitChunk(program);
   }
 
@@ -82,9 +82,31 @@ rdcstr rdcspv::Compile(const rdcspv::CompilationSettings &settings, const rdcarr
     if(settings.lang == rdcspv::InputLanguage::VulkanHLSL)
       flags = EShMessages(flags | EShMsgVulkanRules | EShMsgReadHlsl);
 
-    if(settings.debugInfo)
+    if(settings.debugInfo || settings.nonSemanticDebugInfo)
       flags = EShMessages(flags | EShMsgDebugInfo);
 
+    if(settings.spirvVersion != 0)
+    {
+      if(settings.lang == rdcspv::InputLanguage::VulkanGLSL ||
+         settings.lang == rdcspv::InputLanguage::VulkanHLSL)
+      {
+        // pick the lowest vulkan version that can consume this SPIR-V version
+        glslang::EShTargetClientVersion client = glslang::EShTargetVulkan_1_0;
+        if(settings.spirvVersion >= 0x10600)
+          client = glslang::EShTargetVulkan_1_3;
+        else if(settings.spirvVersion >= 0x10400)
+          client = glslang::EShTargetVulkan_1_2;
+        else if(settings.spirvVersion >= 0x10300)
+          client = glslang::EShTargetVulkan_1_1;
+
+        shader->setEnvClient(glslang::EShClientVulkan, client);
+      }
+
+      // glslang's target versions are encoded the same as the SPIR-V version word
+      shader->setEnvTarget(glslang::EShTargetSpv,
+                           glslang::EShTargetLanguageVersion(settings.spirvVersion));
+    }
+
     bool success = shader->parse(GetDefaultResources(), settings.gles ? 100 : 110, false, flags);
 
     if(!success)
@@ -119,6 +141,8 @@ rdcstr rdcspv::Compile(const rdcspv::CompilationSettings &settings, const rdcarr
         glslang::SpvOptions opts;
         if(settings.debugInfo)
           opts.generateDebugInfo = true;
+        if(settings.nonSemanticDebugInfo)
+          opts.emitNonSemanticShaderDebugSource = true;
 
         std::vector<uint32_t> spirvVec;
         glslang::GlslangToSpv(*intermediate, spirvVec, &opts);
@@ -59,7 +59,11 @@ struct CompilationSettings
   ShaderStage stage = ShaderStage::Invalid;
   InputLanguage lang = InputLanguage::Unknown;
   bool debugInfo = false;
+  // emit NonSemantic.Shader.DebugInfo.100 instead of only OpLine/OpSource. Implies debugInfo
+  bool nonSemanticDebugInfo = false;
   bool gles = false;
+  // the SPIR-V version to target, e.g. 0x10300 for 1.3. If 0 the compiler's default is used
+  uint32_t spirvVersion = 0;
   rdcstr entryPoint;
 };
 
@@ -376,10 +376,6 @@ void ThreadState::SetDst(Id id, const ShaderVariable &val)
 
 void ThreadState::ProcessScopeChange(const rdcarray<Id> &oldLive, const rdcarray<Id> &newLive)
 {
-  // nothing to do if we aren't tracking into a state
-  if(!m_State)
-    return;
-
   // all oldLive (except globals) are going out of scope. all newLive (except globals) are coming
   // into scope
 
@@ -390,7 +386,10 @@ void ThreadState::ProcessScopeChange(const rdcarray<Id> &oldLive, const rdcarray
     if(liveGlobals.contains(id))
       continue;
 
-    m_State->changes.push_back({debugger.GetPointerValue(ids[id])});
+    // even when we aren't tracking into a state, keep the pointer lists up to date in case we
+    // start tracking again later
+    if(m_State)
+      m_State->changes.push_back({debugger.GetPointerValue(ids[id])});
 
     if(ids[id].type == VarType::GPUPointer && !debugger.IsOpaquePointer(ids[id]) &&
        !debugger.IsPhysicalPointer(ids[id]))
@@ -401,6 +400,10 @@ void ThreadState::ProcessScopeChange(const rdcarray<Id> &oldLive, const rdcarray
     }
   }
 
+  // nothing more to do if we aren't tracking into a state
+  if(!m_State)
+    return;
+
   for(const Id &id : newLive)
   {
     if(liveGlobals.contains(id))
@@ -516,6 +519,115 @@ ShaderVariable ThreadState::CalcDeriv(ThreadState::DerivDir dir, ThreadState::De
   return var;
 }
 
+// how far ahead of the next instruction to look for math operations whose parameters are known
+static const uint32_t MathOpLookahead = 64;
+
+// returns the GLSL.std.450 operation if this instruction is evaluated with
+// DebugAPIWrapper::CalculateMathOp, or GLSLstd450::Max if not
+static GLSLstd450 GetAPIMathOp(const GlobalState &global, Op op, const Iter &it)
+{
+  if(op != Op::ExtInst && op != Op::ExtInstWithForwardRefsKHR)
+    return GLSLstd450::Max;
+
+  auto dispatch = global.extInsts.find(Id::fromWord(it.word(3)));
+  if(dispatch == global.extInsts.end())
+    return GLSLstd450::Max;
+
+  uint32_t instruction = it.word(4);
+
+  if(instruction >= dispatch->second.apiMathOps.size() || !dispatch->second.apiMathOps[instruction])
+    return GLSLstd450::Max;
+
+  return (GLSLstd450)instruction;
+}
+
+// instructions that leave the current straight-line run of instructions
+static bool EndsStraightLine(Op op)
+{
+  switch(op)
+  {
+    case Op::Label:
+    case Op::Branch:
+    case Op::BranchConditional:
+    case Op::Switch:
+    case Op::Return:
+    case Op::ReturnValue:
+    case Op::Kill:
+    case Op::TerminateInvocation:
+    case Op::Unreachable:
+    case Op::FunctionCall:
+    case Op::FunctionEnd: return true;
+    default: break;
+  }
+
+  return false;
+}
+
+void ThreadState::GetPendingMathOps(rdcarray<DebugAPIWrapper::MathOp> &ops)
+{
+  if(Finished())
+    return;
+
+  // the operations up to the end of the run have already been returned
+  if(nextInstruction >= m_MathOpsBegin && nextInstruction < m_MathOpsEnd)
+    return;
+
+  const DecodedInstruction &next = debugger.GetDecodedInstruction(nextInstruction);
+  if(GetAPIMathOp(global, next.op, debugger.GetIterForInstruction(nextInstruction)) ==
+     GLSLstd450::Max)
+    return;
+
+  // until we jump, the following instructions will execute in order with the values we have now.
+  // Operations in that run can be evaluated ahead of time with their parameters referenced from
+  // our values, up to the first one that depends on a result from earlier in the run. That one is
+  // collected when we reach it.
+  m_MathOpsDefined.clear();
+
+  const uint32_t end = RDCMIN(debugger.GetNumInstructions(), nextInstruction + MathOpLookahead);
+
+  uint32_t inst = nextInstruction;
+  for(; inst < end; inst++)
+  {
+    const DecodedInstruction &decoded = debugger.GetDecodedInstruction(inst);
+
+    if(decoded.ignored)
+      continue;
+
+    if(EndsStraightLine(decoded.op))
+      break;
+
+    Iter it = debugger.GetIterForInstruction(inst);
+
+    GLSLstd450 mathOp = GetAPIMathOp(global, decoded.op, it);
+
+    if(mathOp != GLSLstd450::Max && decoded.numOperands <= DebugAPIWrapper::MathOp::MaxParams)
+    {
+      const Id *operands = debugger.GetDecodedOperands(decoded);
+
+      bool known = true;
+      for(uint32_t i = 0; i < decoded.numOperands; i++)
+        known &= !m_MathOpsDefined.contains(operands[i]);
+
+      if(!known)
+        break;
+
+      DebugAPIWrapper::MathOp op;
+      op.op = mathOp;
+      for(uint32_t i = 0; i < decoded.numOperands; i++)
+        op.params[op.numParams++] = &GetSrc(operands[i]);
+
+      ops.push_back(op);
+    }
+
+    OpDecoder opdata(it);
+    if(opdata.result != Id())
+      m_MathOpsDefined.push_back(opdata.result);
+  }
+
+  m_MathOpsBegin = nextInstruction;
+  m_MathOpsEnd = inst;
+}
+
 void ThreadState::JumpToLabel(Id target)
 {
   StackFrame *frame = callstack.back();
@@ -525,18 +637,19 @@ void ThreadState::JumpToLabel(Id target)
 
   nextInstruction = debugger.GetInstructionForLabel(target) + 1;
 
+  // we may run the same instructions again with different values
+  m_MathOpsBegin = m_MathOpsEnd = 0;
+
   // if jumping to an empty unconditional loop header, continue to the loop block
-  Iter it = debugger.GetIterForInstruction(nextInstruction);
-  if(it.opcode() == Op::LoopMerge)
+  const DecodedInstruction &inst = debugger.GetDecodedInstruction(nextInstruction);
+  if(inst.op == Op::LoopMerge)
   {
-    OpLoopMerge merge(it);
-
-    mergeBlock = merge.mergeBlock;
+    mergeBlock = inst.label;
 
-    it++;
-    if(it.opcode() == Op::Branch)
+    const DecodedInstruction &next = debugger.GetDecodedInstruction(nextInstruction + 1);
+    if(next.op == Op::Branch)
     {
-      JumpToLabel(OpBranch(it).targetLabel);
+      JumpToLabel(next.label);
     }
   }
 
@@ -579,41 +692,17 @@ void ThreadState::SkipIgnoredInstructions()
   // in pixel shaders, but otherwise skip them.
   while(true)
   {
-    Iter it = debugger.GetIterForInstruction(nextInstruction);
-    rdcspv::Op op = it.opcode();
-    if(op == Op::Line || op == Op::NoLine || op == Op::Undef)
-    {
-      nextInstruction++;
-      continue;
-    }
+    const DecodedInstruction &inst = debugger.GetDecodedInstruction(nextInstruction);
 
-    if(op == Op::ExtInst || op == Op::ExtInstWithForwardRefsKHR)
+    if(inst.ignored)
     {
-      if(debugger.IsDebugExtInstSet(Id::fromWord(it.word(3))))
-      {
-        if(ShaderDbg(it.word(4)) != ShaderDbg::Value || !debugger.InDebugScope(nextInstruction))
-        {
-          nextInstruction++;
-          continue;
-        }
-      }
-    }
-
-    if(op == Op::SelectionMerge)
-    {
-      OpSelectionMerge merge(it);
-
-      mergeBlock = merge.mergeBlock;
-
       nextInstruction++;
       continue;
     }
 
-    if(op == Op::LoopMerge)
+    if(inst.op == Op::SelectionMerge || inst.op == Op::LoopMerge)
     {
-      OpLoopMerge merge(it);
-
-      mergeBlock = merge.mergeBlock;
+      mergeBlock = inst.label;
 
       nextInstruction++;
       continue;
@@ -636,6 +725,9 @@ void ThreadState::StepNext(ShaderDebugState *state, const rdcarray<ThreadState>
 {
   m_State = state;
 
+  const DecodedInstruction &decoded = debugger.GetDecodedInstruction(nextInstruction);
+  const Id *idOperands = debugger.GetDecodedOperands(decoded);
+
   Iter it = debugger.GetIterForInstruction(nextInstruction);
   nextInstruction++;
 
@@ -689,39 +781,37 @@ void ThreadState::StepNext(ShaderDebugState *state, const rdcarray<ThreadState>
     case Op::AccessChain:
     case Op::InBoundsAccessChain:
     {
-      OpAccessChain chain(it);
-
-      rdcarray<uint32_t> indices;
+      Id base = Id::fromWord(it.word(3));
 
       // evaluate the indices
-      indices.reserve(chain.indexes.size());
-      for(Id id : chain.indexes)
-        indices.push_back(uintComp(GetSrc(id), 0));
+      m_Indices.clear();
+      for(uint32_t i = 0; i < decoded.numOperands; i++)
+        m_Indices.push_back(uintComp(GetSrc(idOperands[i]), 0));
 
-      SetDst(chain.result, debugger.MakeCompositePointer(
-                               ids[chain.base], debugger.GetPointerBaseId(ids[chain.base]), indices));
+      SetDst(opdata.result, debugger.MakeCompositePointer(
+                                ids[base], debugger.GetPointerBaseId(ids[base]), m_Indices));
       break;
     }
     case Op::PtrAccessChain:
     case Op::InBoundsPtrAccessChain:
     {
-      OpPtrAccessChain chain(it);
+      Id baseId = Id::fromWord(it.word(3));
+      Id elementId = Id::fromWord(it.word(4));
 
-      rdcarray<uint32_t> indices;
       // evaluate the indices
-      indices.reserve(chain.indexes.size());
-      for(Id id : chain.indexes)
-        indices.push_back(uintComp(GetSrc(id), 0));
+      m_Indices.clear();
+      for(uint32_t i = 0; i < decoded.numOperands; i++)
+        m_Indices.push_back(uintComp(GetSrc(idOperands[i]), 0));
 
-      ShaderVariable base = ids[chain.base];
+      ShaderVariable base = ids[baseId];
       PointerVal val = base.GetPointer();
-      int32_t element = intComp(GetSrc(chain.element), 0);
+      int32_t element = intComp(GetSrc(elementId), 0);
       // adjust the address by the element. We should have the array stride since the base pointer
       // must point into an array and we can't go outside it.
       base.SetTypedPointer(val.pointer + element * debugger.GetPointerArrayStride(base), val.shader,
                            val.pointerTypeID);
-      SetDst(chain.result,
-             debugger.MakeCompositePointer(base, debugger.GetPointerBaseId(base), indices));
+      SetDst(opdata.result,
+             debugger.MakeCompositePointer(base, debugger.GetPointerBaseId(base), m_Indices));
       break;
     }
     case Op::ArrayLength:
@@ -1402,11 +1492,9 @@ void ThreadState::StepNext(ShaderDebugState *state, const rdcarray<ThreadState>
         break;
       }
 
-      rdcarray<Id> params;
-      for(size_t i = 5; i < it.size(); i++)
-        params.push_back(Id::fromWord(it.word(i)));
+      m_Operands.assign(idOperands, decoded.numOperands);
 
-      SetDst(result, dispatch.functions[instruction](*this, instruction, params));
+      SetDst(result, dispatch.functions[instruction](*this, instruction, m_Operands));
       break;
     }
 
@@ -2956,17 +3044,16 @@ void ThreadState::StepNext(ShaderDebugState *state, const rdcarray<ThreadState>
     }
     case Op::Phi:
     {
-      OpPhi phi(it);
-
       ShaderVariable var;
 
       StackFrame *frame = callstack.back();
 
-      for(const PairIdRefIdRef &parent : phi.parents)
+      // operands are pairs of the value and the parent block
+      for(uint32_t i = 0; i + 1 < decoded.numOperands; i += 2)
       {
-        if(parent.second == frame->lastBlock)
+        if(idOperands[i + 1] == frame->lastBlock)
         {
-          var = GetSrc(parent.first);
+          var = GetSrc(idOperands[i]);
           break;
         }
       }
@@ -2974,7 +3061,7 @@ void ThreadState::StepNext(ShaderDebugState *state, const rdcarray<ThreadState>
       // we should have had a matching for the OpPhi of the block we came from
       RDCASSERT(!var.name.empty());
 
-      SetDst(phi.result, var);
+      SetDst(opdata.result, var);
       break;
     }
 
@@ -3039,23 +3126,23 @@ void ThreadState::StepNext(ShaderDebugState *state, const rdcarray<ThreadState>
 
     case Op::FunctionCall:
     {
-      OpFunctionCall call(it);
-
       // we hit this twice. The first time we don't have a return value so we jump into the
       // function. The second time we do have a return value so we process it and continue
       if(returnValue.name.empty())
       {
         uint32_t returnInstruction = nextInstruction - 1;
-        nextInstruction = debugger.GetInstructionForFunction(call.function);
+        nextInstruction = decoded.target;
+        m_MathOpsBegin = m_MathOpsEnd = 0;
 
-        EnterFunction(call.arguments);
+        m_Operands.assign(idOperands, decoded.numOperands);
+        EnterFunction(m_Operands);
 
-        RDCASSERT(callstack.back()->function == call.function);
+        RDCASSERT(callstack.back()->function == Id::fromWord(it.word(3)));
         callstack.back()->funcCallInstruction = returnInstruction;
       }
       else
       {
-        SetDst(call.result, returnValue);
+        SetDst(opdata.result, returnValue);
         returnValue.name.clear();
       }
       break;
@@ -3976,21 +4063,11 @@ void ThreadState::StepNext(ShaderDebugState *state, const rdcarray<ThreadState>
   // skip over any degenerate branches
   while(!debugger.HasDebugInfo())
   {
-    it = debugger.GetIterForInstruction(nextInstruction);
-    if(it.opcode() == Op::Branch)
+    const DecodedInstruction &next = debugger.GetDecodedInstruction(nextInstruction);
+    if(next.degenerateBranch)
     {
-      Id target = OpBranch(it).targetLabel;
-
-      it++;
-
-      while(it.opcode() == Op::Line || it.opcode() == Op::NoLine)
-        it++;
-
-      if(target == OpLabel(it).result)
-      {
-        JumpToLabel(target);
-        continue;
-      }
+      JumpToLabel(next.label);
+      continue;
     }
 
     break;
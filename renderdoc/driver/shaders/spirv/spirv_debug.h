@@ -94,6 +94,22 @@ public:
   virtual bool CalculateMathOp(ThreadState &lane, GLSLstd450 op,
                                const rdcarray<ShaderVariable> &params, ShaderVariable &output) = 0;
 
+  struct MathOp
+  {
+    static const uint32_t MaxParams = 3;
+
+    GLSLstd450 op;
+    // referenced from the lane's values, only valid until the lane next steps
+    const ShaderVariable *params[MaxParams] = {};
+    uint32_t numParams = 0;
+  };
+
+  // called before each step with math operations that the active lanes will pass to
+  // CalculateMathOp, on this step or later in the same run of instructions, so that they can be
+  // evaluated together instead of one at a time. The results are still fetched per-lane with
+  // CalculateMathOp afterwards.
+  virtual void PrepareMathOps(const rdcarray<MathOp> &ops) {}
+
   struct DerivativeDeltas
   {
     ShaderVariable ddxcoarse;
@@ -114,6 +130,8 @@ struct ExtInstDispatcher
   bool nonsemantic = false;
   rdcarray<rdcstr> names;
   rdcarray<ExtInstImpl> functions;
+  // instructions which are evaluated with DebugAPIWrapper::CalculateMathOp
+  rdcarray<bool> apiMathOps;
 };
 
 void ConfigureGLSLStd450(ExtInstDispatcher &extinst);
@@ -192,6 +210,10 @@ struct ThreadState
   ShaderVariable CalcDeriv(DerivDir dir, DerivType type, const rdcarray<ThreadState> &workgroup,
                            Id val);
 
+  // if the next instruction is a math operation evaluated by the API wrapper, adds it and any
+  // others up to the next jump whose parameters are already known.
+  void GetPendingMathOps(rdcarray<DebugAPIWrapper::MathOp> &ops);
+
   void FillCallstack(rdcarray<Id> &funcs);
 
   bool Finished() const;
@@ -238,6 +260,14 @@ struct ThreadState
   ShaderVariable ReadPointerValue(Id pointer);
 
 private:
+  // scratch storage reused between steps to avoid allocating
+  rdcarray<Id> m_Operands;
+  rdcarray<uint32_t> m_Indices;
+  rdcarray<Id> m_MathOpsDefined;
+
+  // the instructions whose math operations have already been returned from GetPendingMathOps
+  uint32_t m_MathOpsBegin = 0, m_MathOpsEnd = 0;
+
   void EnterFunction(const rdcarray<Id> &arguments);
   void SetDst(Id id, const ShaderVariable &val);
   void ProcessScopeChange(const rdcarray<Id> &oldLive, const rdcarray<Id> &newLive);
@@ -353,6 +383,30 @@ struct LocalData
   TypeData *type;
 };
 
+// per-instruction data decoded once when debugging begins, so that stepping doesn't need to decode
+// the same instructions or look up the same maps each time it passes through them
+struct DecodedInstruction
+{
+  Op op = Op::Max;
+  // skipped over when stepping - OpLine, OpNoLine, OpUndef and debug info instructions
+  bool ignored = false;
+  // an OpBranch to the block immediately following it
+  bool degenerateBranch = false;
+  // for OpBranch the target label, for OpSelectionMerge/OpLoopMerge the merge block
+  Id label;
+  // for OpFunctionCall the instruction index of the called function
+  uint32_t target = ~0U;
+  // variable-length Id operands, stored contiguously in the debugger. These are the indices for
+  // access chains, the arguments for OpExtInst and OpFunctionCall, and the value/parent pairs for
+  // OpPhi
+  uint32_t firstOperand = 0;
+  uint32_t numOperands = 0;
+  // debug info scope, if there is debug info and this instruction is in a scope
+  const ScopeData *scope = NULL;
+  InlineData *inlined = NULL;
+  bool inScope = false;
+};
+
 Id ParseRawName(const rdcstr &name);
 rdcstr GetRawName(Id id);
 
@@ -368,6 +422,7 @@ public:
                                const SPIRVPatchData &patchData, uint32_t activeIndex);
 
   rdcarray<ShaderDebugState> ContinueDebug();
+  ShaderDebugState RunDebug(const rdcarray<uint32_t> &breakpoints, uint32_t maxSteps);
 
   Iter GetIterForInstruction(uint32_t inst);
   uint32_t GetInstructionForIter(Iter it);
@@ -400,6 +455,14 @@ public:
 
   DebugAPIWrapper *GetAPIWrapper() { return apiWrapper; }
   uint32_t GetNumInstructions() { return (uint32_t)instructionOffsets.size(); }
+  const DecodedInstruction &GetDecodedInstruction(uint32_t inst) const
+  {
+    return decodedInstructions[inst];
+  }
+  const Id *GetDecodedOperands(const DecodedInstruction &inst) const
+  {
+    return decodedOperands.data() + inst.firstOperand;
+  }
   GlobalState GetGlobal() { return global; }
   const rdcarray<Id> &GetLiveGlobals() { return liveGlobals; }
   ThreadState &GetActiveLane() { return workgroup[activeLaneIndex]; }
@@ -423,7 +486,15 @@ private:
 
   void MakeSignatureNames(const rdcarray<SPIRVInterfaceAccess> &sigList, rdcarray<rdcstr> &sigNames);
 
+  void DecodeInstructions();
+
+  void EnterEntryPoint(ShaderDebugState &initial);
+  void PrepareMathOps(const rdcarray<bool> &activeMask);
+  void RetireLiveIds(ThreadState &thread, ShaderDebugState *state);
+  void GetVisibleVariables(std::map<Id, ShaderVariable> &vars);
+
   void FillCallstack(ThreadState &thread, ShaderDebugState &state);
+  void FillInlineCallstack(ThreadState &thread, ShaderDebugState &state);
   void FillDebugSourceVars(rdcarray<InstructionSourceInfo> &instInfo);
   void FillDefaultSourceVars(rdcarray<InstructionSourceInfo> &instInfo);
 
@@ -442,6 +513,9 @@ private:
 
   int steps = 0;
 
+  // scratch storage for batching up math operations each step
+  rdcarray<DebugAPIWrapper::MathOp> mathOps;
+
   /////////////////////////////////////////////////////////
   // parsed data
 
@@ -462,7 +536,7 @@ private:
   LineColumnInfo m_CurLineCol;
   rdcarray<InstructionSourceInfo> m_InstInfo;
 
-  SparseIdMap<uint32_t> labelInstruction;
+  DenseIdMap<uint32_t> labelInstruction;
 
   SparseIdMap<uint16_t> idToPointerType;
   rdcarray<rdcspv::Id> pointerTypeToId;
@@ -482,6 +556,13 @@ private:
 
   rdcarray<size_t> instructionOffsets;
 
+  rdcarray<DecodedInstruction> decodedInstructions;
+  rdcarray<Id> decodedOperands;
+
+  // true if no instruction can read another lane's values or write memory that another lane could
+  // read, so the lanes of a workgroup don't need to execute together
+  bool independentLanes = false;
+
   std::set<rdcstr> usedNames;
   std::map<Id, rdcstr> dynamicNames;
   void CalcActiveMask(rdcarray<bool> &activeMask);
@@ -1249,6 +1249,7 @@ void ConfigureGLSLStd450(ExtInstDispatcher &extinst)
     extinst.names[i] = ToStr(GLSLstd450(i));
 
   extinst.functions.resize(extinst.names.size());
+  extinst.apiMathOps.resize(extinst.names.size());
 
 #define EXT(func)                                              \
   extinst.functions[(uint32_t)GLSLstd450::func] = &glsl::func; \
@@ -1311,6 +1312,7 @@ void ConfigureGLSLStd450(ExtInstDispatcher &extinst)
 // to be more faithful to the real execution
 #define GPU_EXT(func)                                           \
   extinst.functions[(uint32_t)GLSLstd450::func] = &glsl::GPUOp; \
+  extinst.apiMathOps[(uint32_t)GLSLstd450::func] = true;        \
   uint32_t noduplicate##func;                                   \
   (void)noduplicate##func;
   GPU_EXT(Sin)
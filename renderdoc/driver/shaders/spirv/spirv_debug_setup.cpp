@@ -328,6 +328,172 @@ uint32_t Debugger::GetInstructionForFunction(Id id)
   return instructionOffsets.indexOf(functions[id].begin);
 }
 
+void Debugger::DecodeInstructions()
+{
+  decodedInstructions.clear();
+  decodedOperands.clear();
+  decodedInstructions.resize(instructionOffsets.size());
+
+  independentLanes = true;
+
+  // a store is visible to other lanes unless it's to per-lane storage
+  auto isSharedPointer = [this](Id pointer) {
+    const DataType &type = GetTypeForId(pointer);
+    if(type.type != DataType::PointerType)
+      return true;
+
+    StorageClass storage = type.pointerType.storage;
+    return storage != StorageClass::Function && storage != StorageClass::Private &&
+           storage != StorageClass::Input && storage != StorageClass::Output;
+  };
+
+  for(uint32_t i = 0; i < instructionOffsets.size(); i++)
+  {
+    Iter it = GetIterForInstruction(i);
+    DecodedInstruction &dec = decodedInstructions[i];
+
+    dec.op = it.opcode();
+    dec.firstOperand = (uint32_t)decodedOperands.size();
+
+    if(m_DebugInfo.valid)
+    {
+      auto scopeIt = m_DebugInfo.lineScope.find(it.offs());
+      if(scopeIt != m_DebugInfo.lineScope.end())
+      {
+        dec.inScope = true;
+        dec.scope = scopeIt->second;
+      }
+
+      auto inlineIt = m_DebugInfo.lineInline.find(it.offs());
+      if(inlineIt != m_DebugInfo.lineInline.end())
+        dec.inlined = inlineIt->second;
+    }
+
+    switch(dec.op)
+    {
+      case Op::Line:
+      case Op::NoLine:
+      case Op::Undef: dec.ignored = true; break;
+      case Op::ExtInst:
+      case Op::ExtInstWithForwardRefsKHR:
+      {
+        if(IsDebugExtInstSet(Id::fromWord(it.word(3))))
+          dec.ignored = ShaderDbg(it.word(4)) != ShaderDbg::Value || !dec.inScope;
+
+        for(size_t w = 5; w < it.size(); w++)
+          decodedOperands.push_back(Id::fromWord(it.word(w)));
+        break;
+      }
+      case Op::SelectionMerge: dec.label = OpSelectionMerge(it).mergeBlock; break;
+      case Op::LoopMerge: dec.label = OpLoopMerge(it).mergeBlock; break;
+      case Op::Branch:
+      {
+        dec.label = OpBranch(it).targetLabel;
+
+        Iter next = it;
+        next++;
+
+        while(next.opcode() == Op::Line || next.opcode() == Op::NoLine)
+          next++;
+
+        dec.degenerateBranch = next.opcode() == Op::Label && OpLabel(next).result == dec.label;
+        break;
+      }
+      case Op::AccessChain:
+      case Op::InBoundsAccessChain:
+      {
+        OpAccessChain chain(it);
+        decodedOperands.append(chain.indexes);
+        break;
+      }
+      case Op::PtrAccessChain:
+      case Op::InBoundsPtrAccessChain:
+      {
+        OpPtrAccessChain chain(it);
+        decodedOperands.append(chain.indexes);
+        break;
+      }
+      case Op::FunctionCall:
+      {
+        OpFunctionCall call(it);
+        dec.target = GetInstructionForFunction(call.function);
+        decodedOperands.append(call.arguments);
+        break;
+      }
+      case Op::Phi:
+      {
+        OpPhi phi(it);
+        for(const PairIdRefIdRef &parent : phi.parents)
+        {
+          decodedOperands.push_back(parent.first);
+          decodedOperands.push_back(parent.second);
+        }
+        break;
+      }
+      // these read values from other lanes, either directly or to calculate derivatives
+      case Op::DPdx:
+      case Op::DPdy:
+      case Op::DPdxCoarse:
+      case Op::DPdyCoarse:
+      case Op::DPdxFine:
+      case Op::DPdyFine:
+      case Op::Fwidth:
+      case Op::FwidthCoarse:
+      case Op::FwidthFine:
+      case Op::ImageQueryLod:
+      case Op::ImageSampleImplicitLod:
+      case Op::ImageSampleDrefImplicitLod:
+      case Op::ImageSampleProjImplicitLod:
+      case Op::ImageSampleProjDrefImplicitLod:
+      case Op::ImageSparseSampleImplicitLod:
+      case Op::ImageSparseSampleDrefImplicitLod:
+      case Op::ImageSparseSampleProjImplicitLod:
+      case Op::ImageSparseSampleProjDrefImplicitLod:
+      case Op::GroupNonUniformBitwiseOr:
+      // the clock advances on every step of the workgroup, including steps where the displayed lane
+      // is waiting for others to converge
+      case Op::ReadClockKHR:
+      // these write memory that other lanes could read
+      case Op::ImageWrite:
+      case Op::AtomicLoad:
+      case Op::AtomicStore:
+      case Op::AtomicExchange:
+      case Op::AtomicCompareExchange:
+      case Op::AtomicCompareExchangeWeak:
+      case Op::AtomicIIncrement:
+      case Op::AtomicIDecrement:
+      case Op::AtomicIAdd:
+      case Op::AtomicISub:
+      case Op::AtomicSMin:
+      case Op::AtomicUMin:
+      case Op::AtomicSMax:
+      case Op::AtomicUMax:
+      case Op::AtomicAnd:
+      case Op::AtomicOr:
+      case Op::AtomicXor:
+      case Op::AtomicFAddEXT:
+      case Op::AtomicFMinEXT:
+      case Op::AtomicFMaxEXT: independentLanes = false; break;
+      case Op::Store:
+      {
+        if(isSharedPointer(OpStore(it).pointer))
+          independentLanes = false;
+        break;
+      }
+      case Op::CopyMemory:
+      {
+        if(isSharedPointer(OpCopyMemory(it).target))
+          independentLanes = false;
+        break;
+      }
+      case Op::CopyMemorySized: independentLanes = false; break;
+      default: break;
+    }
+
+    dec.numOperands = (uint32_t)decodedOperands.size() - dec.firstOperand;
+  }
+}
+
 uint32_t Debugger::GetInstructionForLabel(Id id)
 {
   uint32_t ret = labelInstruction[id];
@@ -884,6 +1050,8 @@ ShaderDebugTrace *Debugger::BeginDebug(DebugAPIWrapper *api, const ShaderStage s
     }
   }
 
+  DecodeInstructions();
+
   ShaderDebugTrace *ret = new ShaderDebugTrace;
   ret->debugger = this;
   ret->stage = shaderStage;
@@ -1567,6 +1735,51 @@ void Debugger::FillCallstack(ThreadState &thread, ShaderDebugState &state)
   }
 }
 
+void Debugger::FillInlineCallstack(ThreadState &thread, ShaderDebugState &state)
+{
+  if(!m_DebugInfo.valid)
+    return;
+
+  const DecodedInstruction &endInst = decodedInstructions[thread.nextInstruction - 1];
+
+  // append any inlined functions to the top of the stack
+  InlineData *inlined = endInst.inlined;
+
+  size_t insertPoint = state.callstack.size();
+
+  // start with the current scope, it refers to the *inlined* function
+  if(inlined)
+  {
+    const ScopeData *scope = endInst.scope;
+    // find the function parent of the current scope
+    while(scope && scope->parent && scope->type == DebugScope::Block)
+      scope = scope->parent;
+
+    state.callstack.insert(insertPoint, scope->name);
+  }
+
+  // if this instruction has no scope, don't give it a callstack
+  if(endInst.scope == NULL)
+  {
+    state.callstack.clear();
+  }
+
+  // move to the next inline up on our inline stack. If we reach an actual function
+  // call, this parent will be NULL as there was no more inlining - the final scope will
+  // refer to the real function which is already on our stack
+  while(inlined && inlined->parent)
+  {
+    const ScopeData *scope = inlined->scope;
+    // find the function parent of the current scope
+    while(scope && scope->parent && scope->type == DebugScope::Block)
+      scope = scope->parent;
+
+    state.callstack.insert(insertPoint, scope->name);
+
+    inlined = inlined->parent;
+  }
+}
+
 void Debugger::FillDebugSourceVars(rdcarray<InstructionSourceInfo> &instInfo)
 {
   for(InstructionSourceInfo &i : instInfo)
@@ -2324,50 +2537,95 @@ void Debugger::FillDefaultSourceVars(rdcarray<InstructionSourceInfo> &instInfo)
   }
 }
 
-rdcarray<ShaderDebugState> Debugger::ContinueDebug()
+void Debugger::EnterEntryPoint(ShaderDebugState &initial)
 {
   ThreadState &active = GetActiveLane();
 
-  rdcarray<ShaderDebugState> ret;
-
-  // initialise the first ShaderDebugState if we haven't stepped yet
-  if(steps == 0)
+  // we should be sitting at the entry point function prologue, step forward into the first block
+  // and past any function-local variable declarations
+  for(size_t lane = 0; lane < workgroup.size(); lane++)
   {
-    ShaderDebugState initial;
+    ThreadState &thread = workgroup[lane];
 
-    // we should be sitting at the entry point function prologue, step forward into the first block
-    // and past any function-local variable declarations
-    for(size_t lane = 0; lane < workgroup.size(); lane++)
+    if(lane == activeLaneIndex)
     {
-      ThreadState &thread = workgroup[lane];
-
-      if(lane == activeLaneIndex)
-      {
-        thread.EnterEntryPoint(&initial);
-        FillCallstack(thread, initial);
-        initial.nextInstruction = thread.nextInstruction;
-      }
-      else
-      {
-        thread.EnterEntryPoint(NULL);
-      }
+      thread.EnterEntryPoint(&initial);
+      FillCallstack(thread, initial);
+      initial.nextInstruction = thread.nextInstruction;
+    }
+    else
+    {
+      thread.EnterEntryPoint(NULL);
     }
+  }
+
+  // globals won't be filled out by entering the entry point, ensure their change is registered.
+  for(const Id &v : liveGlobals)
+    initial.changes.push_back({ShaderVariable(), GetPointerValue(active.ids[v])});
 
-    // globals won't be filled out by entering the entry point, ensure their change is registered.
-    for(const Id &v : liveGlobals)
+  if(m_DebugInfo.valid)
+  {
+    // debug info can refer to constants for source variable values. Add an initial change for any
+    // that are so referenced
+    for(const Id &v : m_DebugInfo.constants)
       initial.changes.push_back({ShaderVariable(), GetPointerValue(active.ids[v])});
+  }
 
-    if(m_DebugInfo.valid)
+  steps++;
+}
+
+void Debugger::PrepareMathOps(const rdcarray<bool> &activeMask)
+{
+  // let the API wrapper evaluate all the math operations we're about to do in one go, rather
+  // than a round trip for each lane and each step
+  mathOps.clear();
+  for(size_t lane = 0; lane < workgroup.size(); lane++)
+  {
+    if(activeMask[lane] && workgroup[lane].nextInstruction < instructionOffsets.size())
+      workgroup[lane].GetPendingMathOps(mathOps);
+  }
+
+  if(!mathOps.empty())
+    apiWrapper->PrepareMathOps(mathOps);
+}
+
+void Debugger::RetireLiveIds(ThreadState &thread, ShaderDebugState *state)
+{
+  size_t instOffs = instructionOffsets[thread.nextInstruction];
+
+  // see if we're retiring any IDs at this state
+  for(size_t l = 0; l < thread.live.size();)
+  {
+    Id id = thread.live[l];
+    if(idLiveRange[id].second < instOffs)
     {
-      // debug info can refer to constants for source variable values. Add an initial change for any
-      // that are so referenced
-      for(const Id &v : m_DebugInfo.constants)
-        initial.changes.push_back({ShaderVariable(), GetPointerValue(active.ids[v])});
+      thread.live.erase(l);
+      if(state)
+      {
+        ShaderVariableChange change;
+        change.before = GetPointerValue(thread.ids[id]);
+        state->changes.push_back(change);
+      }
+
+      continue;
     }
 
-    ret.push_back(std::move(initial));
+    l++;
+  }
+}
 
-    steps++;
+rdcarray<ShaderDebugState> Debugger::ContinueDebug()
+{
+  ThreadState &active = GetActiveLane();
+
+  rdcarray<ShaderDebugState> ret;
+
+  // initialise the first ShaderDebugState if we haven't stepped yet
+  if(steps == 0)
+  {
+    ShaderDebugState initial;
+    EnterEntryPoint(initial);
+    ret.push_back(std::move(initial));
   }
 
   // if we've finished, return an empty set to signify that
@@ -2388,6 +2646,8 @@ rdcarray<ShaderDebugState> Debugger::ContinueDebug()
     // calculate the current mask of which threads are active
     CalcActiveMask(activeMask);
 
+    PrepareMathOps(activeMask);
+
     // step all active members of the workgroup
     for(size_t lane = 0; lane < workgroup.size(); lane++)
     {
@@ -2407,97 +2667,153 @@ rdcarray<ShaderDebugState> Debugger::ContinueDebug()
         {
           ShaderDebugState state;
 
-          size_t instOffs = instructionOffsets[thread.nextInstruction];
+          RetireLiveIds(thread, &state);
 
-          // see if we're retiring any IDs at this state
-          for(size_t l = 0; l < thread.live.size();)
-          {
-            Id id = thread.live[l];
-            if(idLiveRange[id].second < instOffs)
-            {
-              thread.live.erase(l);
-              ShaderVariableChange change;
-              change.before = GetPointerValue(thread.ids[id]);
-              state.changes.push_back(change);
+          state.stepIndex = steps;
+          thread.StepNext(&state, workgroup);
 
-              continue;
-            }
+          FillCallstack(thread, state);
+          FillInlineCallstack(thread, state);
 
-            l++;
-          }
+          ret.push_back(std::move(state));
 
-          uint32_t funcRet = ~0U;
-          size_t prevStackSize = thread.callstack.size();
+          steps++;
+        }
+        else
+        {
+          thread.StepNext(NULL, workgroup);
+        }
+      }
+    }
+  }
 
-          if(!thread.callstack.empty())
-            funcRet = thread.callstack.back()->funcCallInstruction;
+  return ret;
+}
 
-          state.stepIndex = steps;
-          thread.StepNext(&state, workgroup);
+void Debugger::GetVisibleVariables(std::map<Id, ShaderVariable> &vars)
+{
+  const ThreadState &active = GetActiveLane();
 
-          if(thread.callstack.size() > prevStackSize)
-            instOffs =
-                instructionOffsets[GetInstructionForFunction(thread.callstack.back()->function)];
+  vars.clear();
 
-          else if(thread.callstack.size() < prevStackSize && funcRet != ~0U)
-            instOffs = instructionOffsets[funcRet];
+  // nothing is visible until we've entered the entry point
+  if(steps == 0)
+    return;
 
-          FillCallstack(thread, state);
+  // keyed by Id rather than name, since a variable can shadow another with the same name
+  for(const Id &v : liveGlobals)
+    vars[v] = GetPointerValue(active.ids[v]);
 
-          if(m_DebugInfo.valid)
-          {
-            size_t endOffs = instructionOffsets[thread.nextInstruction - 1];
+  for(const Id &v : active.live)
+    vars[v] = GetPointerValue(active.ids[v]);
+}
 
-            // append any inlined functions to the top of the stack
-            InlineData *inlined = m_DebugInfo.lineInline[endOffs];
+ShaderDebugState Debugger::RunDebug(const rdcarray<uint32_t> &breakpoints, uint32_t maxSteps)
+{
+  ThreadState &active = GetActiveLane();
 
-            size_t insertPoint = state.callstack.size();
+  // rather than recording every change as we go, take a snapshot of everything visible before and
+  // after running and diff them. This means the cost of running is independent of how many steps
+  // we take, and a variable that changes on every iteration of a loop only appears once.
+  std::map<Id, ShaderVariable> before, after;
+  GetVisibleVariables(before);
 
-            // start with the current scope, it refers to the *inlined* function
-            if(inlined)
-            {
-              const ScopeData *scope = GetScope(endOffs);
-              // find the function parent of the current scope
-              while(scope && scope->parent && scope->type == DebugScope::Block)
-                scope = scope->parent;
+  ShaderDebugState ret;
 
-              state.callstack.insert(insertPoint, scope->name);
-            }
+  // entering the entry point counts as our first step, the same as with ContinueDebug. The changes
+  // it makes will be picked up in the diff below so we don't need to record them
+  if(steps == 0)
+  {
+    ShaderDebugState initial;
+    EnterEntryPoint(initial);
 
-            // if this instruction has no scope, don't give it a callstack
-            if(GetScope(endOffs) == NULL)
-            {
-              state.callstack.clear();
-            }
+    // debug info constants aren't live, so add them directly
+    if(m_DebugInfo.valid)
+    {
+      for(const Id &v : m_DebugInfo.constants)
+        ret.changes.push_back({ShaderVariable(), GetPointerValue(active.ids[v])});
+    }
+  }
 
-            // move to the next inline up on our inline stack. If we reach an actual function
-            // call, this parent will be NULL as there was no more inlining - the final scope will
-            // refer to the real function which is already on our stack
-            while(inlined && inlined->parent)
-            {
-              const ScopeData *scope = inlined->scope;
-              // find the function parent of the current scope
-              while(scope && scope->parent && scope->type == DebugScope::Block)
-                scope = scope->parent;
+  rdcarray<bool> activeMask;
+  uint32_t numSteps = 0;
+  bool hitBreakpoint = false;
 
-              state.callstack.insert(insertPoint, scope->name);
+  while(!hitBreakpoint && (maxSteps == 0 || numSteps < maxSteps))
+  {
+    global.clock++;
 
-              inlined = inlined->parent;
-            }
-          }
+    if(active.Finished())
+      break;
 
-          ret.push_back(std::move(state));
+    CalcActiveMask(activeMask);
 
-          steps++;
-        }
-        else
-        {
-          thread.StepNext(NULL, workgroup);
-        }
+    PrepareMathOps(activeMask);
+
+    for(size_t lane = 0; lane < workgroup.size(); lane++)
+    {
+      ThreadState &thread = workgroup[lane];
+
+      if(!activeMask[lane] || thread.nextInstruction >= instructionOffsets.size())
+        continue;
+
+      if(lane == activeLaneIndex)
+      {
+        RetireLiveIds(thread, NULL);
+
+        thread.StepNext(NULL, workgroup);
+
+        steps++;
+        numSteps++;
+
+        hitBreakpoint = breakpoints.contains(thread.nextInstruction);
+      }
+      else
+      {
+        thread.StepNext(NULL, workgroup);
       }
     }
   }
 
+  GetVisibleVariables(after);
+
+  // both maps are sorted by Id so we can walk them together. The variables carry their names, so
+  // two variables with the same name are still reported separately
+  auto b = before.begin();
+  auto a = after.begin();
+  while(b != before.end() || a != after.end())
+  {
+    if(a == after.end() || (b != before.end() && b->first < a->first))
+    {
+      // went out of scope
+      ret.changes.push_back({b->second, ShaderVariable()});
+      ++b;
+    }
+    else if(b == before.end() || a->first < b->first)
+    {
+      // came into scope
+      ret.changes.push_back({ShaderVariable(), a->second});
+      ++a;
+    }
+    else
+    {
+      if(!(b->second == a->second))
+        ret.changes.push_back({b->second, a->second});
+      ++b;
+      ++a;
+    }
+  }
+
+  // the state is that of the last step we took, the same as ContinueDebug would have returned last
+  ret.stepIndex = RDCMAX(steps, 1) - 1;
+  ret.nextInstruction = RDCMIN(active.nextInstruction, GetNumInstructions() - 1);
+
+  if(!active.Finished())
+  {
+    FillCallstack(active, ret);
+    FillInlineCallstack(active, ret);
+  }
+
   return ret;
 }
 
@@ -3311,6 +3627,15 @@ void Debugger::CalcActiveMask(rdcarray<bool> &activeMask)
   if(stage != ShaderStage::Pixel)
     return;
 
+  // if nothing in the shader can observe the other lanes then their execution can't affect the
+  // lane being debugged, so don't run them at all.
+  if(independentLanes)
+  {
+    for(size_t i = 0; i < workgroup.size(); i++)
+      activeMask[i] = activeMask[i] && (i == activeLaneIndex);
+    return;
+  }
+
   // otherwise we need to make sure that control flow which converges stays in lockstep so that
   // derivatives etc are still valid. While diverged, we don't have to keep threads in lockstep
   // since using derivatives is invalid.
@@ -3768,6 +4093,7 @@ void Debugger::PreParse(uint32_t maxId)
 
   strings.resize(idTypes.size());
   idLiveRange.resize(idTypes.size());
+  labelInstruction.resize(idTypes.size());
 
   m_InstInfo.reserve(idTypes.size());
 }
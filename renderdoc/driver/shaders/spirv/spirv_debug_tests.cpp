@@ -0,0 +1,853 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/globalconfig.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include <math.h>
+#include <functional>
+#include "common/timing.h"
+#include "core/core.h"
+#include "spirv_debug.h"
+#include "spirv_reflect.h"
+
+// must come after the other SPIR-V headers, which refer to the global ShaderStage
+#include "spirv_compile.h"
+
+#include "catch/catch.hpp"
+
+// defined next to RENDERDOC_AllocArrayMem
+extern void (*RENDERDOC_ArrayAllocHook)(uint64_t sz);
+
+static int64_t arrayAllocCount = 0;
+
+static void CountArrayAlloc(uint64_t)
+{
+  Atomic::Inc64(&arrayAllocCount);
+}
+
+// every shader in the corpus reads its inputs from and writes its outputs to this buffer at binding
+// 0, which is the first read-write resource.
+static const char *DataBuffer = R"(
+layout(local_size_x = 1) in;
+
+layout(binding = 0, std430) buffer Data
+{
+  uint inputs[4];
+  float outputs[12];
+} data;
+)";
+
+static const uint64_t OutputsOffset = sizeof(uint32_t) * 4;
+
+// A DebugAPIWrapper which does everything on the CPU, so the debugger can be exercised without a
+// GPU or a capture. Textures are procedural, and transcendental maths uses the C runtime instead of
+// being evaluated on the GPU.
+class CPUDebugAPIWrapper : public rdcspv::DebugAPIWrapper
+{
+public:
+  struct Allocation
+  {
+    uint64_t address;
+    bytebuf data;
+  };
+
+  // the values that fetches and image reads return, before anything is written
+  static ShaderVariable FetchValue(int32_t x, int32_t y)
+  {
+    return ShaderVariable(rdcstr(), float(x * 10 + y), float(x) + float(y) * 0.5f, 0.25f, 1.0f);
+  }
+
+  static ShaderVariable ImageValue(int32_t x, int32_t y)
+  {
+    return ShaderVariable(rdcstr(), float(x + 100), float(y + 200), 0.0f, 0.5f);
+  }
+
+  void AddDebugMessage(MessageCategory c, MessageSeverity sv, MessageSource src, rdcstr d) override
+  {
+    messages.push_back(d);
+  }
+
+  ResourceId GetShaderID() override { return ResourceId(); }
+
+  uint64_t GetBufferLength(ShaderBindIndex bind) override { return buffers[bind.index].size(); }
+
+  void ReadBufferValue(ShaderBindIndex bind, uint64_t offset, uint64_t byteSize, void *dst) override
+  {
+    const bytebuf &buf = buffers[bind.index];
+
+    // out of bounds reads return 0, as with robust buffer access
+    memset(dst, 0, (size_t)byteSize);
+    if(offset < buf.size())
+      memcpy(dst, buf.data() + offset, (size_t)RDCMIN(byteSize, buf.size() - offset));
+  }
+
+  void WriteBufferValue(ShaderBindIndex bind, uint64_t offset, uint64_t byteSize,
+                        const void *src) override
+  {
+    bytebuf &buf = buffers[bind.index];
+
+    if(offset < buf.size())
+      memcpy(buf.data() + offset, src, (size_t)RDCMIN(byteSize, buf.size() - offset));
+  }
+
+  void ReadAddress(uint64_t address, uint64_t byteSize, void *dst) override
+  {
+    memset(dst, 0, (size_t)byteSize);
+
+    Allocation *alloc = FindAllocation(address, byteSize);
+    if(alloc)
+      memcpy(dst, alloc->data.data() + (address - alloc->address), (size_t)byteSize);
+  }
+
+  void WriteAddress(uint64_t address, uint64_t byteSize, const void *src) override
+  {
+    Allocation *alloc = FindAllocation(address, byteSize);
+    if(alloc)
+      memcpy(alloc->data.data() + (address - alloc->address), src, (size_t)byteSize);
+  }
+
+  bool ReadTexel(ShaderBindIndex imageBind, const ShaderVariable &coord, uint32_t sample,
+                 ShaderVariable &output) override
+  {
+    rdcpair<int32_t, int32_t> key = {coord.value.s32v[0], coord.value.s32v[1]};
+
+    auto it = texels.find(key);
+    ShaderVariable value =
+        it != texels.end() ? it->second : ImageValue(coord.value.s32v[0], coord.value.s32v[1]);
+
+    output.value = value.value;
+    return true;
+  }
+
+  bool WriteTexel(ShaderBindIndex imageBind, const ShaderVariable &coord, uint32_t sample,
+                  const ShaderVariable &value) override
+  {
+    texels[{coord.value.s32v[0], coord.value.s32v[1]}] = value;
+    return true;
+  }
+
+  void FillInputValue(ShaderVariable &var, ShaderBuiltin builtin, uint32_t location,
+                      uint32_t component) override
+  {
+    auto it = builtins.find(builtin);
+    if(it != builtins.end())
+      var.value = it->second.value;
+  }
+
+  bool CalculateSampleGather(rdcspv::ThreadState &lane, rdcspv::Op opcode, TextureType texType,
+                             ShaderBindIndex imageBind, ShaderBindIndex samplerBind,
+                             const ShaderVariable &uv, const ShaderVariable &ddxCalc,
+                             const ShaderVariable &ddyCalc, const ShaderVariable &compare,
+                             rdcspv::GatherChannel gatherChannel,
+                             const rdcspv::ImageOperandsAndParamDatas &operands,
+                             ShaderVariable &output) override
+  {
+    // filtering isn't implemented, only fetches of float textures
+    if(opcode != rdcspv::Op::ImageFetch || texType != Float_Texture)
+      return false;
+
+    output.value = FetchValue(uv.value.s32v[0], uv.value.s32v[1]).value;
+    return true;
+  }
+
+  void PrepareMathOps(const rdcarray<MathOp> &ops) override
+  {
+    for(const MathOp &op : ops)
+    {
+      rdcarray<ShaderVariable> params;
+      for(uint32_t i = 0; i < op.numParams; i++)
+        params.push_back(*op.params[i]);
+      preparedMathOps.push_back(MathOpBytes(op.op, params));
+    }
+  }
+
+  bool CalculateMathOp(rdcspv::ThreadState &lane, rdcspv::GLSLstd450 op,
+                       const rdcarray<ShaderVariable> &params, ShaderVariable &output) override
+  {
+    mathOps++;
+
+    if(preparedMathOps.contains(MathOpBytes(op, params)))
+      preparedMathOpHits++;
+
+    // the debugger handles other types itself before they get here in practice, but 32-bit float
+    // is all the corpus needs
+    for(const ShaderVariable &p : params)
+      if(p.type != VarType::Float)
+        return false;
+
+    const ShaderVariable &a = params[0];
+    const ShaderVariable &b = params.size() > 1 ? params[1] : params[0];
+    const ShaderVariable &c = params.size() > 2 ? params[2] : params[0];
+
+    if(op == rdcspv::GLSLstd450::Length || op == rdcspv::GLSLstd450::Distance)
+    {
+      float sum = 0.0f;
+      for(uint8_t i = 0; i < a.columns; i++)
+      {
+        float d = a.value.f32v[i];
+        if(op == rdcspv::GLSLstd450::Distance)
+          d -= b.value.f32v[i];
+        sum += d * d;
+      }
+
+      output.columns = 1;
+      output.value.f32v[0] = sqrtf(sum);
+      return true;
+    }
+
+    for(uint8_t i = 0; i < a.columns; i++)
+    {
+      float x = a.value.f32v[i], y = b.value.f32v[i], z = c.value.f32v[i];
+      float &ret = output.value.f32v[i];
+
+      switch(op)
+      {
+        case rdcspv::GLSLstd450::Sin: ret = sinf(x); break;
+        case rdcspv::GLSLstd450::Cos: ret = cosf(x); break;
+        case rdcspv::GLSLstd450::Tan: ret = tanf(x); break;
+        case rdcspv::GLSLstd450::Asin: ret = asinf(x); break;
+        case rdcspv::GLSLstd450::Acos: ret = acosf(x); break;
+        case rdcspv::GLSLstd450::Atan: ret = atanf(x); break;
+        case rdcspv::GLSLstd450::Sinh: ret = sinhf(x); break;
+        case rdcspv::GLSLstd450::Cosh: ret = coshf(x); break;
+        case rdcspv::GLSLstd450::Tanh: ret = tanhf(x); break;
+        case rdcspv::GLSLstd450::Asinh: ret = asinhf(x); break;
+        case rdcspv::GLSLstd450::Acosh: ret = acoshf(x); break;
+        case rdcspv::GLSLstd450::Atanh: ret = atanhf(x); break;
+        case rdcspv::GLSLstd450::Atan2: ret = atan2f(x, y); break;
+        case rdcspv::GLSLstd450::Pow: ret = powf(x, y); break;
+        case rdcspv::GLSLstd450::Exp: ret = expf(x); break;
+        case rdcspv::GLSLstd450::Log: ret = logf(x); break;
+        case rdcspv::GLSLstd450::Exp2: ret = exp2f(x); break;
+        case rdcspv::GLSLstd450::Log2: ret = log2f(x); break;
+        case rdcspv::GLSLstd450::Sqrt: ret = sqrtf(x); break;
+        case rdcspv::GLSLstd450::InverseSqrt: ret = 1.0f / sqrtf(x); break;
+        case rdcspv::GLSLstd450::Fma: ret = fmaf(x, y, z); break;
+        default: return false;
+      }
+    }
+
+    return true;
+  }
+
+  DerivativeDeltas GetDerivative(ShaderBuiltin builtin, uint32_t location, uint32_t component,
+                                 VarType type) override
+  {
+    // only compute shaders are debugged here, which have no derivatives
+    return DerivativeDeltas();
+  }
+
+  std::map<uint32_t, bytebuf> buffers;
+  rdcarray<Allocation> memory;
+  std::map<rdcpair<int32_t, int32_t>, ShaderVariable> texels;
+  std::map<ShaderBuiltin, ShaderVariable> builtins;
+
+  rdcarray<rdcstr> messages;
+  uint64_t mathOps = 0;
+  uint64_t preparedMathOpHits = 0;
+
+private:
+  // the operation and the bytes of each parameter, to compare what was prepared with what was
+  // later calculated
+  static bytebuf MathOpBytes(rdcspv::GLSLstd450 op, const rdcarray<ShaderVariable> &params)
+  {
+    bytebuf ret((const byte *)&op, sizeof(op));
+    for(const ShaderVariable &p : params)
+      ret.append((const byte *)p.value.u8v.data(), VarTypeByteSize(p.type) * p.columns);
+    return ret;
+  }
+
+  rdcarray<bytebuf> preparedMathOps;
+
+  Allocation *FindAllocation(uint64_t address, uint64_t byteSize)
+  {
+    for(Allocation &alloc : memory)
+    {
+      if(address >= alloc.address && address + byteSize <= alloc.address + alloc.data.size())
+        return &alloc;
+    }
+
+    return NULL;
+  }
+};
+
+static rdcarray<uint32_t> CompileCompute(const rdcstr &source, uint32_t spirvVersion = 0,
+                                         bool nonSemanticDebugInfo = false)
+{
+  rdcspv::Init();
+  RenderDoc::Inst().RegisterShutdownFunction(&rdcspv::Shutdown);
+
+  rdcarray<uint32_t> spirv;
+  rdcspv::CompilationSettings settings(rdcspv::InputLanguage::VulkanGLSL,
+                                       rdcspv::ShaderStage::Compute);
+  settings.debugInfo = true;
+  settings.nonSemanticDebugInfo = nonSemanticDebugInfo;
+  settings.spirvVersion = spirvVersion;
+
+  rdcstr errors = rdcspv::Compile(settings, {source}, spirv);
+
+  INFO("SPIR-V compile output: " << errors);
+
+  REQUIRE(!spirv.empty());
+
+  return spirv;
+}
+
+enum class DebugMode
+{
+  // fetch every state with ContinueDebug, as the UI does
+  Continue,
+  // run straight to the end with RunDebug
+  Run,
+};
+
+struct DebugRun
+{
+  rdcarray<ShaderDebugState> states;
+  uint32_t steps = 0;
+
+  rdcarray<InstructionSourceInfo> instInfo;
+  rdcarray<SourceVariableMapping> sourceVars;
+
+  // the state of the resources after debugging
+  std::map<uint32_t, bytebuf> buffers;
+  rdcarray<CPUDebugAPIWrapper::Allocation> memory;
+  std::map<rdcpair<int32_t, int32_t>, ShaderVariable> texels;
+
+  rdcarray<rdcstr> messages;
+  uint64_t mathOps = 0;
+  uint64_t preparedMathOpHits = 0;
+
+  float Output(uint32_t idx) const
+  {
+    float ret = 0.0f;
+    const bytebuf &buf = buffers.at(0);
+    memcpy(&ret, buf.data() + OutputsOffset + idx * sizeof(float), sizeof(float));
+    return ret;
+  }
+};
+
+static DebugRun DebugCompute(const rdcarray<uint32_t> &spirv, DebugMode mode,
+                             const rdcarray<uint32_t> &inputs,
+                             std::function<void(CPUDebugAPIWrapper &)> setup = {})
+{
+  rdcspv::Reflector reflector;
+  reflector.Parse(spirv);
+
+  ShaderReflection refl;
+  SPIRVPatchData patchData;
+  reflector.MakeReflection(GraphicsAPI::Vulkan, ShaderStage::Compute, "main", {}, refl,
+                           patchData);
+
+  std::map<size_t, uint32_t> instructionLines;
+  reflector.Disassemble("main", instructionLines);
+
+  // owned by the debugger
+  CPUDebugAPIWrapper *api = new CPUDebugAPIWrapper;
+
+  ShaderVariable zero(rdcstr(), 0U, 0U, 0U, 0U);
+  api->builtins[ShaderBuiltin::DispatchThreadIndex] = zero;
+  api->builtins[ShaderBuiltin::GroupIndex] = zero;
+  api->builtins[ShaderBuiltin::GroupThreadIndex] = zero;
+  api->builtins[ShaderBuiltin::GroupFlatIndex] = zero;
+  api->builtins[ShaderBuiltin::DeviceIndex] = zero;
+  api->builtins[ShaderBuiltin::DispatchSize] = ShaderVariable(rdcstr(), 1U, 1U, 1U, 0U);
+  api->builtins[ShaderBuiltin::GroupSize] = ShaderVariable(rdcstr(), 1U, 1U, 1U, 0U);
+
+  bytebuf &data = api->buffers[0];
+  data.resize(size_t(OutputsOffset + sizeof(float) * 12));
+  memcpy(data.data(), inputs.data(), RDCMIN(inputs.byteSize(), (size_t)OutputsOffset));
+
+  if(setup)
+    setup(*api);
+
+  rdcspv::Debugger *debugger = new rdcspv::Debugger;
+  debugger->Parse(spirv);
+  ShaderDebugTrace *trace = debugger->BeginDebug(api, ShaderStage::Compute, "main", {},
+                                                 instructionLines, patchData, 0);
+
+  DebugRun ret;
+
+  if(mode == DebugMode::Continue)
+  {
+    // guard against the debugger never finishing
+    for(int chunk = 0; chunk < 100000; chunk++)
+    {
+      rdcarray<ShaderDebugState> states = debugger->ContinueDebug();
+      if(states.empty())
+        break;
+      ret.states.append(states);
+    }
+
+    if(!ret.states.empty())
+      ret.steps = ret.states.back().stepIndex + 1;
+  }
+  else
+  {
+    ret.states.push_back(debugger->RunDebug({}, 0));
+    ret.steps = ret.states.back().stepIndex + 1;
+  }
+
+  ret.instInfo = trace->instInfo;
+  ret.sourceVars = trace->sourceVars;
+  ret.buffers = api->buffers;
+  ret.memory = api->memory;
+  ret.texels = api->texels;
+  ret.messages = api->messages;
+  ret.mathOps = api->mathOps;
+  ret.preparedMathOpHits = api->preparedMathOpHits;
+
+  delete trace;
+  delete debugger;
+
+  return ret;
+}
+
+// debug the shader both ways, and check they agree on the results
+static DebugRun DebugComputeBothWays(const rdcarray<uint32_t> &spirv,
+                                     const rdcarray<uint32_t> &inputs,
+                                     std::function<void(CPUDebugAPIWrapper &)> setup = {})
+{
+  DebugRun stepped = DebugCompute(spirv, DebugMode::Continue, inputs, setup);
+  DebugRun run = DebugCompute(spirv, DebugMode::Run, inputs, setup);
+
+  rdcstr messages;
+  for(const rdcstr &msg : stepped.messages)
+    messages += msg + "\n";
+  CHECK(messages == "");
+
+  CHECK(stepped.steps > 1);
+  CHECK(run.steps == stepped.steps);
+  CHECK((run.buffers == stepped.buffers));
+
+  return stepped;
+}
+
+static const char *LoopShader = R"(
+struct Accum
+{
+  float sum;
+  uint count;
+};
+
+Accum add(Accum a, float v)
+{
+  a.sum += v;
+  a.count++;
+  return a;
+}
+
+void scale(inout float arr[4], uint idx, float s)
+{
+  arr[idx] *= s;
+}
+
+void main()
+{
+  Accum acc = Accum(0.0, 0u);
+  for(uint i = 0u; i < data.inputs[0]; i++)
+  {
+    if((i & 1u) == 0u)
+      acc = add(acc, float(i));
+    else
+      acc.sum -= 0.5;
+  }
+
+  uint fib[8];
+  fib[0] = 0u;
+  fib[1] = 1u;
+  for(int i = 2; i < 8; i++)
+    fib[i] = fib[i - 1] + fib[i - 2];
+
+  float arr[4] = float[4](1.0, 2.0, 3.0, 4.0);
+  scale(arr, data.inputs[1], 10.0);
+
+  uint n = data.inputs[2];
+  uint steps = 0u;
+  while(n > 1u)
+  {
+    n = (n & 1u) != 0u ? n * 3u + 1u : n / 2u;
+    steps++;
+  }
+
+  data.outputs[0] = acc.sum;
+  data.outputs[1] = float(acc.count);
+  data.outputs[2] = float(fib[7] + fib[data.inputs[1]]);
+  data.outputs[3] = arr[0] + arr[1] + arr[2] + arr[3];
+  data.outputs[4] = float(steps);
+}
+)";
+
+// the same calculation as LoopShader
+static rdcarray<float> LoopShaderExpected(const rdcarray<uint32_t> &inputs)
+{
+  float sum = 0.0f;
+  uint32_t count = 0;
+  for(uint32_t i = 0; i < inputs[0]; i++)
+  {
+    if((i & 1) == 0)
+    {
+      sum += float(i);
+      count++;
+    }
+    else
+    {
+      sum -= 0.5f;
+    }
+  }
+
+  uint32_t fib[8] = {0, 1};
+  for(int i = 2; i < 8; i++)
+    fib[i] = fib[i - 1] + fib[i - 2];
+
+  float arr[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+  arr[inputs[1]] *= 10.0f;
+
+  uint32_t n = inputs[2], steps = 0;
+  while(n > 1)
+  {
+    n = (n & 1) ? n * 3 + 1 : n / 2;
+    steps++;
+  }
+
+  return {sum, float(count), float(fib[7] + fib[inputs[1]]), arr[0] + arr[1] + arr[2] + arr[3],
+          float(steps)};
+}
+
+TEST_CASE("Debug SPIR-V on the CPU", "[spirv][debugger]")
+{
+  SECTION("Loops, functions and local pointers")
+  {
+    rdcarray<uint32_t> inputs = {10, 3, 27, 0};
+
+    DebugRun run = DebugComputeBothWays(CompileCompute(rdcstr("#version 450\n") + DataBuffer +
+                                                       LoopShader),
+                                        inputs);
+
+    rdcarray<float> expected = LoopShaderExpected(inputs);
+    for(uint32_t i = 0; i < expected.size(); i++)
+      CHECK(run.Output(i) == expected[i]);
+
+    // every state was returned, in order
+    REQUIRE(run.states.size() == run.steps);
+    for(uint32_t i = 0; i < run.states.size(); i++)
+      CHECK(run.states[i].stepIndex == i);
+
+    // some of those steps were inside a function
+    bool calledFunction = false;
+    for(const ShaderDebugState &state : run.states)
+      calledFunction |= state.callstack.size() > 1;
+    CHECK(calledFunction);
+  };
+
+  SECTION("GLSL.std.450 maths")
+  {
+    rdcarray<uint32_t> inputs = {3, 5, 7, 11};
+
+    DebugRun run = DebugComputeBothWays(CompileCompute(rdcstr("#version 450\n") + DataBuffer + R"(
+void main()
+{
+  vec4 v = vec4(data.inputs[0], data.inputs[1], data.inputs[2], data.inputs[3]) * 0.25;
+
+  data.outputs[0] = sin(v.x);
+  data.outputs[1] = pow(v.z, v.w);
+  data.outputs[2] = sqrt(v.w);
+  data.outputs[3] = length(v.xyz);
+  data.outputs[4] = fract(v.w * 10.0);
+  data.outputs[5] = clamp(v.w, 0.0, 1.0);
+  data.outputs[6] = atan(v.y, v.z);
+  data.outputs[7] = inversesqrt(v.z);
+  data.outputs[8] = exp2(v.y);
+  data.outputs[9] = fma(v.x, v.y, v.z);
+  data.outputs[10] = distance(v.xy, v.zw);
+  data.outputs[11] = mix(v.x, v.y, 0.25);
+}
+)"),
+                                        inputs);
+
+    float x = 0.75f, y = 1.25f, z = 1.75f, w = 2.75f;
+
+    CHECK(run.Output(0) == Approx(sinf(x)));
+    CHECK(run.Output(1) == Approx(powf(z, w)));
+    CHECK(run.Output(2) == Approx(sqrtf(w)));
+    CHECK(run.Output(3) == Approx(sqrtf(x * x + y * y + z * z)));
+    CHECK(run.Output(4) == Approx(0.5f));
+    CHECK(run.Output(5) == 1.0f);
+    CHECK(run.Output(6) == Approx(atan2f(y, z)));
+    CHECK(run.Output(7) == Approx(1.0f / sqrtf(z)));
+    CHECK(run.Output(8) == Approx(exp2f(y)));
+    CHECK(run.Output(9) == Approx(x * y + z));
+    CHECK(run.Output(10) == Approx(sqrtf((x - z) * (x - z) + (y - w) * (y - w))));
+    CHECK(run.Output(11) == Approx(x + (y - x) * 0.25f));
+
+    // the transcendentals went through the API wrapper, at least once for each of the above
+    CHECK(run.mathOps >= 9);
+
+    // each was prepared ahead of time with the parameters it was then calculated with
+    CHECK(run.preparedMathOpHits == run.mathOps);
+  };
+
+  SECTION("Texel fetches and storage images")
+  {
+    rdcarray<uint32_t> inputs = {5, 7, 0, 0};
+
+    DebugRun run = DebugComputeBothWays(CompileCompute(rdcstr("#version 450\n") + DataBuffer + R"(
+layout(binding = 1) uniform sampler2D tex;
+layout(binding = 2, rgba32f) uniform image2D img;
+
+void main()
+{
+  ivec2 c = ivec2(data.inputs[0], data.inputs[1]);
+
+  vec4 t = texelFetch(tex, c, 0);
+  vec4 i = imageLoad(img, c + ivec2(1, 0));
+  imageStore(img, c, t + i);
+
+  data.outputs[0] = t.x;
+  data.outputs[1] = t.y;
+  data.outputs[2] = i.x;
+  data.outputs[3] = i.w;
+}
+)"),
+                                        inputs);
+
+    ShaderVariable t = CPUDebugAPIWrapper::FetchValue(5, 7);
+    ShaderVariable i = CPUDebugAPIWrapper::ImageValue(6, 7);
+
+    CHECK(run.Output(0) == t.value.f32v[0]);
+    CHECK(run.Output(1) == t.value.f32v[1]);
+    CHECK(run.Output(2) == i.value.f32v[0]);
+    CHECK(run.Output(3) == i.value.f32v[3]);
+
+    REQUIRE(run.texels.size() == 1);
+    const ShaderVariable &stored = run.texels.begin()->second;
+    CHECK((run.texels.begin()->first == make_rdcpair(5, 7)));
+    for(int c = 0; c < 4; c++)
+      CHECK(stored.value.f32v[c] == t.value.f32v[c] + i.value.f32v[c]);
+  };
+
+  SECTION("Subgroup operations")
+  {
+    rdcarray<uint32_t> inputs = {0x3, 0x5, 0, 0};
+
+    DebugRun run = DebugComputeBothWays(CompileCompute(rdcstr("#version 450\n"
+                                                              "#extension "
+                                                              "GL_KHR_shader_subgroup_arithmetic"
+                                                              " : require\n") +
+                                                           DataBuffer + R"(
+void main()
+{
+  uint v = data.inputs[0] | (data.inputs[1] << 4u);
+
+  uint accum = 0u;
+  for(uint i = 0u; i < 4u; i++)
+    accum += subgroupOr(v >> i);
+
+  data.outputs[0] = float(subgroupOr(v));
+  data.outputs[1] = float(accum);
+}
+)",
+                                                       0x10300),
+                                        inputs);
+
+    // with a single invocation in the subgroup, the result is just the value
+    uint32_t v = 0x53;
+    CHECK(run.Output(0) == float(v));
+    CHECK(run.Output(1) == float(v + (v >> 1) + (v >> 2) + (v >> 3)));
+  };
+
+  SECTION("Buffer device address")
+  {
+    rdcarray<uint32_t> inputs = {8, 0, 0, 0};
+
+    const uint64_t srcAddress = 0x100000000ULL, dstAddress = 0x200000000ULL;
+
+    auto setup = [=](CPUDebugAPIWrapper &api) {
+      api.buffers[1].resize(sizeof(uint64_t) * 2);
+      memcpy(api.buffers[1].data(), &srcAddress, sizeof(uint64_t));
+      memcpy(api.buffers[1].data() + sizeof(uint64_t), &dstAddress, sizeof(uint64_t));
+
+      CPUDebugAPIWrapper::Allocation src, dst;
+      src.address = srcAddress;
+      src.data.resize(sizeof(float) * 8);
+      for(uint32_t i = 0; i < 8; i++)
+      {
+        float f = float(i) + 0.5f;
+        memcpy(src.data.data() + i * sizeof(float), &f, sizeof(float));
+      }
+      dst.address = dstAddress;
+      dst.data.resize(sizeof(float) * 8);
+
+      api.memory = {src, dst};
+    };
+
+    DebugRun run = DebugComputeBothWays(CompileCompute(rdcstr("#version 450\n"
+                                                              "#extension GL_EXT_buffer_reference"
+                                                              " : require\n") +
+                                                           DataBuffer + R"(
+layout(buffer_reference, std430, buffer_reference_align = 4) buffer FloatData
+{
+  float v[];
+};
+
+layout(binding = 1, std430) buffer Pointers
+{
+  FloatData src;
+  FloatData dst;
+} ptrs;
+
+void main()
+{
+  FloatData src = ptrs.src;
+
+  float sum = 0.0;
+  for(uint i = 0u; i < data.inputs[0]; i++)
+  {
+    sum += src.v[i];
+    ptrs.dst.v[i] = src.v[i] * 2.0;
+  }
+
+  data.outputs[0] = sum;
+}
+)",
+                                                       0x10500),
+                                        inputs, setup);
+
+    CHECK(run.Output(0) == 32.0f);
+
+    REQUIRE(run.memory.size() == 2);
+    for(uint32_t i = 0; i < 8; i++)
+    {
+      float f = 0.0f;
+      memcpy(&f, run.memory[1].data.data() + i * sizeof(float), sizeof(float));
+      CHECK(f == float(i) * 2.0f + 1.0f);
+    }
+  };
+
+  SECTION("Shader debug info")
+  {
+    rdcarray<uint32_t> inputs = {6, 1, 7, 0};
+
+    DebugRun run = DebugComputeBothWays(CompileCompute(rdcstr("#version 450\n") + DataBuffer +
+                                                           LoopShader,
+                                                       0x10600, true),
+                                        inputs);
+
+    rdcarray<float> expected = LoopShaderExpected(inputs);
+    for(uint32_t i = 0; i < expected.size(); i++)
+      CHECK(run.Output(i) == expected[i]);
+
+    // instructions are mapped back to the source
+    bool hasLines = false;
+    for(const InstructionSourceInfo &info : run.instInfo)
+      hasLines |= info.lineInfo.fileIndex >= 0 && info.lineInfo.lineStart > 0;
+    CHECK(hasLines);
+
+    // and variable changes come with source names
+    bool hasSourceVars = !run.sourceVars.empty();
+    for(const InstructionSourceInfo &info : run.instInfo)
+      hasSourceVars |= !info.sourceVars.empty();
+    CHECK(hasSourceVars);
+
+    bool calledAdd = false;
+    for(const ShaderDebugState &state : run.states)
+      calledAdd |= state.callstack.size() > 1 && state.callstack.back().contains("add");
+    CHECK(calledAdd);
+  };
+};
+
+TEST_CASE("Benchmark SPIR-V debugging on the CPU", "[spirv][debugger][.][benchmark]")
+{
+  rdcarray<uint32_t> inputs = {400, 2, 97, 0};
+
+  rdcarray<uint32_t> spirv =
+      CompileCompute(rdcstr("#version 450\n") + DataBuffer + LoopShader, 0x10600, true);
+
+  const int iterations = 10;
+
+  uint64_t totalSteps = 0, totalChunks = 0;
+  int64_t allocs = 0;
+  double totalMs = 0.0, maxChunkMs = 0.0;
+
+  for(int iter = 0; iter < iterations; iter++)
+  {
+    rdcspv::Reflector reflector;
+    reflector.Parse(spirv);
+
+    ShaderReflection refl;
+    SPIRVPatchData patchData;
+    reflector.MakeReflection(GraphicsAPI::Vulkan, ShaderStage::Compute, "main", {}, refl,
+                             patchData);
+
+    std::map<size_t, uint32_t> instructionLines;
+    reflector.Disassemble("main", instructionLines);
+
+    CPUDebugAPIWrapper *api = new CPUDebugAPIWrapper;
+    api->buffers[0].resize(size_t(OutputsOffset + sizeof(float) * 12));
+    memcpy(api->buffers[0].data(), inputs.data(), inputs.byteSize());
+
+    rdcspv::Debugger *debugger = new rdcspv::Debugger;
+    debugger->Parse(spirv);
+    ShaderDebugTrace *trace = debugger->BeginDebug(api, ShaderStage::Compute, "main", {},
+                                                   instructionLines, patchData, 0);
+
+    arrayAllocCount = 0;
+    RENDERDOC_ArrayAllocHook = &CountArrayAlloc;
+
+    for(;;)
+    {
+      PerformanceTimer timer;
+      rdcarray<ShaderDebugState> states = debugger->ContinueDebug();
+      double ms = timer.GetMilliseconds();
+
+      if(states.empty())
+        break;
+
+      totalMs += ms;
+      maxChunkMs = RDCMAX(maxChunkMs, ms);
+      totalChunks++;
+      totalSteps = states.back().stepIndex + 1;
+    }
+
+    RENDERDOC_ArrayAllocHook = NULL;
+    allocs += arrayAllocCount;
+
+    CHECK(api->messages.empty());
+
+    delete trace;
+    delete debugger;
+  }
+
+  totalSteps *= iterations;
+
+  RDCLOG("Stepped %llu instructions in %.3lf ms: %.0lf steps/sec", totalSteps, totalMs,
+         double(totalSteps) * 1000.0 / totalMs);
+  RDCLOG("ContinueDebug latency: %.3lf ms average, %.3lf ms max over %llu calls",
+         totalMs / double(totalChunks), maxChunkMs, totalChunks);
+  RDCLOG("%.1lf array allocations per step", double(allocs) / double(totalSteps));
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -367,6 +367,10 @@ bool VkInitParams::IsSupportedVersion(uint64_t ver)
   if(ver == CurrentVersion)
     return true;
 
+  // 0x16 -> 0x17 - device memory initial contents can store only the referenced ranges
+  if(ver == 0x16)
+    return true;
+
   // 0x15 -> 0x16 - added support for acceleration structures
   if(ver == 0x15)
     return true;
@@ -1252,6 +1256,44 @@ void DescriptorSetSlot::SetAccelerationStructure(VkDescriptorType writeType,
   resource = GetResID(accelerationStructure);
 }
 
+void DescriptorFrameRefs::Add(ResourceId id, FrameRefType ref, bool disjoint)
+{
+  // both compositions are associative, so a run of references with the same composition can be
+  // folded together before being composed with whatever came earlier.
+  if(!entries.empty())
+  {
+    Entry &last = entries.back();
+    if(last.id == id && last.disjoint == disjoint)
+    {
+      last.ref = disjoint ? ComposeFrameRefsDisjoint(last.ref, ref)
+                          : ComposeFrameRefsUnordered(last.ref, ref);
+      return;
+    }
+  }
+
+  entries.push_back({id, ref, disjoint});
+}
+
+void DescriptorFrameRefs::Resolve()
+{
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const Entry &a, const Entry &b) { return a.id < b.id; });
+
+  refs.clear();
+
+  for(const Entry &e : entries)
+  {
+    if(refs.empty() || refs.back().first != e.id)
+      refs.push_back({e.id, eFrameRef_None});
+
+    FrameRefType &p = refs.back().second;
+    // be conservative - mark refs as read before write if we see a write and a read ref on it
+    p = e.disjoint ? ComposeFrameRefsDisjoint(p, e.ref) : ComposeFrameRefsUnordered(p, e.ref);
+  }
+
+  entries.clear();
+}
+
 void AddBindFrameRef(DescriptorBindRefs &refs, ResourceId id, FrameRefType ref)
 {
   if(id == ResourceId())
@@ -1259,9 +1301,7 @@ void AddBindFrameRef(DescriptorBindRefs &refs, ResourceId id, FrameRefType ref)
     RDCERR("Unexpected NULL resource ID being added as a bind frame ref");
     return;
   }
-  FrameRefType &p = refs.bindFrameRefs[id];
-  // be conservative - mark refs as read before write if we see a write and a read ref on it
-  p = ComposeFrameRefsUnordered(p, ref);
+  refs.bindFrameRefs.Add(id, ref, false);
 }
 
 void AddImgFrameRef(DescriptorBindRefs &refs, VkResourceRecord *view, FrameRefType refType)
@@ -1272,8 +1312,6 @@ void AddImgFrameRef(DescriptorBindRefs &refs, VkResourceRecord *view, FrameRefTy
   if(view->baseResourceMem != ResourceId())
     AddBindFrameRef(refs, view->baseResourceMem, eFrameRef_Read);
 
-  FrameRefType &p = refs.bindFrameRefs[view->baseResource];
-
   ImageRange imgRange = ImageRange((VkImageSubresourceRange)view->viewRange);
   imgRange.viewType = view->viewRange.viewType();
 
@@ -1281,7 +1319,7 @@ void AddImgFrameRef(DescriptorBindRefs &refs, VkResourceRecord *view, FrameRefTy
       MarkImageReferenced(refs.bindImageStates, view->baseResource, view->resInfo->imageInfo,
                           ImageSubresourceRange(imgRange), VK_QUEUE_FAMILY_IGNORED, refType);
 
-  p = ComposeFrameRefsDisjoint(p, maxRef);
+  refs.bindFrameRefs.Add(view->baseResource, maxRef, true);
 }
 
 void AddMemFrameRef(DescriptorBindRefs &refs, ResourceId mem, VkDeviceSize offset,
@@ -1292,10 +1330,9 @@ void AddMemFrameRef(DescriptorBindRefs &refs, ResourceId mem, VkDeviceSize offse
     RDCERR("Unexpected NULL resource ID being added as a bind frame ref");
     return;
   }
-  FrameRefType &p = refs.bindFrameRefs[mem];
   FrameRefType maxRef =
       MarkMemoryReferenced(refs.bindMemRefs, mem, offset, size, refType, ComposeFrameRefsUnordered);
-  p = ComposeFrameRefsDisjoint(p, maxRef);
+  refs.bindFrameRefs.Add(mem, maxRef, true);
 }
 
 void DescriptorSetSlot::AccumulateBindRefs(DescriptorBindRefs &refs, VulkanResourceManager *rm) const
@@ -1617,4 +1654,99 @@ TEST_CASE("Validate CombineDepthStencilLayouts works", "[vulkan]")
   };
 }
 
+// a descriptor-heavy set: arrays of views of a handful of resources, with storage descriptors
+// reading and writing, and images and memory composed disjointly from their subresource states.
+static void MakeDescriptorRefs(rdcarray<ResourceId> &ids, uint32_t numRefs,
+                               rdcarray<rdcpair<ResourceId, rdcpair<FrameRefType, bool>>> &refs)
+{
+  const FrameRefType refTypes[] = {eFrameRef_Read, eFrameRef_Read, eFrameRef_ReadBeforeWrite,
+                                   eFrameRef_PartialWrite, eFrameRef_CompleteWrite};
+
+  uint32_t seed = 0x1234567;
+  auto next = [&seed]() {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) & 0xffffff;
+  };
+
+  refs.clear();
+  while(refs.size() < numRefs)
+  {
+    ResourceId id = ids[next() % ids.size()];
+    FrameRefType ref = refTypes[next() % ARRAY_COUNT(refTypes)];
+    bool disjoint = (next() % 4) == 0;
+
+    // runs of the same resource, as from an array of descriptors
+    uint32_t run = 1 + next() % 16;
+    for(uint32_t i = 0; i < run; i++)
+      refs.push_back({id, {ref, disjoint}});
+  }
+}
+
+TEST_CASE("Check DescriptorFrameRefs matches composing into a map", "[vulkan]")
+{
+  rdcarray<ResourceId> ids;
+  for(uint32_t i = 0; i < 64; i++)
+    ids.push_back(ResourceIDGen::GetNewUniqueID());
+
+  rdcarray<rdcpair<ResourceId, rdcpair<FrameRefType, bool>>> refs;
+  MakeDescriptorRefs(ids, 5000, refs);
+
+  std::unordered_map<ResourceId, FrameRefType> expected;
+  DescriptorFrameRefs packed;
+
+  for(const rdcpair<ResourceId, rdcpair<FrameRefType, bool>> &r : refs)
+  {
+    FrameRefType &p = expected[r.first];
+    p = r.second.second ? ComposeFrameRefsDisjoint(p, r.second.first)
+                        : ComposeFrameRefsUnordered(p, r.second.first);
+
+    packed.Add(r.first, r.second.first, r.second.second);
+  }
+
+  packed.Resolve();
+
+  REQUIRE(packed.refs.size() == expected.size());
+  for(size_t i = 0; i < packed.refs.size(); i++)
+  {
+    if(i > 0)
+      CHECK(packed.refs[i - 1].first < packed.refs[i].first);
+    CHECK(packed.refs[i].second == expected[packed.refs[i].first]);
+  }
+};
+
+TEST_CASE("Benchmark descriptor frame reference tracking", "[vulkan][.][benchmark]")
+{
+  rdcarray<ResourceId> ids;
+  for(uint32_t i = 0; i < 4096; i++)
+    ids.push_back(ResourceIDGen::GetNewUniqueID());
+
+  rdcarray<rdcpair<ResourceId, rdcpair<FrameRefType, bool>>> refs;
+  MakeDescriptorRefs(ids, 1000000, refs);
+
+  PerformanceTimer timer;
+
+  std::unordered_map<ResourceId, FrameRefType> hashed;
+  for(const rdcpair<ResourceId, rdcpair<FrameRefType, bool>> &r : refs)
+  {
+    FrameRefType &p = hashed[r.first];
+    p = r.second.second ? ComposeFrameRefsDisjoint(p, r.second.first)
+                        : ComposeFrameRefsUnordered(p, r.second.first);
+  }
+
+  double hashedTime = timer.GetMilliseconds();
+  timer.Restart();
+
+  DescriptorFrameRefs packed;
+  for(const rdcpair<ResourceId, rdcpair<FrameRefType, bool>> &r : refs)
+    packed.Add(r.first, r.second.first, r.second.second);
+  packed.Resolve();
+
+  double packedTime = timer.GetMilliseconds();
+
+  CHECK(packed.refs.size() == hashed.size());
+
+  RDCLOG("%zu descriptor references to %zu resources: %.3lf ms hashed, %.3lf ms packed",
+         refs.size(), hashed.size(), hashedTime, packedTime);
+};
+
 #endif
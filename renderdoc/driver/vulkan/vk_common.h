@@ -456,6 +456,9 @@ enum class MemoryScope : uint8_t
   IndirectReadback,
   // Same as initial contents but freed after first Serialise/Apply cycle
   InitialContentsFirstApplyOnly,
+  // Initial contents staging uploaded on demand by the residency manager. Only reset or freed as
+  // a whole
+  InitialContentsResident,
   Count,
 };
 
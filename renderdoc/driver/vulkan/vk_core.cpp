@@ -25,6 +25,7 @@
 #include "vk_core.h"
 #include <ctype.h>
 #include <algorithm>
+#include "core/content_delta.h"
 #include "core/settings.h"
 #include "driver/ihv/amd/amd_rgp.h"
 #include "driver/shaders/spirv/spirv_compile.h"
@@ -34,10 +35,12 @@
 #include "strings/string_utils.h"
 #include "vk_debug.h"
 #include "vk_replay.h"
+#include "vk_residency.h"
 
 #include "stb/stb_image_write.h"
 
 RDOC_EXTERN_CONFIG(bool, Replay_Debug_PrintChunkTimings);
+RDOC_EXTERN_CONFIG(bool, Replay_IncrementalForward);
 
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_VerboseCommandRecording);
 
@@ -48,6 +51,12 @@ RDOC_DEBUG_CONFIG(bool, Vulkan_Debug_SingleSubmitFlushing, false,
 RDOC_DEBUG_CONFIG(bool, Vulkan_Experimental_EnableRTSupport, false,
                   "Enable experimental Vulkan RT support");
 
+RDOC_CONFIG(uint32_t, Vulkan_Replay_InitialContentsBudgetMB, 0,
+            "If non-zero, initial contents of memory and images are kept in host memory on "
+            "replay and only uploaded to staging when needed, with at most this many MB of "
+            "staging in use at once. This does not limit the memory used by the capture's own "
+            "resources.");
+
 uint64_t VkInitParams::GetSerialiseSize()
 {
   // misc bytes and fixed integer members
@@ -175,6 +184,10 @@ WrappedVulkan::WrappedVulkan()
     ResourceIDGen::SetReplayResourceIDs();
 
     m_CreationInfo.pushConstantDescriptorStorage = ResourceIDGen::GetNewUniqueID();
+
+    if(Vulkan_Replay_InitialContentsBudgetMB() > 0)
+      m_ResidencyManager = new VulkanResidencyManager(
+          this, uint64_t(Vulkan_Replay_InitialContentsBudgetMB()) * 1024 * 1024);
   }
 }
 
@@ -195,6 +208,8 @@ WrappedVulkan::~WrappedVulkan()
 
   SAFE_DELETE(m_ASManager);
 
+  ClearDescriptorRefs();
+
   // in case the application leaked some objects, avoid crashing trying
   // to release them ourselves by clearing the resource manager.
   // In a well-behaved application, this should be a no-op.
@@ -2268,6 +2283,14 @@ bool WrappedVulkan::Serialise_BeginCaptureFrame(SerialiserType &ser)
   return true;
 }
 
+void WrappedVulkan::ClearDescriptorRefs()
+{
+  SCOPED_LOCK(m_DescriptorRefsLock);
+  for(auto it = m_DescriptorRefs.begin(); it != m_DescriptorRefs.end(); ++it)
+    delete it->second;
+  m_DescriptorRefs.clear();
+}
+
 void WrappedVulkan::StartFrameCapture(DeviceOwnedWindow devWnd)
 {
   if(!IsBackgroundCapturing(m_State))
@@ -2357,6 +2380,8 @@ void WrappedVulkan::StartFrameCapture(DeviceOwnedWindow devWnd)
       m_CapDescriptors.clear();
     }
 
+    ClearDescriptorRefs();
+
     RDCDEBUG("Attempting capture");
     m_FrameCaptureRecord->DeleteChunks();
     {
@@ -2754,8 +2779,17 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
 
     GetResourceManager()->InsertReferencedChunks(ser);
 
+    m_FrameMemRefsComplete = true;
+    m_InitialMemoryBytesTotal = m_InitialMemoryBytesSkipped = 0;
+
     GetResourceManager()->InsertInitialContentsChunks(ser);
 
+    m_FrameMemRefsComplete = false;
+
+    if(m_InitialMemoryBytesSkipped > 0)
+      RDCLOG("Stored %llu of %llu bytes of memory initial contents, skipping unreferenced ranges",
+             m_InitialMemoryBytesTotal - m_InitialMemoryBytesSkipped, m_InitialMemoryBytesTotal);
+
     RDCDEBUG("Creating Capture Scope");
 
     GetResourceManager()->Serialise_InitialContentsNeeded(ser);
@@ -2857,6 +2891,8 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
 
   m_CmdBufferRecords.clear();
 
+  ClearDescriptorRefs();
+
   Atomic::Inc32(&m_ReuseEnabled);
 
   GetResourceManager()->ResetLastWriteTimes();
@@ -2919,6 +2955,8 @@ bool WrappedVulkan::DiscardFrameCapture(DeviceOwnedWindow devWnd)
 
   m_CmdBufferRecords.clear();
 
+  ClearDescriptorRefs();
+
   GetResourceManager()->MarkUnwrittenResources();
 
   GetResourceManager()->ClearReferencedResources();
@@ -3055,6 +3093,27 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
   if(sectionIdx < 0)
     RETURN_ERROR_RESULT(ResultCode::FileCorrupted, "File does not contain captured API data");
 
+  if(IsReplayMode(m_State) && !IsStructuredExporting(m_State))
+  {
+    // identify the capture from its header properties and the start of its frame data, which
+    // includes timestamps, rather than hashing the whole file
+    const SectionProperties &props = rdc->GetSectionProperties(sectionIdx);
+    uint64_t fields[] = {rdc->GetMachineIdent(), rdc->GetTimestampBase(), props.uncompressedSize,
+                         props.compressedSize};
+
+    StreamReader *identReader = rdc->ReadSection(sectionIdx);
+
+    bytebuf ident;
+    ident.resize((size_t)RDCMIN(identReader->GetSize(), (uint64_t)64 * 1024));
+    if(identReader->Read(ident.data(), ident.size()))
+    {
+      ident.append((const byte *)fields, sizeof(fields));
+      m_CaptureHash = HashContents(ident.data(), ident.size());
+    }
+
+    delete identReader;
+  }
+
   StreamReader *reader = rdc->ReadSection(sectionIdx);
 
   if(IsStructuredExporting(m_State))
@@ -3676,6 +3735,9 @@ void WrappedVulkan::ApplyInitialContents()
   SubmitCmds();
   FlushQ();
 
+  if(m_ResidencyManager)
+    m_ResidencyManager->BeginApply();
+
   // actually apply the initial contents here
   GetResourceManager()->ApplyInitialContents();
 
@@ -3717,6 +3779,10 @@ void WrappedVulkan::ApplyInitialContents()
   FlushQ();
   SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
 
+  // nothing is reading from the uploaded initial contents any more
+  if(m_ResidencyManager)
+    m_ResidencyManager->EndApply();
+
   // reset any queries to a valid copy-able state if they need to be copied.
   if(!m_ResetQueries.empty())
   {
@@ -4455,11 +4521,68 @@ VkResourceRecord *WrappedVulkan::RegisterSurface(WindowingSystem system, void *h
   return (VkResourceRecord *)new PackedWindowHandle(system, handle);
 }
 
-void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
+bool WrappedVulkan::CanReplayIncrementally(uint32_t fromEventID, uint32_t toEventID)
+{
+  // we can only continue a partial replay within a single primary command buffer, since the outside
+  // command buffer replays events in isolation and can't follow submissions or executions.
+  if(m_Partial.partialStack.size() != 1)
+    return false;
+
+  const CommandBufferNode &node = m_Partial.partialStack[0];
+  const BakedCmdBufferInfo &info = m_BakedCmdBufferInfo[node.cmdId];
+
+  if(info.level != VK_COMMAND_BUFFER_LEVEL_PRIMARY)
+    return false;
+
+  if(fromEventID < node.beginEvent || toEventID >= node.beginEvent + info.eventCount)
+    return false;
+
+  for(const CommandBufferNode *child : node.childCmdNodes)
+  {
+    if(IsEventInCommandBuffer(child, fromEventID, m_BakedCmdBufferInfo[child->cmdId].eventCount) ||
+       (child->beginEvent >= fromEventID && child->beginEvent <= toEventID))
+      return false;
+  }
+
+  // the partial stack's render pass state is restored after an outside replay, so we can't cross
+  // the beginning or end of a pass.
+  for(uint32_t eid = fromEventID; eid <= toEventID; eid++)
+  {
+    const ActionDescription *action = GetAction(eid);
+    if(action && (action->flags & ActionFlags::PassBoundary))
+      return false;
+  }
+
+  return true;
+}
+
+void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType,
+                              bool incremental)
 {
   bool partial = true;
 
-  if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
+  uint32_t replayedEventID = m_ReplayedEventID;
+  m_ReplayedEventID = 0;
+
+  if(!incremental || !Replay_IncrementalForward())
+    replayedEventID = 0;
+
+  // if the previous replay left the frame at an earlier event and nothing has changed since then,
+  // only replay the events in between.
+  bool continued = false;
+  if(startEventID == 0 && replayType == eReplay_WithoutDraw && replayedEventID > 0 &&
+     replayedEventID < endEventID && CanReplayIncrementally(replayedEventID, endEventID))
+  {
+    if(replayedEventID + 1 == endEventID)
+    {
+      m_ReplayedEventID = replayedEventID;
+      return;
+    }
+
+    startEventID = replayedEventID + 1;
+    continued = true;
+  }
+  else if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
   {
     startEventID = 1;
     partial = false;
@@ -4599,9 +4722,23 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
 
     RDCASSERTEQUAL(status.code, ResultCode::Succeeded);
 
+    // any active transform feedback or conditional rendering is ended below, so the replayed state
+    // can't be continued from. Otherwise note where we got to if this replay was a continuation of
+    // the last one or started from scratch.
+    if(incremental && status == ResultCode::Succeeded && m_RenderState.xfbcounters.empty() &&
+       !m_RenderState.IsConditionalRenderingEnabled())
+    {
+      if(replayType == eReplay_WithoutDraw && (!partial || continued))
+        m_ReplayedEventID = RDCMAX(1U, endEventID) - 1;
+      else if(replayType == eReplay_Full && !partial)
+        m_ReplayedEventID = endEventID;
+      else if(replayType == eReplay_OnlyDraw && replayedEventID + 1 == endEventID)
+        m_ReplayedEventID = endEventID;
+    }
+
     if(m_OutsideCmdBuffer != VK_NULL_HANDLE)
     {
-      if(replayType == eReplay_OnlyDraw)
+      if(replayType == eReplay_OnlyDraw || continued)
         UpdateImageStates(m_BakedCmdBufferInfo[m_LastCmdBufferID].imageStates);
 
       VkCommandBuffer cmd = m_OutsideCmdBuffer;
@@ -5937,6 +6074,10 @@ void WrappedVulkan::UpdateImageStates(const rdcflatmap<ResourceId, ImageState> &
 
 void WrappedVulkan::ReplayDraw(VkCommandBuffer cmd, const ActionDescription &action)
 {
+  // the action is executed again on top of whatever has been replayed, so the replayed state can't
+  // be continued from any more
+  InvalidateIncrementalReplay();
+
   // if this isn't a multidraw (or it's the first action in a multidraw, it's fairly easy
   if(action.drawIndex == 0)
   {
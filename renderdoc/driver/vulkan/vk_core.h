@@ -34,6 +34,7 @@
 #include "vk_state.h"
 
 class VulkanShaderCache;
+class VulkanResidencyManager;
 class VulkanDebugManager;
 class VulkanResourceManager;
 class VulkanTextRenderer;
@@ -55,7 +56,7 @@ struct VkInitParams
   uint64_t GetSerialiseSize();
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x16;
+  static const uint64_t CurrentVersion = 0x17;
   static bool IsSupportedVersion(uint64_t ver);
 };
 
@@ -288,6 +289,7 @@ private:
   friend class VulkanDebugManager;
   friend struct VulkanRenderState;
   friend class VulkanShaderCache;
+  friend class VulkanResidencyManager;
 
   struct ScopedDebugMessageSink
   {
@@ -361,6 +363,8 @@ private:
 
   VkInitParams m_InitParams;
   uint64_t m_SectionVersion;
+  // identifies the capture being replayed, for on-disk caches. 0 if unknown
+  uint64_t m_CaptureHash = 0;
 
   StreamReader *m_FrameReader = NULL;
 
@@ -369,6 +373,18 @@ private:
   Threading::CriticalSection m_CapDescriptorsLock;
   std::set<rdcpair<ResourceId, VkResourceRecord *>> m_CapDescriptors;
 
+  // references gathered from descriptor sets at submit time while capturing a frame, so a set
+  // submitted many times is only walked again if it's been written in between.
+  struct CachedDescriptorRefs
+  {
+    uint32_t writeGeneration;
+    DescriptorBindRefs refs;
+  };
+  Threading::CriticalSection m_DescriptorRefsLock;
+  std::unordered_map<ResourceId, CachedDescriptorRefs *> m_DescriptorRefs;
+
+  void ClearDescriptorRefs();
+
   VkResourceRecord *m_FrameCaptureRecord;
 
   // we record the command buffer records so we can insert them
@@ -385,6 +401,7 @@ private:
   VulkanShaderCache *m_ShaderCache = NULL;
   VulkanTextRenderer *m_TextRenderer = NULL;
   VulkanAccelerationStructureManager *m_ASManager = NULL;
+  VulkanResidencyManager *m_ResidencyManager = NULL;
 
   Threading::RWLock m_CapTransitionLock;
 
@@ -621,6 +638,12 @@ private:
   rdcarray<ResourceId> m_PreparedNotSerialisedInitStates;
 
   rdcarray<rdcstr> m_InitTempFiles;
+
+  // set while initial contents are serialised at the end of a capture, when the memory references
+  // for the frame are complete
+  bool m_FrameMemRefsComplete = false;
+  uint64_t m_InitialMemoryBytesTotal = 0;
+  uint64_t m_InitialMemoryBytesSkipped = 0;
   VkCommandBuffer initStateCurCmd = VK_NULL_HANDLE;
   rdcarray<std::function<void()>> m_PendingCleanups;
 
@@ -857,6 +880,14 @@ private:
   // so we just set this command buffer
   VkCommandBuffer m_OutsideCmdBuffer = VK_NULL_HANDLE;
 
+  // the event that the frame has been replayed up to and including by the last incremental-capable
+  // replay, or 0 if the state since then is unknown. Any other replay resets this.
+  uint32_t m_ReplayedEventID = 0;
+
+  // determines whether the replayed state at fromEventID can be carried forward to toEventID by
+  // only replaying the events in between onto an outside command buffer.
+  bool CanReplayIncrementally(uint32_t fromEventID, uint32_t toEventID);
+
   // stores the currently re-recording command buffer for any original command buffer ID (not bake
   // ID). This allows a quick check to see if an original command should be recorded, and also to
   // fetch the command buffer to record into.
@@ -1209,6 +1240,7 @@ public:
   VulkanDebugManager *GetDebugManager() { return m_DebugManager; }
   VulkanShaderCache *GetShaderCache() { return m_ShaderCache; }
   VulkanAccelerationStructureManager *GetAccelerationStructureManager() { return m_ASManager; }
+  VulkanResidencyManager *GetResidencyManager() { return m_ResidencyManager; }
   CaptureState GetState() { return m_State; }
   VulkanReplay *GetReplay() { return m_Replay; }
   // replay interface
@@ -1231,13 +1263,19 @@ public:
 
   RDResult Initialise(VkInitParams &params, uint64_t sectionVersion, const ReplayOptions &opts);
   uint64_t GetLogVersion() { return m_SectionVersion; }
+  uint64_t GetCaptureHash() { return m_CaptureHash; }
   void SetStructuredExport(uint64_t sectionVersion)
   {
     m_SectionVersion = sectionVersion;
     m_State = CaptureState::StructuredExport;
   }
   void Shutdown();
-  void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
+  // incremental should only be set by callers that haven't modified any replay state since their
+  // last replay, which lets a replay from the start of the frame continue on from where that one
+  // stopped instead.
+  void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType,
+                 bool incremental = false);
+  void InvalidateIncrementalReplay() { m_ReplayedEventID = 0; }
   void ReplayDraw(VkCommandBuffer cmd, const ActionDescription &action);
   RDResult ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers);
 
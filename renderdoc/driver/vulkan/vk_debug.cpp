@@ -1890,74 +1890,121 @@ void VulkanDebugManager::ResetBufferMSDescriptorPools()
 }
 
 void VulkanDebugManager::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &ret)
+{
+  ReadbackRequest req;
+  req.resource = buff;
+  req.offset = offset;
+  req.length = len;
+
+  rdcarray<ReadbackRequest *> requests = {&req};
+  GetBufferData(requests);
+
+  ret.swap(req.data);
+}
+
+void VulkanDebugManager::GetBufferData(const rdcarray<ReadbackRequest *> &requests)
 {
   VkDevice dev = m_pDriver->GetDev();
   const VkDevDispatchTable *vt = ObjDisp(dev);
 
-  if(!m_pDriver->GetResourceManager()->HasCurrentResource(buff))
+  // a contiguous range to copy from a source buffer into a request's data
+  struct CopyRange
   {
-    RDCERR("Getting buffer data for unknown buffer/memory %s!", ToStr(buff).c_str());
-    return;
-  }
+    VkBuffer buf;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    byte *dst;
+  };
 
-  WrappedVkRes *res = m_pDriver->GetResourceManager()->GetCurrentResource(buff);
+  rdcarray<CopyRange> ranges;
+  rdcarray<VkBufferMemoryBarrier> srcBarriers;
 
-  if(res == VK_NULL_HANDLE)
+  for(ReadbackRequest *req : requests)
   {
-    RDCERR("Getting buffer data for unknown buffer/memory %s!", ToStr(buff).c_str());
-    return;
-  }
+    ResourceId buff = req->resource;
+    uint64_t offset = req->offset;
+    uint64_t len = req->length;
 
-  VkBuffer srcBuf = VK_NULL_HANDLE;
-  uint64_t bufsize = 0;
+    if(!m_pDriver->GetResourceManager()->HasCurrentResource(buff))
+    {
+      RDCERR("Getting buffer data for unknown buffer/memory %s!", ToStr(buff).c_str());
+      continue;
+    }
 
-  if(WrappedVkDeviceMemory::IsAlloc(res))
-  {
-    srcBuf = m_pDriver->m_CreationInfo.m_Memory[buff].wholeMemBuf;
-    bufsize = m_pDriver->m_CreationInfo.m_Memory[buff].wholeMemBufSize;
+    WrappedVkRes *res = m_pDriver->GetResourceManager()->GetCurrentResource(buff);
 
-    if(srcBuf == VK_NULL_HANDLE)
+    if(res == VK_NULL_HANDLE)
     {
-      RDCLOG(
-          "Memory doesn't have wholeMemBuf, either non-buffer accessible (non-linear) or dedicated "
-          "image memory");
-      return;
+      RDCERR("Getting buffer data for unknown buffer/memory %s!", ToStr(buff).c_str());
+      continue;
     }
-  }
-  else if(WrappedVkBuffer::IsAlloc(res))
-  {
-    srcBuf = m_pDriver->GetResourceManager()->GetCurrentHandle<VkBuffer>(buff);
-    bufsize = m_pDriver->m_CreationInfo.m_Buffer[buff].size;
-  }
-  else
-  {
-    RDCERR("Getting buffer data for object that isn't buffer or memory %s!", ToStr(buff).c_str());
-    return;
-  }
 
-  if(offset >= bufsize)
-  {
-    // can't read past the end of the buffer, return empty
-    return;
-  }
+    VkBuffer srcBuf = VK_NULL_HANDLE;
+    uint64_t bufsize = 0;
 
-  if(len == 0 || len > bufsize)
-  {
-    len = bufsize - offset;
-  }
+    if(WrappedVkDeviceMemory::IsAlloc(res))
+    {
+      srcBuf = m_pDriver->m_CreationInfo.m_Memory[buff].wholeMemBuf;
+      bufsize = m_pDriver->m_CreationInfo.m_Memory[buff].wholeMemBufSize;
 
-  if(VkDeviceSize(offset + len) > bufsize)
-  {
-    RDCWARN("Attempting to read off the end of the buffer (%llu %llu). Will be clamped (%llu)",
-            offset, len, bufsize);
-    len = RDCMIN(len, bufsize - offset);
-  }
+      if(srcBuf == VK_NULL_HANDLE)
+      {
+        RDCLOG(
+            "Memory doesn't have wholeMemBuf, either non-buffer accessible (non-linear) or "
+            "dedicated image memory");
+        continue;
+      }
+    }
+    else if(WrappedVkBuffer::IsAlloc(res))
+    {
+      srcBuf = m_pDriver->GetResourceManager()->GetCurrentHandle<VkBuffer>(buff);
+      bufsize = m_pDriver->m_CreationInfo.m_Buffer[buff].size;
+    }
+    else
+    {
+      RDCERR("Getting buffer data for object that isn't buffer or memory %s!",
+             ToStr(buff).c_str());
+      continue;
+    }
+
+    if(offset >= bufsize)
+    {
+      // can't read past the end of the buffer, return empty
+      continue;
+    }
 
-  ret.resize((size_t)len);
+    if(len == 0 || len > bufsize)
+    {
+      len = bufsize - offset;
+    }
+
+    if(VkDeviceSize(offset + len) > bufsize)
+    {
+      RDCWARN("Attempting to read off the end of the buffer (%llu %llu). Will be clamped (%llu)",
+              offset, len, bufsize);
+      len = RDCMIN(len, bufsize - offset);
+    }
+
+    req->data.resize((size_t)len);
+
+    ranges.push_back({srcBuf, offset, len, req->data.data()});
+
+    VkBufferMemoryBarrier bufBarrier = {
+        VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        NULL,
+        VK_ACCESS_ALL_WRITE_BITS,
+        VK_ACCESS_TRANSFER_READ_BIT,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        Unwrap(srcBuf),
+        offset,
+        len,
+    };
+    srcBarriers.push_back(bufBarrier);
+  }
 
-  VkDeviceSize srcoffset = (VkDeviceSize)offset;
-  size_t dstoffset = 0;
-  VkDeviceSize sizeRemaining = (VkDeviceSize)len;
+  if(ranges.empty())
+    return;
 
   VkCommandBuffer cmd = m_pDriver->GetNextCmd();
 
@@ -1970,22 +2017,8 @@ void VulkanDebugManager::GetBufferData(ResourceId buff, uint64_t offset, uint64_
   VkResult vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
   CHECK_VKR(m_pDriver, vkr);
 
-  VkBufferMemoryBarrier bufBarrier = {
-      VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-      NULL,
-      0,
-      VK_ACCESS_TRANSFER_READ_BIT,
-      VK_QUEUE_FAMILY_IGNORED,
-      VK_QUEUE_FAMILY_IGNORED,
-      Unwrap(srcBuf),
-      srcoffset,
-      sizeRemaining,
-  };
-
-  bufBarrier.srcAccessMask = VK_ACCESS_ALL_WRITE_BITS;
-
   // wait for previous writes to happen before we copy to our window buffer
-  DoPipelineBarrier(cmd, 1, &bufBarrier);
+  DoPipelineBarrier(cmd, srcBarriers.size(), srcBarriers.data());
 
   vkr = vt->EndCommandBuffer(Unwrap(cmd));
   CHECK_VKR(m_pDriver, vkr);
@@ -1993,10 +2026,23 @@ void VulkanDebugManager::GetBufferData(ResourceId buff, uint64_t offset, uint64_
   if(Vulkan_Debug_SingleSubmitFlushing())
     m_pDriver->SubmitCmds();
 
-  while(sizeRemaining > 0)
+  // a piece of a range that's been copied into the readback window
+  struct WindowPiece
   {
-    VkDeviceSize chunkSize = RDCMIN(sizeRemaining, STAGE_BUFFER_BYTE_SIZE);
+    VkDeviceSize windowOffset;
+    VkDeviceSize size;
+    byte *dst;
+  };
+
+  rdcarray<WindowPiece> pieces;
 
+  size_t r = 0;
+  VkDeviceSize rangeDone = 0;
+
+  // pack as many ranges as will fit into each fill of the window, so small readbacks share a
+  // single submit and wait. Ranges larger than the window are split across several fills.
+  while(r < ranges.size())
+  {
     cmd = m_pDriver->GetNextCmd();
 
     if(cmd == VK_NULL_HANDLE)
@@ -2005,14 +2051,42 @@ void VulkanDebugManager::GetBufferData(ResourceId buff, uint64_t offset, uint64_
     vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
     CHECK_VKR(m_pDriver, vkr);
 
-    VkBufferCopy region = {srcoffset, 0, chunkSize};
-    vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(m_ReadbackWindow.buf), 1, &region);
+    pieces.clear();
+    VkDeviceSize windowOffset = 0;
 
-    bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    bufBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
-    bufBarrier.buffer = Unwrap(m_ReadbackWindow.buf);
-    bufBarrier.offset = 0;
-    bufBarrier.size = chunkSize;
+    while(r < ranges.size() && windowOffset < STAGE_BUFFER_BYTE_SIZE)
+    {
+      const CopyRange &range = ranges[r];
+
+      VkDeviceSize chunkSize =
+          RDCMIN(range.size - rangeDone, STAGE_BUFFER_BYTE_SIZE - windowOffset);
+
+      VkBufferCopy region = {range.offset + rangeDone, windowOffset, chunkSize};
+      vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(range.buf), Unwrap(m_ReadbackWindow.buf), 1, &region);
+
+      pieces.push_back({windowOffset, chunkSize, range.dst + rangeDone});
+
+      windowOffset += chunkSize;
+      rangeDone += chunkSize;
+
+      if(rangeDone == range.size)
+      {
+        r++;
+        rangeDone = 0;
+      }
+    }
+
+    VkBufferMemoryBarrier bufBarrier = {
+        VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        NULL,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_ACCESS_HOST_READ_BIT,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        Unwrap(m_ReadbackWindow.buf),
+        0,
+        windowOffset,
+    };
 
     // wait for transfer to happen before we read
     DoPipelineBarrier(cmd, 1, &bufBarrier);
@@ -2043,12 +2117,8 @@ void VulkanDebugManager::GetBufferData(ResourceId buff, uint64_t offset, uint64_
     vkr = vt->InvalidateMappedMemoryRanges(Unwrap(dev), 1, &range);
     CHECK_VKR(m_pDriver, vkr);
 
-    RDCASSERT(pData != NULL);
-    memcpy(&ret[dstoffset], pData, (size_t)chunkSize);
-
-    srcoffset += chunkSize;
-    dstoffset += (size_t)chunkSize;
-    sizeRemaining -= chunkSize;
+    for(const WindowPiece &piece : pieces)
+      memcpy(piece.dst, pData + piece.windowOffset, (size_t)piece.size);
 
     vt->UnmapMemory(Unwrap(dev), Unwrap(m_ReadbackWindow.mem));
   }
@@ -3295,6 +3365,7 @@ void VulkanReplay::CreateResources()
   RenderDoc::Inst().SetProgress(LoadProgress::DebugManagerInit, 0.8f);
 
   m_Histogram.Init(m_pDriver, m_General.DescriptorPool);
+  m_ContentHash.Init(m_pDriver, m_General.DescriptorPool);
 
   RenderDoc::Inst().SetProgress(LoadProgress::DebugManagerInit, 0.9f);
 
@@ -3360,6 +3431,7 @@ void VulkanReplay::DestroyResources()
   m_PixelPick.Destroy(m_pDriver);
   m_PixelHistory.Destroy(m_pDriver);
   m_Histogram.Destroy(m_pDriver);
+  m_ContentHash.Destroy(m_pDriver);
   m_PostVS.Destroy(m_pDriver);
 
   SAFE_DELETE(m_pAMDCounters);
@@ -4865,6 +4937,34 @@ void VulkanReplay::HistogramMinMax::Destroy(WrappedVulkan *driver)
   m_HistogramUBO.Destroy();
 }
 
+void VulkanReplay::ContentHash::Init(WrappedVulkan *driver, VkDescriptorPool descriptorPool)
+{
+  CREATE_OBJECT(DescSetLayout,
+                {
+                    {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL, NULL},
+                    {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL, NULL},
+                });
+
+  CREATE_OBJECT(PipeLayout, DescSetLayout, sizeof(Vec4u));
+  CREATE_OBJECT(DescSet, descriptorPool, DescSetLayout);
+  CREATE_OBJECT(Pipe, PipeLayout,
+                driver->GetShaderCache()->GetBuiltinModule(BuiltinShader::ContentHashCS));
+}
+
+void VulkanReplay::ContentHash::Destroy(WrappedVulkan *driver)
+{
+  if(DescSetLayout == VK_NULL_HANDLE)
+    return;
+
+  driver->vkDestroyDescriptorSetLayout(driver->GetDev(), DescSetLayout, NULL);
+  driver->vkDestroyPipelineLayout(driver->GetDev(), PipeLayout, NULL);
+  driver->vkDestroyPipeline(driver->GetDev(), Pipe, NULL);
+
+  Scratch.Destroy();
+  Result.Destroy();
+  ResultReadback.Destroy();
+}
+
 void VulkanReplay::PostVS::Destroy(WrappedVulkan *driver)
 {
   if(XFBQueryPool != VK_NULL_HANDLE)
@@ -5031,8 +5131,9 @@ void ShaderDebugData::Init(WrappedVulkan *driver, VkDescriptorPool descriptorPoo
   MathResult.Create(driver, driver->GetDev(), sizeof(Vec4f) * 4, 1,
                     GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
 
-  // don't need to ring this, as we hard-sync for readback anyway
-  ReadbackBuffer.Create(driver, driver->GetDev(), sizeof(Vec4f) * 4, 1,
+  // don't need to ring this, as we hard-sync for readback anyway. It holds one result per batched
+  // math operation, each up to a double4
+  ReadbackBuffer.Create(driver, driver->GetDev(), sizeof(Vec4f) * 2 * MathBatchSize, 1,
                         GPUBuffer::eGPUBufferReadback);
   ConstantsBuffer.Create(driver, driver->GetDev(), 1024, 1, 0);
 }
@@ -62,10 +62,14 @@ public:
   ~VulkanDebugManager();
 
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &ret);
+  // reads back several buffer ranges at once, sharing submits between them where they fit
+  void GetBufferData(const rdcarray<ReadbackRequest *> &requests);
 
+  // destOffset must be aligned for binding destBuffer as a storage buffer
   void CopyTex2DMSToBuffer(VkCommandBuffer cmd, VkBuffer destBuffer, VkImage srcMS,
                            VkExtent3D extent, uint32_t baseSlice, uint32_t numSlices,
-                           uint32_t baseSample, uint32_t numSamples, VkFormat fmt);
+                           uint32_t baseSample, uint32_t numSamples, VkFormat fmt,
+                           VkDeviceSize destOffset = 0);
 
   void CopyBufferToTex2DMS(VkCommandBuffer cmd, VkImage destMS, VkBuffer srcBuffer,
                            VkExtent3D extent, uint32_t numSlices, uint32_t numSamples, VkFormat fmt);
@@ -174,7 +178,8 @@ private:
 
   void CopyDepthTex2DMSToBuffer(VkCommandBuffer cmd, VkBuffer destBuffer, VkImage srcMS,
                                 VkExtent3D extent, uint32_t baseSlice, uint32_t numSlices,
-                                uint32_t baseSample, uint32_t numSamples, VkFormat fmt);
+                                uint32_t baseSample, uint32_t numSamples, VkFormat fmt,
+                                VkDeviceSize destOffset);
 
   void CopyDepthBufferToTex2DMS(VkCommandBuffer cmd, VkImage destMS, VkBuffer srcBuffer,
                                 VkExtent3D extent, uint32_t numSlices, uint32_t numSamples,
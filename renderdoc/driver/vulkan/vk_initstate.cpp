@@ -26,9 +26,58 @@
 #include "strings/string_utils.h"
 #include "vk_core.h"
 #include "vk_debug.h"
+#include "vk_residency.h"
 
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_SingleSubmitFlushing);
 
+RDOC_CONFIG(bool, Vulkan_Capture_ReferencedMemoryOnly, false,
+            "When capturing, only store the initial contents of memory allocations in the ranges "
+            "that are referenced by the frame. Unreferenced ranges have undefined contents on "
+            "replay.");
+
+struct MemoryContentsRange
+{
+  uint64_t offset;
+  uint64_t size;
+};
+
+DECLARE_REFLECTION_STRUCT(MemoryContentsRange);
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, MemoryContentsRange &el)
+{
+  SERIALISE_MEMBER(offset);
+  SERIALISE_MEMBER(size);
+}
+
+// the ranges of a memory allocation that must be stored for the frame to replay. Ranges that are
+// close together are merged, so that we don't fragment the contents into many small pieces.
+static rdcarray<MemoryContentsRange> GetReferencedMemoryRanges(MemRefs &memRefs, uint64_t size)
+{
+  const uint64_t mergeDistance = 4096;
+
+  rdcarray<MemoryContentsRange> ret;
+
+  for(auto it = memRefs.rangeRefs.begin(); it != memRefs.rangeRefs.end(); it++)
+  {
+    if(it->value() == eFrameRef_None)
+      continue;
+
+    uint64_t start = it->start();
+    uint64_t finish = RDCMIN(it->finish(), size);
+
+    if(start >= finish)
+      continue;
+
+    if(!ret.empty() && start <= ret.back().offset + ret.back().size + mergeDistance)
+      ret.back().size = finish - ret.back().offset;
+    else
+      ret.push_back({start, finish - start});
+  }
+
+  return ret;
+}
+
 // VKTODOLOW there's a lot of duplicated code in this file for creating a buffer to do
 // a memory copy and saving to disk.
 
@@ -1499,12 +1548,79 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
     // Serialise this separately so that it can be used on reading to prepare the upload memory
     SERIALISE_ELEMENT(ContentsSize);
 
+    // device memory may only store the ranges referenced by the frame. This can only be decided
+    // once the frame is complete, memory serialised before then (when flushing to disk under a
+    // soft memory limit) is always stored whole.
+    bool PartialContents = false;
+    rdcarray<MemoryContentsRange> StoredRanges;
+
+    if(ser.IsWriting() && type == eResDeviceMemory && initial &&
+       initial->mem.mem != VK_NULL_HANDLE && m_FrameMemRefsComplete &&
+       Vulkan_Capture_ReferencedMemoryOnly() &&
+       !RenderDoc::Inst().GetCaptureOptions().refAllResources)
+    {
+      MemRefs *memRefs = GetResourceManager()->FindMemRefs(id);
+      if(memRefs)
+      {
+        StoredRanges = GetReferencedMemoryRanges(*memRefs, ContentsSize);
+
+        // don't bother if the whole allocation is referenced anyway
+        PartialContents = !(StoredRanges.size() == 1 && StoredRanges[0].offset == 0 &&
+                            StoredRanges[0].size == ContentsSize);
+        if(!PartialContents)
+          StoredRanges.clear();
+      }
+    }
+
+    if(type == eResDeviceMemory && !ser.VersionLess(0x17))
+    {
+      SERIALISE_ELEMENT(PartialContents).Hidden();
+      SERIALISE_ELEMENT(StoredRanges).Hidden();
+    }
+
+    for(const MemoryContentsRange &range : StoredRanges)
+    {
+      if(range.offset > ContentsSize || range.size > ContentsSize - range.offset)
+      {
+        RDCERR("Invalid stored range %llu+%llu in memory of size %llu", range.offset, range.size,
+               ContentsSize);
+        return false;
+      }
+    }
+
+    if(ser.IsWriting() && type == eResDeviceMemory)
+    {
+      uint64_t stored = ContentsSize;
+      if(PartialContents)
+      {
+        stored = 0;
+        for(const MemoryContentsRange &range : StoredRanges)
+          stored += range.size;
+      }
+
+      m_InitialMemoryBytesTotal += ContentsSize;
+      m_InitialMemoryBytesSkipped += ContentsSize - stored;
+    }
+
     const VkDeviceSize nonCoherentAtomSize = GetDeviceProps().limits.nonCoherentAtomSize;
 
     // the memory/buffer that we allocated on read, to upload the initial contents.
     MemoryAllocation uploadMemory;
     VkBuffer uploadBuf = VK_NULL_HANDLE;
 
+    // with a residency manager, contents that we can upload lazily stay in host memory until an
+    // apply needs them. MSAA images are copied into a GPU-local buffer immediately, and sparse
+    // images need their page tables alongside, so both of those are uploaded as normal.
+    bool hostContents = false;
+    if(IsReplayingAndReading() && !ser.IsErrored() && m_ResidencyManager && ContentsSize > 0)
+    {
+      if(type == eResDeviceMemory)
+        hostContents = true;
+      else if(sparseTables.empty())
+        hostContents = m_CreationInfo.m_Image[GetResourceManager()->GetLiveID(id)].samples ==
+                       VK_SAMPLE_COUNT_1_BIT;
+    }
+
     // during writing, we already have the memory copied off - we just need to map it.
     if(ser.IsWriting())
     {
@@ -1530,6 +1646,11 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
         CHECK_VKR(this, vkr);
       }
     }
+    else if(hostContents)
+    {
+      Contents = m_ResidencyManager->AddContents(GetResourceManager()->GetLiveID(id), ContentsSize)
+                     .data();
+    }
     else if(IsReplayingAndReading() && !ser.IsErrored())
     {
       // create a buffer with memory attached, which we will fill with the initial contents
@@ -1568,8 +1689,21 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
     }
 
     // not using SERIALISE_ELEMENT_ARRAY so we can deliberately avoid allocation - we serialise
-    // directly into upload memory
-    ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags).Important();
+    // directly into upload memory, or the residency manager's host copy
+    if(PartialContents)
+    {
+      // the rest of the upload memory is left undefined, it was never referenced by the frame
+      for(const MemoryContentsRange &range : StoredRanges)
+      {
+        byte *RangeContents = Contents ? Contents + range.offset : NULL;
+        ser.Serialise("Contents"_lit, RangeContents, range.size, SerialiserFlags::NoFlags)
+            .Important();
+      }
+    }
+    else
+    {
+      ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags).Important();
+    }
 
     // unmap the resource we mapped before - we need to do this on read and on write.
     if(!IsStructuredExporting(m_State) && mappedMem.mem != VK_NULL_HANDLE)
@@ -1600,7 +1734,15 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
     {
       ResourceId liveid = GetResourceManager()->GetLiveID(id);
 
-      if(type == eResDeviceMemory)
+      if(hostContents)
+      {
+        // no buffer until the contents are made resident, but keep the size for apply
+        VkInitialContents initialContents(type, uploadMemory);
+        initialContents.mem.size = ContentsSize;
+
+        GetResourceManager()->SetInitialContents(id, initialContents);
+      }
+      else if(type == eResDeviceMemory)
       {
         VkInitialContents initialContents(type, uploadMemory);
         initialContents.buf = uploadBuf;
@@ -2249,6 +2391,13 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, VkInitialContents &in
       }
     }
 
+    if(buf == VK_NULL_HANDLE && copyRegions.size() > 0 && m_ResidencyManager)
+    {
+      buf = m_ResidencyManager->MakeResident(id);
+      if(buf == VK_NULL_HANDLE)
+        copyRegions.clear();
+    }
+
     if(copyRegions.size() + clearRegions.size() > 0)
     {
       VkCommandBuffer cmd = GetInitStateCmd();
@@ -2316,16 +2465,17 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, VkInitialContents &in
       bool initialized = memRefs->initializedLiveRes == live;
       memRefs->initializedLiveRes = live;
       InitPolicy policy = GetResourceManager()->GetInitPolicy();
+
+      // the ref intervals are already sorted and disjoint, so apply them all in one pass
+      rdcarray<IntervalUpdate<InitReqType>> updates;
       for(auto it = memRefs->rangeRefs.begin(); it != memRefs->rangeRefs.end(); it++)
       {
         InitReqType t = InitReq(it->value(), policy, initialized);
-        if(t == eInitReq_Copy)
-          resetReq.update(it->start(), it->finish(), eInitReq_Copy,
-                          [](InitReqType x, InitReqType y) -> InitReqType { return RDCMAX(x, y); });
-        else if(t == eInitReq_Clear)
-          resetReq.update(it->start(), it->finish(), eInitReq_Clear,
-                          [](InitReqType x, InitReqType y) -> InitReqType { return RDCMAX(x, y); });
+        if(t == eInitReq_Copy || t == eInitReq_Clear)
+          updates.push_back({it->start(), it->finish(), t});
       }
+      resetReq.updateBatch(
+          updates, [](InitReqType x, InitReqType y) -> InitReqType { return RDCMAX(x, y); });
     }
 
     VkBuffer srcBuf = initial.buf;
@@ -2344,6 +2494,20 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, VkInitialContents &in
       return;    // no copy or clear required
     }
 
+    if(srcBuf == VK_NULL_HANDLE && m_ResidencyManager)
+    {
+      bool needsContents = false;
+      for(auto it = resetReq.begin(); it != resetReq.end(); it++)
+        needsContents |= (it->value() == eInitReq_Copy && it->start() < dstBufSize);
+
+      if(needsContents)
+      {
+        srcBuf = m_ResidencyManager->MakeResident(id);
+        if(srcBuf == VK_NULL_HANDLE)
+          return;
+      }
+    }
+
     VkCommandBuffer cmd = GetInitStateCmd();
 
     if(cmd == VK_NULL_HANDLE)
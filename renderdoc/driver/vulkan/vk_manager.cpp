@@ -457,7 +457,7 @@ bool VulkanResourceManager::Serialise_DeviceMemoryRefs(SerialiserType &ser,
 
       auto res = m_MemFrameRefs.insert(std::pair<ResourceId, MemRefs>(mem, MemRefs()));
       RDCASSERTMSG("MemRefIntervals for each memory resource must be contiguous", res.second);
-      Intervals<FrameRefType> &rangeRefs = res.first->second.rangeRefs;
+      TreeIntervals<FrameRefType> &rangeRefs = res.first->second.rangeRefs;
 
       auto it_ints = rangeRefs.begin();
       uint64_t last = 0;
@@ -579,7 +579,7 @@ void VulkanResourceManager::InsertDeviceMemoryRefs(WriteSerialiser &ser)
       memRefs = &emptyMemRefs;
     else
       memRefs = &it->second;
-    Intervals<FrameRefType> &rangeRefs = memRefs->rangeRefs;
+    TreeIntervals<FrameRefType> &rangeRefs = memRefs->rangeRefs;
     for(auto jt = rangeRefs.begin(); jt != rangeRefs.end(); jt++)
       data.push_back({*memIt, jt->start(), jt->value()});
   }
@@ -629,12 +629,25 @@ void VulkanResourceManager::MarkSparseMapReferenced(const ResourceInfo *sparse)
       }
       else
       {
-        // this is a huge perf cliff as we've lost any batching and we perform as badly as if every
-        // page was mapped to a different resource, so we hope applications don't hit this often.
+        // this is a perf cliff as every page could be mapped to a different place, so gather the
+        // pages per memory - merging pages that are contiguous - and update each memory's
+        // references in one batch rather than splitting its intervals page by page.
+        std::map<ResourceId, rdcarray<IntervalUpdate<FrameRefType>>> batches;
         for(const Sparse::Page &page : mapping.pages)
         {
-          MarkMemoryFrameReferenced(page.memory, page.offset, table.getPageByteSize(),
-                                    eFrameRef_Read);
+          rdcarray<IntervalUpdate<FrameRefType>> &ranges = batches[page.memory];
+          if(!ranges.empty() && ranges.back().finish == page.offset)
+            ranges.back().finish += table.getPageByteSize();
+          else
+            ranges.push_back({page.offset, page.offset + table.getPageByteSize(), eFrameRef_Read});
+        }
+
+        for(auto it = batches.begin(); it != batches.end(); ++it)
+        {
+          typedef IntervalUpdate<FrameRefType> Range;
+          std::sort(it->second.begin(), it->second.end(),
+                    [](const Range &a, const Range &b) { return a.start < b.start; });
+          MarkMemoryFrameReferenced(it->first, it->second);
         }
       }
     }
@@ -925,6 +938,22 @@ void VulkanResourceManager::MarkMemoryFrameReferenced(ResourceId mem, VkDeviceSi
   MarkResourceFrameReferenced(mem, maxRef, ComposeFrameRefsDisjoint);
 }
 
+void VulkanResourceManager::MarkMemoryFrameReferenced(
+    ResourceId mem, const rdcarray<IntervalUpdate<FrameRefType>> &ranges)
+{
+  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
+
+  FrameRefType maxRef = m_MemFrameRefs[mem].UpdateBatch(ranges, ComposeFrameRefs);
+  if(IsCompleteWriteFrameRef(maxRef))
+  {
+    // as above, only a single range covering the entire memory is really a CompleteWrite
+    VkResourceRecord *record = GetResourceRecord(mem);
+    if(ranges.size() != 1 || ranges[0].start != 0 || ranges[0].finish != record->Length)
+      maxRef = eFrameRef_PartialWrite;
+  }
+  MarkResourceFrameReferenced(mem, maxRef, ComposeFrameRefsDisjoint);
+}
+
 void VulkanResourceManager::AddMemoryFrameRefs(ResourceId mem)
 {
   m_MemFrameRefs[mem] = MemRefs();
@@ -474,6 +474,9 @@ public:
 
   void MarkMemoryFrameReferenced(ResourceId mem, VkDeviceSize start, VkDeviceSize end,
                                  FrameRefType refType);
+  // mark several ranges of one memory at once, the ranges must be sorted by offset
+  void MarkMemoryFrameReferenced(ResourceId mem,
+                                 const rdcarray<IntervalUpdate<FrameRefType>> &ranges);
   void AddMemoryFrameRefs(ResourceId mem);
   void AddDeviceMemory(ResourceId mem);
   void RemoveDeviceMemory(ResourceId mem);
@@ -33,12 +33,13 @@
 void VulkanDebugManager::CopyTex2DMSToBuffer(VkCommandBuffer cmd, VkBuffer destBuffer,
                                              VkImage srcMS, VkExtent3D extent, uint32_t baseSlice,
                                              uint32_t numSlices, uint32_t baseSample,
-                                             uint32_t numSamples, VkFormat fmt)
+                                             uint32_t numSamples, VkFormat fmt,
+                                             VkDeviceSize destOffset)
 {
   if(IsDepthOrStencilFormat(fmt))
   {
     CopyDepthTex2DMSToBuffer(cmd, destBuffer, srcMS, extent, baseSlice, numSlices, baseSample,
-                             numSamples, fmt);
+                             numSamples, fmt, destOffset);
     return;
   }
 
@@ -129,7 +130,7 @@ void VulkanDebugManager::CopyTex2DMSToBuffer(VkCommandBuffer cmd, VkBuffer destB
 
     VkDescriptorBufferInfo destdesc = {0};
     destdesc.buffer = destBuffer;
-    destdesc.offset = 0;
+    destdesc.offset = destOffset;
     destdesc.range = VK_WHOLE_SIZE;
 
     VkDescriptorSet descSet = GetBufferMSDescSet();
@@ -195,7 +196,7 @@ void VulkanDebugManager::CopyDepthTex2DMSToBuffer(VkCommandBuffer cmd, VkBuffer
                                                   VkImage srcMS, VkExtent3D extent,
                                                   uint32_t baseSlice, uint32_t numSlices,
                                                   uint32_t baseSample, uint32_t numSamples,
-                                                  VkFormat fmt)
+                                                  VkFormat fmt, VkDeviceSize destOffset)
 {
   if(m_DepthMS2BufferPipe == VK_NULL_HANDLE)
     return;
@@ -331,7 +332,7 @@ void VulkanDebugManager::CopyDepthTex2DMSToBuffer(VkCommandBuffer cmd, VkBuffer
 
   VkDescriptorBufferInfo destdesc = {0};
   destdesc.buffer = destBuffer;
-  destdesc.offset = 0;
+  destdesc.offset = destOffset;
   destdesc.range = VK_WHOLE_SIZE;
 
   VkDescriptorSet descSet = GetBufferMSDescSet();
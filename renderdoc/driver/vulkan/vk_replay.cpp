@@ -209,7 +209,7 @@ void VulkanReplay::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
     if(replayed)
       return;
   }
-  m_pDriver->ReplayLog(0, endEventID, replayType);
+  m_pDriver->ReplayLog(0, endEventID, replayType, true);
 }
 
 SDFile *VulkanReplay::GetStructuredFile()
@@ -974,7 +974,7 @@ void VulkanReplay::RenderHighlightBox(float w, float h, float scale)
     m_pDriver->SubmitCmds();
 }
 
-void VulkanReplay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &ret)
+bool VulkanReplay::GetInlineBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &ret)
 {
   bytebuf inlineData;
   bool useInlineData = false;
@@ -1083,31 +1083,512 @@ void VulkanReplay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
     useInlineData = true;
   }
 
-  if(useInlineData)
+  if(!useInlineData)
+    return false;
+
+  if(offset >= inlineData.size())
+    return true;
+
+  if(len == 0 || len > inlineData.size())
+    len = inlineData.size() - offset;
+
+  if(offset + len > inlineData.size())
+  {
+    RDCWARN(
+        "Attempting to read off the end of current push constants (%llu %llu). Will be clamped "
+        "(%llu)",
+        offset, len, inlineData.size());
+    len = RDCMIN(len, inlineData.size() - offset);
+  }
+
+  ret.resize((size_t)len);
+
+  memcpy(ret.data(), inlineData.data() + offset, ret.size());
+
+  return true;
+}
+
+void VulkanReplay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &ret)
+{
+  if(GetInlineBufferData(buff, offset, len, ret))
+    return;
+
+  GetDebugManager()->GetBufferData(buff, offset, len, ret);
+}
+
+void VulkanReplay::GetBatchResourceData(rdcarray<ReadbackRequest> &requests)
+{
+  rdcarray<ReadbackRequest *> buffers;
+
+  for(ReadbackRequest &req : requests)
+  {
+    if(req.texture)
+      GetTextureData(req.resource, req.sub, req.params, req.data);
+    else if(!GetInlineBufferData(req.resource, req.offset, req.length, req.data))
+      buffers.push_back(&req);
+  }
+
+  // all real buffers are read back together so they can share submits
+  GetDebugManager()->GetBufferData(buffers);
+}
+
+rdcarray<uint64_t> VulkanReplay::GetResourceFingerprints(rdcarray<ReadbackRequest> &requests)
+{
+  rdcarray<uint64_t> ret;
+  ret.resize(requests.size());
+
+  if(m_ContentHash.Pipe == VK_NULL_HANDLE)
+    return IRemoteDriver::GetResourceFingerprints(requests);
+
+  VkDevice dev = m_pDriver->GetDev();
+  const VkDevDispatchTable *vt = ObjDisp(dev);
+
+  // each request is copied into the scratch buffer on the GPU, then reduced there to a 64-bit hash
+  // so only the hashes are read back. Requests are batched until the scratch buffer is full.
+  const VkDeviceSize MinScratchSize = 64 * 1024 * 1024;
+  const uint32_t MaxBatchRequests = 1024;
+
+  if(m_ContentHash.Result.buf == VK_NULL_HANDLE)
+  {
+    m_ContentHash.Result.Create(m_pDriver, dev, MaxBatchRequests * sizeof(uint32_t) * 2, 1,
+                                GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
+    m_ContentHash.ResultReadback.Create(m_pDriver, dev, MaxBatchRequests * sizeof(uint32_t) * 2,
+                                        1, GPUBuffer::eGPUBufferReadback);
+  }
+
+  // a range of the scratch buffer that's hashed into a request's result. Depth-stencil
+  // subresources have one range per aspect, with positions continuing on from the depth
+  struct HashRange
   {
-    if(offset >= inlineData.size())
+    uint32_t slot;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    uint32_t positionBase;
+  };
+
+  rdcarray<HashRange> ranges;
+  // the request that each result slot in the current batch is for
+  rdcarray<size_t> slots;
+  VkDeviceSize scratchUsed = 0;
+
+  // requests we can't copy on the GPU, e.g. multi-planar images or CPU-side buffers
+  rdcarray<size_t> fallback;
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkCommandBuffer cmd = VK_NULL_HANDLE;
+  VkResult vkr = VK_SUCCESS;
+
+  auto beginCmd = [&]() {
+    cmd = m_pDriver->GetNextCmd();
+
+    if(cmd == VK_NULL_HANDLE)
+      return false;
+
+    vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+    CHECK_VKR(m_pDriver, vkr);
+    return true;
+  };
+
+  // hash everything copied so far and read back the results
+  auto flush = [&]() {
+    if(slots.empty() || cmd == VK_NULL_HANDLE)
       return;
 
-    if(len == 0 || len > inlineData.size())
-      len = inlineData.size() - offset;
+    VkBufferMemoryBarrier barriers[2] = {
+        {
+            VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            NULL,
+            VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            VK_ACCESS_SHADER_READ_BIT,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            Unwrap(m_ContentHash.Scratch.buf),
+            0,
+            VK_WHOLE_SIZE,
+        },
+        {
+            VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            NULL,
+            VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            Unwrap(m_ContentHash.Result.buf),
+            0,
+            VK_WHOLE_SIZE,
+        },
+    };
 
-    if(offset + len > inlineData.size())
+    const VkDeviceSize resultSize = slots.size() * sizeof(uint32_t) * 2;
+
+    vt->CmdFillBuffer(Unwrap(cmd), Unwrap(m_ContentHash.Result.buf), 0, resultSize, 0);
+
+    // wait for the copies and the clear before hashing
+    DoPipelineBarrier(cmd, ARRAY_COUNT(barriers), barriers);
+
+    vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
+                        Unwrap(m_ContentHash.Pipe));
+    vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
+                              Unwrap(m_ContentHash.PipeLayout), 0, 1,
+                              UnwrapPtr(m_ContentHash.DescSet), 0, NULL);
+
+    for(const HashRange &range : ranges)
     {
-      RDCWARN(
-          "Attempting to read off the end of current push constants (%llu %llu). Will be clamped "
-          "(%llu)",
-          offset, len, inlineData.size());
-      len = RDCMIN(len, inlineData.size() - offset);
+      Vec4u push = {uint32_t(range.offset / 4), uint32_t(range.size), range.slot,
+                    range.positionBase};
+
+      vt->CmdPushConstants(Unwrap(cmd), Unwrap(m_ContentHash.PipeLayout), VK_SHADER_STAGE_ALL, 0,
+                           sizeof(push), &push);
+
+      const VkDeviceSize numWords = AlignUp(range.size, (VkDeviceSize)4) / 4;
+      const uint32_t numGroups = (uint32_t)RDCMIN(
+          AlignUp(numWords, (VkDeviceSize)HASH_LOCAL_SIZE) / HASH_LOCAL_SIZE,
+          (VkDeviceSize)HASH_MAX_WORKGROUPS);
+
+      vt->CmdDispatch(Unwrap(cmd), RDCMAX(1U, numGroups), 1, 1);
     }
 
-    ret.resize((size_t)len);
+    barriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[0].buffer = Unwrap(m_ContentHash.Result.buf);
 
-    memcpy(ret.data(), inlineData.data() + offset, ret.size());
+    // wait for the hashes before copying them to the readback buffer
+    DoPipelineBarrier(cmd, 1, barriers);
 
-    return;
+    VkBufferCopy region = {0, 0, resultSize};
+    vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(m_ContentHash.Result.buf),
+                      Unwrap(m_ContentHash.ResultReadback.buf), 1, &region);
+
+    barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    barriers[0].buffer = Unwrap(m_ContentHash.ResultReadback.buf);
+
+    // wait for copy to complete before mapping
+    DoPipelineBarrier(cmd, 1, barriers);
+
+    vt->EndCommandBuffer(Unwrap(cmd));
+    cmd = VK_NULL_HANDLE;
+
+    m_pDriver->SubmitCmds();
+    m_pDriver->FlushQ();
+
+    uint32_t *hashes = (uint32_t *)m_ContentHash.ResultReadback.Map(NULL, resultSize);
+    if(hashes)
+    {
+      for(size_t i = 0; i < slots.size(); i++)
+        ret[slots[i]] = uint64_t(hashes[i * 2 + 0]) | (uint64_t(hashes[i * 2 + 1]) << 32);
+
+      m_ContentHash.ResultReadback.Unmap();
+    }
+
+    ranges.clear();
+    slots.clear();
+    scratchUsed = 0;
+  };
+
+  // make sure there's room for size bytes at the given alignment, flushing or growing the scratch
+  // buffer if needed. Returns the offset to copy to
+  auto reserve = [&](VkDeviceSize size, VkDeviceSize alignment) -> VkDeviceSize {
+    // the shader reads whole words, so make sure the last partial word is still in the buffer
+    size = AlignUp(size, (VkDeviceSize)4);
+
+    VkDeviceSize offset = AlignUp(scratchUsed, alignment);
+
+    if(slots.size() >= MaxBatchRequests ||
+       (m_ContentHash.Scratch.buf != VK_NULL_HANDLE && offset + size > m_ContentHash.Scratch.sz))
+    {
+      flush();
+      offset = 0;
+    }
+
+    if(m_ContentHash.Scratch.buf == VK_NULL_HANDLE || size > m_ContentHash.Scratch.sz)
+    {
+      m_ContentHash.Scratch.Destroy();
+      m_ContentHash.Scratch.Create(m_pDriver, dev, RDCMAX(MinScratchSize, AlignUp(size, alignment)),
+                                   1, GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
+
+      VkDescriptorBufferInfo bufInfo[2] = {};
+      m_ContentHash.Scratch.FillDescriptor(bufInfo[0]);
+      m_ContentHash.Result.FillDescriptor(bufInfo[1]);
+
+      VkWriteDescriptorSet writes[] = {
+          {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(m_ContentHash.DescSet), 0, 0, 1,
+           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &bufInfo[0], NULL},
+          {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(m_ContentHash.DescSet), 1, 0, 1,
+           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &bufInfo[1], NULL},
+      };
+      vt->UpdateDescriptorSets(Unwrap(dev), ARRAY_COUNT(writes), writes, 0, NULL);
+    }
+
+    scratchUsed = offset + size;
+    return offset;
+  };
+
+  // storage buffer offsets need at most 256 byte alignment, and copies need a multiple of the texel
+  // block size
+  auto copyAlignment = [](uint32_t blockBytes) -> VkDeviceSize {
+    if((blockBytes & (blockBytes - 1)) == 0)
+      return RDCMAX(256U, blockBytes);
+    return VkDeviceSize(256) * blockBytes;
+  };
+
+  for(size_t i = 0; i < requests.size(); i++)
+  {
+    const ReadbackRequest &req = requests[i];
+
+    if(!req.texture)
+    {
+      // push constants and other CPU-side buffers are hashed from their data
+      if(m_pDriver->m_CreationInfo.m_Buffer.find(req.resource) ==
+             m_pDriver->m_CreationInfo.m_Buffer.end() &&
+         m_pDriver->m_CreationInfo.m_Memory.find(req.resource) ==
+             m_pDriver->m_CreationInfo.m_Memory.end())
+      {
+        fallback.push_back(i);
+        continue;
+      }
+
+      WrappedVkRes *res = GetResourceManager()->GetCurrentResource(req.resource);
+
+      VkBuffer srcBuf = VK_NULL_HANDLE;
+      uint64_t bufsize = 0;
+
+      if(res && WrappedVkDeviceMemory::IsAlloc(res))
+      {
+        srcBuf = m_pDriver->m_CreationInfo.m_Memory[req.resource].wholeMemBuf;
+        bufsize = m_pDriver->m_CreationInfo.m_Memory[req.resource].wholeMemBufSize;
+      }
+      else if(res && WrappedVkBuffer::IsAlloc(res))
+      {
+        srcBuf = GetResourceManager()->GetCurrentHandle<VkBuffer>(req.resource);
+        bufsize = m_pDriver->m_CreationInfo.m_Buffer[req.resource].size;
+      }
+
+      if(srcBuf == VK_NULL_HANDLE || req.offset >= bufsize)
+        continue;
+
+      uint64_t len = req.length;
+      if(len == 0 || len > bufsize - req.offset)
+        len = bufsize - req.offset;
+
+      // the shader takes the size as 32-bit
+      if(len > 0xffffffffULL)
+      {
+        fallback.push_back(i);
+        continue;
+      }
+
+      VkDeviceSize offset = reserve(len, 256);
+
+      if(cmd == VK_NULL_HANDLE && !beginCmd())
+        return ret;
+
+      VkBufferMemoryBarrier bufBarrier = {
+          VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+          NULL,
+          VK_ACCESS_ALL_WRITE_BITS,
+          VK_ACCESS_TRANSFER_READ_BIT,
+          VK_QUEUE_FAMILY_IGNORED,
+          VK_QUEUE_FAMILY_IGNORED,
+          Unwrap(srcBuf),
+          req.offset,
+          len,
+      };
+
+      DoPipelineBarrier(cmd, 1, &bufBarrier);
+
+      VkBufferCopy region = {req.offset, offset, len};
+      vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(m_ContentHash.Scratch.buf), 1, &region);
+
+      ranges.push_back({(uint32_t)slots.size(), offset, len, 0});
+      slots.push_back(i);
+      continue;
+    }
+
+    auto imit = m_pDriver->m_CreationInfo.m_Image.find(req.resource);
+    if(imit == m_pDriver->m_CreationInfo.m_Image.end())
+    {
+      RDCERR("Trying to get fingerprint for unknown image %s!", ToStr(req.resource).c_str());
+      continue;
+    }
+
+    const VulkanCreationInfo::Image &imInfo = imit->second;
+
+    const VkImageAspectFlags aspects = FormatImageAspects(imInfo.format);
+    const bool isDepth = (aspects & VK_IMAGE_ASPECT_DEPTH_BIT) != 0;
+    const bool isStencil = (aspects & VK_IMAGE_ASPECT_STENCIL_BIT) != 0;
+    const bool isMS = imInfo.samples > 1;
+
+    const uint32_t mip = RDCMIN(uint32_t(imInfo.mipLevels - 1), req.sub.mip);
+    const uint32_t slice = RDCMIN(uint32_t(imInfo.arrayLayers - 1), req.sub.slice);
+    const uint32_t sample = RDCMIN(uint32_t(imInfo.samples - 1), req.sub.sample);
+
+    const VkExtent3D &ext = imInfo.extent;
+
+    // each piece of the subresource to copy, relative to where it's placed in the scratch buffer
+    rdcarray<VkBufferImageCopy> regions;
+    rdcarray<HashRange> pieces;
+    VkDeviceSize alignment = 256;
+
+    VkBufferImageCopy region = {
+        0,
+        0,
+        0,
+        {VK_IMAGE_ASPECT_COLOR_BIT, mip, imInfo.type == VK_IMAGE_TYPE_3D ? 0 : slice, 1},
+        {0, 0, 0},
+        {RDCMAX(1U, ext.width >> mip), RDCMAX(1U, ext.height >> mip),
+         RDCMAX(1U, ext.depth >> mip)},
+    };
+
+    if(aspects & VK_IMAGE_ASPECT_PLANE_0_BIT)
+    {
+      fallback.push_back(i);
+      continue;
+    }
+    else if(isMS)
+    {
+      // each sample is copied out by a compute shader, depth and stencil interleaved
+      BuiltinShader copyShader =
+          (isDepth || isStencil) ? BuiltinShader::DepthMS2BufferCS : BuiltinShader::MS2BufferCS;
+      if(m_pDriver->GetShaderCache()->GetBuiltinModule(copyShader) == VK_NULL_HANDLE)
+      {
+        fallback.push_back(i);
+        continue;
+      }
+
+      pieces.push_back({0, 0, GetByteSize(ext.width, ext.height, 1, imInfo.format, 0), 0});
+    }
+    else if(isDepth || isStencil)
+    {
+      // copy each aspect separately, the way they're laid out in buffers
+      VkDeviceSize offset = 0;
+      uint32_t position = 0;
+
+      if(isDepth)
+      {
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        regions.push_back(region);
+
+        VkDeviceSize size = GetByteSize(ext.width, ext.height, ext.depth,
+                                        GetDepthOnlyFormat(imInfo.format), mip);
+        pieces.push_back({0, offset, size, position});
+
+        offset = AlignUp(size, (VkDeviceSize)4);
+        position = uint32_t(offset / 4);
+      }
+
+      if(isStencil)
+      {
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
+        region.bufferOffset = offset;
+        regions.push_back(region);
+
+        pieces.push_back(
+            {0, offset, GetByteSize(ext.width, ext.height, ext.depth, VK_FORMAT_S8_UINT, mip),
+             position});
+      }
+    }
+    else
+    {
+      regions.push_back(region);
+      pieces.push_back(
+          {0, 0, GetByteSize(ext.width, ext.height, ext.depth, imInfo.format, mip), 0});
+      alignment = copyAlignment(GetBlockShape(imInfo.format, 0).bytes);
+    }
+
+    const VkDeviceSize totalSize = pieces.back().offset + pieces.back().size;
+
+    if(totalSize > 0xffffffffULL)
+    {
+      fallback.push_back(i);
+      continue;
+    }
+
+    LockedConstImageStateRef lockedImage = m_pDriver->FindConstImageState(req.resource);
+    if(!lockedImage || !lockedImage->isMemoryBound)
+      continue;
+
+    VkDeviceSize base = reserve(totalSize, alignment);
+
+    if(cmd == VK_NULL_HANDLE && !beginCmd())
+      return ret;
+
+    VkImage srcImage = Unwrap(GetResourceManager()->GetCurrentHandle<VkImage>(req.resource));
+
+    ImageBarrierSequence setupBarriers, cleanupBarriers;
+    lockedImage->TempTransition(
+        m_pDriver->m_QueueFamilyIdx,
+        isMS ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        isMS ? VK_ACCESS_SHADER_READ_BIT : VK_ACCESS_TRANSFER_READ_BIT, setupBarriers,
+        cleanupBarriers, m_pDriver->GetImageTransitionInfo());
+    m_pDriver->InlineSetupImageBarriers(cmd, setupBarriers);
+    m_pDriver->SubmitAndFlushImageStateBarriers(setupBarriers);
+
+    if(isMS)
+    {
+      GetDebugManager()->CopyTex2DMSToBuffer(cmd, Unwrap(m_ContentHash.Scratch.buf), srcImage, ext,
+                                             slice, 1, sample, 1, imInfo.format, base);
+    }
+    else
+    {
+      for(VkBufferImageCopy &r : regions)
+        r.bufferOffset += base;
+
+      vt->CmdCopyImageToBuffer(Unwrap(cmd), srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               Unwrap(m_ContentHash.Scratch.buf), (uint32_t)regions.size(),
+                               regions.data());
+    }
+
+    m_pDriver->InlineCleanupImageBarriers(cmd, cleanupBarriers);
+
+    if(!cleanupBarriers.empty())
+    {
+      // ensure the copy happens before handing back the image to the original queue
+      vkr = vt->EndCommandBuffer(Unwrap(cmd));
+      CHECK_VKR(m_pDriver, vkr);
+
+      m_pDriver->SubmitCmds();
+      m_pDriver->FlushQ();
+
+      m_pDriver->SubmitAndFlushImageStateBarriers(cleanupBarriers);
+
+      if(!beginCmd())
+        return ret;
+    }
+
+    for(HashRange &piece : pieces)
+    {
+      piece.slot = (uint32_t)slots.size();
+      piece.offset += base;
+      ranges.push_back(piece);
+    }
+
+    slots.push_back(i);
   }
 
-  GetDebugManager()->GetBufferData(buff, offset, len, ret);
+  flush();
+
+  if(cmd != VK_NULL_HANDLE)
+  {
+    vt->EndCommandBuffer(Unwrap(cmd));
+    m_pDriver->SubmitCmds();
+  }
+
+  if(!fallback.empty())
+  {
+    rdcarray<ReadbackRequest> readbacks;
+    for(size_t i : fallback)
+      readbacks.push_back(requests[i]);
+
+    rdcarray<uint64_t> hashes = IRemoteDriver::GetResourceFingerprints(readbacks);
+
+    for(size_t i = 0; i < fallback.size() && i < hashes.size(); i++)
+      ret[fallback[i]] = hashes[i];
+  }
+
+  return ret;
 }
 
 void VulkanReplay::FileChanged()
@@ -4899,6 +5380,8 @@ void VulkanReplay::FreeTargetResource(ResourceId id)
 
 void VulkanReplay::ReplaceResource(ResourceId from, ResourceId to)
 {
+  m_pDriver->InvalidateIncrementalReplay();
+
   // remove existing shader replacement
   m_pDriver->GetResourceManager()->RemoveReplacement(from);
 
@@ -4919,6 +5402,8 @@ void VulkanReplay::RemoveReplacement(ResourceId id)
 {
   if(m_pDriver->GetResourceManager()->HasReplacement(id))
   {
+    m_pDriver->InvalidateIncrementalReplay();
+
     m_pDriver->GetResourceManager()->RemoveReplacement(id);
 
     RefreshDerivedReplacements();
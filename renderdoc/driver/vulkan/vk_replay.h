@@ -291,6 +291,9 @@ struct ShaderDebugData
 
   std::map<uint32_t, VkPipeline> m_Pipelines;
 
+  // how many math results can be read back in one submission
+  static const uint32_t MathBatchSize = 64;
+
   GPUBuffer MathResult;
   GPUBuffer ConstantsBuffer;
   GPUBuffer ReadbackBuffer;
@@ -408,6 +411,8 @@ public:
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &retData);
   void GetTextureData(ResourceId tex, const Subresource &sub, const GetTextureDataParams &params,
                       bytebuf &data);
+  void GetBatchResourceData(rdcarray<ReadbackRequest> &requests);
+  rdcarray<uint64_t> GetResourceFingerprints(rdcarray<ReadbackRequest> &requests);
 
   void ReplaceResource(ResourceId from, ResourceId to);
   void RemoveReplacement(ResourceId id);
@@ -452,6 +457,8 @@ public:
   ShaderDebugTrace *DebugThread(uint32_t eventId, const rdcfixedarray<uint32_t, 3> &groupid,
                                 const rdcfixedarray<uint32_t, 3> &threadid);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
+  ShaderDebugState RunDebug(ShaderDebugger *debugger, const rdcarray<uint32_t> &breakpoints,
+                            uint32_t maxSteps);
   void FreeDebugger(ShaderDebugger *debugger);
 
   uint32_t PickVertex(uint32_t eventId, int32_t width, int32_t height, const MeshDisplay &cfg,
@@ -491,12 +498,17 @@ public:
   bool Depth3DSupported() { return m_TexRender.DummyImages[3][2] != VK_NULL_HANDLE; }
   bool DepthCubeSupported() { return m_TexRender.DepthCubesSupported; }
 private:
+  // returns true if buff is one of the virtual buffers backed by CPU-side data, e.g. push constants
+  bool GetInlineBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &ret);
+
   bool FetchShaderFeedback(uint32_t eventId);
   void ClearFeedbackCache();
 
   void FillDescriptor(Descriptor &dstel, const DescriptorSetSlot &srcel);
   void FillSamplerDescriptor(SamplerDescriptor &dstel, const DescriptorSetSlot &srcel);
 
+  void PrepareShaderDebugDummyWrites();
+
   void PatchReservedDescriptors(const VulkanStatePipeline &pipe, VkDescriptorPool &descpool,
                                 rdcarray<VkDescriptorSetLayout> &setLayouts,
                                 rdcarray<VkDescriptorSet> &descSets,
@@ -800,6 +812,23 @@ private:
     VkPipeline m_MinMaxResultPipe[3] = {VK_NULL_HANDLE};
   } m_Histogram;
 
+  struct ContentHash
+  {
+    void Init(WrappedVulkan *driver, VkDescriptorPool descriptorPool);
+    void Destroy(WrappedVulkan *driver);
+
+    // contents are copied here to be hashed. Created on first use, and grown if a single
+    // subresource or buffer doesn't fit
+    GPUBuffer Scratch;
+    // two words for each request hashed in a batch, and the copy to read them back
+    GPUBuffer Result;
+    GPUBuffer ResultReadback;
+    VkDescriptorSetLayout DescSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSet DescSet = VK_NULL_HANDLE;
+    VkPipelineLayout PipeLayout = VK_NULL_HANDLE;
+    VkPipeline Pipe = VK_NULL_HANDLE;
+  } m_ContentHash;
+
   struct PostVS
   {
     void Destroy(WrappedVulkan *driver);
@@ -0,0 +1,242 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "vk_residency.h"
+#include "core/settings.h"
+#include "vk_core.h"
+
+RDOC_CONFIG(bool, Vulkan_Debug_ResidencyLogging, false,
+            "Output the initial contents resident set and upload/eviction counts after each "
+            "replay, when the initial contents budget is in use.");
+
+VulkanResidencyManager::VulkanResidencyManager(WrappedVulkan *driver, uint64_t budget)
+    : m_pDriver(driver), m_Budget(budget)
+{
+}
+
+VulkanResidencyManager::~VulkanResidencyManager()
+{
+  // the device must be idle by now, nothing can still be reading from these
+  for(ResourceId id : m_Resident)
+    Evict(m_Entries[id]);
+  m_Resident.clear();
+
+  m_pDriver->FreeAllMemory(MemoryScope::InitialContentsResident);
+}
+
+bytebuf &VulkanResidencyManager::AddContents(ResourceId id, uint64_t size)
+{
+  Entry &entry = m_Entries[id];
+
+  // the space isn't reclaimed until the next reset, but the old contents can't be used again
+  if(entry.buf != VK_NULL_HANDLE)
+  {
+    Evict(entry);
+    m_Resident.removeOne(id);
+  }
+
+  m_Stats.hostBytes -= entry.contents.size();
+  entry.contents.resize((size_t)size);
+  m_Stats.hostBytes += entry.contents.size();
+
+  return entry.contents;
+}
+
+VkBuffer VulkanResidencyManager::MakeResident(ResourceId id)
+{
+  auto it = m_Entries.find(id);
+  if(it == m_Entries.end())
+  {
+    RDCERR("No initial contents stored for %s", ToStr(id).c_str());
+    return VK_NULL_HANDLE;
+  }
+
+  Entry &entry = it->second;
+
+  if(entry.buf == VK_NULL_HANDLE)
+  {
+    uint64_t size = entry.contents.size();
+
+    if(m_Stats.residentBytes > 0 && m_Stats.residentBytes + size > m_Budget)
+    {
+      // work we've recorded in this apply reads from the current uploads. Flush it through so
+      // they can be evicted, rather than growing past the budget.
+      if(m_PendingWork)
+      {
+        m_pDriver->CloseInitStateCmd();
+        m_pDriver->SubmitAndFlushImageStateBarriers(m_pDriver->m_setupImageBarriers);
+        m_pDriver->SubmitCmds();
+        m_pDriver->FlushQ();
+        m_pDriver->SubmitAndFlushImageStateBarriers(m_pDriver->m_cleanupImageBarriers);
+
+        m_PendingWork = false;
+        m_Stats.flushes++;
+      }
+
+      EvictAll();
+    }
+
+    if(!Upload(entry))
+      return VK_NULL_HANDLE;
+
+    m_Resident.push_back(id);
+  }
+
+  m_PendingWork = true;
+
+  return entry.buf;
+}
+
+void VulkanResidencyManager::BeginApply()
+{
+  m_PendingWork = false;
+
+  m_Stats.uploads = m_Stats.uploadedBytes = m_Stats.evictions = m_Stats.resets =
+      m_Stats.flushes = 0;
+}
+
+void VulkanResidencyManager::EndApply()
+{
+  // the apply has been flushed, so nothing is reading from the uploads anymore
+  m_PendingWork = false;
+
+  // a single upload larger than the budget is allowed through, but don't keep it around
+  if(m_Stats.residentBytes > m_Budget)
+    EvictAll();
+
+  if(Vulkan_Debug_ResidencyLogging())
+  {
+    RDCLOG("Initial contents: %llu resident (%llu MB of %llu MB), %llu MB in host memory",
+           m_Stats.residentCount, m_Stats.residentBytes / (1024 * 1024), m_Budget / (1024 * 1024),
+           m_Stats.hostBytes / (1024 * 1024));
+    RDCLOG("  %llu uploads (%llu MB), %llu evictions in %llu resets, %llu flushes",
+           m_Stats.uploads, m_Stats.uploadedBytes / (1024 * 1024), m_Stats.evictions,
+           m_Stats.resets, m_Stats.flushes);
+  }
+}
+
+bool VulkanResidencyManager::Upload(Entry &entry)
+{
+  VkDevice d = m_pDriver->GetDev();
+  VkResult vkr = VK_SUCCESS;
+
+  VkBufferCreateInfo bufInfo = {
+      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, NULL, 0, entry.contents.size(),
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT};
+
+  vkr = m_pDriver->vkCreateBuffer(d, &bufInfo, NULL, &entry.buf);
+  CHECK_VKR(m_pDriver, vkr);
+
+  if(vkr != VK_SUCCESS)
+  {
+    entry.buf = VK_NULL_HANDLE;
+    return false;
+  }
+
+  // sub-allocate from blocks that are reused on every reset, so the number of device allocations
+  // stays bounded by the budget rather than by the number of resources
+  entry.alloc = m_pDriver->AllocateMemoryForResource(
+      entry.buf, MemoryScope::InitialContentsResident, MemoryType::Upload);
+
+  if(entry.alloc.mem == VK_NULL_HANDLE)
+  {
+    RDCERR("Failed to allocate %llu bytes for initial contents upload",
+           (uint64_t)entry.contents.size());
+    m_pDriver->vkDestroyBuffer(d, entry.buf, NULL);
+    entry.buf = VK_NULL_HANDLE;
+    entry.alloc = MemoryAllocation();
+    return false;
+  }
+
+  vkr = m_pDriver->vkBindBufferMemory(d, entry.buf, entry.alloc.mem, entry.alloc.offs);
+  CHECK_VKR(m_pDriver, vkr);
+
+  const VkDeviceSize nonCoherentAtomSize =
+      m_pDriver->GetDeviceProps().limits.nonCoherentAtomSize;
+  const VkDeviceSize mapSize = AlignUp(entry.alloc.size, nonCoherentAtomSize);
+
+  byte *ptr = NULL;
+  vkr = ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(entry.alloc.mem), entry.alloc.offs, mapSize, 0,
+                              (void **)&ptr);
+  CHECK_VKR(m_pDriver, vkr);
+
+  if(ptr)
+  {
+    memcpy(ptr, entry.contents.data(), entry.contents.size());
+
+    VkMappedMemoryRange range = {
+        VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+        NULL,
+        Unwrap(entry.alloc.mem),
+        entry.alloc.offs,
+        mapSize,
+    };
+
+    vkr = ObjDisp(d)->FlushMappedMemoryRanges(Unwrap(d), 1, &range);
+    CHECK_VKR(m_pDriver, vkr);
+
+    ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(entry.alloc.mem));
+  }
+  else
+  {
+    RDCERR("Manually reporting failed memory map");
+    CHECK_VKR(m_pDriver, VK_ERROR_MEMORY_MAP_FAILED);
+  }
+
+  m_Stats.residentCount++;
+  m_Stats.residentBytes = m_pDriver->CurMemoryUsage(MemoryScope::InitialContentsResident);
+  m_Stats.uploads++;
+  m_Stats.uploadedBytes += entry.contents.size();
+
+  return true;
+}
+
+void VulkanResidencyManager::Evict(Entry &entry)
+{
+  if(entry.buf == VK_NULL_HANDLE)
+    return;
+
+  VkDevice d = m_pDriver->GetDev();
+
+  m_pDriver->vkDestroyBuffer(d, entry.buf, NULL);
+
+  // the memory itself is only reclaimed when the whole scope is reset
+  m_Stats.residentCount--;
+  m_Stats.evictions++;
+
+  entry.buf = VK_NULL_HANDLE;
+  entry.alloc = MemoryAllocation();
+}
+
+void VulkanResidencyManager::EvictAll()
+{
+  for(ResourceId id : m_Resident)
+    Evict(m_Entries[id]);
+  m_Resident.clear();
+
+  m_pDriver->ResetMemoryBlocks(MemoryScope::InitialContentsResident);
+
+  m_Stats.residentBytes = 0;
+  m_Stats.resets++;
+}
@@ -0,0 +1,107 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <map>
+#include "vk_common.h"
+
+class WrappedVulkan;
+
+// Caps the staging memory used for initial contents on replay. The initial contents of memory and
+// single-sample images are kept in host memory, and only uploaded to a staging buffer when an apply
+// actually needs to copy from them. Without this every resource's initial contents has its own
+// upload buffer for the lifetime of the replay.
+//
+// This only covers the initial contents staging. The application's own resources are all still
+// created and bound when the capture is loaded and are never evicted, so a capture that needs more
+// device memory than is available for those will still fail to load. There is no per-event use
+// tracking either. Which contents an apply needs comes from the frame references that already
+// decide whether a resource is copied, cleared or skipped.
+//
+// Uploads are sub-allocated from their own memory scope. Since the memory manager can only free a
+// whole scope, once the cap is reached every upload is evicted at once and the scope's blocks are
+// reused. If the current apply has already recorded copies from the uploads, the pending initial
+// state work is submitted and flushed first. When one apply needs more than the cap this happens on
+// every replay, so the cap trades upload bandwidth for staging memory rather than avoiding uploads.
+class VulkanResidencyManager
+{
+public:
+  struct Stats
+  {
+    uint64_t residentCount = 0;
+    uint64_t residentBytes = 0;
+    uint64_t hostBytes = 0;
+
+    // these are reset at the start of each apply
+    uint64_t uploads = 0;
+    uint64_t uploadedBytes = 0;
+    uint64_t evictions = 0;
+    uint64_t resets = 0;
+    uint64_t flushes = 0;
+  };
+
+  VulkanResidencyManager(WrappedVulkan *driver, uint64_t budget);
+  ~VulkanResidencyManager();
+
+  // returns storage for the host copy of the given resource's initial contents. Any previous
+  // contents (and upload) are discarded.
+  bytebuf &AddContents(ResourceId id, uint64_t size);
+
+  // returns a transfer source buffer containing the initial contents for the given resource,
+  // uploading it if necessary. Must be called before recording into the init state command buffer
+  // for the resource, as it may need to submit the pending work to make room.
+  VkBuffer MakeResident(ResourceId id);
+
+  void BeginApply();
+  void EndApply();
+
+  const Stats &GetStats() const { return m_Stats; }
+private:
+  struct Entry
+  {
+    bytebuf contents;
+
+    VkBuffer buf = VK_NULL_HANDLE;
+    MemoryAllocation alloc;
+  };
+
+  bool Upload(Entry &entry);
+  void Evict(Entry &entry);
+  void EvictAll();
+
+  WrappedVulkan *m_pDriver;
+  uint64_t m_Budget;
+
+  std::map<ResourceId, Entry> m_Entries;
+
+  // entries with an upload, in the order they were uploaded
+  rdcarray<ResourceId> m_Resident;
+
+  // set when work recorded in the current apply reads from a resident upload, and cleared when
+  // that work is flushed
+  bool m_PendingWork = false;
+
+  Stats m_Stats;
+};
@@ -1065,7 +1065,9 @@ struct ResourceInfo
 
 struct MemRefs
 {
-  Intervals<FrameRefType> rangeRefs;
+  // memory can be referenced in many small pieces at arbitrary offsets, so use the tree-backed
+  // intervals to keep splits cheap
+  TreeIntervals<FrameRefType> rangeRefs;
   WrappedVkRes *initializedLiveRes;
   inline MemRefs() : initializedLiveRes(NULL) {}
   inline MemRefs(VkDeviceSize offset, VkDeviceSize size, FrameRefType refType)
@@ -1081,6 +1083,8 @@ struct MemRefs
     return Update(offset, size, refType, ComposeFrameRefs);
   }
   template <typename Compose>
+  FrameRefType UpdateBatch(const rdcarray<IntervalUpdate<FrameRefType>> &ranges, Compose comp);
+  template <typename Compose>
   FrameRefType Merge(MemRefs &other, Compose comp);
   inline FrameRefType Merge(MemRefs &other) { return Merge(other, ComposeFrameRefs); }
 };
@@ -1181,17 +1185,30 @@ struct CmdBufferRecordingInfo
 
 struct DescSetLayout;
 
-struct DescriptorSetData
+// frame references gathered from descriptors. Large descriptor sets refer to the same few resources
+// many times over, so rather than hashing every reference into a map they're appended to a flat
+// array and merged once with Resolve(). Consecutive references to the same resource, as from an
+// array of descriptors, are merged as they're added.
+struct DescriptorFrameRefs
 {
-  DescriptorSetData() : layout(NULL) {}
-  DescriptorSetData(const DescriptorSetData &) = delete;
-  DescriptorSetData &operator=(const DescriptorSetData &) = delete;
-  ~DescriptorSetData() { data.clear(); }
-  DescSetLayout *layout;
+  // add a reference, composed either with ComposeFrameRefsUnordered or ComposeFrameRefsDisjoint
+  void Add(ResourceId id, FrameRefType ref, bool disjoint);
 
-  // descriptor set bindings for this descriptor set. Filled out on
-  // create from the layout.
-  BindingStorage data;
+  // sort and merge the references so each resource is listed once in refs. References to the same
+  // resource are composed in the order they were added.
+  void Resolve();
+
+  rdcarray<rdcpair<ResourceId, FrameRefType>> refs;
+
+private:
+  struct Entry
+  {
+    ResourceId id;
+    FrameRefType ref;
+    bool disjoint;
+  };
+
+  rdcarray<Entry> entries;
 };
 
 // we used to cache these bindrefs at update time, but unfortunately many applications have
@@ -1200,13 +1217,30 @@ struct DescriptorSetData
 // gather the data we need from the descriptor contents at capture time only into this struct.
 struct DescriptorBindRefs
 {
-  std::unordered_map<ResourceId, FrameRefType> bindFrameRefs;
+  DescriptorFrameRefs bindFrameRefs;
   std::unordered_map<ResourceId, MemRefs> bindMemRefs;
   rdcflatmap<ResourceId, ImageState> bindImageStates;
   std::unordered_set<VkResourceRecord *> sparseRefs;
   std::unordered_set<VkResourceRecord *> storableRefs;
 };
 
+struct DescriptorSetData
+{
+  DescriptorSetData() : layout(NULL) {}
+  DescriptorSetData(const DescriptorSetData &) = delete;
+  DescriptorSetData &operator=(const DescriptorSetData &) = delete;
+  ~DescriptorSetData() { data.clear(); }
+  DescSetLayout *layout;
+
+  // descriptor set bindings for this descriptor set. Filled out on
+  // create from the layout.
+  BindingStorage data;
+
+  // incremented whenever the set is written, so references gathered from it while capturing a
+  // frame can be reused until it changes.
+  uint32_t writeGeneration = 0;
+};
+
 struct PipelineLayoutData
 {
   rdcarray<DescSetLayout> layouts;
@@ -2179,6 +2213,20 @@ FrameRefType MemRefs::Update(VkDeviceSize offset, VkDeviceSize size, FrameRefTyp
   return maxRefType;
 }
 
+template <typename Compose>
+FrameRefType MemRefs::UpdateBatch(const rdcarray<IntervalUpdate<FrameRefType>> &ranges,
+                                  Compose comp)
+{
+  FrameRefType maxRefType = eFrameRef_None;
+  rangeRefs.updateBatch(
+      ranges, [&maxRefType, comp](FrameRefType oldRef, FrameRefType newRef) -> FrameRefType {
+        FrameRefType ref = comp(oldRef, newRef);
+        maxRefType = ComposeFrameRefsDisjoint(maxRefType, ref);
+        return ref;
+      });
+  return maxRefType;
+}
+
 template <typename Compose>
 FrameRefType MemRefs::Merge(MemRefs &other, Compose comp)
 {
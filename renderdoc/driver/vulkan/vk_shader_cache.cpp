@@ -24,9 +24,14 @@
 
 #include "vk_shader_cache.h"
 #include "common/shader_cache.h"
+#include "core/settings.h"
 #include "data/glsl_shaders.h"
 #include "strings/string_utils.h"
 
+RDOC_CONFIG(bool, Vulkan_Replay_PipelineCacheOnDisk, true,
+            "Keep a pipeline cache on disk for each capture on replay, so that reopening the same "
+            "capture doesn't need to recompile all of its pipelines.");
+
 enum class FeatureCheck
 {
   NoCheck = 0x0,
@@ -142,6 +147,8 @@ static const BuiltinShaderConfig builtinShaders[] = {
                         rdcspv::ShaderStage::Fragment, FeatureCheck::FragmentStores),
     BuiltinShaderConfig(BuiltinShader::DepthCopyMSFS, EmbeddedResource(glsl_depth_copyms_frag),
                         rdcspv::ShaderStage::Fragment, FeatureCheck::FragmentStores),
+    BuiltinShaderConfig(BuiltinShader::ContentHashCS, EmbeddedResource(glsl_vk_contenthash_comp),
+                        rdcspv::ShaderStage::Compute),
 };
 
 RDCCOMPILE_ASSERT(ARRAY_COUNT(builtinShaders) == arraydim<BuiltinShader>(),
@@ -353,46 +360,8 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
 
     GetPipeCacheBlob();
 
-    if(!m_PipeCacheBlob.empty())
-    {
-      if(m_PipeCacheBlob.size() < sizeof(VkPipeCacheHeader))
-      {
-        m_PipeCacheBlob.clear();
-      }
-      else
-      {
-        VkPipeCacheHeader *header = (VkPipeCacheHeader *)m_PipeCacheBlob.data();
-
-        // check explicitly for incompatibility
-        if(header->length != sizeof(VkPipeCacheHeader))
-        {
-          m_PipeCacheBlob.clear();
-          RDCLOG("Pipeline cache header length %u is unexpected, not using cache", header->length);
-        }
-        else if(header->version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
-        {
-          m_PipeCacheBlob.clear();
-          RDCLOG("Pipeline cache header version %u is unexpected, not using cache", header->version);
-        }
-        else if(header->vendorID != m_pDriver->GetDeviceProps().vendorID)
-        {
-          m_PipeCacheBlob.clear();
-          RDCLOG("Pipeline cache header vendorID %u doesn't match %u", header->vendorID,
-                 m_pDriver->GetDeviceProps().vendorID);
-        }
-        else if(header->deviceID != m_pDriver->GetDeviceProps().deviceID)
-        {
-          m_PipeCacheBlob.clear();
-          RDCLOG("Pipeline cache header deviceID %u doesn't match %u", header->deviceID,
-                 m_pDriver->GetDeviceProps().deviceID);
-        }
-        else if(memcmp(header->uuid, m_pDriver->GetDeviceProps().pipelineCacheUUID, VK_UUID_SIZE) != 0)
-        {
-          m_PipeCacheBlob.clear();
-          RDCLOG("Pipeline cache UUID doesn't match");
-        }
-      }
-    }
+    if(!IsPipeCacheBlobCompatible(m_PipeCacheBlob))
+      m_PipeCacheBlob.clear();
 
     if(!m_PipeCacheBlob.empty())
     {
@@ -422,11 +391,20 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
     }
   }
 
+  if(IsReplayMode(m_pDriver->GetState()))
+    CreateReplayPipeCache();
+
   SetCaching(false);
 }
 
 VulkanShaderCache::~VulkanShaderCache()
 {
+  if(m_ReplayPipelineCache != VK_NULL_HANDLE)
+  {
+    SaveReplayPipeCache();
+    ObjDisp(m_Device)->DestroyPipelineCache(Unwrap(m_Device), m_ReplayPipelineCache, NULL);
+  }
+
   if(m_PipelineCache != VK_NULL_HANDLE)
   {
     bytebuf blob;
@@ -501,6 +479,132 @@ rdcstr VulkanShaderCache::GetSPIRVBlob(const rdcspv::CompilationSettings &settin
   return errors;
 }
 
+bool VulkanShaderCache::IsPipeCacheBlobCompatible(const bytebuf &blob)
+{
+  if(blob.size() < sizeof(VkPipeCacheHeader))
+    return false;
+
+  const VkPipeCacheHeader *header = (const VkPipeCacheHeader *)blob.data();
+
+  // check explicitly for incompatibility
+  if(header->length != sizeof(VkPipeCacheHeader))
+  {
+    RDCLOG("Pipeline cache header length %u is unexpected, not using cache", header->length);
+    return false;
+  }
+  else if(header->version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+  {
+    RDCLOG("Pipeline cache header version %u is unexpected, not using cache", header->version);
+    return false;
+  }
+  else if(header->vendorID != m_pDriver->GetDeviceProps().vendorID)
+  {
+    RDCLOG("Pipeline cache header vendorID %u doesn't match %u", header->vendorID,
+           m_pDriver->GetDeviceProps().vendorID);
+    return false;
+  }
+  else if(header->deviceID != m_pDriver->GetDeviceProps().deviceID)
+  {
+    RDCLOG("Pipeline cache header deviceID %u doesn't match %u", header->deviceID,
+           m_pDriver->GetDeviceProps().deviceID);
+    return false;
+  }
+  else if(memcmp(header->uuid, m_pDriver->GetDeviceProps().pipelineCacheUUID, VK_UUID_SIZE) != 0)
+  {
+    RDCLOG("Pipeline cache UUID doesn't match");
+    return false;
+  }
+
+  return true;
+}
+
+rdcstr VulkanShaderCache::GetReplayPipeCacheFilename()
+{
+  // one file per capture and driver. The driver's cache UUID is also checked in the header, but
+  // including it here means different drivers don't keep overwriting each other's caches
+  const VkPhysicalDeviceProperties &props = m_pDriver->GetDeviceProps();
+
+  uint32_t driverHash = strhash(StringFormat::Fmt("%x%x", props.vendorID, props.deviceID).c_str());
+  for(size_t i = 0; i < VK_UUID_SIZE; i++)
+    driverHash = strhash(StringFormat::Fmt("%02x", props.pipelineCacheUUID[i]).c_str(), driverHash);
+
+  return FileIO::GetAppFolderFilename(StringFormat::Fmt(
+      "vkpipelines/%016llx_%08x.cache", m_pDriver->GetCaptureHash(), driverHash));
+}
+
+void VulkanShaderCache::CreateReplayPipeCache()
+{
+  if(!Vulkan_Replay_PipelineCacheOnDisk() || m_pDriver->GetCaptureHash() == 0)
+    return;
+
+  bytebuf blob;
+  FileIO::ReadAll(GetReplayPipeCacheFilename(), blob);
+
+  if(!IsPipeCacheBlobCompatible(blob))
+    blob.clear();
+
+  VkPipelineCacheCreateInfo createInfo = {VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+  createInfo.initialDataSize = blob.size();
+  createInfo.pInitialData = blob.empty() ? NULL : blob.data();
+
+  VkResult vkr = ObjDisp(m_Device)->CreatePipelineCache(Unwrap(m_Device), &createInfo, NULL,
+                                                        &m_ReplayPipelineCache);
+
+  if(vkr != VK_SUCCESS)
+  {
+    RDCWARN("Couldn't create replay pipeline cache: %s", ToStr(vkr).c_str());
+    m_ReplayPipelineCache = VK_NULL_HANDLE;
+    return;
+  }
+
+  m_ReplayPipeCacheLoadedSize = blob.size();
+
+  if(!blob.empty())
+    RDCLOG("Loaded %llu byte pipeline cache for this capture", (uint64_t)blob.size());
+}
+
+void VulkanShaderCache::SaveReplayPipeCache()
+{
+  size_t size = 0;
+  ObjDisp(m_Device)->GetPipelineCacheData(Unwrap(m_Device), m_ReplayPipelineCache, &size, NULL);
+
+  // nothing new was compiled since loading, don't rewrite the file
+  if(size == 0 || size == m_ReplayPipeCacheLoadedSize)
+    return;
+
+  bytebuf blob;
+  blob.resize(size);
+  VkResult vkr = ObjDisp(m_Device)->GetPipelineCacheData(Unwrap(m_Device), m_ReplayPipelineCache,
+                                                         &size, blob.data());
+  if(vkr != VK_SUCCESS)
+    return;
+
+  blob.resize(size);
+
+  rdcstr filename = GetReplayPipeCacheFilename();
+  FileIO::CreateParentDirectory(filename);
+  FileIO::WriteAll(filename, blob);
+
+  // only keep the caches for the most recently opened captures
+  const size_t maxCachedCaptures = 16;
+
+  rdcstr dir = get_dirname(filename);
+
+  rdcarray<PathEntry> files;
+  FileIO::GetFilesInDirectory(dir, files);
+
+  files.removeIf([](const PathEntry &f) { return bool(f.flags & PathProperty::Directory); });
+
+  if(files.size() > maxCachedCaptures)
+  {
+    std::sort(files.begin(), files.end(),
+              [](const PathEntry &a, const PathEntry &b) { return a.lastmod > b.lastmod; });
+
+    for(size_t i = maxCachedCaptures; i < files.size(); i++)
+      FileIO::Delete(dir + "/" + files[i].filename);
+  }
+}
+
 void VulkanShaderCache::GetPipeCacheBlob()
 {
   m_PipeCacheBlob.clear();
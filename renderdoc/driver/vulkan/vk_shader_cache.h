@@ -64,6 +64,7 @@ enum class BuiltinShader
   DepthBuf2MSFS,
   DepthCopyFS,
   DepthCopyMSFS,
+  ContentHashCS,
   Count,
 };
 
@@ -113,6 +114,9 @@ public:
     return m_BuiltinShaderModules[(size_t)builtin][(size_t)baseType][(size_t)texType];
   }
   VkPipelineCache GetPipeCache() { return m_PipelineCache; }
+  // the on-disk cache for the capture's own pipelines on replay. This is an unwrapped handle, since
+  // it's only used when creating the real pipelines in deferred compile jobs. May be NULL
+  VkPipelineCache GetReplayPipeCache() { return m_ReplayPipelineCache; }
   void MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &pipeCreateInfo, ResourceId pipeline);
   void MakeComputePipelineInfo(VkComputePipelineCreateInfo &pipeCreateInfo, ResourceId pipeline);
   void MakeShaderObjectInfo(VkShaderCreateInfoEXT &shadCreateInfo, ResourceId shader);
@@ -125,6 +129,11 @@ private:
 
   void GetPipeCacheBlob();
   void SetPipeCacheBlob(bytebuf &blob);
+  bool IsPipeCacheBlobCompatible(const bytebuf &blob);
+
+  rdcstr GetReplayPipeCacheFilename();
+  void CreateReplayPipeCache();
+  void SaveReplayPipeCache();
 
   WrappedVulkan *m_pDriver = NULL;
   VkDevice m_Device = VK_NULL_HANDLE;
@@ -136,6 +145,9 @@ private:
   bytebuf m_PipeCacheBlob;
   VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
 
+  VkPipelineCache m_ReplayPipelineCache = VK_NULL_HANDLE;
+  size_t m_ReplayPipeCacheLoadedSize = 0;
+
   bool m_Buffer2MSSupported = false;
 
   bool m_ShaderCacheDirty = false, m_CacheShaders = false;
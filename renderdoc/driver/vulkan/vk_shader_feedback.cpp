@@ -2115,6 +2115,10 @@ bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
     if(cmd == VK_NULL_HANDLE)
       return false;
 
+    // the action itself is executed below, after the replay up to just before it. That replayed
+    // state can't be continued from afterwards.
+    m_pDriver->InvalidateIncrementalReplay();
+
     VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
                                           VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
 
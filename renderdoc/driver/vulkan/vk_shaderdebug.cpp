@@ -584,9 +584,12 @@ public:
                              const rdcspv::ImageOperandsAndParamDatas &operands,
                              ShaderVariable &output) override
   {
-    ShaderConstParameters constParams = {};
+    ShaderConstParameters constParams;
     ShaderUniformParameters uniformParams = {};
 
+    // these parameters are used to look up cached results, so clear any padding as well
+    RDCEraseEl(constParams);
+
     const bool buffer = (texType & DebugAPIWrapper::Buffer_Texture) != 0;
     const bool uintTex = (texType & DebugAPIWrapper::UInt_Texture) != 0;
     const bool sintTex = (texType & DebugAPIWrapper::SInt_Texture) != 0;
@@ -1159,6 +1162,21 @@ public:
       return false;
     }
 
+    SampleKey key;
+    key.constParams = constParams;
+    key.uniformParams = uniformParams;
+    key.pipe = pipe;
+    key.sampler = sampler;
+    key.view = sampleView;
+    key.bufferView = bufferView;
+
+    auto cached = m_SampleResults.find(key);
+    if(cached != m_SampleResults.end())
+    {
+      SetSampleOutput(cached->second, output);
+      return true;
+    }
+
     VkDescriptorImageInfo samplerWriteInfo = {Unwrap(sampler), VK_NULL_HANDLE,
                                               VK_IMAGE_LAYOUT_UNDEFINED};
     VkDescriptorImageInfo imageWriteInfo = {VK_NULL_HANDLE, Unwrap(sampleView), layout};
@@ -1324,56 +1342,196 @@ public:
       m_pDriver->FlushQ();
     }
 
-    float *retf = (float *)m_DebugData.ReadbackBuffer.Map(NULL, 0);
-    if(!retf)
+    byte *ret = (byte *)m_DebugData.ReadbackBuffer.Map(NULL, 0);
+    if(!ret)
       return false;
 
-    uint32_t *retu = (uint32_t *)retf;
-    int32_t *reti = (int32_t *)retf;
+    if(m_SampleResults.size() >= MaxCachedResults)
+      m_SampleResults.clear();
+
+    ShaderValue &result = m_SampleResults[key];
+    memcpy(result.u32v.data(), ret, sizeof(Vec4f));
+
+    m_DebugData.ReadbackBuffer.Unmap();
+
+    SetSampleOutput(result, output);
+
+    return true;
+  }
 
+  static void SetSampleOutput(const ShaderValue &result, ShaderVariable &output)
+  {
     // convert full precision results, we did all sampling at 32-bit precision
     for(uint8_t c = 0; c < 4; c++)
     {
       if(VarTypeCompType(output.type) == CompType::Float)
-        setFloatComp(output, c, retf[c]);
+        setFloatComp(output, c, result.f32v[c]);
       else if(VarTypeCompType(output.type) == CompType::SInt)
-        setIntComp(output, c, reti[c]);
+        setIntComp(output, c, result.s32v[c]);
       else
-        setUintComp(output, c, retu[c]);
+        setUintComp(output, c, result.u32v[c]);
     }
+  }
 
-    m_DebugData.ReadbackBuffer.Unmap();
+  virtual bool CalculateMathOp(rdcspv::ThreadState &lane, rdcspv::GLSLstd450 op,
+                               const rdcarray<ShaderVariable> &params, ShaderVariable &output) override
+  {
+    RDCASSERT(params.size() <= MathOp::MaxParams, params.size());
+
+    const uint32_t numParams = RDCMIN((uint32_t)params.size(), (uint32_t)MathOp::MaxParams);
+
+    const ShaderVariable *paramPtrs[MathOp::MaxParams] = {};
+    for(uint32_t i = 0; i < numParams; i++)
+      paramPtrs[i] = &params[i];
+
+    MathOpKey key = MakeMathOpKey(op, paramPtrs, numParams);
+
+    auto it = m_MathResults.find(key);
+    if(it == m_MathResults.end())
+    {
+      if(!EvaluateMathOps({key}))
+        return false;
+
+      it = m_MathResults.find(key);
+      if(it == m_MathResults.end())
+        return false;
+    }
+
+    // these two operations change the type of the output
+    if(op == rdcspv::GLSLstd450::Length || op == rdcspv::GLSLstd450::Distance)
+      output.columns = 1;
+
+    memcpy(output.value.u32v.data(), it->second.u32v.data(),
+           VarTypeByteSize(output.type) * output.columns);
 
     return true;
   }
 
-  virtual bool CalculateMathOp(rdcspv::ThreadState &lane, rdcspv::GLSLstd450 op,
-                               const rdcarray<ShaderVariable> &params, ShaderVariable &output) override
+  virtual void PrepareMathOps(const rdcarray<MathOp> &ops) override
+  {
+    rdcarray<MathOpKey> keys;
+    keys.reserve(ops.size());
+
+    // lanes are often coherent, so only evaluate each distinct operation once
+    for(const MathOp &op : ops)
+    {
+      MathOpKey key = MakeMathOpKey(op.op, op.params, op.numParams);
+      if(m_MathResults.find(key) == m_MathResults.end() && !keys.contains(key))
+        keys.push_back(key);
+    }
+
+    if(!keys.empty())
+      EvaluateMathOps(keys);
+  }
+
+  std::map<ShaderBuiltin, ShaderVariable> builtin_inputs;
+  rdcarray<ShaderVariable> location_inputs;
+
+  std::map<ShaderBuiltin, DerivativeDeltas> builtin_derivatives;
+  rdcarray<DerivativeDeltas> location_derivatives;
+
+private:
+  WrappedVulkan *m_pDriver = NULL;
+  ShaderDebugData &m_DebugData;
+  VulkanCreationInfo &m_Creation;
+
+  bool m_ResourcesDirty = false;
+  uint32_t m_EventID;
+  ResourceId m_ShaderID;
+
+  rdcarray<DescriptorAccess> m_Access;
+  rdcarray<Descriptor> m_Descriptors;
+  rdcarray<SamplerDescriptor> m_SamplerDescriptors;
+
+  std::map<ResourceId, VkImageView> m_SampleViews;
+
+  typedef rdcpair<ResourceId, float> SamplerBiasKey;
+  std::map<SamplerBiasKey, VkSampler> m_BiasSamplers;
+
+  // math operations are pure functions of their parameters, so we remember every result we've
+  // fetched from the GPU. The parameters are stored exactly as they're pushed to the shader.
+  struct MathOpKey
+  {
+    MathOpKey() { memset(this, 0, sizeof(*this)); }
+    bool operator<(const MathOpKey &o) const { return memcmp(this, &o, sizeof(*this)) < 0; }
+    bool operator==(const MathOpKey &o) const { return memcmp(this, &o, sizeof(*this)) == 0; }
+    rdcspv::GLSLstd450 op;
+    uint32_t floatSizeIdx;
+    double params[MathOp::MaxParams][4];
+  };
+
+  std::map<MathOpKey, ShaderValue> m_MathResults;
+
+  // sample results are similarly cached, keyed by everything that goes into the sampling draw.
+  // Images can't change underneath us as texel writes are only applied to our CPU-side copy.
+  struct SampleKey
+  {
+    SampleKey() { memset(this, 0, sizeof(*this)); }
+    bool operator<(const SampleKey &o) const { return memcmp(this, &o, sizeof(*this)) < 0; }
+    ShaderConstParameters constParams;
+    ShaderUniformParameters uniformParams;
+    VkPipeline pipe;
+    VkSampler sampler;
+    VkImageView view;
+    VkBufferView bufferView;
+  };
+
+  std::map<SampleKey, ShaderValue> m_SampleResults;
+
+  // avoid growing the caches without bound on long-running loops
+  static const size_t MaxCachedResults = 64 * 1024;
+
+  MathOpKey MakeMathOpKey(rdcspv::GLSLstd450 op, const ShaderVariable *const *params,
+                          uint32_t numParams)
   {
-    RDCASSERT(params.size() <= 3, params.size());
+    MathOpKey key;
+    key.op = op;
+
+    if(params[0]->type == VarType::Half)
+      key.floatSizeIdx = 1;
+    else if(params[0]->type == VarType::Double)
+      key.floatSizeIdx = 2;
+
+    for(uint32_t i = 0; i < numParams; i++)
+    {
+      RDCASSERTEQUAL(params[i]->type, params[0]->type);
+      memcpy(key.params[i], params[i]->value.f32v.data(),
+             VarTypeByteSize(params[i]->type) * params[i]->columns);
+    }
 
-    int floatSizeIdx = 0;
-    if(params[0].type == VarType::Half)
-      floatSizeIdx = 1;
-    else if(params[0].type == VarType::Double)
-      floatSizeIdx = 2;
+    return key;
+  }
 
+  VkPipeline GetMathPipe(uint32_t floatSizeIdx)
+  {
     if(m_DebugData.MathPipe[floatSizeIdx] == VK_NULL_HANDLE)
     {
+      const uint32_t floatBitSizes[] = {32, 16, 64};
+
       ShaderConstParameters pipeParams = {};
       pipeParams.operation = (uint32_t)rdcspv::Op::ExtInst;
       m_DebugData.MathPipe[floatSizeIdx] =
-          MakePipe(pipeParams, VarTypeByteSize(params[0].type) * 8, false, false, false);
+          MakePipe(pipeParams, floatBitSizes[floatSizeIdx], false, false, false);
 
       if(m_DebugData.MathPipe[floatSizeIdx] == VK_NULL_HANDLE)
       {
         m_pDriver->AddDebugMessage(MessageCategory::Execution, MessageSeverity::High,
                                    MessageSource::RuntimeWarning,
                                    "Failed to compile graphics pipeline for math operation");
-        return false;
       }
     }
 
+    return m_DebugData.MathPipe[floatSizeIdx];
+  }
+
+  // evaluate a set of math operations on the GPU and store the results in m_MathResults. Each
+  // operation is a separate dispatch with the result copied out to its own slot in the readback
+  // buffer, but they are all recorded into a single submission with only one wait.
+  bool EvaluateMathOps(const rdcarray<MathOpKey> &keys)
+  {
+    if(m_MathResults.size() + keys.size() > MaxCachedResults)
+      m_MathResults.clear();
+
     VkDescriptorBufferInfo storageWriteInfo = {};
     m_DebugData.MathResult.FillDescriptor(storageWriteInfo);
 
@@ -1396,7 +1554,12 @@ public:
 
     ObjDisp(dev)->UpdateDescriptorSets(Unwrap(dev), 1, writeSets, 0, NULL);
 
+    const VkDeviceSize resultSize = sizeof(Vec4f) * 2;
+
+    for(size_t base = 0; base < keys.size(); base += ShaderDebugData::MathBatchSize)
     {
+      const size_t count = RDCMIN(keys.size() - base, (size_t)ShaderDebugData::MathBatchSize);
+
       VkCommandBuffer cmd = m_pDriver->GetNextCmd();
 
       if(cmd == VK_NULL_HANDLE)
@@ -1408,53 +1571,79 @@ public:
       VkResult vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
       CHECK_VKR(m_pDriver, vkr);
 
-      ObjDisp(cmd)->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
-                                    Unwrap(m_DebugData.MathPipe[floatSizeIdx]));
-
       ObjDisp(cmd)->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
                                           Unwrap(m_DebugData.PipeLayout), 0, 1,
                                           UnwrapPtr(m_DebugData.DescSet), 0, NULL);
 
-      // push the parameters
-      for(size_t i = 0; i < params.size(); i++)
+      VkPipeline boundPipe = VK_NULL_HANDLE;
+
+      for(size_t i = 0; i < count; i++)
       {
-        RDCASSERTEQUAL(params[i].type, params[0].type);
-        double p[4] = {};
-        memcpy(p, params[i].value.f32v.data(), VarTypeByteSize(params[i].type) * params[i].columns);
+        const MathOpKey &key = keys[base + i];
+
+        VkPipeline pipe = GetMathPipe(key.floatSizeIdx);
+
+        if(pipe == VK_NULL_HANDLE)
+        {
+          ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+          return false;
+        }
+
+        if(pipe != boundPipe)
+        {
+          ObjDisp(cmd)->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE, Unwrap(pipe));
+          boundPipe = pipe;
+        }
+
+        // push the parameters
         ObjDisp(cmd)->CmdPushConstants(Unwrap(cmd), Unwrap(m_DebugData.PipeLayout),
-                                       VK_SHADER_STAGE_ALL, uint32_t(sizeof(p) * i), sizeof(p), p);
-      }
+                                       VK_SHADER_STAGE_ALL, 0, sizeof(key.params), key.params);
+
+        // push the operation afterwards
+        ObjDisp(cmd)->CmdPushConstants(Unwrap(cmd), Unwrap(m_DebugData.PipeLayout),
+                                       VK_SHADER_STAGE_ALL, sizeof(Vec4f) * 6, sizeof(uint32_t),
+                                       &key.op);
+
+        ObjDisp(cmd)->CmdDispatch(Unwrap(cmd), 1, 1, 1);
+
+        VkBufferMemoryBarrier bufBarrier = {
+            VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            NULL,
+            VK_ACCESS_SHADER_WRITE_BIT,
+            VK_ACCESS_TRANSFER_READ_BIT,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            Unwrap(m_DebugData.MathResult.buf),
+            0,
+            VK_WHOLE_SIZE,
+        };
+
+        DoPipelineBarrier(cmd, 1, &bufBarrier);
+
+        VkBufferCopy bufCopy = {0, resultSize * i, resultSize};
+        ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(m_DebugData.MathResult.buf),
+                                    Unwrap(m_DebugData.ReadbackBuffer.buf), 1, &bufCopy);
 
-      // push the operation afterwards
-      ObjDisp(cmd)->CmdPushConstants(Unwrap(cmd), Unwrap(m_DebugData.PipeLayout),
-                                     VK_SHADER_STAGE_ALL, sizeof(Vec4f) * 6, sizeof(uint32_t), &op);
+        // the next dispatch overwrites the result, so it must wait for the copy
+        bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        bufBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
 
-      ObjDisp(cmd)->CmdDispatch(Unwrap(cmd), 1, 1, 1);
+        DoPipelineBarrier(cmd, 1, &bufBarrier);
+      }
 
       VkBufferMemoryBarrier bufBarrier = {
           VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
           NULL,
-          VK_ACCESS_SHADER_WRITE_BIT,
-          VK_ACCESS_TRANSFER_READ_BIT,
+          VK_ACCESS_TRANSFER_WRITE_BIT,
+          VK_ACCESS_HOST_READ_BIT,
           VK_QUEUE_FAMILY_IGNORED,
           VK_QUEUE_FAMILY_IGNORED,
-          Unwrap(m_DebugData.MathResult.buf),
+          Unwrap(m_DebugData.ReadbackBuffer.buf),
           0,
           VK_WHOLE_SIZE,
       };
 
-      DoPipelineBarrier(cmd, 1, &bufBarrier);
-
-      VkBufferCopy bufCopy = {0, 0, 0};
-      bufCopy.size = sizeof(Vec4f) * 2;
-      ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(m_DebugData.MathResult.buf),
-                                  Unwrap(m_DebugData.ReadbackBuffer.buf), 1, &bufCopy);
-
-      bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-      bufBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
-      bufBarrier.buffer = Unwrap(m_DebugData.ReadbackBuffer.buf);
-
-      // wait for copy to finish before reading back to host
+      // wait for copies to finish before reading back to host
       DoPipelineBarrier(cmd, 1, &bufBarrier);
 
       vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
@@ -1462,47 +1651,23 @@ public:
 
       m_pDriver->SubmitCmds();
       m_pDriver->FlushQ();
-    }
-
-    byte *ret = (byte *)m_DebugData.ReadbackBuffer.Map(NULL, 0);
-    if(!ret)
-      return false;
 
-    // these two operations change the type of the output
-    if(op == rdcspv::GLSLstd450::Length || op == rdcspv::GLSLstd450::Distance)
-      output.columns = 1;
+      byte *ret = (byte *)m_DebugData.ReadbackBuffer.Map(NULL, 0);
+      if(!ret)
+        return false;
 
-    memcpy(output.value.u32v.data(), ret, VarTypeByteSize(output.type) * output.columns);
+      for(size_t i = 0; i < count; i++)
+      {
+        ShaderValue &result = m_MathResults[keys[base + i]];
+        memcpy(result.u32v.data(), ret + resultSize * i, (size_t)resultSize);
+      }
 
-    m_DebugData.ReadbackBuffer.Unmap();
+      m_DebugData.ReadbackBuffer.Unmap();
+    }
 
     return true;
   }
 
-  std::map<ShaderBuiltin, ShaderVariable> builtin_inputs;
-  rdcarray<ShaderVariable> location_inputs;
-
-  std::map<ShaderBuiltin, DerivativeDeltas> builtin_derivatives;
-  rdcarray<DerivativeDeltas> location_derivatives;
-
-private:
-  WrappedVulkan *m_pDriver = NULL;
-  ShaderDebugData &m_DebugData;
-  VulkanCreationInfo &m_Creation;
-
-  bool m_ResourcesDirty = false;
-  uint32_t m_EventID;
-  ResourceId m_ShaderID;
-
-  rdcarray<DescriptorAccess> m_Access;
-  rdcarray<Descriptor> m_Descriptors;
-  rdcarray<SamplerDescriptor> m_SamplerDescriptors;
-
-  std::map<ResourceId, VkImageView> m_SampleViews;
-
-  typedef rdcpair<ResourceId, float> SamplerBiasKey;
-  std::map<SamplerBiasKey, VkSampler> m_BiasSamplers;
-
   std::map<ShaderBindIndex, bytebuf> bufferCache;
 
   struct ImageData
@@ -5080,15 +5245,8 @@ ShaderDebugTrace *VulkanReplay::DebugThread(uint32_t eventId,
   return ret;
 }
 
-rdcarray<ShaderDebugState> VulkanReplay::ContinueDebug(ShaderDebugger *debugger)
+void VulkanReplay::PrepareShaderDebugDummyWrites()
 {
-  rdcspv::Debugger *spvDebugger = (rdcspv::Debugger *)debugger;
-
-  if(!spvDebugger)
-    return {};
-
-  VkMarkerRegion region("ContinueDebug Simulation Loop");
-
   for(size_t fmt = 0; fmt < ARRAY_COUNT(m_TexRender.DummyImageViews); fmt++)
   {
     for(size_t dim = 0; dim < ARRAY_COUNT(m_TexRender.DummyImageViews[0]); dim++)
@@ -5130,6 +5288,18 @@ rdcarray<ShaderDebugState> VulkanReplay::ContinueDebug(ShaderDebugger *debugger)
           UnwrapPtr(m_TexRender.DummyBufferView[fmt]);
     }
   }
+}
+
+rdcarray<ShaderDebugState> VulkanReplay::ContinueDebug(ShaderDebugger *debugger)
+{
+  rdcspv::Debugger *spvDebugger = (rdcspv::Debugger *)debugger;
+
+  if(!spvDebugger)
+    return {};
+
+  VkMarkerRegion region("ContinueDebug Simulation Loop");
+
+  PrepareShaderDebugDummyWrites();
 
   rdcarray<ShaderDebugState> ret = spvDebugger->ContinueDebug();
 
@@ -5139,6 +5309,26 @@ rdcarray<ShaderDebugState> VulkanReplay::ContinueDebug(ShaderDebugger *debugger)
   return ret;
 }
 
+ShaderDebugState VulkanReplay::RunDebug(ShaderDebugger *debugger,
+                                        const rdcarray<uint32_t> &breakpoints, uint32_t maxSteps)
+{
+  rdcspv::Debugger *spvDebugger = (rdcspv::Debugger *)debugger;
+
+  if(!spvDebugger)
+    return {};
+
+  VkMarkerRegion region("RunDebug Simulation Loop");
+
+  PrepareShaderDebugDummyWrites();
+
+  ShaderDebugState ret = spvDebugger->RunDebug(breakpoints, maxSteps);
+
+  VulkanAPIWrapper *api = (VulkanAPIWrapper *)spvDebugger->GetAPIWrapper();
+  api->ResetReplay();
+
+  return ret;
+}
+
 void VulkanReplay::FreeDebugger(ShaderDebugger *debugger)
 {
   delete debugger;
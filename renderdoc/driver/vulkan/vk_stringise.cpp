@@ -299,6 +299,7 @@ rdcstr DoStringise(const MemoryScope &el)
     STRINGISE_ENUM_CLASS(InitialContents);
     STRINGISE_ENUM_CLASS(IndirectReadback);
     STRINGISE_ENUM_CLASS(InitialContentsFirstApplyOnly);
+    STRINGISE_ENUM_CLASS(InitialContentsResident);
   }
   END_ENUM_STRINGISE()
 }
@@ -686,6 +686,9 @@ VkResult WrappedVulkan::vkAllocateDescriptorSets(VkDevice device,
       {
         record->descInfo->data.reset();
       }
+
+      // a reused record keeps its ID, so make sure it isn't mistaken for its previous contents
+      record->descInfo->writeGeneration++;
     }
     else
     {
@@ -739,6 +742,7 @@ VkResult WrappedVulkan::vkResetDescriptorPool(VkDevice device, VkDescriptorPool
         {
           ((WrappedVkNonDispRes *)(*it)->Resource)->real = RealVkRes(0x123456);
           (*it)->descInfo->data.reset();
+          (*it)->descInfo->writeGeneration++;
         }
 
         record->descPoolInfo->freelist.assign(record->pooledChildren);
@@ -1354,6 +1358,8 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
 
       RDCASSERT(descWrite.dstBinding < record->descInfo->data.binds.size());
 
+      record->descInfo->writeGeneration++;
+
       DescriptorSetSlot **binding = &record->descInfo->data.binds[descWrite.dstBinding];
       bytebuf &inlineData = record->descInfo->data.inlineBytes;
 
@@ -1466,6 +1472,8 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
       RDCASSERT(pDescriptorCopies[i].dstBinding < dstrecord->descInfo->data.binds.size());
       RDCASSERT(pDescriptorCopies[i].srcBinding < srcrecord->descInfo->data.binds.size());
 
+      dstrecord->descInfo->writeGeneration++;
+
       DescriptorSetSlot **dstbinding =
           &dstrecord->descInfo->data.binds[pDescriptorCopies[i].dstBinding];
       DescriptorSetSlot **srcbinding =
@@ -1791,6 +1799,8 @@ void WrappedVulkan::vkUpdateDescriptorSetWithTemplate(
 
       RDCASSERT(entry.dstBinding < record->descInfo->data.binds.size());
 
+      record->descInfo->writeGeneration++;
+
       DescriptorSetSlot **binding = &record->descInfo->data.binds[entry.dstBinding];
       bytebuf &inlineData = record->descInfo->data.inlineBytes;
 
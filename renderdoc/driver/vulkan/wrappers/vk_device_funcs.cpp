@@ -27,6 +27,7 @@
 #include "../vk_debug.h"
 #include "../vk_rendertext.h"
 #include "../vk_replay.h"
+#include "../vk_residency.h"
 #include "../vk_shader_cache.h"
 #include "api/replay/version.h"
 #include "core/settings.h"
@@ -1013,6 +1014,8 @@ void WrappedVulkan::Shutdown()
     }
   }
 
+  SAFE_DELETE(m_ResidencyManager);
+
   FreeAllMemory(MemoryScope::InitialContents);
   FreeAllMemory(MemoryScope::InitialContentsFirstApplyOnly);
 
@@ -1087,32 +1087,48 @@ void WrappedVulkan::CaptureQueueSubmit(VkQueue queue,
       rm->MarkResourceFrameReferenced(it->first, eFrameRef_Read);
 
       VkResourceRecord *setrecord = it->second;
+      DescriptorSetData *descInfo = setrecord->descInfo;
 
-      DescriptorBindRefs refs;
+      SCOPED_LOCK(m_DescriptorRefsLock);
 
-      DescSetLayout *layout = setrecord->descInfo->layout;
+      // if this set was already submitted in this frame and hasn't been written since, the
+      // references are the same as last time
+      CachedDescriptorRefs *&cached = m_DescriptorRefs[it->first];
 
-      for(size_t b = 0, num = layout->bindings.size(); b < num; b++)
+      if(cached == NULL || cached->writeGeneration != descInfo->writeGeneration)
       {
-        const DescSetLayout::Binding &bind = layout->bindings[b];
+        SAFE_DELETE(cached);
+        cached = new CachedDescriptorRefs;
+        cached->writeGeneration = descInfo->writeGeneration;
 
-        // skip empty bindings or inline uniform blocks
-        if(bind.layoutDescType == VK_DESCRIPTOR_TYPE_MAX_ENUM ||
-           bind.layoutDescType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK)
-          continue;
+        DescSetLayout *layout = descInfo->layout;
+
+        for(size_t b = 0, num = layout->bindings.size(); b < num; b++)
+        {
+          const DescSetLayout::Binding &bind = layout->bindings[b];
 
-        uint32_t count = bind.descriptorCount;
-        if(bind.variableSize)
-          count = setrecord->descInfo->data.variableDescriptorCount;
+          // skip empty bindings or inline uniform blocks
+          if(bind.layoutDescType == VK_DESCRIPTOR_TYPE_MAX_ENUM ||
+             bind.layoutDescType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK)
+            continue;
 
-        for(uint32_t a = 0; a < count; a++)
-          setrecord->descInfo->data.binds[b][a].AccumulateBindRefs(refs, rm);
+          uint32_t count = bind.descriptorCount;
+          if(bind.variableSize)
+            count = descInfo->data.variableDescriptorCount;
+
+          for(uint32_t a = 0; a < count; a++)
+            descInfo->data.binds[b][a].AccumulateBindRefs(cached->refs, rm);
+        }
+
+        cached->refs.bindFrameRefs.Resolve();
       }
 
-      for(auto refit = refs.bindFrameRefs.begin(); refit != refs.bindFrameRefs.end(); ++refit)
+      DescriptorBindRefs &refs = cached->refs;
+
+      for(const rdcpair<ResourceId, FrameRefType> &ref : refs.bindFrameRefs.refs)
       {
-        refdIDs.insert(refit->first);
-        GetResourceManager()->MarkResourceFrameReferenced(refit->first, refit->second);
+        refdIDs.insert(ref.first);
+        GetResourceManager()->MarkResourceFrameReferenced(ref.first, ref.second);
       }
 
       for(auto refit = refs.sparseRefs.begin(); refit != refs.sparseRefs.end(); ++refit)
@@ -1127,10 +1143,8 @@ void WrappedVulkan::CaptureQueueSubmit(VkQueue queue,
       // the first recorded reference is a complete write then a later readbeforewrite won't
       // properly mark it as needing initial states preserved. So we do that here. Images are
       // handled separately
-      for(auto refit = refs.storableRefs.begin(); refit != refs.storableRefs.end(); ++refit)
-      {
+      if(!refs.storableRefs.empty())
         GetResourceManager()->FixupStorageBufferMemory(refs.storableRefs);
-      }
     }
 
     // now we can insert frame references from command buffers, to have a conservative ordering vs.
@@ -24,12 +24,13 @@
 
 #include "../vk_core.h"
 #include "../vk_replay.h"
+#include "../vk_shader_cache.h"
 #include "core/settings.h"
 #include "driver/shaders/spirv/spirv_reflect.h"
 
 RDOC_EXTERN_CONFIG(bool, Replay_Debug_SingleThreadedCompilation);
 
-static RDResult DeferredPipelineCompile(VkDevice device,
+static RDResult DeferredPipelineCompile(VkDevice device, VkPipelineCache cache,
                                         const VkGraphicsPipelineCreateInfo &createInfo,
                                         WrappedVkPipeline *wrappedPipe)
 {
@@ -38,8 +39,8 @@ static RDResult DeferredPipelineCompile(VkDevice device,
       UnwrapStructAndChain(CaptureState::LoadingReplaying, mem, &createInfo);
 
   VkPipeline realPipe;
-  VkResult ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), VK_NULL_HANDLE, 1,
-                                                          unwrapped, NULL, &realPipe);
+  VkResult ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), cache, 1, unwrapped,
+                                                          NULL, &realPipe);
 
   FreeAlignedBuffer((byte *)unwrapped);
 
@@ -54,7 +55,7 @@ static RDResult DeferredPipelineCompile(VkDevice device,
   return ResultCode::Succeeded;
 }
 
-static RDResult DeferredPipelineCompile(VkDevice device,
+static RDResult DeferredPipelineCompile(VkDevice device, VkPipelineCache cache,
                                         const VkComputePipelineCreateInfo &createInfo,
                                         WrappedVkPipeline *wrappedPipe)
 {
@@ -63,8 +64,8 @@ static RDResult DeferredPipelineCompile(VkDevice device,
       UnwrapStructAndChain(CaptureState::LoadingReplaying, mem, &createInfo);
 
   VkPipeline realPipe;
-  VkResult ret = ObjDisp(device)->CreateComputePipelines(Unwrap(device), VK_NULL_HANDLE, 1,
-                                                         unwrapped, NULL, &realPipe);
+  VkResult ret = ObjDisp(device)->CreateComputePipelines(Unwrap(device), cache, 1, unwrapped,
+                                                         NULL, &realPipe);
 
   FreeAlignedBuffer((byte *)unwrapped);
 
@@ -79,7 +80,7 @@ static RDResult DeferredPipelineCompile(VkDevice device,
   return ResultCode::Succeeded;
 }
 
-static RDResult DeferredPipelineCompile(VkDevice device,
+static RDResult DeferredPipelineCompile(VkDevice device, VkPipelineCache cache,
                                         const VkRayTracingPipelineCreateInfoKHR &createInfo,
                                         const bytebuf &replayHandles,
                                         uint32_t captureReplayHandleSize,
@@ -98,7 +99,7 @@ static RDResult DeferredPipelineCompile(VkDevice device,
 
   VkPipeline realPipe;
   VkResult ret = ObjDisp(device)->CreateRayTracingPipelinesKHR(
-      Unwrap(device), VK_NULL_HANDLE, VK_NULL_HANDLE, 1, unwrapped, NULL, &realPipe);
+      Unwrap(device), VK_NULL_HANDLE, cache, 1, unwrapped, NULL, &realPipe);
 
   FreeAlignedBuffer((byte *)unwrapped);
 
@@ -883,12 +884,15 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
       }
     }
 
+    // the application's own pipeline cache isn't replayed, but we have our own per-capture cache
+    VkPipelineCache replayCache = GetShaderCache()->GetReplayPipeCache();
+
     if(Replay_Debug_SingleThreadedCompilation())
     {
       for(rdcpair<VkGraphicsPipelineCreateInfo, VkPipeline> &deferredPipe : pipelinesToCompile)
       {
-        RDResult res =
-            DeferredPipelineCompile(device, deferredPipe.first, GetWrapped(deferredPipe.second));
+        RDResult res = DeferredPipelineCompile(device, replayCache, deferredPipe.first,
+                                               GetWrapped(deferredPipe.second));
 
         if(res != ResultCode::Succeeded)
         {
@@ -908,10 +912,11 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
       {
         WrappedVkPipeline *wrappedPipe = GetWrapped(deferredPipe.second);
         wrappedPipe->deferredJob = Threading::JobSystem::AddJob(
-            [wrappedVulkan = this, device, createInfo = deferredPipe.first, wrappedPipe]() {
+            [wrappedVulkan = this, device, replayCache, createInfo = deferredPipe.first,
+             wrappedPipe]() {
               PerformanceTimer timer;
               wrappedVulkan->CheckDeferredResult(
-                  DeferredPipelineCompile(device, createInfo, wrappedPipe));
+                  DeferredPipelineCompile(device, replayCache, createInfo, wrappedPipe));
               wrappedVulkan->AddDeferredTime(timer.GetMilliseconds());
             },
             parents);
@@ -1150,9 +1155,13 @@ bool WrappedVulkan::Serialise_vkCreateComputePipelines(SerialiserType &ser, VkDe
     m_CreationInfo.m_Pipeline[live].Init(GetResourceManager(), m_CreationInfo, live,
                                          &shadInstantiatedInfo);
 
+    // the application's own pipeline cache isn't replayed, but we have our own per-capture cache
+    VkPipelineCache replayCache = GetShaderCache()->GetReplayPipeCache();
+
     if(Replay_Debug_SingleThreadedCompilation())
     {
-      RDResult res = DeferredPipelineCompile(device, OrigCreateInfo, GetWrapped(pipe));
+      RDResult res =
+          DeferredPipelineCompile(device, replayCache, OrigCreateInfo, GetWrapped(pipe));
       Deserialise(OrigCreateInfo);
 
       if(res != ResultCode::Succeeded)
@@ -1164,11 +1173,11 @@ bool WrappedVulkan::Serialise_vkCreateComputePipelines(SerialiserType &ser, VkDe
     else
     {
       WrappedVkPipeline *wrappedPipe = GetWrapped(pipe);
-      wrappedPipe->deferredJob =
-          Threading::JobSystem::AddJob([wrappedVulkan = this, device, OrigCreateInfo, wrappedPipe]() {
+      wrappedPipe->deferredJob = Threading::JobSystem::AddJob(
+          [wrappedVulkan = this, device, replayCache, OrigCreateInfo, wrappedPipe]() {
             PerformanceTimer timer;
             wrappedVulkan->CheckDeferredResult(
-                DeferredPipelineCompile(device, OrigCreateInfo, wrappedPipe));
+                DeferredPipelineCompile(device, replayCache, OrigCreateInfo, wrappedPipe));
             wrappedVulkan->AddDeferredTime(timer.GetMilliseconds());
 
             Deserialise(OrigCreateInfo);
@@ -1416,10 +1425,14 @@ bool WrappedVulkan::Serialise_vkCreateRayTracingPipelinesKHR(
       }
     }
 
+    // the application's own pipeline cache isn't replayed, but we have our own per-capture cache
+    VkPipelineCache replayCache = GetShaderCache()->GetReplayPipeCache();
+
     if(Replay_Debug_SingleThreadedCompilation())
     {
-      RDResult res = DeferredPipelineCompile(device, OrigCreateInfo, *OrigReplayHandles,
-                                             captureReplayHandleSize, GetWrapped(pipe));
+      RDResult res =
+          DeferredPipelineCompile(device, replayCache, OrigCreateInfo, *OrigReplayHandles,
+                                  captureReplayHandleSize, GetWrapped(pipe));
       if(res == ResultCode::APIHardwareUnsupported)
         res.message = rdcstr(res.message) + "\n" + GetPhysDeviceCompatString(false, false);
       Deserialise(OrigCreateInfo);
@@ -1435,11 +1448,12 @@ bool WrappedVulkan::Serialise_vkCreateRayTracingPipelinesKHR(
     {
       WrappedVkPipeline *wrappedPipe = GetWrapped(pipe);
       wrappedPipe->deferredJob = Threading::JobSystem::AddJob(
-          [wrappedVulkan = this, device, OrigCreateInfo, OrigReplayHandles, captureReplayHandleSize,
-           wrappedPipe]() {
+          [wrappedVulkan = this, device, replayCache, OrigCreateInfo, OrigReplayHandles,
+           captureReplayHandleSize, wrappedPipe]() {
             PerformanceTimer timer;
-            RDResult res = DeferredPipelineCompile(device, OrigCreateInfo, *OrigReplayHandles,
-                                                   captureReplayHandleSize, wrappedPipe);
+            RDResult res =
+                DeferredPipelineCompile(device, replayCache, OrigCreateInfo, *OrigReplayHandles,
+                                        captureReplayHandleSize, wrappedPipe);
             wrappedVulkan->AddDeferredTime(timer.GetMilliseconds());
             if(res == ResultCode::APIHardwareUnsupported)
               res.message = rdcstr(res.message) + "\n" +
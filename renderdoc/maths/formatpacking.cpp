@@ -30,6 +30,10 @@
 #include "common/common.h"
 #include "os/os_specific.h"
 
+#if DISABLED(RDOC_ANDROID)
+#include "compressonator/CMP_Core.h"
+#endif
+
 //	for(int i=0; i < 256; i++)
 //	{
 //		uint8_t comp = i&0xff;
@@ -876,6 +880,521 @@ void DecodePixelData(const ResourceFormat &fmt, const byte *data, PixelValue &ou
   }
 }
 
+// lookup tables for 8-bit normalised components, calculated with the same expressions as
+// DecodePixelData so the results are identical.
+struct Norm8Tables
+{
+  Norm8Tables()
+  {
+    for(int i = 0; i < 256; i++)
+    {
+      int8_t s = int8_t(uint8_t(i));
+
+      unorm[i] = float(i) / 255.0f;
+      snorm[i] = s == -128 ? -1.0f : float(s) / 127.0f;
+    }
+  }
+
+  float unorm[256];
+  float snorm[256];
+};
+
+static const Norm8Tables &GetNorm8Tables()
+{
+  static const Norm8Tables tables;
+  return tables;
+}
+
+static inline float FloatFromBits(uint32_t bits)
+{
+  float ret;
+  memcpy(&ret, &bits, sizeof(ret));
+  return ret;
+}
+
+static inline uint32_t BitsFromFloat(float f)
+{
+  uint32_t ret;
+  memcpy(&ret, &f, sizeof(ret));
+  return ret;
+}
+
+// same result as ConvertFromHalf, but selecting between the cases instead of branching so that
+// loops over it can be vectorised
+static inline float ConvertFromHalfRow(uint16_t comp)
+{
+  const uint32_t sign = uint32_t(comp & 0x8000U) << 16;
+  const uint32_t exponent = comp & 0x7C00U;
+  const uint32_t mantissa = comp & 0x03FFU;
+
+  // normal values just need the exponent rebiased
+  const uint32_t normal = sign | ((uint32_t(comp & 0x7FFFU) << 13) + ((127 - 15) << 23));
+
+  // subnormals are mantissa * 2^-24, which is exact in a float
+  const uint32_t subnormal = sign | BitsFromFloat(float(mantissa) * (1.0f / 16777216.0f));
+
+  const uint32_t special = mantissa ? 0x7F800001U : (sign | 0x7F800000U);
+
+  return FloatFromBits(exponent == 0 ? subnormal : (exponent == 0x7C00U ? special : normal));
+}
+
+// same result as one channel of ConvertFromR11G11B10, selecting between the cases instead of
+// branching
+template <uint32_t mantissaBits>
+static inline float ConvertFromSmallFloatRow(uint32_t exponent, uint32_t mantissa)
+{
+  const uint32_t normal = ((exponent + (127 - 15)) << 23) | (mantissa << (23 - mantissaBits));
+  const uint32_t subnormal =
+      BitsFromFloat(float(mantissa) * (1.0f / float(1U << (14 + mantissaBits))));
+  const uint32_t special = 0x7f800000 | (mantissa << (23 - mantissaBits));
+
+  return FloatFromBits(exponent == 0 ? subnormal : (exponent == 0x1f ? special : normal));
+}
+
+template <typename T>
+static inline T LoadComp(const byte *data)
+{
+  T ret;
+  memcpy(&ret, data, sizeof(T));
+  return ret;
+}
+
+template <typename DecodeComp>
+static void DecodeRegularRow(const ResourceFormat &fmt, const byte *data, size_t stride,
+                             size_t count, FloatVector *out, DecodeComp decode)
+{
+  const uint32_t compCount = fmt.compCount;
+  const uint32_t compWidth = fmt.compByteWidth;
+
+  // matches the defaults in DecodePixelData
+  const float defaultAlpha =
+      (fmt.compType == CompType::UInt || fmt.compType == CompType::SInt || compCount == 4) ? 0.0f
+                                                                                            : 1.0f;
+
+  const bool bgra = fmt.BGRAOrder();
+
+  for(size_t i = 0; i < count; i++)
+  {
+    float comps[4] = {0.0f, 0.0f, 0.0f, defaultAlpha};
+
+    for(uint32_t c = 0; c < compCount; c++)
+      comps[c] = decode(data + c * compWidth, c);
+
+    if(bgra)
+      std::swap(comps[0], comps[2]);
+
+    out[i] = FloatVector(comps[0], comps[1], comps[2], comps[3]);
+
+    data += stride;
+  }
+}
+
+// returns false if the format isn't handled here and must be decoded one texel at a time
+static bool DecodeRowFast(const ResourceFormat &fmt, const byte *data, size_t stride, size_t count,
+                          FloatVector *out)
+{
+  const float defaultAlpha =
+      (fmt.compType == CompType::UInt || fmt.compType == CompType::SInt || fmt.compCount == 4)
+          ? 0.0f
+          : 1.0f;
+
+  if(fmt.type == ResourceFormatType::Regular && fmt.compCount >= 1 && fmt.compCount <= 4)
+  {
+    const CompType compType = fmt.compType;
+
+    if(fmt.compByteWidth == 1)
+    {
+      const Norm8Tables &tables = GetNorm8Tables();
+
+      if(compType == CompType::UNorm)
+        DecodeRegularRow(fmt, data, stride, count, out,
+                         [&tables](const byte *d, uint32_t) { return tables.unorm[*d]; });
+      else if(compType == CompType::UNormSRGB)
+        DecodeRegularRow(fmt, data, stride, count, out, [&tables](const byte *d, uint32_t c) {
+          // alpha is never interpreted as sRGB
+          return c == 3 ? tables.unorm[*d] : SRGB8_lookuptable[*d];
+        });
+      else if(compType == CompType::SNorm)
+        DecodeRegularRow(fmt, data, stride, count, out,
+                         [&tables](const byte *d, uint32_t) { return tables.snorm[*d]; });
+      else if(compType == CompType::UInt || compType == CompType::UScaled)
+        DecodeRegularRow(fmt, data, stride, count, out,
+                         [](const byte *d, uint32_t) { return float(*d); });
+      else if(compType == CompType::SInt || compType == CompType::SScaled)
+        DecodeRegularRow(fmt, data, stride, count, out,
+                         [](const byte *d, uint32_t) { return float(int8_t(*d)); });
+      else
+        return false;
+
+      return true;
+    }
+    else if(fmt.compByteWidth == 2)
+    {
+      if(compType == CompType::Float)
+        DecodeRegularRow(fmt, data, stride, count, out, [](const byte *d, uint32_t) {
+          return ConvertFromHalfRow(LoadComp<uint16_t>(d));
+        });
+      else if(compType == CompType::UNorm || compType == CompType::Depth)
+        DecodeRegularRow(fmt, data, stride, count, out, [](const byte *d, uint32_t) {
+          return float(LoadComp<uint16_t>(d)) / 65535.0f;
+        });
+      else if(compType == CompType::SNorm)
+        DecodeRegularRow(fmt, data, stride, count, out, [](const byte *d, uint32_t) {
+          int16_t i = LoadComp<int16_t>(d);
+          return i == -32768 ? -1.0f : float(i) / 32767.0f;
+        });
+      else if(compType == CompType::UInt || compType == CompType::UScaled)
+        DecodeRegularRow(fmt, data, stride, count, out,
+                         [](const byte *d, uint32_t) { return float(LoadComp<uint16_t>(d)); });
+      else if(compType == CompType::SInt || compType == CompType::SScaled)
+        DecodeRegularRow(fmt, data, stride, count, out,
+                         [](const byte *d, uint32_t) { return float(LoadComp<int16_t>(d)); });
+      else
+        return false;
+
+      return true;
+    }
+    else if(fmt.compByteWidth == 4)
+    {
+      if(compType == CompType::Float || compType == CompType::Depth)
+        DecodeRegularRow(fmt, data, stride, count, out,
+                         [](const byte *d, uint32_t) { return LoadComp<float>(d); });
+      else if(compType == CompType::UInt || compType == CompType::UScaled)
+        DecodeRegularRow(fmt, data, stride, count, out,
+                         [](const byte *d, uint32_t) { return float(LoadComp<uint32_t>(d)); });
+      else if(compType == CompType::SInt || compType == CompType::SScaled)
+        DecodeRegularRow(fmt, data, stride, count, out,
+                         [](const byte *d, uint32_t) { return float(LoadComp<int32_t>(d)); });
+      else
+        return false;
+
+      return true;
+    }
+
+    return false;
+  }
+  else if(fmt.type == ResourceFormatType::R10G10B10A2 &&
+          (fmt.compType == CompType::UNorm || fmt.compType == CompType::UInt))
+  {
+    const bool bgra = fmt.BGRAOrder();
+    const float scale[4] = {
+        fmt.compType == CompType::UInt ? 1.0f : 1023.0f,
+        fmt.compType == CompType::UInt ? 1.0f : 1023.0f,
+        fmt.compType == CompType::UInt ? 1.0f : 1023.0f,
+        fmt.compType == CompType::UInt ? 1.0f : 3.0f,
+    };
+
+    for(size_t i = 0; i < count; i++)
+    {
+      uint32_t val = LoadComp<uint32_t>(data);
+
+      float r = float((val >> 0) & 0x3ff) / scale[0];
+      float g = float((val >> 10) & 0x3ff) / scale[1];
+      float b = float((val >> 20) & 0x3ff) / scale[2];
+      float a = float((val >> 30) & 0x003) / scale[3];
+
+      if(bgra)
+        std::swap(r, b);
+
+      out[i] = FloatVector(r, g, b, a);
+
+      data += stride;
+    }
+
+    return true;
+  }
+  else if(fmt.type == ResourceFormatType::R11G11B10)
+  {
+    for(size_t i = 0; i < count; i++)
+    {
+      uint32_t val = LoadComp<uint32_t>(data);
+
+      out[i] = FloatVector(ConvertFromSmallFloatRow<6>((val >> 6) & 0x1f, (val >> 0) & 0x3f),
+                           ConvertFromSmallFloatRow<6>((val >> 17) & 0x1f, (val >> 11) & 0x3f),
+                           ConvertFromSmallFloatRow<5>((val >> 27) & 0x1f, (val >> 22) & 0x1f),
+                           defaultAlpha);
+
+      data += stride;
+    }
+
+    return true;
+  }
+  else if(fmt.type == ResourceFormatType::D16S8)
+  {
+    for(size_t i = 0; i < count; i++)
+    {
+      uint32_t val = LoadComp<uint32_t>(data);
+
+      out[i] = FloatVector(float(val & 0x00ffff) / 65535.0f,
+                           float((val & 0xff0000) >> 16) / 255.0f, 0.0f, defaultAlpha);
+
+      data += stride;
+    }
+
+    return true;
+  }
+  else if(fmt.type == ResourceFormatType::D24S8)
+  {
+    for(size_t i = 0; i < count; i++)
+    {
+      uint32_t val = LoadComp<uint32_t>(data);
+
+      out[i] = FloatVector(float(val & 0x00ffffff) / 16777215.0f,
+                           float((val & 0xff000000) >> 24) / 255.0f, 0.0f, defaultAlpha);
+
+      data += stride;
+    }
+
+    return true;
+  }
+  else if(fmt.type == ResourceFormatType::D32S8)
+  {
+    for(size_t i = 0; i < count; i++)
+    {
+      out[i] = FloatVector(LoadComp<float>(data), float(LoadComp<uint32_t>(data + 4)) / 255.0f,
+                           0.0f, defaultAlpha);
+
+      data += stride;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+void DecodeFormattedComponentsRow(const ResourceFormat &fmt, const byte *data, size_t stride,
+                                  size_t count, FloatVector *out, bool *success)
+{
+  if(count == 0 || !data)
+  {
+    DecodeFormattedComponents(fmt, NULL, success);
+    return;
+  }
+
+  if(DecodeRowFast(fmt, data, stride, count, out))
+  {
+    if(success)
+      *success = true;
+    return;
+  }
+
+  for(size_t i = 0; i < count; i++)
+  {
+    out[i] = DecodeFormattedComponents(fmt, data, success);
+    data += stride;
+  }
+}
+
+template <typename EncodeComp>
+static void EncodeRegularRow(const ResourceFormat &fmt, const FloatVector *in, size_t count,
+                             byte *data, size_t stride, EncodeComp encode)
+{
+  const uint32_t compCount = fmt.compCount;
+  const uint32_t compWidth = fmt.compByteWidth;
+
+  for(size_t i = 0; i < count; i++)
+  {
+    const float *comp = &in[i].x;
+
+    for(uint32_t c = 0; c < compCount; c++)
+      encode(data + c * compWidth, comp[c], c);
+
+    data += stride;
+  }
+}
+
+// returns false if the format isn't handled here and must be encoded one texel at a time
+static bool EncodeRowFast(const ResourceFormat &fmt, const FloatVector *in, size_t count,
+                          byte *data, size_t stride)
+{
+  if(fmt.type != ResourceFormatType::Regular || fmt.compCount < 1 || fmt.compCount > 4)
+    return false;
+
+  const CompType compType = fmt.compType;
+
+  if(fmt.compByteWidth == 1 && compType == CompType::UNorm)
+  {
+    EncodeRegularRow(fmt, in, count, data, stride, [](byte *d, float f, uint32_t) {
+      *d = uint8_t(RDCCLAMP(f, 0.0f, 1.0f) * float(0xff) + 0.5f);
+    });
+  }
+  else if(fmt.compByteWidth == 1 && compType == CompType::UNormSRGB)
+  {
+    EncodeRegularRow(fmt, in, count, data, stride, [](byte *d, float f, uint32_t c) {
+      // alpha is never interpreted as sRGB
+      if(c == 3)
+        *d = uint8_t(RDCCLAMP(f, 0.0f, 1.0f) * float(0xff) + 0.5f);
+      else
+        *d = uint8_t(ConvertLinearToSRGB(f) * float(0xff) + 0.5f);
+    });
+  }
+  else if(fmt.compByteWidth == 2 && compType == CompType::Float)
+  {
+    EncodeRegularRow(fmt, in, count, data, stride, [](byte *d, float f, uint32_t) {
+      uint16_t h = ConvertToHalf(f);
+      memcpy(d, &h, sizeof(h));
+    });
+  }
+  else if(fmt.compByteWidth == 2 && (compType == CompType::UNorm || compType == CompType::Depth))
+  {
+    EncodeRegularRow(fmt, in, count, data, stride, [](byte *d, float f, uint32_t) {
+      uint16_t u = uint16_t(RDCCLAMP(f, 0.0f, 1.0f) * float(0xffff) + 0.5f);
+      memcpy(d, &u, sizeof(u));
+    });
+  }
+  else if(fmt.compByteWidth == 4 && (compType == CompType::Float || compType == CompType::Depth))
+  {
+    EncodeRegularRow(fmt, in, count, data, stride,
+                     [](byte *d, float f, uint32_t) { memcpy(d, &f, sizeof(f)); });
+  }
+  else
+  {
+    return false;
+  }
+
+  return true;
+}
+
+void EncodeFormattedComponentsRow(const ResourceFormat &fmt, const FloatVector *in, size_t count,
+                                  byte *data, size_t stride, bool *success)
+{
+  if(count == 0 || !data)
+  {
+    EncodeFormattedComponents(fmt, FloatVector(), NULL, success);
+    return;
+  }
+
+  if(EncodeRowFast(fmt, in, count, data, stride))
+  {
+    if(success)
+      *success = true;
+    return;
+  }
+
+  for(size_t i = 0; i < count; i++)
+  {
+    EncodeFormattedComponents(fmt, in[i], data, success);
+    data += stride;
+  }
+}
+
+bool CanDecodeBlockCompressed(const ResourceFormat &fmt)
+{
+#if ENABLED(RDOC_ANDROID)
+  return false;
+#else
+  switch(fmt.type)
+  {
+    case ResourceFormatType::BC1:
+    case ResourceFormatType::BC2:
+    case ResourceFormatType::BC3:
+    case ResourceFormatType::BC7: return true;
+    // compressonator only decodes the unsigned variants
+    case ResourceFormatType::BC4:
+    case ResourceFormatType::BC5:
+    case ResourceFormatType::BC6: return fmt.compType != CompType::SNorm;
+    default: break;
+  }
+
+  return false;
+#endif
+}
+
+bool DecodeBlockCompressed(const ResourceFormat &fmt, const byte *data, uint32_t width,
+                           uint32_t height, FloatVector *out)
+{
+  if(!CanDecodeBlockCompressed(fmt))
+    return false;
+
+#if DISABLED(RDOC_ANDROID)
+  const size_t blockSize =
+      (fmt.type == ResourceFormatType::BC1 || fmt.type == ResourceFormatType::BC4) ? 8 : 16;
+
+  const uint32_t blocksWide = RDCMAX(1U, (width + 3) / 4);
+  const uint32_t blocksHigh = RDCMAX(1U, (height + 3) / 4);
+
+  const Norm8Tables &tables = GetNorm8Tables();
+  const bool srgb = fmt.compType == CompType::UNormSRGB;
+
+  byte rgba[64];
+  byte red[16], green[16];
+  uint16_t rgbHalf[48];
+
+  FloatVector texels[16];
+
+  for(uint32_t by = 0; by < blocksHigh; by++)
+  {
+    for(uint32_t bx = 0; bx < blocksWide; bx++)
+    {
+      const byte *block = data + (by * blocksWide + bx) * blockSize;
+
+      switch(fmt.type)
+      {
+        case ResourceFormatType::BC1:
+        case ResourceFormatType::BC2:
+        case ResourceFormatType::BC3:
+        case ResourceFormatType::BC7:
+        {
+          if(fmt.type == ResourceFormatType::BC1)
+            DecompressBlockBC1(block, rgba);
+          else if(fmt.type == ResourceFormatType::BC2)
+            DecompressBlockBC2(block, rgba);
+          else if(fmt.type == ResourceFormatType::BC3)
+            DecompressBlockBC3(block, rgba);
+          else
+            DecompressBlockBC7(block, rgba);
+
+          const float *rgbTable = srgb ? SRGB8_lookuptable : tables.unorm;
+
+          for(int t = 0; t < 16; t++)
+            texels[t] = FloatVector(rgbTable[rgba[t * 4 + 0]], rgbTable[rgba[t * 4 + 1]],
+                                    rgbTable[rgba[t * 4 + 2]], tables.unorm[rgba[t * 4 + 3]]);
+          break;
+        }
+        case ResourceFormatType::BC4:
+        {
+          DecompressBlockBC4(block, red);
+
+          for(int t = 0; t < 16; t++)
+            texels[t] = FloatVector(tables.unorm[red[t]], 0.0f, 0.0f, 1.0f);
+          break;
+        }
+        case ResourceFormatType::BC5:
+        {
+          DecompressBlockBC5(block, red, green);
+
+          for(int t = 0; t < 16; t++)
+            texels[t] = FloatVector(tables.unorm[red[t]], tables.unorm[green[t]], 0.0f, 1.0f);
+          break;
+        }
+        case ResourceFormatType::BC6:
+        {
+          DecompressBlockBC6(block, rgbHalf);
+
+          for(int t = 0; t < 16; t++)
+            texels[t] =
+                FloatVector(ConvertFromHalfRow(rgbHalf[t * 3 + 0]),
+                            ConvertFromHalfRow(rgbHalf[t * 3 + 1]),
+                            ConvertFromHalfRow(rgbHalf[t * 3 + 2]), 1.0f);
+          break;
+        }
+        default: return false;
+      }
+
+      // copy out the texels that are inside the image, blocks on the edge may be partial
+      for(uint32_t ty = 0; ty < 4 && by * 4 + ty < height; ty++)
+        for(uint32_t tx = 0; tx < 4 && bx * 4 + tx < width; tx++)
+          out[(by * 4 + ty) * width + bx * 4 + tx] = texels[ty * 4 + tx];
+    }
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #undef None
@@ -1603,4 +2122,199 @@ TEST_CASE("Check format conversion", "[format]")
   };
 }
 
+TEST_CASE("Check batch format conversion", "[format]")
+{
+  // deterministic noise so that every bit pattern is likely to be hit in each component
+  rdcarray<byte> noise;
+  noise.resize(16 * 1024);
+  uint32_t state = 0x1234;
+  for(byte &b : noise)
+  {
+    state = state * 1664525U + 1013904223U;
+    b = byte(state >> 24);
+  }
+
+  // large enough for 4 components of 8 bytes each
+  const size_t stride = 32;
+  const size_t count = noise.size() / stride;
+
+  auto makeFormat = [](ResourceFormatType type, CompType compType, uint8_t compCount,
+                       uint8_t compByteWidth, bool bgra) {
+    ResourceFormat fmt;
+    fmt.type = type;
+    fmt.compType = compType;
+    fmt.compCount = compCount;
+    fmt.compByteWidth = compByteWidth;
+    fmt.SetBGRAOrder(bgra);
+    return fmt;
+  };
+
+  rdcarray<ResourceFormat> formats;
+
+  for(uint8_t width : {1, 2, 4, 8})
+  {
+    for(CompType compType : {CompType::Float, CompType::UNorm, CompType::SNorm, CompType::UInt,
+                             CompType::SInt, CompType::UScaled, CompType::SScaled,
+                             CompType::Depth, CompType::UNormSRGB})
+    {
+      for(uint8_t compCount = 1; compCount <= 4; compCount++)
+        formats.push_back(makeFormat(ResourceFormatType::Regular, compType, compCount, width,
+                                     compCount == 4 && width == 1));
+    }
+  }
+
+  for(CompType compType : {CompType::UNorm, CompType::UInt, CompType::SNorm})
+  {
+    formats.push_back(makeFormat(ResourceFormatType::R10G10B10A2, compType, 4, 1, false));
+    formats.push_back(makeFormat(ResourceFormatType::R10G10B10A2, compType, 4, 1, true));
+  }
+
+  formats.push_back(makeFormat(ResourceFormatType::R11G11B10, CompType::Float, 3, 1, false));
+  formats.push_back(makeFormat(ResourceFormatType::D16S8, CompType::Depth, 2, 1, false));
+  formats.push_back(makeFormat(ResourceFormatType::D24S8, CompType::Depth, 2, 1, false));
+  formats.push_back(makeFormat(ResourceFormatType::D32S8, CompType::Depth, 2, 1, false));
+  formats.push_back(makeFormat(ResourceFormatType::A8, CompType::UNorm, 1, 1, false));
+  formats.push_back(makeFormat(ResourceFormatType::R9G9B9E5, CompType::Float, 3, 1, false));
+
+  SECTION("Row decoding matches single texel decoding")
+  {
+    rdcarray<FloatVector> row;
+    row.resize(count);
+
+    for(const ResourceFormat &fmt : formats)
+    {
+      bool rowSuccess = false, singleSuccess = false;
+
+      DecodeFormattedComponentsRow(fmt, noise.data(), stride, count, row.data(), &rowSuccess);
+      DecodeFormattedComponents(fmt, NULL, &singleSuccess);
+
+      INFO(fmt.Name());
+      CHECK(rowSuccess == singleSuccess);
+
+      size_t mismatches = 0;
+      for(size_t i = 0; i < count; i++)
+      {
+        FloatVector single = DecodeFormattedComponents(fmt, noise.data() + i * stride);
+
+        // compare bitwise so that NaNs are checked too
+        if(memcmp(&single, &row[i], sizeof(FloatVector)) != 0)
+          mismatches++;
+      }
+
+      CHECK(mismatches == 0);
+    }
+  };
+
+  SECTION("Row half decoding matches for every value")
+  {
+    rdcarray<uint16_t> halves;
+    for(uint32_t i = 0; i <= 0xffff; i++)
+      halves.push_back(uint16_t(i));
+
+    ResourceFormat fmt = makeFormat(ResourceFormatType::Regular, CompType::Float, 1, 2, false);
+
+    rdcarray<FloatVector> row;
+    row.resize(halves.size());
+
+    DecodeFormattedComponentsRow(fmt, (const byte *)halves.data(), sizeof(uint16_t),
+                                 halves.size(), row.data());
+
+    size_t mismatches = 0;
+    for(size_t i = 0; i < halves.size(); i++)
+    {
+      float single = ConvertFromHalf(halves[i]);
+      if(memcmp(&single, &row[i].x, sizeof(float)) != 0)
+        mismatches++;
+    }
+
+    CHECK(mismatches == 0);
+  };
+
+  SECTION("Row encoding matches single texel encoding")
+  {
+    rdcarray<FloatVector> values;
+    for(size_t i = 0; i + 4 <= noise.size(); i += 4)
+    {
+      // spread values around and outside of the normalised range
+      float f = (float(noise[i]) - 64.0f) / 96.0f;
+      values.push_back(FloatVector(f, f * 0.5f, f * 100.0f, -f));
+    }
+    values.push_back(FloatVector(FLT_MAX, -FLT_MAX, 1.0e-9f, -0.0f));
+
+    bytebuf rowData, singleData;
+    rowData.resize(values.size() * stride);
+    singleData.resize(values.size() * stride);
+
+    for(const ResourceFormat &fmt : formats)
+    {
+      bool rowSuccess = false, singleSuccess = false;
+
+      EncodeFormattedComponentsRow(fmt, values.data(), values.size(), rowData.data(), stride,
+                                   &rowSuccess);
+
+      for(size_t i = 0; i < values.size(); i++)
+        EncodeFormattedComponents(fmt, values[i], singleData.data() + i * stride, &singleSuccess);
+
+      INFO(fmt.Name());
+      CHECK(rowSuccess == singleSuccess);
+      if(singleSuccess)
+        CHECK((rowData == singleData));
+    }
+  };
+
+#if DISABLED(RDOC_ANDROID)
+  SECTION("Block compressed decoding")
+  {
+    // 6x5 texels so that the right and bottom blocks are partial
+    const uint32_t width = 6, height = 5;
+
+    const byte colours[4][4] = {
+        {255, 0, 0, 255},
+        {0, 255, 0, 255},
+        {0, 0, 255, 255},
+        {255, 255, 255, 255},
+    };
+
+    bytebuf compressed;
+    for(int b = 0; b < 4; b++)
+    {
+      byte src[64];
+      for(int t = 0; t < 16; t++)
+        memcpy(src + t * 4, colours[b], 4);
+
+      byte block[8];
+      CompressBlockBC1(src, 4 * sizeof(uint32_t), block, NULL);
+      compressed.append(block, sizeof(block));
+    }
+
+    ResourceFormat fmt = makeFormat(ResourceFormatType::BC1, CompType::UNorm, 4, 1, false);
+
+    REQUIRE(CanDecodeBlockCompressed(fmt));
+
+    rdcarray<FloatVector> decoded;
+    decoded.resize(width * height);
+    REQUIRE(DecodeBlockCompressed(fmt, compressed.data(), width, height, decoded.data()));
+
+    for(uint32_t y = 0; y < height; y++)
+    {
+      for(uint32_t x = 0; x < width; x++)
+      {
+        const byte *expected = colours[(y / 4) * 2 + (x / 4)];
+        const FloatVector &texel = decoded[y * width + x];
+
+        INFO("texel " << x << "," << y);
+        CHECK(fabsf(texel.x - float(expected[0]) / 255.0f) < 0.02f);
+        CHECK(fabsf(texel.y - float(expected[1]) / 255.0f) < 0.02f);
+        CHECK(fabsf(texel.z - float(expected[2]) / 255.0f) < 0.02f);
+        CHECK(texel.w == 1.0f);
+      }
+    }
+
+    fmt.compType = CompType::SNorm;
+    fmt.type = ResourceFormatType::BC4;
+    CHECK_FALSE(CanDecodeBlockCompressed(fmt));
+  };
+#endif
+}
+
 #endif
@@ -186,3 +186,20 @@ void EncodeFormattedComponents(const ResourceFormat &fmt, FloatVector v, byte *d
 
 void DecodePixelData(const ResourceFormat &srcFmt, const byte *data, PixelValue &out,
                      bool *success = NULL);
+
+// batch versions of the above for converting whole rows or images at a time. Texels are read from
+// or written to data every stride bytes. The results are identical to converting each texel
+// individually, but the format is only inspected once and common formats are converted in tight
+// loops without per-texel branching, which is significantly faster for large images.
+void DecodeFormattedComponentsRow(const ResourceFormat &fmt, const byte *data, size_t stride,
+                                  size_t count, FloatVector *out, bool *success = NULL);
+void EncodeFormattedComponentsRow(const ResourceFormat &fmt, const FloatVector *in, size_t count,
+                                  byte *data, size_t stride, bool *success = NULL);
+
+// returns true if DecodeBlockCompressed can decode the given format on the CPU
+bool CanDecodeBlockCompressed(const ResourceFormat &fmt);
+
+// decode a single depth slice of BC1-7 data, width x height texels, into tightly packed texels.
+// Returns false if the format isn't supported.
+bool DecodeBlockCompressed(const ResourceFormat &fmt, const byte *data, uint32_t width,
+                           uint32_t height, FloatVector *out);
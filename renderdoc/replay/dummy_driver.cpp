@@ -314,6 +314,12 @@ rdcarray<ShaderDebugState> DummyDriver::ContinueDebug(ShaderDebugger *debugger)
   return {};
 }
 
+ShaderDebugState DummyDriver::RunDebug(ShaderDebugger *debugger,
+                                       const rdcarray<uint32_t> &breakpoints, uint32_t maxSteps)
+{
+  return {};
+}
+
 void DummyDriver::FreeDebugger(ShaderDebugger *debugger)
 {
 }
@@ -115,6 +115,8 @@ public:
   ShaderDebugTrace *DebugThread(uint32_t eventId, const rdcfixedarray<uint32_t, 3> &groupid,
                                 const rdcfixedarray<uint32_t, 3> &threadid);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
+  ShaderDebugState RunDebug(ShaderDebugger *debugger, const rdcarray<uint32_t> &breakpoints,
+                            uint32_t maxSteps);
   void FreeDebugger(ShaderDebugger *debugger);
 
   ResourceId RenderOverlay(ResourceId texid, FloatVector clearCol, DebugOverlay overlay,
@@ -427,8 +427,18 @@ void RENDERDOC_OutOfMemory(uint64_t sz)
   RDCFATAL("Allocation failed for %llu bytes", sz);
 }
 
+#if ENABLED(ENABLE_UNIT_TESTS)
+// called on every container allocation when set, so that tests and benchmarks can measure how often
+// a hot path allocates. Only ever installed by tests.
+void (*RENDERDOC_ArrayAllocHook)(uint64_t sz) = NULL;
+#endif
+
 extern "C" RENDERDOC_API void *RENDERDOC_CC RENDERDOC_AllocArrayMem(uint64_t sz)
 {
+#if ENABLED(ENABLE_UNIT_TESTS)
+  if(RENDERDOC_ArrayAllocHook)
+    RENDERDOC_ArrayAllocHook(sz);
+#endif
   void *ret = malloc((size_t)sz);
   if(ret == NULL)
     RENDERDOC_OutOfMemory(sz);
@@ -27,6 +27,7 @@
 #include <string.h>
 #include <time.h>
 #include "common/dds_readwrite.h"
+#include "core/content_delta.h"
 #include "driver/ihv/amd/amd_isa.h"
 #include "driver/ihv/amd/amd_rgp.h"
 #include "jpeg-compressor/jpgd.h"
@@ -73,6 +74,9 @@ void ReplayController::SetFrameEvent(uint32_t eventId, bool force)
 
   if(eventId != m_EventID || force)
   {
+    // any queued readbacks are for the previous event
+    FlushReadbacks();
+
     m_EventID = eventId;
 
     m_pDevice->ReplayLog(eventId, eReplay_WithoutDraw);
@@ -533,6 +537,299 @@ rdcarray<EventUsage> ReplayController::GetUsage(ResourceId id)
   return m_pDevice->GetUsage(id);
 }
 
+static bool IsWriteUsage(ResourceUsage usage)
+{
+  if(usage >= ResourceUsage::VS_RWResource && usage <= ResourceUsage::All_RWResource)
+    return true;
+
+  switch(usage)
+  {
+    case ResourceUsage::StreamOut:
+    case ResourceUsage::ColorTarget:
+    case ResourceUsage::DepthStencilTarget:
+    case ResourceUsage::Clear:
+    case ResourceUsage::Discard:
+    case ResourceUsage::GenMips:
+    case ResourceUsage::Resolve:
+    case ResourceUsage::ResolveDst:
+    case ResourceUsage::Copy:
+    case ResourceUsage::CopyDst:
+    case ResourceUsage::CPUWrite: return true;
+    default: break;
+  }
+
+  return false;
+}
+
+void ReplayController::CalculateFingerprints()
+{
+  RENDERDOC_PROFILEFUNCTION();
+
+  // anything queued is for the current event, read it back before we move the replay around
+  FlushReadbacks();
+
+  m_Fingerprints.clear();
+
+  std::map<ResourceId, const TextureDescription *> textures;
+  for(const TextureDescription &tex : m_Textures)
+    textures[tex.resourceId] = &tex;
+
+  // the resources each event writes to, and whether every write is as a bound colour or depth
+  // target. Those are the only writes where we know which subresources are written.
+  struct EventWrite
+  {
+    ResourceId id;
+    bool targetsOnly;
+  };
+
+  std::map<uint32_t, rdcarray<EventWrite>> eventWrites;
+
+  auto addWrites = [this, &eventWrites](ResourceId id) {
+    ResourceId liveId = m_pDevice->GetLiveID(id);
+    if(liveId == ResourceId())
+      return;
+
+    for(const EventUsage &use : m_pDevice->GetUsage(liveId))
+    {
+      if(!IsWriteUsage(use.usage))
+        continue;
+
+      const bool target =
+          use.usage == ResourceUsage::ColorTarget || use.usage == ResourceUsage::DepthStencilTarget;
+
+      rdcarray<EventWrite> &writes = eventWrites[use.eventId];
+
+      EventWrite *existing = NULL;
+      for(EventWrite &w : writes)
+        if(w.id == id)
+          existing = &w;
+
+      if(existing)
+        existing->targetsOnly &= target;
+      else
+        writes.push_back({id, target});
+    }
+  };
+
+  for(const TextureDescription &tex : m_Textures)
+    addWrites(tex.resourceId);
+
+  std::set<ResourceId> buffers;
+  for(const BufferDescription &buf : m_Buffers)
+  {
+    buffers.insert(buf.resourceId);
+    addWrites(buf.resourceId);
+  }
+
+  // the hash of each subresource of each resource as of the last event that wrote to it. A
+  // resource's fingerprint is the hash of all of these, so only the subresources an event writes
+  // need to be read back again.
+  std::map<ResourceId, rdcarray<uint64_t>> subHashes;
+
+  for(auto eventIt = eventWrites.begin(); eventIt != eventWrites.end(); ++eventIt)
+  {
+    const uint32_t eventId = eventIt->first;
+    const rdcarray<EventWrite> &written = eventIt->second;
+
+    // replay to just after this event, the same way as SetFrameEvent
+    m_pDevice->ReplayLog(eventId, eReplay_WithoutDraw);
+    FatalErrorCheck();
+
+    m_pDevice->ReplayLog(eventId, eReplay_OnlyDraw);
+    FatalErrorCheck();
+
+    bool anyTargetsOnly = false;
+    for(const EventWrite &w : written)
+      anyTargetsOnly |= w.targetsOnly;
+
+    // only fetch the pipeline state if we can use it to narrow down what was written
+    rdcarray<Descriptor> targets;
+    if(anyTargetsOnly)
+    {
+      m_pDevice->SavePipelineState(eventId);
+      FatalErrorCheck();
+
+      if(m_APIProps.pipelineType == GraphicsAPI::D3D11)
+        m_PipeState.SetState(&m_D3D11PipelineState);
+      else if(m_APIProps.pipelineType == GraphicsAPI::D3D12)
+        m_PipeState.SetState(&m_D3D12PipelineState);
+      else if(m_APIProps.pipelineType == GraphicsAPI::OpenGL)
+        m_PipeState.SetState(&m_GLPipelineState);
+      else if(m_APIProps.pipelineType == GraphicsAPI::Vulkan)
+        m_PipeState.SetState(&m_VulkanPipelineState);
+
+      targets = m_PipeState.GetOutputTargets();
+      targets.push_back(m_PipeState.GetDepthTarget());
+    }
+
+    rdcarray<ReadbackRequest> requests;
+    // the resource and subresource index that each request is for
+    rdcarray<rdcpair<ResourceId, uint32_t>> requestSubs;
+
+    for(const EventWrite &w : written)
+    {
+      const ResourceId id = w.id;
+      ResourceId liveId = m_pDevice->GetLiveID(id);
+
+      auto texit = textures.find(id);
+      if(texit != textures.end())
+      {
+        const TextureDescription &tex = *texit->second;
+        const uint32_t mips = RDCMAX(1U, tex.mips);
+        const uint32_t slices = tex.dimension == 3 ? 1 : RDCMAX(1U, tex.arraysize);
+        const uint32_t samples = RDCMAX(1U, tex.msSamp);
+
+        rdcarray<uint64_t> &hashes = subHashes[id];
+
+        // the first time a resource is written we need everything, as a baseline. Shader writes,
+        // copies, clears and so on don't describe which subresources they write, so those re-read
+        // the whole resource
+        bool all = hashes.empty() || !w.targetsOnly;
+        hashes.resize(mips * slices * samples);
+
+        rdcarray<bool> needed;
+        needed.resize(mips * slices);
+
+        for(const Descriptor &desc : targets)
+        {
+          if(desc.resource != id)
+            continue;
+
+          const uint32_t endMip = RDCMIN(mips, uint32_t(desc.firstMip + desc.numMips));
+          const uint32_t endSlice = RDCMIN(slices, uint32_t(desc.firstSlice + desc.numSlices));
+
+          for(uint32_t mip = desc.firstMip; mip < endMip; mip++)
+          {
+            // 3D textures are fingerprinted as a whole per mip
+            if(tex.dimension == 3)
+            {
+              needed[mip * slices] = true;
+              continue;
+            }
+
+            for(uint32_t slice = desc.firstSlice; slice < endSlice; slice++)
+              needed[mip * slices + slice] = true;
+          }
+        }
+
+        // if the event wrote to it but we couldn't find where, read all of it back to be safe
+        if(!needed.contains(true))
+          all = true;
+
+        for(uint32_t mip = 0; mip < mips; mip++)
+        {
+          for(uint32_t slice = 0; slice < slices; slice++)
+          {
+            if(!all && !needed[mip * slices + slice])
+              continue;
+
+            // every sample is hashed separately, so a write that only changes some samples of a
+            // multisampled target is still seen
+            for(uint32_t sample = 0; sample < samples; sample++)
+            {
+              ReadbackRequest req;
+              req.resource = liveId;
+              req.texture = true;
+              req.sub = {mip, slice, sample};
+              requests.push_back(req);
+              requestSubs.push_back({id, (mip * slices + slice) * samples + sample});
+            }
+          }
+        }
+      }
+      else if(buffers.find(id) != buffers.end())
+      {
+        subHashes[id].resize(1);
+
+        ReadbackRequest req;
+        req.resource = liveId;
+        requests.push_back(req);
+        requestSubs.push_back({id, 0U});
+      }
+    }
+
+    if(requests.empty())
+      continue;
+
+    rdcarray<uint64_t> hashes = m_pDevice->GetResourceFingerprints(requests);
+    FatalErrorCheck();
+
+    if(hashes.size() != requests.size())
+      continue;
+
+    for(size_t i = 0; i < requests.size(); i++)
+      subHashes[requestSubs[i].first][requestSubs[i].second] = hashes[i];
+
+    for(const EventWrite &w : written)
+    {
+      auto it = subHashes.find(w.id);
+      if(it == subHashes.end())
+        continue;
+
+      uint64_t hash =
+          HashContents((const byte *)it->second.data(), it->second.size() * sizeof(uint64_t));
+
+      rdcarray<rdcpair<uint32_t, uint64_t>> &changes = m_Fingerprints[w.id];
+      if(changes.empty() || changes.back().second != hash)
+        changes.push_back({eventId, hash});
+    }
+  }
+
+  m_FingerprintsValid = true;
+
+  // return to the current event, the same as SetFrameEvent
+  m_pDevice->ReplayLog(m_EventID, eReplay_WithoutDraw);
+  FatalErrorCheck();
+
+  m_pDevice->ReplayLog(m_EventID, eReplay_OnlyDraw);
+  FatalErrorCheck();
+
+  FetchPipelineState(m_EventID);
+}
+
+rdcarray<uint32_t> ReplayController::GetModifyingEvents(ResourceId id)
+{
+  CHECK_REPLAY_THREAD();
+
+  if(!m_FingerprintsValid)
+    CalculateFingerprints();
+
+  rdcarray<uint32_t> ret;
+
+  auto it = m_Fingerprints.find(id);
+  if(it != m_Fingerprints.end())
+  {
+    ret.reserve(it->second.size());
+    for(const rdcpair<uint32_t, uint64_t> &change : it->second)
+      ret.push_back(change.first);
+  }
+
+  return ret;
+}
+
+uint64_t ReplayController::GetResourceFingerprint(ResourceId id, uint32_t eventId)
+{
+  CHECK_REPLAY_THREAD();
+
+  if(!m_FingerprintsValid)
+    CalculateFingerprints();
+
+  auto it = m_Fingerprints.find(id);
+  if(it == m_Fingerprints.end())
+    return 0;
+
+  // find the last change at or before this event
+  const rdcarray<rdcpair<uint32_t, uint64_t>> &changes = it->second;
+  auto change = std::upper_bound(
+      changes.begin(), changes.end(), eventId,
+      [](uint32_t eid, const rdcpair<uint32_t, uint64_t> &c) { return eid < c.first; });
+
+  if(change == changes.begin())
+    return 0;
+
+  return (change - 1)->second;
+}
+
 MeshFormat ReplayController::GetPostVSData(uint32_t instID, uint32_t viewID, MeshDataStage stage)
 {
   CHECK_REPLAY_THREAD();
@@ -597,6 +894,125 @@ bytebuf ReplayController::GetTextureData(ResourceId tex, const Subresource &sub)
   return ret;
 }
 
+uint32_t ReplayController::QueueBufferReadback(ResourceId buff, uint64_t offset, uint64_t len)
+{
+  CHECK_REPLAY_THREAD();
+
+  if(buff == ResourceId())
+    return 0;
+
+  ReadbackRequest req;
+  req.resource = m_pDevice->GetLiveID(buff);
+  req.offset = offset;
+  req.length = len;
+
+  if(req.resource == ResourceId())
+  {
+    RDCERR("Couldn't get Live ID for %s queueing buffer readback", ToStr(buff).c_str());
+    return 0;
+  }
+
+  uint32_t handle = m_NextReadback++;
+  m_Readbacks[handle] = req;
+  m_PendingReadbacks.push_back(handle);
+  return handle;
+}
+
+uint32_t ReplayController::QueueTextureReadback(ResourceId tex, const Subresource &sub)
+{
+  CHECK_REPLAY_THREAD();
+
+  ReadbackRequest req;
+  req.resource = m_pDevice->GetLiveID(tex);
+  req.texture = true;
+  req.sub = sub;
+
+  if(req.resource == ResourceId())
+  {
+    RDCERR("Couldn't get Live ID for %s queueing texture readback", ToStr(tex).c_str());
+    return 0;
+  }
+
+  uint32_t handle = m_NextReadback++;
+  m_Readbacks[handle] = req;
+  m_PendingReadbacks.push_back(handle);
+  return handle;
+}
+
+void ReplayController::FlushReadbacks()
+{
+  if(m_PendingReadbacks.empty())
+    return;
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  rdcarray<ReadbackRequest> requests;
+  requests.reserve(m_PendingReadbacks.size());
+  for(uint32_t handle : m_PendingReadbacks)
+    requests.push_back(m_Readbacks[handle]);
+
+  m_pDevice->GetBatchResourceData(requests);
+  FatalErrorCheck();
+
+  for(size_t i = 0; i < m_PendingReadbacks.size(); i++)
+    m_Readbacks[m_PendingReadbacks[i]].data.swap(requests[i].data);
+
+  m_PendingReadbacks.clear();
+}
+
+bytebuf ReplayController::FetchReadback(uint32_t handle)
+{
+  CHECK_REPLAY_THREAD();
+
+  bytebuf ret;
+
+  auto it = m_Readbacks.find(handle);
+  if(it == m_Readbacks.end())
+  {
+    RDCERR("Unknown readback handle %u", handle);
+    return ret;
+  }
+
+  if(m_PendingReadbacks.contains(handle))
+  {
+    FlushReadbacks();
+    it = m_Readbacks.find(handle);
+  }
+
+  ret.swap(it->second.data);
+  m_Readbacks.erase(it);
+
+  return ret;
+}
+
+ResultDetails ReplayController::SaveReadback(uint32_t handle, const rdcstr &path)
+{
+  CHECK_REPLAY_THREAD();
+
+  if(m_Readbacks.find(handle) == m_Readbacks.end())
+    RETURN_ERROR_RESULT(ResultCode::InvalidParameter, "Unknown readback handle %u", handle);
+
+  bytebuf data = FetchReadback(handle);
+
+  FILE *f = FileIO::fopen(path, FileIO::WriteBinary);
+
+  if(!f)
+  {
+    RETURN_ERROR_RESULT(ResultCode::FileIOFailed, "Couldn't write to path %s, error: %s",
+                        path.c_str(), FileIO::ErrorString().c_str());
+  }
+
+  size_t written = data.empty() ? 0 : FileIO::fwrite(data.data(), 1, data.size(), f);
+
+  FileIO::fclose(f);
+
+  if(written != data.size())
+    RETURN_ERROR_RESULT(ResultCode::FileIOFailed, "Couldn't write all readback data to %s",
+                        path.c_str());
+
+  return RDResult();
+}
+
 ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const rdcstr &path)
 {
   CHECK_REPLAY_THREAD();
@@ -1324,12 +1740,18 @@ ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const r
       if(saveFmt.compType == CompType::Depth && pixStride == 3)
         pixStride = 4;
 
+      // decode a row at a time, so the format is only inspected once per row
+      rdcarray<FloatVector> row;
+      row.resize(td.width);
+
       for(uint32_t y = 0; y < td.height; y++)
       {
+        DecodeFormattedComponentsRow(saveFmt, srcData, pixStride, td.width, row.data());
+        srcData += pixStride * td.width;
+
         for(uint32_t x = 0; x < td.width; x++)
         {
-          FloatVector pixel = DecodeFormattedComponents(saveFmt, srcData);
-          srcData += pixStride;
+          FloatVector pixel = row[x];
 
           // HDR can't represent negative values
           if(sd.destType == FileType::HDR)
@@ -1710,6 +2132,20 @@ rdcarray<ShaderDebugState> ReplayController::ContinueDebug(ShaderDebugger *debug
   return ret;
 }
 
+ShaderDebugState ReplayController::RunDebug(ShaderDebugger *debugger,
+                                            const rdcarray<uint32_t> &breakpoints,
+                                            uint32_t maxSteps)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  ShaderDebugState ret = m_pDevice->RunDebug(debugger, breakpoints, maxSteps);
+  FatalErrorCheck();
+
+  return ret;
+}
+
 void ReplayController::FreeTrace(ShaderDebugTrace *trace)
 {
   CHECK_REPLAY_THREAD();
@@ -1933,6 +2369,9 @@ void ReplayController::Shutdown()
 
   RDCLOG("Shutting down replay renderer");
 
+  m_PendingReadbacks.clear();
+  m_Readbacks.clear();
+
   for(size_t i = 0; i < m_Outputs.size(); i++)
     SAFE_DELETE(m_Outputs[i]);
 
@@ -2132,6 +2571,9 @@ void ReplayController::ReplaceResource(ResourceId from, ResourceId to)
 {
   CHECK_REPLAY_THREAD();
 
+  FlushReadbacks();
+  m_FingerprintsValid = false;
+
   m_pDevice->ReplaceResource(from, to);
   FatalErrorCheck();
 
@@ -2146,6 +2588,9 @@ void ReplayController::RemoveReplacement(ResourceId id)
 {
   CHECK_REPLAY_THREAD();
 
+  FlushReadbacks();
+  m_FingerprintsValid = false;
+
   m_pDevice->RemoveReplacement(id);
   FatalErrorCheck();
 
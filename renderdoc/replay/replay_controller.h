@@ -215,15 +215,24 @@ public:
   ShaderDebugTrace *DebugThread(const rdcfixedarray<uint32_t, 3> &groupid,
                                 const rdcfixedarray<uint32_t, 3> &threadid);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
+  ShaderDebugState RunDebug(ShaderDebugger *debugger, const rdcarray<uint32_t> &breakpoints,
+                            uint32_t maxSteps);
   void FreeTrace(ShaderDebugTrace *trace);
 
   MeshFormat GetPostVSData(uint32_t instID, uint32_t viewID, MeshDataStage stage);
 
   rdcarray<EventUsage> GetUsage(ResourceId id);
+  rdcarray<uint32_t> GetModifyingEvents(ResourceId id);
+  uint64_t GetResourceFingerprint(ResourceId id, uint32_t eventId);
 
   bytebuf GetBufferData(ResourceId buff, uint64_t offset, uint64_t len);
   bytebuf GetTextureData(ResourceId buff, const Subresource &sub);
 
+  uint32_t QueueBufferReadback(ResourceId buff, uint64_t offset, uint64_t len);
+  uint32_t QueueTextureReadback(ResourceId tex, const Subresource &sub);
+  bytebuf FetchReadback(uint32_t handle);
+  ResultDetails SaveReadback(uint32_t handle, const rdcstr &path);
+
   ResultDetails SaveTexture(const TextureSave &saveData, const rdcstr &path);
 
   rdcarray<ShaderVariable> GetCBufferVariableContents(ResourceId pipeline, ResourceId shader,
@@ -251,6 +260,9 @@ private:
 
   void FetchPipelineState(uint32_t eventId);
 
+  void FlushReadbacks();
+  void CalculateFingerprints();
+
   ActionDescription *GetActionByEID(uint32_t eventId);
   bool ContainsMarker(const rdcarray<ActionDescription> &actions);
   bool PassEquivalent(const ActionDescription &a, const ActionDescription &b);
@@ -291,6 +303,17 @@ private:
 
   rdcarray<ShaderDebugger *> m_Debuggers;
 
+  // readbacks queued by handle. The pending ones haven't been read back yet and are all read back
+  // together by FlushReadbacks.
+  std::map<uint32_t, ReadbackRequest> m_Readbacks;
+  rdcarray<uint32_t> m_PendingReadbacks;
+  uint32_t m_NextReadback = 1;
+
+  // for each resource written as an action output, the events where its fingerprint changed and
+  // the new fingerprint. Calculated on first use
+  std::map<ResourceId, rdcarray<rdcpair<uint32_t, uint64_t>>> m_Fingerprints;
+  bool m_FingerprintsValid = false;
+
   std::set<ResourceId> m_TargetResources;
   std::set<ResourceId> m_CustomShaders;
 
@@ -26,6 +26,7 @@
 #include <float.h>
 #include <math.h>
 #include "compressonator/CMP_Core.h"
+#include "core/content_delta.h"
 #include "maths/formatpacking.h"
 #include "maths/half_convert.h"
 #include "serialise/serialiser.h"
@@ -58,6 +59,35 @@ void DoSerialise(SerialiserType &ser, GetTextureDataParams &el)
 
 INSTANTIATE_SERIALISE_TYPE(GetTextureDataParams);
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, ReadbackRequest &el)
+{
+  SERIALISE_MEMBER(resource);
+  SERIALISE_MEMBER(texture);
+  SERIALISE_MEMBER(offset);
+  SERIALISE_MEMBER(length);
+  SERIALISE_MEMBER(sub);
+  SERIALISE_MEMBER(params);
+}
+
+INSTANTIATE_SERIALISE_TYPE(ReadbackRequest);
+
+rdcarray<uint64_t> IRemoteDriver::GetResourceFingerprints(rdcarray<ReadbackRequest> &requests)
+{
+  GetBatchResourceData(requests);
+
+  rdcarray<uint64_t> ret;
+  ret.resize(requests.size());
+
+  for(size_t i = 0; i < requests.size(); i++)
+  {
+    ret[i] = HashContents(requests[i].data.data(), requests[i].data.size());
+    requests[i].data.clear();
+  }
+
+  return ret;
+}
+
 static bool PreviousNextExcludedMarker(ActionDescription *action)
 {
   return bool(action->flags & (ActionFlags::PushMarker | ActionFlags::PopMarker |
@@ -101,6 +101,24 @@ struct GetTextureDataParams
 
 DECLARE_REFLECTION_STRUCT(GetTextureDataParams);
 
+// one buffer range or texture subresource to read back as part of a batch with
+// GetBatchResourceData
+struct ReadbackRequest
+{
+  ResourceId resource;
+  // if true this reads back a texture subresource, otherwise a buffer range
+  bool texture = false;
+  uint64_t offset = 0;
+  uint64_t length = 0;
+  Subresource sub;
+  GetTextureDataParams params;
+
+  // the contents, filled in when the batch is read back. Not serialised with the request
+  bytebuf data;
+};
+
+DECLARE_REFLECTION_STRUCT(ReadbackRequest);
+
 CompType BaseRemapType(RemapTexture remap, CompType typeCast);
 inline CompType BaseRemapType(const GetTextureDataParams &params)
 {
@@ -206,6 +224,26 @@ public:
   virtual void GetTextureData(ResourceId tex, const Subresource &sub,
                               const GetTextureDataParams &params, bytebuf &data) = 0;
 
+  // batch query for the above, reading back several resources at once. Drivers can override this
+  // to record all of the copies before waiting on any of them, and it's overridden in the proxy to
+  // fetch everything in one round trip. By default each request is read back in turn.
+  virtual void GetBatchResourceData(rdcarray<ReadbackRequest> &requests)
+  {
+    for(ReadbackRequest &req : requests)
+    {
+      if(req.texture)
+        GetTextureData(req.resource, req.sub, req.params, req.data);
+      else
+        GetBufferData(req.resource, req.offset, req.length, req.data);
+    }
+  }
+
+  // returns a hash of the contents of each request instead of the contents themselves, so that
+  // changes can be detected without transferring the data. By default the requests are read back
+  // and hashed, the data is not returned. Drivers can override this to hash on the GPU and only
+  // read back the hashes. The hashes only need to be consistent within one driver.
+  virtual rdcarray<uint64_t> GetResourceFingerprints(rdcarray<ReadbackRequest> &requests);
+
   virtual void BuildTargetShader(ShaderEncoding sourceEncoding, const bytebuf &source,
                                  const rdcstr &entry, const ShaderCompileFlags &compileFlags,
                                  ShaderStage type, ResourceId &id, rdcstr &errors) = 0;
@@ -232,6 +270,8 @@ public:
   virtual ShaderDebugTrace *DebugThread(uint32_t eventId, const rdcfixedarray<uint32_t, 3> &groupid,
                                         const rdcfixedarray<uint32_t, 3> &threadid) = 0;
   virtual rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger) = 0;
+  virtual ShaderDebugState RunDebug(ShaderDebugger *debugger,
+                                    const rdcarray<uint32_t> &breakpoints, uint32_t maxSteps) = 0;
   virtual void FreeDebugger(ShaderDebugger *debugger) = 0;
 
   virtual ResourceId RenderOverlay(ResourceId texid, FloatVector clearCol, DebugOverlay overlay,
@@ -28,7 +28,8 @@
 static const uint64_t zstdBlockSize = 128 * 1024;
 static const uint64_t compressBlockSize = ZSTD_compressBound(zstdBlockSize);
 
-ZSTDCompressor::ZSTDCompressor(StreamWriter *write, Ownership own) : Compressor(write, own)
+ZSTDCompressor::ZSTDCompressor(StreamWriter *write, Ownership own, int level)
+    : Compressor(write, own), m_Level(level)
 {
   m_Page = AllocAlignedBuffer(zstdBlockSize);
   m_CompressBuffer = AllocAlignedBuffer(compressBlockSize);
@@ -145,7 +146,7 @@ bool ZSTDCompressor::FlushPage()
 
 bool ZSTDCompressor::CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out)
 {
-  size_t err = ZSTD_initCStream(m_Stream, 7);
+  size_t err = ZSTD_initCStream(m_Stream, m_Level);
 
   if(ZSTD_isError(err))
   {
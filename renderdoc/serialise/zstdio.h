@@ -30,9 +30,12 @@
 class ZSTDCompressor : public Compressor
 {
 public:
-  ZSTDCompressor(StreamWriter *write, Ownership own);
+  ZSTDCompressor(StreamWriter *write, Ownership own) : ZSTDCompressor(write, own, DefaultLevel) {}
+  ZSTDCompressor(StreamWriter *write, Ownership own, int level);
   ~ZSTDCompressor();
 
+  static const int DefaultLevel = 7;
+
   bool Write(const void *data, uint64_t numBytes);
   bool Finish();
 
@@ -44,6 +47,7 @@ private:
   byte *m_Page;
   byte *m_CompressBuffer;
   uint64_t m_PageOffset;
+  int m_Level;
 
   ZSTD_CStream *m_Stream;
 };
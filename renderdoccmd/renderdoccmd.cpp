@@ -26,7 +26,15 @@
 #include "renderdoccmd.h"
 #include <app/renderdoc_app.h>
 #include <replay/version.h>
+#include <string.h>
+#include <atomic>
+#include <fstream>
+#include <mutex>
 #include <string>
+#include <thread>
+
+// the pipeline state helpers aren't exported from the core library, so compile them in here
+#include <replay/pipestate.inl>
 
 rdcstr conv(const std::string &s)
 {
@@ -51,6 +59,17 @@ rdcstr DoStringise(const uint32_t &el)
   return conv(oss.str());
 }
 
+// likewise for ResourceId, formatted the same way as the core library does
+template <>
+rdcstr DoStringise(const ResourceId &el)
+{
+  uint64_t num;
+  memcpy(&num, &el, sizeof(num));
+  std::ostringstream oss;
+  oss << "ResourceId::" << num;
+  return conv(oss.str());
+}
+
 inline std::ostream &operator<<(std::ostream &os, rdcstr const &str)
 {
   return os << str.c_str();
@@ -835,6 +854,587 @@ public:
   }
 };
 
+#if !defined(__ANDROID__)
+
+static std::string json_escape(const std::string &str)
+{
+  std::string ret;
+  ret.reserve(str.size() + 2);
+  ret.push_back('"');
+  for(char c : str)
+  {
+    if(c == '"' || c == '\\')
+    {
+      ret.push_back('\\');
+      ret.push_back(c);
+    }
+    else if(c == '\n')
+    {
+      ret += "\\n";
+    }
+    else if(c == '\r')
+    {
+      ret += "\\r";
+    }
+    else if(c == '\t')
+    {
+      ret += "\\t";
+    }
+    else if((unsigned char)c < 0x20)
+    {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", (unsigned int)c);
+      ret += buf;
+    }
+    else
+    {
+      ret.push_back(c);
+    }
+  }
+  ret.push_back('"');
+  return ret;
+}
+
+static std::string csv_escape(const std::string &str)
+{
+  if(str.find_first_of(",\"\r\n") == std::string::npos)
+    return str;
+
+  std::string ret = "\"";
+  for(char c : str)
+  {
+    if(c == '"')
+      ret.push_back('"');
+    ret.push_back(c);
+  }
+  ret.push_back('"');
+  return ret;
+}
+
+struct AnalyseCommand : public Command
+{
+private:
+  std::vector<std::string> captures;
+  std::string output;
+  std::string format;
+  uint32_t jobs = 1;
+  bool worker = false;
+
+  bool reportCounts = false;
+  bool reportDurations = false;
+  bool reportMemory = false;
+  bool reportShaders = false;
+
+  struct Report
+  {
+    std::string capture;
+    std::string error;
+    std::string api;
+
+    uint32_t actions = 0, draws = 0, dispatches = 0, clears = 0, copies = 0;
+
+    bool hasDurations = false;
+    double totalDuration = 0.0;
+    struct ActionDuration
+    {
+      uint32_t eventId;
+      std::string name;
+      double duration;
+    };
+    std::vector<ActionDuration> durations;
+
+    uint64_t textureCount = 0, textureBytes = 0, bufferCount = 0, bufferBytes = 0;
+
+    struct ShaderUse
+    {
+      std::string name;
+      std::vector<std::string> stages;
+      uint32_t actions = 0;
+    };
+    std::map<ResourceId, ShaderUse> shaders;
+  };
+
+  std::string reportList() const
+  {
+    std::string ret;
+    if(reportCounts)
+      ret += "counts,";
+    if(reportDurations)
+      ret += "durations,";
+    if(reportMemory)
+      ret += "memory,";
+    if(reportShaders)
+      ret += "shaders,";
+    if(!ret.empty())
+      ret.pop_back();
+    return ret;
+  }
+
+  static bool IsWork(ActionFlags flags)
+  {
+    return bool(flags & (ActionFlags::Drawcall | ActionFlags::MeshDispatch | ActionFlags::Dispatch |
+                         ActionFlags::DispatchRay));
+  }
+
+  void WalkActions(const rdcarray<ActionDescription> &actions, const SDFile &sdfile, Report &report,
+                   std::map<uint32_t, std::string> &names, std::vector<uint32_t> &workEvents)
+  {
+    for(const ActionDescription &a : actions)
+    {
+      report.actions++;
+
+      if(a.flags & (ActionFlags::Drawcall | ActionFlags::MeshDispatch))
+        report.draws++;
+      if(a.flags & (ActionFlags::Dispatch | ActionFlags::DispatchRay))
+        report.dispatches++;
+      if(a.flags & ActionFlags::Clear)
+        report.clears++;
+      if(a.flags & (ActionFlags::Copy | ActionFlags::Resolve))
+        report.copies++;
+
+      if(reportDurations)
+        names[a.eventId] = conv(a.GetName(sdfile));
+
+      if(IsWork(a.flags))
+        workEvents.push_back(a.eventId);
+
+      WalkActions(a.children, sdfile, report, names, workEvents);
+    }
+  }
+
+  void Analyse(IReplayController *renderer, Report &report)
+  {
+    report.api = conv(ToStr(renderer->GetAPIProperties().pipelineType));
+
+    std::map<uint32_t, std::string> names;
+    std::vector<uint32_t> workEvents;
+    WalkActions(renderer->GetRootActions(), renderer->GetStructuredFile(), report, names,
+                workEvents);
+
+    if(reportDurations)
+    {
+      rdcarray<GPUCounter> counters = renderer->EnumerateCounters();
+      if(counters.contains(GPUCounter::EventGPUDuration))
+      {
+        report.hasDurations = true;
+
+        for(const CounterResult &r : renderer->FetchCounters({GPUCounter::EventGPUDuration}))
+        {
+          report.durations.push_back({r.eventId, names[r.eventId], r.value.d});
+          report.totalDuration += r.value.d;
+        }
+      }
+    }
+
+    if(reportMemory)
+    {
+      for(const TextureDescription &tex : renderer->GetTextures())
+      {
+        report.textureCount++;
+        report.textureBytes += tex.byteSize;
+      }
+
+      for(const BufferDescription &buf : renderer->GetBuffers())
+      {
+        report.bufferCount++;
+        report.bufferBytes += buf.length;
+      }
+    }
+
+    if(reportShaders)
+    {
+      std::map<ResourceId, std::string> resourceNames;
+      for(const ResourceDescription &res : renderer->GetResources())
+        resourceNames[res.resourceId] = conv(res.name);
+
+      // actions are walked in order, so this replays forward through the capture once
+      for(uint32_t eventId : workEvents)
+      {
+        renderer->SetFrameEvent(eventId, false);
+
+        const PipeState &pipe = renderer->GetPipelineState();
+
+        for(ShaderStage stage = ShaderStage::First; stage < ShaderStage::Count; ++stage)
+        {
+          ResourceId id = pipe.GetShader(stage);
+          if(id == ResourceId())
+            continue;
+
+          Report::ShaderUse &use = report.shaders[id];
+          if(use.name.empty())
+            use.name = resourceNames[id];
+
+          std::string stageName = conv(ToStr(stage));
+          if(std::find(use.stages.begin(), use.stages.end(), stageName) == use.stages.end())
+            use.stages.push_back(stageName);
+
+          use.actions++;
+        }
+      }
+    }
+  }
+
+  std::string FormatJSON(const Report &report) const
+  {
+    std::ostringstream out;
+    out.precision(9);
+
+    out << "  {\n";
+    out << "    \"capture\": " << json_escape(report.capture) << ",\n";
+    out << "    \"success\": " << (report.error.empty() ? "true" : "false");
+
+    if(!report.error.empty())
+    {
+      out << ",\n    \"error\": " << json_escape(report.error) << "\n  }";
+      return out.str();
+    }
+
+    out << ",\n    \"api\": " << json_escape(report.api);
+
+    if(reportCounts)
+    {
+      out << ",\n    \"counts\": {\"actions\": " << report.actions
+          << ", \"draws\": " << report.draws << ", \"dispatches\": " << report.dispatches
+          << ", \"clears\": " << report.clears << ", \"copies\": " << report.copies << "}";
+    }
+
+    if(reportDurations)
+    {
+      out << ",\n    \"durations\": ";
+      if(!report.hasDurations)
+      {
+        out << "null";
+      }
+      else
+      {
+        out << "{\n      \"total\": " << report.totalDuration << ",\n      \"actions\": [";
+        for(size_t i = 0; i < report.durations.size(); i++)
+        {
+          const Report::ActionDuration &d = report.durations[i];
+          out << (i == 0 ? "\n" : ",\n") << "        {\"eventId\": " << d.eventId
+              << ", \"name\": " << json_escape(d.name) << ", \"duration\": " << d.duration << "}";
+        }
+        out << "\n      ]\n    }";
+      }
+    }
+
+    if(reportMemory)
+    {
+      out << ",\n    \"memory\": {\"textures\": " << report.textureCount
+          << ", \"textureBytes\": " << report.textureBytes
+          << ", \"buffers\": " << report.bufferCount
+          << ", \"bufferBytes\": " << report.bufferBytes << "}";
+    }
+
+    if(reportShaders)
+    {
+      out << ",\n    \"shaders\": [";
+      bool first = true;
+      for(auto it = report.shaders.begin(); it != report.shaders.end(); ++it)
+      {
+        out << (first ? "\n" : ",\n") << "      {\"id\": " << json_escape(conv(ToStr(it->first)))
+            << ", \"name\": " << json_escape(it->second.name) << ", \"stages\": [";
+        for(size_t s = 0; s < it->second.stages.size(); s++)
+          out << (s == 0 ? "" : ", ") << json_escape(it->second.stages[s]);
+        out << "], \"actions\": " << it->second.actions << "}";
+        first = false;
+      }
+      out << "\n    ]";
+    }
+
+    out << "\n  }";
+    return out.str();
+  }
+
+  std::string FormatCSVHeader() const
+  {
+    return "capture,success,error,api,actions,draws,dispatches,clears,copies,gpu_duration,"
+           "textures,texture_bytes,buffers,buffer_bytes,shaders";
+  }
+
+  std::string FormatCSV(const Report &report) const
+  {
+    std::ostringstream out;
+    out.precision(9);
+
+    out << csv_escape(report.capture) << "," << (report.error.empty() ? "true" : "false") << ","
+        << csv_escape(report.error) << "," << csv_escape(report.api) << ",";
+
+    if(reportCounts && report.error.empty())
+      out << report.actions << "," << report.draws << "," << report.dispatches << ","
+          << report.clears << "," << report.copies << ",";
+    else
+      out << ",,,,,";
+
+    if(reportDurations && report.hasDurations)
+      out << report.totalDuration << ",";
+    else
+      out << ",";
+
+    if(reportMemory && report.error.empty())
+      out << report.textureCount << "," << report.textureBytes << "," << report.bufferCount << ","
+          << report.bufferBytes << ",";
+    else
+      out << ",,,,";
+
+    if(reportShaders && report.error.empty())
+      out << report.shaders.size();
+
+    return out.str();
+  }
+
+  std::string Format(const Report &report) const
+  {
+    return format == "csv" ? FormatCSV(report) : FormatJSON(report);
+  }
+
+  Report AnalyseCapture(const std::string &capture)
+  {
+    Report report;
+    report.capture = capture;
+
+    ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+
+    ResultDetails res = file->OpenFile(conv(capture), "rdc", NULL);
+
+    if(res.OK())
+    {
+      IReplayController *renderer = NULL;
+      rdctie(res, renderer) = file->OpenCapture(ReplayOptions(), NULL);
+
+      if(res.OK())
+      {
+        Analyse(renderer, report);
+        renderer->Shutdown();
+      }
+    }
+
+    file->Shutdown();
+
+    if(!res.OK())
+      report.error = conv(res.Message());
+
+    return report;
+  }
+
+  // written by workers before their result, so that anything else on stdout is skipped
+  static const char *ResultMarker() { return "--- renderdoccmd analyse result ---\n"; }
+
+  // analyse our single capture in this process and write the formatted result to stdout
+  int ExecuteWorker()
+  {
+    Report report = AnalyseCapture(captures[0]);
+
+    std::cout << std::endl << ResultMarker() << Format(report) << std::endl;
+
+    return report.error.empty() ? 0 : 1;
+  }
+
+  // analyse a capture in a worker process and return its formatted result. If the worker crashes or
+  // doesn't produce a result, the capture is reported as failed.
+  std::string RunWorker(const std::string &capture)
+  {
+    std::vector<std::string> args = {
+        "analyse", "--worker", "--format", format, "--report", reportList(), capture,
+    };
+
+    std::string workerOutput, error;
+    bool exited = RunWorkerProcess(args, workerOutput, error);
+
+    size_t marker = workerOutput.rfind(ResultMarker());
+    if(exited && marker != std::string::npos)
+    {
+      std::string result = workerOutput.substr(marker + strlen(ResultMarker()));
+      while(!result.empty() && (result.back() == '\n' || result.back() == '\r'))
+        result.pop_back();
+      return result;
+    }
+
+    Report report;
+    report.capture = capture;
+    report.error = exited ? "Analysis process exited without a result" : error;
+    return Format(report);
+  }
+
+public:
+  AnalyseCommand() : Command() {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<capture.rdc> [<capture.rdc> ...]");
+    parser.add<std::string>("output", 'o', "Write the results to this file instead of stdout.",
+                            false);
+    parser.add<std::string>(
+        "format", 'f',
+        "The output format. CSV contains one summary row per capture, per-action durations and "
+        "per-shader details are only included in JSON.",
+        false, "json", cmdline::oneof<std::string>("json", "csv"));
+    parser.add<std::string>("report", 'r',
+                            "Comma-separated list of what to report. Any of: counts, durations, "
+                            "memory, shaders.",
+                            false, "counts,durations,memory,shaders");
+    parser.add<std::string>("list", 'l',
+                            "Read additional capture paths from this file, one per line.", false);
+    parser.add<uint32_t>("jobs", 'j',
+                         "How many captures to analyse at once, each in its own process. Defaults "
+                         "to the number of CPU cores.",
+                         false, std::max(1U, std::thread::hardware_concurrency()));
+    parser.add("worker", '\0', "Internal use only!");
+  }
+  virtual const char *Description()
+  {
+    return "Replay a set of captures and report statistics about each one.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
+  {
+    captures = parser.rest();
+    parser.set_rest({});
+
+    if(parser.exist("list"))
+    {
+      std::string listFile = parser.get<std::string>("list");
+      std::ifstream list(listFile);
+      if(!list)
+      {
+        std::cerr << "Couldn't open capture list '" << listFile << "'." << std::endl;
+        return false;
+      }
+
+      std::string line;
+      while(std::getline(list, line))
+      {
+        while(!line.empty() && (line.back() == '\r' || line.back() == ' '))
+          line.pop_back();
+        if(!line.empty())
+          captures.push_back(line);
+      }
+    }
+
+    if(captures.empty())
+    {
+      std::cerr << "Error: analyse command requires at least one capture to analyse." << std::endl
+                << std::endl
+                << parser.usage();
+      return false;
+    }
+
+    std::string report = parser.get<std::string>("report") + ",";
+    size_t start = 0;
+    for(size_t comma = report.find(','); comma != std::string::npos;
+        start = comma + 1, comma = report.find(',', start))
+    {
+      std::string section = report.substr(start, comma - start);
+
+      if(section == "counts")
+        reportCounts = true;
+      else if(section == "durations")
+        reportDurations = true;
+      else if(section == "memory")
+        reportMemory = true;
+      else if(section == "shaders")
+        reportShaders = true;
+      else if(!section.empty())
+      {
+        std::cerr << "Unknown report section '" << section << "'." << std::endl
+                  << std::endl
+                  << parser.usage();
+        return false;
+      }
+    }
+
+    format = parser.get<std::string>("format");
+    jobs = std::max(1U, parser.get<uint32_t>("jobs"));
+
+    if(parser.exist("output"))
+      output = parser.get<std::string>("output");
+
+    worker = parser.exist("worker");
+
+    if(worker && captures.size() != 1)
+    {
+      std::cerr << "Worker processes analyse exactly one capture." << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+  virtual int Execute(const CaptureOptions &)
+  {
+    if(worker)
+      return ExecuteWorker();
+
+    std::ofstream outFile;
+    if(!output.empty())
+    {
+      outFile.open(output, std::ios::out | std::ios::trunc | std::ios::binary);
+      if(!outFile)
+      {
+        std::cerr << "Couldn't open '" << output << "' to write results." << std::endl;
+        return 1;
+      }
+    }
+
+    std::ostream &out = output.empty() ? std::cout : outFile;
+
+    if(format == "csv")
+      out << FormatCSVHeader() << "\n";
+    else
+      out << "[\n";
+
+    // each capture is analysed in its own process. This keeps a capture that crashes the replay
+    // from taking down the whole batch, and lets several replay at once without sharing any state.
+    // Results are written in order, each as soon as it and everything before it is finished.
+    std::vector<std::string> results(captures.size());
+    std::vector<bool> finished(captures.size());
+    size_t written = 0, done = 0;
+    std::mutex lock;
+
+    std::atomic<size_t> next(0);
+
+    auto work = [&]() {
+      for(size_t idx = next++; idx < captures.size(); idx = next++)
+      {
+        std::string result = RunWorker(captures[idx]);
+
+        std::lock_guard<std::mutex> guard(lock);
+
+        results[idx] = result;
+        finished[idx] = true;
+
+        for(; written < captures.size() && finished[written]; written++)
+        {
+          if(format == "csv")
+            out << results[written] << "\n";
+          else
+            out << results[written] << (written + 1 < captures.size() ? ",\n" : "\n");
+
+          results[written].clear();
+        }
+
+        out.flush();
+
+        std::cerr << "Analysed " << ++done << "/" << captures.size() << ": " << captures[idx]
+                  << std::endl;
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < std::min<size_t>(jobs, captures.size()); i++)
+      threads.push_back(std::thread(work));
+
+    for(std::thread &t : threads)
+      t.join();
+
+    if(format != "csv")
+      out << "]\n";
+
+    return 0;
+  }
+};
+
+#endif    // !defined(__ANDROID__)
+
 struct TestCommand : public Command
 {
 private:
@@ -1572,6 +2172,9 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
     add_command("capaltbit", new CapAltBitCommand());
     add_command("test", new TestCommand());
     add_command("convert", new ConvertCommand());
+#if !defined(__ANDROID__)
+    add_command("analyse", new AnalyseCommand());
+#endif
     add_command("embed", new EmbeddedSectionCommand(false));
     add_command("extract", new EmbeddedSectionCommand(true));
 #endif    // !defined(RDOC_SELFCAPTURE_LIMITEDAPI)
@@ -59,3 +59,7 @@ void DisplayRendererPreview(IReplayController *renderer, TextureDisplay &display
                             uint32_t height, uint32_t numLoops);
 WindowingData DisplayRemoteServerPreview(bool active, const rdcarray<WindowingSystem> &systems);
 void Daemonise();
+// run this executable again with the given arguments and collect everything it writes to
+// stdout. Returns false with a description in error if it couldn't be run or didn't exit normally.
+bool RunWorkerProcess(const std::vector<std::string> &args, std::string &output,
+                      std::string &error);
@@ -71,6 +71,12 @@ void Daemonise()
 {
 }
 
+bool RunWorkerProcess(const std::vector<std::string> &args, std::string &output, std::string &error)
+{
+  error = "Worker processes aren't supported on Android";
+  return false;
+}
+
 // every 15 minutes we fade briefly to avoid burn-in
 const float splashFadePeriod = 45 * 60.0f;
 
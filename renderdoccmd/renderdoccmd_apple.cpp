@@ -23,10 +23,17 @@
  ******************************************************************************/
 
 #include "renderdoccmd.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <locale.h>
+#include <mach-o/dyld.h>
 #include <string.h>
+#include <sys/wait.h>
 #include <unistd.h>
+#include <mutex>
 #include <string>
+#include <vector>
 
 // helpers defined in cocoa_window.mm
 extern void *cocoa_windowCreate(int width, int height, const char *title);
@@ -39,6 +46,92 @@ void Daemonise()
 {
 }
 
+bool RunWorkerProcess(const std::vector<std::string> &args, std::string &output, std::string &error)
+{
+  char exe[PATH_MAX + 1] = {};
+  uint32_t exeSize = PATH_MAX;
+  if(_NSGetExecutablePath(exe, &exeSize) != 0)
+  {
+    error = "Couldn't locate renderdoccmd executable";
+    return false;
+  }
+
+  // build the arguments up front, only async-signal-safe calls can be made after fork()
+  std::vector<char *> argv;
+  argv.push_back(exe);
+  for(const std::string &a : args)
+    argv.push_back((char *)a.c_str());
+  argv.push_back(NULL);
+
+
+  // there's no pipe2() here, so hold a lock from creating the pipe until it's marked close-on-exec
+  // and our end is closed. Otherwise workers launched concurrently from other threads could inherit
+  // this pipe, which would keep it open past this worker's exit
+  static std::mutex forkLock;
+
+  int fds[2];
+  pid_t pid;
+  int forkError;
+  {
+    std::lock_guard<std::mutex> guard(forkLock);
+
+    if(pipe(fds) != 0)
+    {
+      error = "Couldn't create pipe: " + std::string(strerror(errno));
+      return false;
+    }
+
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+    pid = fork();
+    forkError = errno;
+
+    if(pid == 0)
+    {
+      dup2(fds[1], STDOUT_FILENO);
+      execv(exe, argv.data());
+      _exit(127);
+    }
+
+    close(fds[1]);
+  }
+
+  if(pid < 0)
+  {
+    close(fds[0]);
+    error = "Couldn't launch analysis process: " + std::string(strerror(forkError));
+    return false;
+  }
+
+  // read this side until the worker exits and closes its end, then reap it
+  char buf[4096];
+  for(;;)
+  {
+    ssize_t numRead = read(fds[0], buf, sizeof(buf));
+    if(numRead > 0)
+      output.append(buf, (size_t)numRead);
+    else if(numRead == 0 || errno != EINTR)
+      break;
+  }
+
+  close(fds[0]);
+
+  int status = 0;
+  while(waitpid(pid, &status, 0) < 0 && errno == EINTR)
+  {
+  }
+
+  if(WIFSIGNALED(status))
+  {
+    error = "Analysis process crashed with signal " + std::to_string(WTERMSIG(status)) + " (" +
+            strsignal(WTERMSIG(status)) + ")";
+    return false;
+  }
+
+  return true;
+}
+
 WindowingData DisplayRemoteServerPreview(bool active, const rdcarray<WindowingSystem> &systems)
 {
   WindowingData ret = {WindowingSystem::Unknown};
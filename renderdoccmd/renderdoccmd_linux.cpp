@@ -25,6 +25,8 @@
 
 #include "renderdoccmd.h"
 #include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <iconv.h>
 #include <limits.h>
 #include <locale.h>
@@ -33,8 +35,10 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <string>
+#include <vector>
 
 #if defined(RENDERDOC_WINDOWING_XLIB)
 #include <X11/Xlib-xcb.h>
@@ -48,6 +52,79 @@ void Daemonise()
   daemon(1, 0);
 }
 
+bool RunWorkerProcess(const std::vector<std::string> &args, std::string &output, std::string &error)
+{
+  char exe[PATH_MAX + 1] = {};
+  if(readlink("/proc/self/exe", exe, PATH_MAX) <= 0)
+  {
+    error = "Couldn't locate renderdoccmd executable";
+    return false;
+  }
+
+  // build the arguments up front, only async-signal-safe calls can be made after fork()
+  std::vector<char *> argv;
+  argv.push_back(exe);
+  for(const std::string &a : args)
+    argv.push_back((char *)a.c_str());
+  argv.push_back(NULL);
+
+
+  // close-on-exec so that workers launched concurrently from other threads don't inherit this
+  // pipe, which would keep it open past this worker's exit
+  int fds[2];
+  if(pipe2(fds, O_CLOEXEC) != 0)
+  {
+    error = "Couldn't create pipe: " + std::string(strerror(errno));
+    return false;
+  }
+
+  pid_t pid = fork();
+  int forkError = errno;
+
+  if(pid == 0)
+  {
+    dup2(fds[1], STDOUT_FILENO);
+    execv(exe, argv.data());
+    _exit(127);
+  }
+
+  close(fds[1]);
+
+  if(pid < 0)
+  {
+    close(fds[0]);
+    error = "Couldn't launch analysis process: " + std::string(strerror(forkError));
+    return false;
+  }
+
+  // read this side until the worker exits and closes its end, then reap it
+  char buf[4096];
+  for(;;)
+  {
+    ssize_t numRead = read(fds[0], buf, sizeof(buf));
+    if(numRead > 0)
+      output.append(buf, (size_t)numRead);
+    else if(numRead == 0 || errno != EINTR)
+      break;
+  }
+
+  close(fds[0]);
+
+  int status = 0;
+  while(waitpid(pid, &status, 0) < 0 && errno == EINTR)
+  {
+  }
+
+  if(WIFSIGNALED(status))
+  {
+    error = "Analysis process crashed with signal " + std::to_string(WTERMSIG(status)) + " (" +
+            strsignal(WTERMSIG(status)) + ")";
+    return false;
+  }
+
+  return true;
+}
+
 static Display *display = NULL;
 
 WindowingData DisplayRemoteServerPreview(bool active, const rdcarray<WindowingSystem> &systems)
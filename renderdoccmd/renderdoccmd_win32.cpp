@@ -27,6 +27,7 @@
 #include <app/renderdoc_app.h>
 #include <renderdocshim.h>
 #include <windows.h>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "miniz/miniz.h"
@@ -130,6 +131,126 @@ void Daemonise()
   // nothing really to do, windows version of renderdoccmd is already 'detached'
 }
 
+// quote an argument so that it's parsed back exactly by the C runtime's command line splitting
+static std::wstring quote_arg(const std::wstring &arg)
+{
+  if(!arg.empty() && arg.find_first_of(L" \t\n\v\"") == std::wstring::npos)
+    return arg;
+
+  std::wstring ret = L"\"";
+
+  for(size_t i = 0;; i++)
+  {
+    size_t backslashes = 0;
+    while(i < arg.size() && arg[i] == L'\\')
+    {
+      i++;
+      backslashes++;
+    }
+
+    if(i == arg.size())
+    {
+      // double up trailing backslashes so they don't escape the closing quote
+      ret.append(backslashes * 2, L'\\');
+      break;
+    }
+    else if(arg[i] == L'"')
+    {
+      ret.append(backslashes * 2 + 1, L'\\');
+      ret.push_back(arg[i]);
+    }
+    else
+    {
+      ret.append(backslashes, L'\\');
+      ret.push_back(arg[i]);
+    }
+  }
+
+  ret.push_back(L'"');
+
+  return ret;
+}
+
+bool RunWorkerProcess(const std::vector<std::string> &args, std::string &output, std::string &error)
+{
+  wchar_t exe[MAX_PATH + 1] = {};
+  GetModuleFileNameW(NULL, exe, MAX_PATH);
+
+  std::wstring cmdLine = quote_arg(exe);
+  for(const std::string &a : args)
+    cmdLine += L" " + quote_arg(conv(a));
+
+  SECURITY_ATTRIBUTES pSec = {};
+  pSec.nLength = sizeof(pSec);
+  pSec.bInheritHandle = TRUE;
+
+  PROCESS_INFORMATION pi = {};
+  STARTUPINFOW si = {};
+  si.cb = sizeof(si);
+  si.dwFlags = STARTF_USESTDHANDLES;
+  si.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+  si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+  HANDLE readPipe = NULL, writePipe = NULL;
+  BOOL created = FALSE;
+
+  {
+    // the write end is inheritable, so hold a lock until our copy is closed. Otherwise workers
+    // launched concurrently from other threads could inherit it, which would keep the pipe open
+    // past this worker's exit
+    static std::mutex launchLock;
+    std::lock_guard<std::mutex> guard(launchLock);
+
+    if(!CreatePipe(&readPipe, &writePipe, &pSec, 0))
+    {
+      error = "Couldn't create pipe";
+      return false;
+    }
+
+    SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0);
+
+    si.hStdOutput = writePipe;
+
+    created = CreateProcessW(NULL, &cmdLine[0], NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi);
+
+    CloseHandle(writePipe);
+  }
+
+  if(!created)
+  {
+    CloseHandle(readPipe);
+    error = "Couldn't launch analysis process";
+    return false;
+  }
+
+  // read our end until the worker exits and closes its end, then collect its exit code
+  char buf[4096];
+  DWORD numRead = 0;
+  while(ReadFile(readPipe, buf, sizeof(buf), &numRead, NULL) && numRead > 0)
+    output.append(buf, numRead);
+
+  CloseHandle(readPipe);
+
+  WaitForSingleObject(pi.hProcess, INFINITE);
+
+  DWORD exitCode = 0;
+  GetExitCodeProcess(pi.hProcess, &exitCode);
+
+  CloseHandle(pi.hProcess);
+  CloseHandle(pi.hThread);
+
+  // NTSTATUS error codes, e.g. 0xC0000005 for an access violation, mean the process crashed
+  if(exitCode >= 0xC0000000)
+  {
+    char hex[16];
+    snprintf(hex, sizeof(hex), "0x%08X", (unsigned int)exitCode);
+    error = std::string("Analysis process crashed with exception ") + hex;
+    return false;
+  }
+
+  return true;
+}
+
 WindowingData DisplayRemoteServerPreview(bool active, const rdcarray<WindowingSystem> &systems)
 {
   static WindowingData remoteServerPreview = {WindowingSystem::Unknown};
@@ -1,3 +1,4 @@
+import struct
 import renderdoc as rd
 import rdtest
 
@@ -49,6 +50,33 @@ class GL_Simple_Triangle(rdtest.TestCase):
 
         self.check_mesh_data(postvs_ref, postvs_data)
 
+        # Data returned from functions is a read-only memoryview, while bytes stored in structs are
+        # still returned as bytes
+        pipe: rd.PipeState = self.controller.GetPipelineState()
+
+        vsrefl: rd.ShaderReflection = pipe.GetShaderReflection(rd.ShaderStage.Vertex)
+        self.check(isinstance(vsrefl.rawBytes, bytes))
+        self.check(b'main' in vsrefl.rawBytes)
+
+        vb: rd.BoundVBuffer = pipe.GetVBuffers()[0]
+        vb_data = self.controller.GetBufferData(vb.resourceId, vb.byteOffset, 0)
+        self.check(isinstance(vb_data, memoryview))
+        self.check(vb_data.readonly)
+        self.check(len(vb_data) > 0 and bytes(vb_data) == vb_data.tobytes())
+
+        # the view decodes in place to the triangle's vertex positions
+        tri_pos = [[-0.5, -0.5, 0.0], [0.0, 0.5, 0.0], [0.5, -0.5, 0.0]]
+        self.check(len(vb_data) >= vb.byteStride * len(tri_pos))
+
+        for i, ref in enumerate(tri_pos):
+            pos = list(struct.unpack_from("3f", vb_data, i * vb.byteStride))
+
+            if not rdtest.value_compare(ref, pos):
+                raise rdtest.TestFailureException(
+                    "Vertex {} position {} from buffer data is not as expected {}".format(i, pos, ref))
+
+        rdtest.log.success("Byte data is returned with the expected types")
+
         save_data = rd.TextureSave()
         save_data.destType = rd.FileType.DDS
         path = rdtest.get_tmp_path('temp.dds')